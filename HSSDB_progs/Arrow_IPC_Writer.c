@@ -0,0 +1,655 @@
+//  Writes tables in the Apache Arrow IPC format, so that the data can be read by
+//  pyarrow, pandas, DuckDB, etc., without any parsing: e.g., in Python,
+//     pyarrow.ipc.open_file ( "Processed_TTE.arrow" ) .read_all ()
+//  or pyarrow.memory_map to map the file instead of reading it.
+
+//  Implemented here, without libarrow, for the few types needed: columns of
+//  unsigned integers (8, 16, 32 or 64 bit), each either one value per row or a
+//  fixed size list of values per row (e.g., the 14 x 8 counts of a CTIME packet).
+//  No column has nulls.
+
+//  A file whose name ends in .arrows is written in the IPC stream format;
+//  otherwise the IPC file format ("ARROW1" magic, the stream, then a footer with
+//  the locations of the record batches) is written, which can be memory mapped.
+
+//  The Arrow metadata are flatbuffers (Schema.fbs, Message.fbs, File.fbs of the
+//  Arrow format), which are built here by a minimal builder: everything is
+//  appended front to back, each table preceded by its vtable, and each offset
+//  field is patched when the object it refers to has been appended (flatbuffer
+//  offsets must point forward).   Little-endian byte order is assumed, as
+//  elsewhere in these programs.
+
+//  As elsewhere in these programs, errors are fatal: a message is output and the
+//  program exits.
+
+
+#include "HSSDB_Progs_Header.h"
+
+
+//  Arrow format constants:
+
+#define  ARROW_MAGIC                 "ARROW1"
+#define  ARROW_METADATA_V5           4
+#define  ARROW_HEADER_SCHEMA         1
+#define  ARROW_HEADER_RECORD_BATCH   3
+#define  ARROW_TYPE_INT              2
+#define  ARROW_TYPE_FIXED_SIZE_LIST  16
+#define  ARROW_CONTINUATION          0xFFFFFFFFU
+
+#define  INITIAL_FLATBUFFER_BYTES   1024U
+#define  INITIAL_NUM_BLOCKS          64U
+
+
+//  local typedefs:
+
+typedef struct  Flatbuffer_type {
+   uint8_t *  Bytes;
+   uint32_t  Size;
+   uint32_t  Capacity;
+} Flatbuffer_type;
+
+//  The Buffer and FieldNode structs of Message.fbs (Block of File.fbs is
+//  Arrow_Block_type, in the header):
+
+typedef struct  Arrow_Buffer_type {
+   int64_t  Offset;
+   int64_t  Length;
+} Arrow_Buffer_type;
+
+typedef struct  Arrow_Field_Node_type {
+   int64_t  Length;
+   int64_t  Null_Count;
+} Arrow_Field_Node_type;
+
+
+//  local function prototypes:
+
+static uint32_t  FB_Append ( Flatbuffer_type * FB_ptr, uint32_t Num_Bytes, uint32_t Alignment, uint32_t Alignment_Offset );
+
+static void  FB_Put ( Flatbuffer_type * FB_ptr, uint32_t Position, const void * Value_ptr, uint32_t Num_Bytes );
+
+static void  FB_Set_Offset ( Flatbuffer_type * FB_ptr, uint32_t Field_Position, uint32_t Target_Position );
+
+static uint32_t  FB_Table ( Flatbuffer_type * FB_ptr, uint32_t Num_Fields, const uint32_t Field_Sizes [], uint32_t Field_Positions [] );
+
+static uint32_t  FB_Vector ( Flatbuffer_type * FB_ptr, uint32_t Num_Elements, uint32_t Element_Bytes, uint32_t Alignment );
+
+static uint32_t  FB_String ( Flatbuffer_type * FB_ptr, const char * String );
+
+static uint32_t  Build_Schema ( Flatbuffer_type * FB_ptr, const Arrow_File_type * Arrow_ptr );
+
+static uint32_t  Build_Field ( Flatbuffer_type * FB_ptr, const char * Name, uint32_t Bit_Width, uint32_t List_Size );
+
+static uint32_t  Build_Message ( Flatbuffer_type * FB_ptr, uint8_t Header_Type, int64_t Body_Length );
+
+static void  Write_Message ( Arrow_File_type * Arrow_ptr, Flatbuffer_type * FB_ptr );
+
+static void  Write_Bytes ( Arrow_File_type * Arrow_ptr, const void * Bytes, size_t Num_Bytes );
+
+static void  Write_Padding ( Arrow_File_type * Arrow_ptr, size_t Num_Bytes );
+
+
+static const uint8_t  Zeros [8];
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Opens the output file and writes the schema: the columns, in order, with their
+//  names and types.
+
+void Open_Arrow_Output (
+
+   // Input arguments:
+   const char * FileName,
+   uint32_t Num_Columns,
+   const Arrow_Column_type Columns [],
+
+   // Output argument:
+   Arrow_File_type * Arrow_ptr
+
+) {
+
+   Flatbuffer_type  FB = { NULL, 0, 0 };
+   uint32_t  Header_Field;
+   size_t  FileName_Length;
+   uint32_t  i_col;
+
+
+   if ( Num_Columns == 0  ||  Num_Columns > MAX_ARROW_COLUMNS ) {
+      printf ( "\n\nProgram logic error: %u Arrow columns requested -- Exiting!\n", Num_Columns );
+      exit (100);
+   }
+
+   for ( i_col=0;  i_col < Num_Columns;  i_col++ ) {
+      if ( Columns [i_col] .Bit_Width != 8  &&  Columns [i_col] .Bit_Width != 16  &&
+           Columns [i_col] .Bit_Width != 32  &&  Columns [i_col] .Bit_Width != 64 ) {
+         printf ( "\n\nProgram logic error: bad Arrow column '%s' -- Exiting!\n", Columns [i_col] .Name );
+         exit (100);
+      }
+   }
+
+   Arrow_ptr->File_ptr = fopen ( FileName, "wb" );
+   if ( Arrow_ptr->File_ptr == NULL ) {
+      printf ( "\n\nFailed to open output Arrow File '%s' -- Exiting!\n", FileName );
+      exit (101);
+   }
+
+   Arrow_ptr->Num_Columns = Num_Columns;
+   memcpy ( Arrow_ptr->Columns, Columns, Num_Columns * sizeof (Arrow_Column_type) );
+
+   FileName_Length = strlen ( FileName );
+   Arrow_ptr->Stream_Format = FileName_Length >= 7  &&  strcmp ( FileName + FileName_Length - 7, ".arrows" ) == 0;
+
+   Arrow_ptr->Offset = 0;
+   Arrow_ptr->Num_Rows = 0;
+   Arrow_ptr->Blocks = NULL;
+   Arrow_ptr->Num_Blocks = 0;
+   Arrow_ptr->Block_Capacity = 0;
+
+   if ( ! Arrow_ptr->Stream_Format ) {
+      Write_Bytes ( Arrow_ptr, ARROW_MAGIC, 6 );
+      Write_Padding ( Arrow_ptr, 2 );
+   }
+
+   Header_Field = Build_Message ( &FB, ARROW_HEADER_SCHEMA, 0 );
+   FB_Set_Offset ( &FB, Header_Field, Build_Schema ( &FB, Arrow_ptr ) );
+
+   Write_Message ( Arrow_ptr, &FB );
+
+   free ( FB.Bytes );
+
+}  // Open_Arrow_Output ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Writes Num_Rows rows as one record batch.   Column_Data [i] holds the values of
+//  column i, Num_Rows x List_Size values (or Num_Rows if List_Size = 0), as a plain
+//  array of the column's type.
+
+void Write_Arrow_Batch (
+
+   // Input/Output argument:
+   Arrow_File_type * Arrow_ptr,
+
+   // Input arguments:
+   uint32_t Num_Rows,
+   const void * const Column_Data []
+
+) {
+
+   Flatbuffer_type  FB = { NULL, 0, 0 };
+   uint32_t  Table_Fields [3];
+   uint32_t  Nodes_Vector;
+   uint32_t  Buffers_Vector;
+   uint32_t  Header_Field;
+   uint32_t  Num_Nodes = 0;
+   uint32_t  Num_Buffers = 0;
+
+   Arrow_Field_Node_type  Nodes [2 * MAX_ARROW_COLUMNS];
+   Arrow_Buffer_type  Buffers [4 * MAX_ARROW_COLUMNS];
+   uint64_t  Data_Bytes [MAX_ARROW_COLUMNS];
+   int64_t  Body_Length = 0;
+   int64_t  Num_Values;
+   int64_t  Length;
+   Arrow_Block_type * New_Blocks;
+   Arrow_Block_type * Block_ptr;
+
+   static const uint32_t  Record_Batch_Sizes [3] = { 8, 4, 4 };   // length, nodes, buffers
+
+   uint32_t  i_col;
+
+
+   if ( Num_Rows == 0 )  return;
+
+
+   //  The layout of the body: for a column of values, a validity bitmap (empty, since
+   //  there are no nulls) and the values; for a fixed size list, an empty validity
+   //  bitmap for the lists, then the child array of values.
+
+   for ( i_col=0;  i_col < Arrow_ptr->Num_Columns;  i_col++ ) {
+
+      Num_Values = (int64_t) Num_Rows;
+      if ( Arrow_ptr->Columns [i_col] .List_Size > 0 ) {
+         Nodes [Num_Nodes] .Length = (int64_t) Num_Rows;
+         Nodes [Num_Nodes] .Null_Count = 0;
+         Num_Nodes++;
+         Buffers [Num_Buffers] .Offset = Body_Length;
+         Buffers [Num_Buffers] .Length = 0;
+         Num_Buffers++;
+         Num_Values *= Arrow_ptr->Columns [i_col] .List_Size;
+      }
+
+      Nodes [Num_Nodes] .Length = Num_Values;
+      Nodes [Num_Nodes] .Null_Count = 0;
+      Num_Nodes++;
+
+      Data_Bytes [i_col] = (uint64_t) Num_Values * Arrow_ptr->Columns [i_col] .Bit_Width / 8;
+
+      Buffers [Num_Buffers] .Offset = Body_Length;
+      Buffers [Num_Buffers] .Length = 0;
+      Num_Buffers++;
+      Buffers [Num_Buffers] .Offset = Body_Length;
+      Buffers [Num_Buffers] .Length = (int64_t) Data_Bytes [i_col];
+      Num_Buffers++;
+
+      Body_Length += (int64_t) ( ( Data_Bytes [i_col] + 7 ) & ~ (uint64_t) 7 );
+
+   }
+
+
+   //  The RecordBatch message:
+
+   Header_Field = Build_Message ( &FB, ARROW_HEADER_RECORD_BATCH, Body_Length );
+   FB_Set_Offset ( &FB, Header_Field, FB_Table ( &FB, 3, Record_Batch_Sizes, Table_Fields ) );
+   Length = (int64_t) Num_Rows;
+   FB_Put ( &FB, Table_Fields [0], &Length, 8 );
+
+   Nodes_Vector = FB_Vector ( &FB, Num_Nodes, sizeof (Arrow_Field_Node_type), 8 );
+   FB_Put ( &FB, Nodes_Vector + 4, Nodes, Num_Nodes * (uint32_t) sizeof (Arrow_Field_Node_type) );
+   FB_Set_Offset ( &FB, Table_Fields [1], Nodes_Vector );
+
+   Buffers_Vector = FB_Vector ( &FB, Num_Buffers, sizeof (Arrow_Buffer_type), 8 );
+   FB_Put ( &FB, Buffers_Vector + 4, Buffers, Num_Buffers * (uint32_t) sizeof (Arrow_Buffer_type) );
+   FB_Set_Offset ( &FB, Table_Fields [2], Buffers_Vector );
+
+
+   //  Remember where the batch is, for the footer:
+
+   if ( Arrow_ptr->Num_Blocks == Arrow_ptr->Block_Capacity ) {
+      Arrow_ptr->Block_Capacity = ( Arrow_ptr->Block_Capacity == 0 )  ?  INITIAL_NUM_BLOCKS  :  2 * Arrow_ptr->Block_Capacity;
+      New_Blocks = realloc ( Arrow_ptr->Blocks, Arrow_ptr->Block_Capacity * sizeof (Arrow_Block_type) );
+      if ( New_Blocks == NULL ) {
+         printf ( "\n\nmalloc of Arrow block list failed. exiting.\n" );
+         exit (102);
+      }
+      Arrow_ptr->Blocks = New_Blocks;
+   }
+
+   Block_ptr = &Arrow_ptr->Blocks [Arrow_ptr->Num_Blocks];
+   Block_ptr->Offset = (int64_t) Arrow_ptr->Offset;
+   Block_ptr->Padding = 0;
+   Block_ptr->Body_Length = Body_Length;
+
+   Write_Message ( Arrow_ptr, &FB );
+
+   Block_ptr->Metadata_Length = (int32_t) ( (int64_t) Arrow_ptr->Offset - Block_ptr->Offset );
+   Arrow_ptr->Num_Blocks++;
+
+
+   //  The body:
+
+   for ( i_col=0;  i_col < Arrow_ptr->Num_Columns;  i_col++ ) {
+      Write_Bytes ( Arrow_ptr, Column_Data [i_col], Data_Bytes [i_col] );
+      Write_Padding ( Arrow_ptr, ( 8 - Data_Bytes [i_col] % 8 ) % 8 );
+   }
+
+   Arrow_ptr->Num_Rows += Num_Rows;
+
+   free ( FB.Bytes );
+
+}  // Write_Arrow_Batch ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Writes the end-of-stream marker and, for the file format, the footer.
+
+void Close_Arrow_Output (
+
+   // Input/Output argument:
+   Arrow_File_type * Arrow_ptr
+
+) {
+
+   Flatbuffer_type  FB = { NULL, 0, 0 };
+   uint32_t  Footer_Fields [4];
+   uint32_t  Footer;
+   uint32_t  Vector;
+   int32_t  Footer_Length;
+   int16_t  Version = ARROW_METADATA_V5;
+
+   static const uint32_t  Footer_Sizes [4] = { 2, 4, 4, 4 };   // version, schema, dictionaries, recordBatches
+   static const uint32_t  End_of_Stream [2] = { ARROW_CONTINUATION, 0 };
+
+
+   Write_Bytes ( Arrow_ptr, End_of_Stream, sizeof (End_of_Stream) );
+
+   if ( ! Arrow_ptr->Stream_Format ) {  // file format ?
+
+      FB_Append ( &FB, 4, 4, 0 );   // root offset
+      Footer = FB_Table ( &FB, 4, Footer_Sizes, Footer_Fields );
+      FB_Set_Offset ( &FB, 0, Footer );
+      FB_Put ( &FB, Footer_Fields [0], &Version, 2 );
+
+      FB_Set_Offset ( &FB, Footer_Fields [1], Build_Schema ( &FB, Arrow_ptr ) );
+
+      FB_Set_Offset ( &FB, Footer_Fields [2], FB_Vector ( &FB, 0, sizeof (Arrow_Block_type), 8 ) );
+
+      Vector = FB_Vector ( &FB, Arrow_ptr->Num_Blocks, sizeof (Arrow_Block_type), 8 );
+      if ( Arrow_ptr->Num_Blocks > 0 )
+         FB_Put ( &FB, Vector + 4, Arrow_ptr->Blocks, Arrow_ptr->Num_Blocks * (uint32_t) sizeof (Arrow_Block_type) );
+      FB_Set_Offset ( &FB, Footer_Fields [3], Vector );
+
+      Footer_Length = (int32_t) FB.Size;
+      Write_Bytes ( Arrow_ptr, FB.Bytes, FB.Size );
+      Write_Bytes ( Arrow_ptr, &Footer_Length, 4 );
+      Write_Bytes ( Arrow_ptr, ARROW_MAGIC, 6 );
+
+      free ( FB.Bytes );
+
+   }  // file format ?
+
+   if ( fclose ( Arrow_ptr->File_ptr ) != 0 ) {
+      printf ( "\nClose of Arrow file failed !\n" );
+      exit (103);
+   }
+
+   Arrow_ptr->File_ptr = NULL;
+   free ( Arrow_ptr->Blocks );
+   Arrow_ptr->Blocks = NULL;
+
+}  // Close_Arrow_Output ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The Schema table: the fields, one per column.
+
+static uint32_t  Build_Schema ( Flatbuffer_type * FB_ptr, const Arrow_File_type * Arrow_ptr ) {
+
+   uint32_t  Schema_Fields [2];
+   uint32_t  Schema;
+   uint32_t  Vector;
+   uint32_t  i_col;
+
+   static const uint32_t  Schema_Sizes [2] = { 2, 4 };   // endianness, fields
+
+
+   Schema = FB_Table ( FB_ptr, 2, Schema_Sizes, Schema_Fields );   // endianness: 0 = little
+
+   Vector = FB_Vector ( FB_ptr, Arrow_ptr->Num_Columns, 4, 4 );
+   FB_Set_Offset ( FB_ptr, Schema_Fields [1], Vector );
+
+   for ( i_col=0;  i_col < Arrow_ptr->Num_Columns;  i_col++ )
+      FB_Set_Offset ( FB_ptr, Vector + 4 + 4 * i_col, Build_Field ( FB_ptr, Arrow_ptr->Columns [i_col] .Name,
+                                                                    Arrow_ptr->Columns [i_col] .Bit_Width,
+                                                                    Arrow_ptr->Columns [i_col] .List_Size ) );
+
+   return Schema;
+
+}  // Build_Schema ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  A Field table: an unsigned integer, or a fixed size list of them, not nullable.
+
+static uint32_t  Build_Field ( Flatbuffer_type * FB_ptr, const char * Name, uint32_t Bit_Width, uint32_t List_Size ) {
+
+   uint32_t  Field_Fields [6];
+   uint32_t  Type_Fields [2];
+   uint32_t  Field;
+   uint32_t  Children;
+   uint8_t  Type_Type;
+
+   //  name, nullable, type_type, type, dictionary, children:
+   static const uint32_t  Field_Sizes [6] = { 4, 1, 1, 4, 0, 4 };
+   static const uint32_t  Int_Sizes [2] = { 4, 1 };            // bitWidth, is_signed
+   static const uint32_t  List_Sizes [1] = { 4 };              // listSize
+
+
+   Field = FB_Table ( FB_ptr, 6, Field_Sizes, Field_Fields );
+
+   FB_Set_Offset ( FB_ptr, Field_Fields [0], FB_String ( FB_ptr, Name ) );
+
+   if ( List_Size > 0 ) {  // list ?
+
+      Type_Type = ARROW_TYPE_FIXED_SIZE_LIST;
+      FB_Put ( FB_ptr, Field_Fields [2], &Type_Type, 1 );
+      FB_Set_Offset ( FB_ptr, Field_Fields [3], FB_Table ( FB_ptr, 1, List_Sizes, Type_Fields ) );
+      FB_Put ( FB_ptr, Type_Fields [0], &List_Size, 4 );
+
+      Children = FB_Vector ( FB_ptr, 1, 4, 4 );
+      FB_Set_Offset ( FB_ptr, Field_Fields [5], Children );
+      FB_Set_Offset ( FB_ptr, Children + 4, Build_Field ( FB_ptr, "item", Bit_Width, 0 ) );
+
+   } else {  // list ?
+
+      Type_Type = ARROW_TYPE_INT;
+      FB_Put ( FB_ptr, Field_Fields [2], &Type_Type, 1 );
+      FB_Set_Offset ( FB_ptr, Field_Fields [3], FB_Table ( FB_ptr, 2, Int_Sizes, Type_Fields ) );
+      FB_Put ( FB_ptr, Type_Fields [0], &Bit_Width, 4 );   // is_signed: false
+
+      FB_Set_Offset ( FB_ptr, Field_Fields [5], FB_Vector ( FB_ptr, 0, 4, 4 ) );   // no children
+
+   }  // list ?
+
+   return Field;
+
+}  // Build_Field ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Starts a new flatbuffer holding a Message table.   Returns the position of the
+//  header field, to be set to the header table when that has been built.
+
+static uint32_t  Build_Message ( Flatbuffer_type * FB_ptr, uint8_t Header_Type, int64_t Body_Length ) {
+
+   uint32_t  Message_Fields [4];
+   int16_t  Version = ARROW_METADATA_V5;
+
+   static const uint32_t  Message_Sizes [4] = { 2, 1, 4, 8 };   // version, header_type, header, bodyLength
+
+
+   FB_ptr->Size = 0;
+   FB_Append ( FB_ptr, 4, 4, 0 );   // root offset
+
+   FB_Set_Offset ( FB_ptr, 0, FB_Table ( FB_ptr, 4, Message_Sizes, Message_Fields ) );
+   FB_Put ( FB_ptr, Message_Fields [0], &Version, 2 );
+   FB_Put ( FB_ptr, Message_Fields [1], &Header_Type, 1 );
+   FB_Put ( FB_ptr, Message_Fields [3], &Body_Length, 8 );
+
+   return Message_Fields [2];
+
+}  // Build_Message ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Writes an encapsulated message: the continuation marker, the length of the
+//  metadata, the metadata padded to a multiple of 8 bytes.   The body, if any,
+//  follows, written by the caller.
+
+static void  Write_Message ( Arrow_File_type * Arrow_ptr, Flatbuffer_type * FB_ptr ) {
+
+   uint32_t  Prefix [2];
+
+
+   FB_Append ( FB_ptr, ( 8 - FB_ptr->Size % 8 ) % 8, 1, 0 );
+
+   Prefix [0] = ARROW_CONTINUATION;
+   Prefix [1] = FB_ptr->Size;
+
+   Write_Bytes ( Arrow_ptr, Prefix, sizeof (Prefix) );
+   Write_Bytes ( Arrow_ptr, FB_ptr->Bytes, FB_ptr->Size );
+
+}  // Write_Message ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Write_Bytes ( Arrow_File_type * Arrow_ptr, const void * Bytes, size_t Num_Bytes ) {
+
+   if ( Num_Bytes > 0  &&  fwrite ( Bytes, 1, Num_Bytes, Arrow_ptr->File_ptr ) != Num_Bytes ) {
+      printf ( "\nWrite to Arrow output file failed !\n" );
+      exit (104);
+   }
+
+   Arrow_ptr->Offset += Num_Bytes;
+
+}  // Write_Bytes ()
+
+
+
+static void  Write_Padding ( Arrow_File_type * Arrow_ptr, size_t Num_Bytes ) {
+
+   Write_Bytes ( Arrow_ptr, Zeros, Num_Bytes );
+
+}  // Write_Padding ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The flatbuffer builder.
+
+//  Appends Num_Bytes zero bytes, first padding so that their position plus
+//  Alignment_Offset is a multiple of Alignment.   Returns their position.
+
+static uint32_t  FB_Append ( Flatbuffer_type * FB_ptr, uint32_t Num_Bytes, uint32_t Alignment, uint32_t Alignment_Offset ) {
+
+   uint32_t  Position;
+   uint8_t * New_Bytes;
+
+
+   Position = FB_ptr->Size;
+   while ( ( Position + Alignment_Offset ) % Alignment != 0 )  Position++;
+
+   if ( Position + Num_Bytes > FB_ptr->Capacity ) {
+      while ( Position + Num_Bytes > FB_ptr->Capacity )
+         FB_ptr->Capacity = ( FB_ptr->Capacity == 0 )  ?  INITIAL_FLATBUFFER_BYTES  :  2 * FB_ptr->Capacity;
+      New_Bytes = realloc ( FB_ptr->Bytes, FB_ptr->Capacity );
+      if ( New_Bytes == NULL ) {
+         printf ( "\n\nmalloc of Arrow metadata failed. exiting.\n" );
+         exit (102);
+      }
+      FB_ptr->Bytes = New_Bytes;
+   }
+
+   memset ( FB_ptr->Bytes + FB_ptr->Size, 0, Position + Num_Bytes - FB_ptr->Size );
+   FB_ptr->Size = Position + Num_Bytes;
+
+   return Position;
+
+}  // FB_Append ()
+
+
+
+static void  FB_Put ( Flatbuffer_type * FB_ptr, uint32_t Position, const void * Value_ptr, uint32_t Num_Bytes ) {
+
+   memcpy ( FB_ptr->Bytes + Position, Value_ptr, Num_Bytes );
+
+}  // FB_Put ()
+
+
+
+//  Sets the offset field at Field_Position to refer to the object at Target_Position,
+//  which must come later in the buffer.
+
+static void  FB_Set_Offset ( Flatbuffer_type * FB_ptr, uint32_t Field_Position, uint32_t Target_Position ) {
+
+   uint32_t  Offset;
+
+
+   Offset = Target_Position - Field_Position;
+   FB_Put ( FB_ptr, Field_Position, &Offset, 4 );
+
+}  // FB_Set_Offset ()
+
+
+
+//  Appends a table with Num_Fields fields, preceded by its vtable.   Field_Sizes [i]
+//  is the size of field i (1, 2, 4 or 8 bytes -- 4 for an offset), or 0 if the field
+//  is absent.   The fields are zeroed; their positions are returned in Field_Positions,
+//  and the position of the table is returned.
+
+static uint32_t  FB_Table ( Flatbuffer_type * FB_ptr, uint32_t Num_Fields, const uint32_t Field_Sizes [], uint32_t Field_Positions [] ) {
+
+   uint16_t  VTable [2 + 8];
+   uint32_t  VTable_Position;
+   uint32_t  Table_Position;
+   uint32_t  Table_Bytes = 4;   // the vtable offset
+   int32_t  VTable_Offset;
+   uint32_t  i_field;
+
+
+   for ( i_field=0;  i_field < Num_Fields;  i_field++ ) {
+      if ( Field_Sizes [i_field] == 0 ) {
+         VTable [2 + i_field] = 0;
+         continue;
+      }
+      while ( Table_Bytes % Field_Sizes [i_field] != 0 )  Table_Bytes++;
+      VTable [2 + i_field] = (uint16_t) Table_Bytes;
+      Table_Bytes += Field_Sizes [i_field];
+   }
+
+   VTable [0] = (uint16_t) ( 4 + 2 * Num_Fields );
+   VTable [1] = (uint16_t) Table_Bytes;
+
+   VTable_Position = FB_Append ( FB_ptr, VTable [0], 2, 0 );
+   FB_Put ( FB_ptr, VTable_Position, VTable, VTable [0] );
+
+   Table_Position = FB_Append ( FB_ptr, Table_Bytes, 8, 0 );
+   VTable_Offset = (int32_t) ( Table_Position - VTable_Position );
+   FB_Put ( FB_ptr, Table_Position, &VTable_Offset, 4 );
+
+   for ( i_field=0;  i_field < Num_Fields;  i_field++ )
+      Field_Positions [i_field] = ( VTable [2 + i_field] == 0 )  ?  0  :  Table_Position + VTable [2 + i_field];
+
+   return Table_Position;
+
+}  // FB_Table ()
+
+
+
+//  Appends a vector: its length, then Num_Elements zeroed elements, aligned to
+//  Alignment.   Returns the position of the length; the elements follow it.
+
+static uint32_t  FB_Vector ( Flatbuffer_type * FB_ptr, uint32_t Num_Elements, uint32_t Element_Bytes, uint32_t Alignment ) {
+
+   uint32_t  Position;
+
+
+   Position = FB_Append ( FB_ptr, 4 + Num_Elements * Element_Bytes, Alignment, 4 );
+   FB_Put ( FB_ptr, Position, &Num_Elements, 4 );
+
+   return Position;
+
+}  // FB_Vector ()
+
+
+
+static uint32_t  FB_String ( Flatbuffer_type * FB_ptr, const char * String ) {
+
+   uint32_t  Position;
+   uint32_t  Length;
+
+
+   Length = (uint32_t) strlen ( String );
+   Position = FB_Append ( FB_ptr, 4 + Length + 1, 4, 0 );   // the terminating NUL is zero
+   FB_Put ( FB_ptr, Position, &Length, 4 );
+   FB_Put ( FB_ptr, Position + 4, String, Length );
+
+   return Position;
+
+}  // FB_String ()
@@ -0,0 +1,29 @@
+//  Inverse of IntegerTime_from_CoarseFine: splits "unified GBM time", a single
+//  integer in 2 microsecond ticks, back into the two GBM MET counters,
+//  the 4-byte coarse time with units of 0.1 s and the 2-byte fine time
+//  with units of 2 microseconds.
+
+//  Used where a tool holds the time as a single integer (e.g., the v2
+//  processed TTE record) but needs to display or output the native
+//  (Coarse, Fine) form, which is better for debugging.
+
+
+#include "HSSDB_Progs_Header.h"
+
+
+//   First argument is input, the other two are output.
+
+void CoarseFine_from_IntegerTime (
+
+   uint64_t   Time_in_OneVariable,
+   uint32_t * CoarseTime_ptr,
+   uint16_t * FineTime_ptr
+
+) {
+
+   const uint64_t Ticks_per_Coarse = 50000;
+
+   *CoarseTime_ptr = (uint32_t) ( Time_in_OneVariable / Ticks_per_Coarse );
+   *FineTime_ptr = (uint16_t) ( Time_in_OneVariable % Ticks_per_Coarse );
+
+}  // CoarseFine_from_IntegerTime ()
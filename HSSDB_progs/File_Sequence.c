@@ -0,0 +1,361 @@
+//  Presents an ordered list of files as a single continuous input stream.
+
+//  The L0 data of a day is split into hourly or partial-day files, and packets
+//  can straddle the boundary between two files.   Open_File_Sequence returns an
+//  ordinary FILE pointer from which the bytes of all of the files can be read,
+//  in order, as if they were one file -- so ReSync and ReadPacket work unchanged,
+//  a packet that straddles a file boundary is read whole, and the state of the
+//  decoding routines (e.g., the most recent TTE time word and sequence count)
+//  carries across the boundaries.
+
+//  The files are read by a separate thread, which writes their bytes into a
+//  pipe; the FILE pointer returned is the read end of the pipe.   So the reading
+//  of the files proceeds while the main thread decodes.   When the thread starts
+//  on a file, it advises the OS that the next file will be needed, so that the
+//  next file is (where supported) read ahead into the page cache.
+
+//  Only one sequence can be open at a time.
+
+//  Expand_File_List turns command-line arguments into the list of files:
+//  an argument may be a file name, a wildcard pattern (quote it so that the shell
+//  doesn't expand it, e.g., 'GLAST_2008289_*_GBTTE.dat'), whose matches are used in
+//  alphabetical order, which for L0 file names is time order, or @ListFile, where
+//  ListFile contains the file names, one per line (blank lines and lines starting
+//  with # are ignored).
+
+
+#define  _POSIX_C_SOURCE  200809L
+
+#include "HSSDB_Progs_Header.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <glob.h>
+#include <sys/stat.h>
+
+
+//  Size of the blocks read from the files:
+#define  SEQUENCE_BLOCK_BYTES   (1U << 20)
+
+#define  MAX_LIST_LINE   1024U
+
+
+//  local typedefs:
+
+typedef struct  File_Sequence_type {
+   uint32_t  Num_Files;
+   char * const * FileNames;
+   int  Pipe_fd [2];          // [0]: read end, [1]: write end
+   pthread_t  Thread;
+   FILE * Stream_ptr;
+} File_Sequence_type;
+
+
+//  local function prototypes:
+
+static void * File_Sequence_Thread ( void * Arg_ptr );
+
+static void  Advise_WillNeed ( const char * FileName_ptr );
+
+static void  Add_File_to_List ( const char * FileName_ptr, char *** List_ptr, uint32_t * Num_ptr, uint32_t * Capacity_ptr );
+
+
+static File_Sequence_type  Sequence;
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+FILE * Open_File_Sequence (
+
+   //  input arguments:
+   uint32_t Num_Files,
+   char * const FileNames []
+
+) {
+
+   uint32_t  i_file;
+   struct stat  File_Status;
+
+
+   if ( Sequence.Stream_ptr != NULL ) {
+      printf ( "\nOpen_File_Sequence: a file sequence is already open!\n" );
+      exit (60);
+   }
+
+   //  Check all of the files now, rather than failing part way through the sequence:
+
+   for ( i_file=0;  i_file < Num_Files;  i_file++ ) {
+      if ( stat ( FileNames [i_file], &File_Status ) != 0  ||  ! S_ISREG ( File_Status.st_mode ) ) {
+         printf ( "\nFailed to find input file '%s' -- Exiting!\n", FileNames [i_file] );
+         exit (61);
+      }
+   }
+
+   Sequence.Num_Files = Num_Files;
+   Sequence.FileNames = FileNames;
+
+   if ( pipe ( Sequence.Pipe_fd ) != 0 ) {
+      printf ( "\nOpen_File_Sequence: pipe failed: %s\n", strerror (errno) );
+      exit (62);
+   }
+
+   Sequence.Stream_ptr = fdopen ( Sequence.Pipe_fd [0], "rb" );
+   if ( Sequence.Stream_ptr == NULL ) {
+      printf ( "\nOpen_File_Sequence: fdopen failed: %s\n", strerror (errno) );
+      exit (62);
+   }
+
+   if ( pthread_create ( &Sequence.Thread, NULL, File_Sequence_Thread, &Sequence ) != 0 ) {
+      printf ( "\nOpen_File_Sequence: failed to create the reading thread!\n" );
+      exit (63);
+   }
+
+   return Sequence.Stream_ptr;
+
+}  // Open_File_Sequence ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Closes the stream.   Any bytes not yet read are consumed first, so that the
+//  reading thread can finish normally.
+
+void Close_File_Sequence (
+
+   //  input argument:
+   FILE * Stream_ptr
+
+) {
+
+   char  Discard [4096];
+
+
+   if ( Stream_ptr == NULL  ||  Stream_ptr != Sequence.Stream_ptr )  return;
+
+   while ( fread ( Discard, 1, sizeof (Discard), Stream_ptr ) > 0 );
+
+   pthread_join ( Sequence.Thread, NULL );
+   fclose ( Stream_ptr );
+
+   Sequence.Stream_ptr = NULL;
+
+}  // Close_File_Sequence ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The reading thread: copies every file, in order, into the pipe, then closes the
+//  write end, which the reader sees as EOF.
+
+static void * File_Sequence_Thread ( void * Arg_ptr ) {
+
+   File_Sequence_type * Seq_ptr = Arg_ptr;
+
+   char * Block;
+   ssize_t  Num_Read;
+   ssize_t  Num_Written;
+   size_t  Offset;
+   uint32_t  i_file;
+   int  Input_fd;
+
+
+   Block = malloc ( SEQUENCE_BLOCK_BYTES );
+   if ( Block == NULL ) {
+      printf ( "\nFile_Sequence_Thread: malloc failed. exiting.\n" );
+      exit (64);
+   }
+
+   for ( i_file=0;  i_file < Seq_ptr->Num_Files;  i_file++ ) {  // loop over files
+
+      Input_fd = open ( Seq_ptr->FileNames [i_file], O_RDONLY );
+      if ( Input_fd < 0 ) {
+         printf ( "\nFailed to open input file '%s' -- Exiting!\n", Seq_ptr->FileNames [i_file] );
+         exit (61);
+      }
+
+      if ( i_file + 1 < Seq_ptr->Num_Files )  Advise_WillNeed ( Seq_ptr->FileNames [i_file + 1] );
+
+      while ( ( Num_Read = read ( Input_fd, Block, SEQUENCE_BLOCK_BYTES ) )  !=  0 ) {  // read file
+
+         if ( Num_Read < 0 ) {
+            if ( errno == EINTR )  continue;
+            printf ( "\nError reading input file '%s': %s -- Exiting!\n", Seq_ptr->FileNames [i_file], strerror (errno) );
+            exit (65);
+         }
+
+         for ( Offset=0;  Offset < (size_t) Num_Read;  Offset += (size_t) Num_Written ) {
+            Num_Written = write ( Seq_ptr->Pipe_fd [1], Block + Offset, (size_t) Num_Read - Offset );
+            if ( Num_Written < 0 ) {
+               if ( errno == EINTR ) {
+                  Num_Written = 0;
+                  continue;
+               }
+               printf ( "\nFile_Sequence_Thread: write to pipe failed: %s\n", strerror (errno) );
+               exit (66);
+            }
+         }
+
+      }  // read file
+
+      close ( Input_fd );
+
+   }  // loop over files
+
+   close ( Seq_ptr->Pipe_fd [1] );
+   free ( Block );
+
+   return NULL;
+
+}  // File_Sequence_Thread ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Asks the OS to start reading the file into the page cache.   Only a hint: on
+//  systems without posix_fadvise (e.g., macOS) it does nothing.
+
+static void  Advise_WillNeed ( const char * FileName_ptr ) {
+
+#ifdef POSIX_FADV_WILLNEED
+
+   int  fd;
+
+   fd = open ( FileName_ptr, O_RDONLY );
+   if ( fd < 0 )  return;
+
+   posix_fadvise ( fd, 0, 0, POSIX_FADV_WILLNEED );
+   close ( fd );
+
+#else
+
+   (void) FileName_ptr;
+
+#endif
+
+}  // Advise_WillNeed ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Expands the arguments (file names, wildcard patterns and @ListFiles) into the
+//  list of files, in order.   Returns the malloc'ed list; exits if no files.
+
+char ** Expand_File_List (
+
+   //  input arguments:
+   int Num_Args,
+   char * Args [],
+
+   //  output argument:
+   uint32_t * Num_Files_ptr
+
+) {
+
+   char **  List = NULL;
+   uint32_t  Capacity = 0;
+
+   FILE * ListFile_ptr;
+   char  Line [MAX_LIST_LINE];
+   size_t  Line_Length;
+   glob_t  Glob_Result;
+   size_t  i_match;
+   int  i_arg;
+
+
+   *Num_Files_ptr = 0;
+
+   for ( i_arg=0;  i_arg < Num_Args;  i_arg++ ) {  // loop over arguments
+
+      if ( Args [i_arg] [0] == '@' ) {  // list file / pattern / name ?
+
+         ListFile_ptr = fopen ( Args [i_arg] + 1, "r" );
+         if ( ListFile_ptr == NULL ) {
+            printf ( "\nFailed to open list file '%s' -- Exiting!\n", Args [i_arg] + 1 );
+            exit (67);
+         }
+
+         while ( fgets ( Line, MAX_LIST_LINE, ListFile_ptr ) != NULL ) {
+            Line_Length = strlen ( Line );
+            while ( Line_Length > 0  &&  ( Line [Line_Length-1] == '\n'  ||  Line [Line_Length-1] == '\r'  ||  Line [Line_Length-1] == ' ' ) )
+               Line [--Line_Length] = '\0';
+            if ( Line_Length == 0  ||  Line [0] == '#' )  continue;
+            Add_File_to_List ( Line, &List, Num_Files_ptr, &Capacity );
+         }
+
+         fclose ( ListFile_ptr );
+
+      } else if ( strpbrk ( Args [i_arg], "*?[" ) != NULL ) {  // list file / pattern / name ?
+
+         if ( glob ( Args [i_arg], 0, NULL, &Glob_Result ) != 0 ) {
+            printf ( "\nNo files match '%s' -- Exiting!\n", Args [i_arg] );
+            exit (68);
+         }
+
+         for ( i_match=0;  i_match < Glob_Result.gl_pathc;  i_match++ )
+            Add_File_to_List ( Glob_Result.gl_pathv [i_match], &List, Num_Files_ptr, &Capacity );
+
+         globfree ( &Glob_Result );
+
+      } else {  // list file / pattern / name ?
+
+         Add_File_to_List ( Args [i_arg], &List, Num_Files_ptr, &Capacity );
+
+      }  // list file / pattern / name ?
+
+   }  // loop over arguments
+
+
+   if ( *Num_Files_ptr == 0 ) {
+      printf ( "\nNo input files! -- Exiting!\n" );
+      exit (68);
+   }
+
+   return List;
+
+}  // Expand_File_List ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Add_File_to_List ( const char * FileName_ptr, char *** List_ptr, uint32_t * Num_ptr, uint32_t * Capacity_ptr ) {
+
+   char ** New_List;
+
+
+   if ( *Num_ptr == *Capacity_ptr ) {
+      *Capacity_ptr = ( *Capacity_ptr == 0 )  ?  16  :  2 * *Capacity_ptr;
+      New_List = realloc ( *List_ptr, *Capacity_ptr * sizeof (char *) );
+      if ( New_List == NULL ) {
+         printf ( "\nExpand_File_List: malloc failed. exiting.\n" );
+         exit (64);
+      }
+      *List_ptr = New_List;
+   }
+
+   ( *List_ptr ) [*Num_ptr] = malloc ( strlen ( FileName_ptr ) + 1 );
+   if ( ( *List_ptr ) [*Num_ptr] == NULL ) {
+      printf ( "\nExpand_File_List: malloc failed. exiting.\n" );
+      exit (64);
+   }
+   strcpy ( ( *List_ptr ) [*Num_ptr], FileName_ptr );
+
+   ( *Num_ptr )++;
+
+}  // Add_File_to_List ()
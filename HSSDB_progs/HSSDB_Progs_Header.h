@@ -32,6 +32,12 @@
 #define  NUM_DET         14U
 #define  NUM_NAI_DET     12U
 
+//  Units of the time of processed TTE (Time_in_OneVariable): 2 microsec ticks.
+#define  TICKS_PER_SECOND   500000U
+
+//  Detector selection mask with bit j set for each detector j:
+#define  ALL_DETECTORS_MASK   ( ( 1U << NUM_DET ) - 1U )
+
 
 //    Must be divisble by 4:
 #define  MAX_PACKET_ARRAY_BYTES    10000U
@@ -92,6 +98,516 @@ typedef struct   Processed_TTE_type {
 }  Processed_TTE_type;
 
 
+//  Version 2 of the processed TTE record.   The time is held only as
+//  GBM Unified Time (2 microsec ticks since the GLAST Epoch, see
+//  IntegerTime_from_CoarseFine), so that readers need no per-event time
+//  arithmetic.   The record is 16 bytes with the 64 bit time first, so
+//  that arrays of records (and the records of a file, which start after
+//  a 16 byte file header) are naturally aligned.
+//  Flags and Reserved are written as zero.
+
+typedef struct   Processed_TTE_v2_type {
+   uint64_t  Time_in_OneVariable;
+   uint8_t   Detector;
+   uint8_t   SpecChannel;
+   uint16_t  Flags;
+   uint32_t  Reserved;
+}  Processed_TTE_v2_type;
+
+
+//  A v2 file begins with this header.   Version 1 files (Processed_TTE_type)
+//  have no header.   The files are told apart by the magic string: bytes 6 and 7
+//  of the magic, read as the Detector field of a v1 record, give 50, which is
+//  not a legal detector number, so a v1 file can never begin with the magic.
+
+#define  PROCESSED_TTE_MAGIC   "PTTE_V2"
+
+typedef struct   Processed_TTE_File_Header_type {
+   char      Magic [8];      // PROCESSED_TTE_MAGIC, including the terminating NUL
+   uint32_t  Version;        // 2
+   uint32_t  RecordBytes;    // sizeof ( Processed_TTE_v2_type )
+}  Processed_TTE_File_Header_type;
+
+
+//  Version 3 is version 2 compressed: the same file header, with magic
+//  PROCESSED_TTE_Z_MAGIC (bytes 6 and 7 give the illegal v1 detector 51)
+//  and Version 3, then a sequence of compressed blocks of up to
+//  TTE_CODEC_BLOCK_EVENTS events -- see TTE_Codec.c.
+
+#define  PROCESSED_TTE_Z_MAGIC   "PTTE_Z3"
+
+#define  TTE_CODEC_BLOCK_EVENTS   4096U
+
+typedef struct   TTE_Block_Header_type {
+   uint32_t  Block_Bytes;    // size of the block, including this header
+   uint32_t  Num_Events;
+   uint64_t  First_Time;     // time of the first event
+   uint8_t   Time_Bits;      // widths of the packed fields
+   uint8_t   Time_Mode;      // 0: time differences, 1: zigzag coded differences
+   uint8_t   Det_Base;
+   uint8_t   Det_Bits;
+   uint8_t   Chan_Bits;
+   uint8_t   Flag_Bits;
+   uint16_t  Reserved;
+}  TTE_Block_Header_type;
+
+
+//  Version 4 is version 3 made seekable: magic PROCESSED_TTE_I_MAGIC (bytes 6
+//  and 7 give the illegal v1 detector 52) and Version 4, then the same compressed
+//  blocks, each followed by its zone map; then the block directory, one entry per
+//  block; then the trailer.   The directory allows a reader to find the blocks of
+//  a time range by binary search, and to skip blocks without events of the
+//  requested detectors -- see Select_Processed_TTE.
+
+#define  PROCESSED_TTE_I_MAGIC     "PTTE_I4"
+#define  TTE_DIRECTORY_MAGIC       "PTTEDIR"
+
+//  The channel summary: numbers of events in bins of 16 channels.
+#define  TTE_ZONE_CHANNEL_BINS   8U
+
+typedef struct   TTE_Zone_Map_type {
+   uint64_t  Min_Time;                   // earliest and latest times in the block
+   uint64_t  Max_Time;
+   uint16_t  Det_Counts [NUM_DET];       // number of events of each detector
+   uint16_t  Channel_Counts [TTE_ZONE_CHANNEL_BINS];   // channels 0-15, 16-31, ..., 112 and up
+   uint32_t  Num_Events;
+}  TTE_Zone_Map_type;
+
+typedef struct   TTE_Block_Directory_type {
+   uint64_t  Offset;                     // file offset of the block
+   TTE_Zone_Map_type  Zone_Map;
+}  TTE_Block_Directory_type;
+
+typedef struct   TTE_Block_Trailer_type {
+   uint64_t  Directory_Offset;
+   uint64_t  Num_Blocks;
+   char      Magic [8];                  // TTE_DIRECTORY_MAGIC, including the terminating NUL
+}  TTE_Block_Trailer_type;
+
+
+//  State of an open processed TTE file, for reading or writing
+//  any version -- see Processed_TTE_IO.c
+
+typedef struct   Processed_TTE_File_type {
+   FILE *    File_ptr;
+   uint32_t  Version;        // 1, 2, 3 or 4
+   uint64_t  Num_Events;     // events read or written so far
+   //  versions 3 and 4 only:
+   uint64_t *  Block;                   // one compressed block
+   Processed_TTE_v2_type *  Pending;    // events decoded but not yet returned, or not yet encoded
+   uint32_t  Num_Pending;
+   uint32_t  i_Pending;
+   _Bool     Output;                    // open for writing ?
+   uint64_t  Num_Blocks_Read;
+   //  version 4 only:
+   TTE_Block_Directory_type *  Directory;
+   uint64_t  Num_Blocks;
+   uint64_t  Directory_Capacity;        // output: entries allocated
+   uint64_t  i_Block;                   // input: next block to read
+   uint64_t  Offset;                    // output: file offset of the next block
+   _Bool     Time_Ordered;              // input: the blocks are in time order, without overlap
+   //  the selection of Select_Processed_TTE:
+   _Bool     Selected;
+   uint64_t  Begin_Time;
+   uint64_t  End_Time;
+   uint32_t  Detector_Mask;             // bit j set to select detector j
+}  Processed_TTE_File_type;
+
+
+//  A segment of a TTE archive (see MAIN_Compact_TTE.c and TTE_Segment_IO.c):
+//  the time-ordered events of one time partition.   The file is this 64 byte
+//  header, the events as Processed_TTE_v2_type records, then the time index:
+//  the time of every Index_Stride'th event (events 0, Index_Stride, ...).
+
+#define  TTE_SEGMENT_MAGIC   "PTTESEG"
+
+typedef struct   TTE_Segment_Header_type {
+   char      Magic [8];          // TTE_SEGMENT_MAGIC, including the terminating NUL
+   uint32_t  Version;            // 1
+   uint32_t  RecordBytes;        // sizeof ( Processed_TTE_v2_type )
+   uint64_t  Partition;          // partition number = time / Partition_Ticks
+   uint64_t  Partition_Ticks;    // length of the partitions, in 2 microsec ticks
+   uint64_t  Num_Events;
+   uint64_t  First_Time;         // time of the first and last events
+   uint64_t  Last_Time;
+   uint32_t  Index_Stride;       // events per index entry
+   uint32_t  Num_Index;          // number of index entries
+}  TTE_Segment_Header_type;
+
+
+//  State of an open segment, for reading or writing:
+
+typedef struct   TTE_Segment_File_type {
+   FILE *    File_ptr;
+   TTE_Segment_Header_type  Header;
+   uint64_t *  Index;
+   uint32_t  Index_Capacity;
+   uint64_t  Next_Event;         // number of the next event to be read or written
+   _Bool     Output;             // open for writing ?
+}  TTE_Segment_File_type;
+
+
+//  Columnar processed TTE file (see TTE_Columnar_IO.c): this 32 byte header, then
+//  row groups of Rows_per_Group events (the last group may be shorter).   Each row
+//  group holds its events as three columns, one after the other: the times
+//  (uint64_t, 2 microsec ticks), the detectors (uint8_t) and the channels (uint8_t),
+//  then zero padding to a multiple of 8 bytes.   Since Rows_per_Group is a multiple
+//  of 8, row group g starts at byte 32 + g * 10 * Rows_per_Group.
+
+#define  TTE_COLUMNAR_MAGIC   "PTTECOL"
+
+typedef struct   TTE_Columnar_Header_type {
+   char      Magic [8];          // TTE_COLUMNAR_MAGIC, including the terminating NUL
+   uint32_t  Version;            // 1
+   uint32_t  Rows_per_Group;
+   uint64_t  Num_Events;
+   uint32_t  Num_Groups;
+   uint32_t  Reserved;
+}  TTE_Columnar_Header_type;
+
+//  Column selection for Read_TTE_Columnar_Group:
+#define  TTE_COLUMN_TIME       1U
+#define  TTE_COLUMN_DETECTOR   2U
+#define  TTE_COLUMN_CHANNEL    4U
+
+
+//  State of an open columnar file, for reading or writing.   For writing, the
+//  column arrays buffer the row group being filled.
+
+typedef struct   TTE_Columnar_File_type {
+   FILE *    File_ptr;
+   TTE_Columnar_Header_type  Header;
+   uint64_t *  Times;
+   uint8_t *   Detectors;
+   uint8_t *   Channels;
+   uint32_t  Num_in_Group;
+   _Bool     Output;             // open for writing ?
+}  TTE_Columnar_File_type;
+
+
+//  Output of tables in the Apache Arrow IPC format -- see Arrow_IPC_Writer.c.
+//  Each column is of unsigned integers of Bit_Width bits: one per row, or if
+//  List_Size > 0, a fixed size list of List_Size per row.
+
+#define  MAX_ARROW_COLUMNS   8U
+
+typedef struct   Arrow_Column_type {
+   const char *  Name;
+   uint32_t  Bit_Width;          // 8, 16, 32 or 64
+   uint32_t  List_Size;          // 0: a single value per row
+}  Arrow_Column_type;
+
+//  The location of a record batch in the file (Block of the Arrow File.fbs):
+typedef struct   Arrow_Block_type {
+   int64_t   Offset;
+   int32_t   Metadata_Length;
+   int32_t   Padding;
+   int64_t   Body_Length;
+}  Arrow_Block_type;
+
+typedef struct   Arrow_File_type {
+   FILE *    File_ptr;
+   uint32_t  Num_Columns;
+   Arrow_Column_type  Columns [MAX_ARROW_COLUMNS];
+   _Bool     Stream_Format;      // IPC stream format (.arrows), rather than the file format
+   uint64_t  Offset;             // bytes written so far
+   uint64_t  Num_Rows;
+   Arrow_Block_type *  Blocks;   // the record batches written, for the footer
+   uint32_t  Num_Blocks;
+   uint32_t  Block_Capacity;
+}  Arrow_File_type;
+
+
+//  Reader of TTE event files (see TTE_Event_Reader.c), which returns batches of
+//  events as v2 records, optionally only those selected by time, detector and channel.
+
+#define  TTE_READER_MAPPED_V1     1U     // processed v1 file, mapped
+#define  TTE_READER_MAPPED_V2     2U     // processed v2 file, mapped
+#define  TTE_READER_STREAM        3U     // processed v3 or v4 file, read by Processed_TTE_IO
+#define  TTE_READER_DETECTOR      4U     // per-detector file of TTE_Data_type records, mapped
+
+typedef struct   TTE_Event_Reader_type {
+   uint32_t  Kind;                      // TTE_READER_...
+   char *    FileName;
+   uint32_t  Detector;                  // of a per-detector file
+   const unsigned char *  Map;          // the mapped file
+   size_t    Map_Bytes;
+   const unsigned char *  Records;      // the first record in the map
+   uint64_t  Num_Records;
+   uint64_t  i_Record;                  // next record to read
+   Processed_TTE_File_type  Stream;     // TTE_READER_STREAM only
+   Processed_TTE_v2_type *  Batch;
+   uint32_t  Batch_Size;
+   //  the selection of Select_TTE_Events:
+   _Bool     Selected;
+   uint64_t  Begin_Time;
+   uint64_t  End_Time;
+   uint32_t  Detector_Mask;             // bit j set to select detector j
+   uint32_t  Min_Channel;
+   uint32_t  Max_Channel;
+   //  counts:
+   uint64_t  Num_Scanned;               // events read from the file
+   uint64_t  Num_Returned;              // events returned, i.e., selected
+   //  with a bitmap index (see TTE_Bitmap_Index.c), the positions of the selected events:
+   uint32_t *  Ordinals;
+   uint64_t  Num_Ordinals;
+   uint64_t  i_Ordinal;
+}  TTE_Event_Reader_type;
+
+
+//  Bitmap index of a processed TTE file (see TTE_Bitmap_Index.c), held in the
+//  sidecar file FileName.bix.   There is one bitmap of event positions ("ordinals")
+//  for each detector, then one for each channel.   Each bitmap is divided by the
+//  upper 16 bits of the ordinal into containers of up to 65536 events, held either
+//  as a sorted array of the lower 16 bits (up to TTE_BITMAP_ARRAY_MAX) or as a
+//  bitmap of 1024 uint64_t.   The file is the header, the directory of the bitmaps,
+//  then for each bitmap its container headers and the containers, each starting at
+//  a multiple of 8 bytes.
+
+#define  TTE_BITMAP_INDEX_MAGIC   "PTTEBIX"
+#define  TTE_BITMAP_INDEX_EXTENSION   ".bix"
+
+#define  NUM_TTE_BITMAPS   ( NUM_DET + NUM_SPEC_CHAN )     // detectors, then channels
+
+#define  TTE_BITMAP_ARRAY_MAX   4096U
+#define  TTE_BITMAP_WORDS       1024U
+
+typedef struct   TTE_Bitmap_Index_Header_type {
+   char      Magic [8];          // TTE_BITMAP_INDEX_MAGIC, including the terminating NUL
+   uint32_t  Version;            // 3
+   uint32_t  Num_Bitmaps;        // NUM_TTE_BITMAPS
+   uint64_t  Num_Events;
+   uint64_t  Source_Bytes;       // size of the indexed file,
+   int64_t   Source_Mtime;       // its time of last modification (seconds), and
+   uint32_t  Source_CRC;         // the CRC32C of samples of it, to recognize a stale index
+   uint32_t  Reserved;
+}  TTE_Bitmap_Index_Header_type;
+
+typedef struct   TTE_Bitmap_Directory_type {
+   uint64_t  Offset;             // of the bitmap's container headers
+   uint32_t  Num_Containers;
+   uint32_t  Reserved;
+}  TTE_Bitmap_Directory_type;
+
+typedef struct   TTE_Container_Header_type {
+   uint16_t  Key;                // upper 16 bits of the ordinals
+   uint16_t  Is_Bitmap;          // 0: sorted array,  1: bitmap
+   uint32_t  Cardinality;
+   uint64_t  Offset;             // of the container
+}  TTE_Container_Header_type;
+
+//  An index opened for queries (the file is mapped into memory):
+typedef struct   TTE_Bitmap_Index_type {
+   const unsigned char *  Map;
+   size_t    Map_Bytes;
+   const TTE_Bitmap_Index_Header_type *  Header;
+   const TTE_Bitmap_Directory_type *  Directory;
+}  TTE_Bitmap_Index_type;
+
+
+//  Block checksums of an output file (see TTE_Checksum.c), held in the sidecar file
+//  FileName.crc: the header, then the CRC32C of each block of TTE_CHECKSUM_BLOCK_BYTES
+//  of the file, the last block possibly shorter.
+
+#define  TTE_CHECKSUM_MAGIC   "PTTECRC"
+
+#define  TTE_CHECKSUM_BLOCK_BYTES   1048576U
+
+typedef struct   TTE_Checksum_Header_type {
+   char      Magic [8];          // TTE_CHECKSUM_MAGIC, including the terminating NUL
+   uint32_t  Version;            // 1
+   uint32_t  Block_Bytes;        // TTE_CHECKSUM_BLOCK_BYTES
+   uint64_t  File_Bytes;
+   uint64_t  Num_Blocks;
+   uint32_t  Table_CRC;          // CRC32C of the checksums that follow
+   uint32_t  Reserved;
+}  TTE_Checksum_Header_type;
+
+
+//  Local cache of the results of the programs (see Result_Cache.c), in the directory
+//  named by the environment variable HSSDB_CACHE_DIR.   HSSDB_PROGS_VERSION is part
+//  of every key: change it whenever a change to the programs changes their outputs.
+
+#define  HSSDB_PROGS_VERSION   "2026.10"
+
+#define  MAX_CACHE_OUTPUTS   64U
+
+typedef struct   Result_Cache_type {
+   _Bool     Enabled;             // HSSDB_CACHE_DIR is set
+   const char *  Program;
+   char *    Directory;
+   char *    Description;         // the text hashed for the key: program, parameters, inputs, outputs
+   size_t    Description_Length;
+   size_t    Description_Capacity;
+   char      Key [17];            // hash of Description, in hex
+   uint32_t  Num_Outputs;
+   const char *  Outputs [MAX_CACHE_OUTPUTS];     // NULL for the standard output
+   char *    Stdout_FileName;     // while the standard output is captured
+   int       Saved_Stdout;
+}  Result_Cache_type;
+
+
+//  The trigger engine of Trigger_from_TTE (see Trigger_Engine.c): a table of trigger
+//  algorithms, each an energy band (SPEC channels), a timescale, an offset of its time
+//  bins, a threshold in sigma and the number of NaI detectors that must exceed it,
+//  all evaluated in one pass over the events.   The background of each band is kept
+//  once, in 1.024 s bins, and shared by the algorithms of the band.
+
+#define  MAX_TRIGGER_ALGORITHMS   256U
+#define  MAX_TRIGGER_BANDS         32U
+
+//  The background model of the flight software: the average of the 1.024 s bins that
+//  begin no more than 35.5 s and end at least 4.096 s before the data accumulation, if
+//  there are at least 30 of them with data:
+
+#define  ONE_SEC_IN_TICKS   512000LLU     /* 1.024 s in 2 microsec ticks */
+
+#define  MAX_ALLOWED_BCKG_AGE   18176000LLU   /* 35.5 * 1.024 s in 2 microsec ticks */
+
+#define  MIN_ALLOWED_BCKG_GAP   2048000LLU    /* 4.096 s in 2 microsec ticks */
+
+#define  MIN_REQ_GOOD_BCKG_BINS   30U
+
+//  The counts of the 12 NaI detectors are vectors of 16 byte aligned uint32_t, for SSE2:
+
+#if defined (__GNUC__)
+#define  TRIGGER_ALIGNED   __attribute__ (( aligned (16) ))
+#else
+#define  TRIGGER_ALIGNED
+#endif
+
+typedef struct   Trigger_Algorithm_type {
+   uint32_t  Beg_SPEC_Chan;
+   uint32_t  End_SPEC_Chan;
+   uint64_t  Timescale;          // in 2 microsec ticks
+   uint64_t  Offset;             // of the time bins, in ticks, less than Timescale
+   double    Threshold;          // in sigma
+   uint32_t  Min_Detectors;      // the k of k-of-n NaI detectors
+   uint32_t  Statistic;          // of the significance: TRIGGER_GAUSSIAN or TRIGGER_POISSON
+   uint64_t  Step;               // of sliding windows, in ticks, at most Timescale; 0 for the bins of the timescale
+}  Trigger_Algorithm_type;
+
+#define  TRIGGER_GAUSSIAN   0U
+#define  TRIGGER_POISSON    1U
+
+//  The windows of the algorithms with a step are sums of the cumulative counts of their
+//  band, kept in bins of:
+
+#define  TRIGGER_FINE_TICKS   2000LLU     /* 4 ms in 2 microsec ticks */
+
+//  The counts that are significant for a Poisson background, for a threshold in sigma,
+//  as a function of the expected counts (see Trigger_Poisson.c):
+
+typedef struct   Poisson_Table_type {
+   double    Threshold;          // in sigma
+   double    Log_Tail;           // log of the probability of the Gaussian tail beyond Threshold
+   double    Max_Expected;       // of the grid: above it, the Gaussian significance
+   double    Cells_per_Count;    // of the grid
+   uint32_t  Num_Cells;
+   uint32_t *  Up_Cell;          // for each cell, the least significant excess at its beginning
+   uint32_t *  Lo_Cell;          // for each cell, the number of significant deficits (counts 0 to n-1) at its beginning
+   double *  Up_Boundary;        // [n]: the largest expected for which n counts are a significant excess
+   double *  Lo_Boundary;        // [n]: the least expected for which n counts are a significant deficit
+   uint32_t  Num_Up;
+   uint32_t  Num_Lo;
+}  Poisson_Table_type;
+
+typedef struct   Trigger_State_type {
+   Trigger_Algorithm_type  Algorithm;
+   uint32_t  Band;
+   uint64_t  Step;               // of the accumulations: the step of sliding windows, else the timescale
+   uint64_t  Phase;              // ( Step - Offset ) % Step, plus the whole steps within a timescale for sliding windows
+   double    Timescale_Factor;   // Timescale / 1.024 s
+   uint32_t  BinNum_Underway;
+   uint32_t  Data_Accum [NUM_NAI_DET]  TRIGGER_ALIGNED;
+   //  the background model, the sums over the background bins Window_Lo to Window_Hi:
+   int64_t   Window_Lo;
+   int64_t   Window_Hi;
+   uint32_t  Bckg_Sums [NUM_NAI_DET]  TRIGGER_ALIGNED;
+   uint32_t  Num_Bckg_Bins;     // of the window, those with data
+   const Poisson_Table_type *  Poisson;   // for TRIGGER_POISSON, else NULL
+   //  results:
+   double    Largest_Pos_Deviation;
+   double    Largest_Neg_Deviation;
+   uint32_t  DataAccum_with_Bckg;
+   uint32_t  DataAccum_without_Bckg;
+   uint32_t  Num_Triggers;
+   char      Prefix [24];        // of the lines output for this algorithm
+}  Trigger_State_type;
+
+typedef struct   Trigger_Band_type {
+   uint32_t  Beg_SPEC_Chan;
+   uint32_t  End_SPEC_Chan;
+   _Bool     Started;
+   uint64_t  BaseTime;           // of the first event in the band
+   uint32_t *  Bckg_BinNum;      // for each slot, the 1.024 s bin held, or UINT32_MAX
+   uint32_t *  Bckg_Counts;      // for each slot, the counts of the NaI detectors (16 byte aligned)
+   uint32_t  Latest_BinNum;      // of the events so far
+   //  for the sliding windows, if the band has any, the cumulative counts of the NaI
+   //  detectors in 4 ms bins:
+   uint32_t *  Fine_Counts;      // for each slot, the counts before its bin (16 byte aligned), or NULL
+   uint32_t  Fine_Totals [NUM_NAI_DET]  TRIGGER_ALIGNED;   // the counts so far
+   uint32_t  Fine_BinNum;        // of the events so far
+   char      Prefix [24];
+}  Trigger_Band_type;
+
+typedef struct   Trigger_Engine_type {
+   uint32_t  Num_Algorithms;
+   Trigger_State_type *  States;
+   uint32_t  Num_Bands;
+   Trigger_Band_type  Bands [MAX_TRIGGER_BANDS];
+   uint32_t  Bckg_Depth;         // slots of the background of each band
+   uint32_t  Fine_Depth;         // slots of the cumulative counts of each band with sliding windows
+   uint32_t  Beg_SPEC_Chan;      // the channels of all of the bands, for the selection of events
+   uint32_t  End_SPEC_Chan;
+   uint32_t  Band_Masks [UINT8_MAX + 1];   // for each SPEC channel, bit i_band set if in band i_band
+   uint32_t  Num_Bands_Started;
+   uint64_t  Latest_Time;        // of the events so far
+   uint64_t  Num_Events_in_Bands;
+   uint64_t  Max_Timescale;      // of the algorithms
+   uint64_t  Warm_Up_Ticks;      // the events before an accumulation on which it depends
+   FILE *    Output;             // of the lines of the accumulations: stdout, the buffer of a time slice, or NULL for none
+   _Bool     Warming_Up;         // a time slice before its own events: accumulating, not evaluating
+   _Bool     Preset_BaseTimes;   // a time slice: the base times of the bands are those of the whole file
+}  Trigger_Engine_type;
+
+
+//  Checkpoint of the state of the trigger engine (see Trigger_Checkpoint.c), from
+//  which the next file of a sequence resumes.
+
+#define  TRIGGER_CHECKPOINT_MAGIC   "TRIGCKP"
+
+typedef struct   Trigger_Checkpoint_Header_type {
+   char      Magic [8];          // TRIGGER_CHECKPOINT_MAGIC, including the terminating NUL
+   uint32_t  Version;            // 3
+   uint32_t  Num_Algorithms;
+   uint32_t  Num_Bands;
+   uint32_t  Bckg_Depth;
+   uint64_t  Latest_Time;        // of the last event processed
+   uint64_t  Body_Bytes;         // of the state that follows
+   uint32_t  Body_CRC;           // CRC32C of the state
+   uint32_t  Reserved;
+}  Trigger_Checkpoint_Header_type;
+
+
+
+
+//  Injections of synthetic bursts into the events of Trigger_from_TTE, for the
+//  efficiency of its algorithms (see Trigger_Injection.c): each class is a number of
+//  bursts of the same mean counts, duration, channels and pattern over the NaI
+//  detectors, at random times.
+
+#define  MAX_INJECTION_CLASSES   256U
+
+typedef struct   Injection_Class_type {
+   double    Counts;             // mean, of a burst, summed over the NaI detectors
+   uint64_t  Duration;           // in 2 microsec ticks, of the constant rate
+   uint32_t  Beg_SPEC_Chan;      // the channels of the events, uniformly
+   uint32_t  End_SPEC_Chan;
+   uint32_t  Num_Injections;
+   double    Cum_Weights [NUM_NAI_DET];   // the pattern: the cumulative fraction of the counts, by detector
+   uint32_t  Num_Triggered;      // of the bursts, by any algorithm
+}  Injection_Class_type;
 
 
 //   >>>>   GLOBAL VARIABLES   <<<<
@@ -150,6 +666,10 @@ _Bool  ReSync (
 );
 
 
+//  Asks the user, once, whether the data are from I&T or Level 0; returns "IT" or "L0":
+const char * Ask_Data_Origin ( void );
+
+
 //  The argument is solely input; output is solely by function return:
 uint16_t  ByteSwap_2  ( uint16_t  Word_2 );
 
@@ -221,6 +741,16 @@ uint64_t IntegerTime_from_CoarseFine (
 );
 
 
+  // First argument is input, the other two are output.
+void CoarseFine_from_IntegerTime (
+
+   uint64_t   Time_in_OneVariable,
+   uint32_t * CoarseTime_ptr,
+   uint16_t * FineTime_ptr
+
+);
+
+
 long double  Time_from_TTE_Data (
    uint32_t HeaderCoarseTime,
    uint32_t TTE_TimeWord,
@@ -259,6 +789,803 @@ void Output_TTE (
    uint16_t TTE_Detector [],
    char * Analysis_FileName_ptr,
    FILE * ptr_to_AnalysisFile,
-   FILE * ptr_to_SummaryFile
+   FILE * ptr_to_SummaryFile,
+   _Bool Compress
+
+);
+
+
+void Open_Processed_TTE_Input (
+
+   // Input argument:
+   const char * FileName,
+
+   // Output argument:
+   Processed_TTE_File_type * Input_ptr
+
+);
+
+
+size_t Read_Processed_TTE (
+
+   // Input/Output argument:
+   Processed_TTE_File_type * Input_ptr,
+
+   // Output arguments:
+   Processed_TTE_v2_type Events [],
+
+   // Input argument:
+   size_t Max_Events
+
+);
+
+
+void Open_Processed_TTE_Output (
+
+   // Input arguments:
+   const char * FileName,
+   uint32_t Version,
+
+   // Output argument:
+   Processed_TTE_File_type * Output_ptr
+
+);
+
+
+void Write_Processed_TTE (
+
+   // Input/Output argument:
+   Processed_TTE_File_type * Output_ptr,
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events
+
+);
+
+
+void Close_Processed_TTE_File (
+   Processed_TTE_File_type * File_ptr
+);
+
+
+void Select_Processed_TTE (
+
+   // Input/Output argument:
+   Processed_TTE_File_type * Input_ptr,
+
+   // Input arguments:
+   uint64_t Begin_Time,
+   uint64_t End_Time,
+   uint32_t Detector_Mask
+
+);
+
+
+void Zone_Map_of_TTE_Events (
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   uint32_t Num_Events,
+
+   // Output argument:
+   TTE_Zone_Map_type * Zone_Map_ptr
+
+);
+
+
+void Output_TTE_InMemory (
+
+   // Input arguments:
+   uint16_t Number_TTE_DataWords,
+   uint32_t TTE_CoarseTime [],
+   uint16_t TTE_FineTime [],
+   uint16_t TTE_Channel [],
+   uint16_t TTE_Detector [],
+   const char * Output_FileName_ptr,
+   FILE * ptr_to_AnalysisFile,
+   FILE * ptr_to_SummaryFile,
+   _Bool Compress
+
+);
+
+
+void Radix_Sort_Processed_TTE (
+
+   // Input/Output argument:
+   Processed_TTE_v2_type Events [],
+
+   // Input arguments:
+   size_t Num_Events,
+   uint32_t Num_Threads
+
+);
+
+
+uint32_t  Number_of_Processors ( void );
+
+
+FILE * Open_File_Sequence (
+
+   // Input arguments:
+   uint32_t Num_Files,
+   char * const FileNames []
+
+);
+
+
+void Close_File_Sequence (
+
+   // Input argument:
+   FILE * Stream_ptr
+
+);
+
+
+char ** Expand_File_List (
+
+   // Input arguments:
+   int Num_Args,
+   char * Args [],
+
+   // Output argument:
+   uint32_t * Num_Files_ptr
+
+);
+
+
+void Open_TTE_Segment_Output (
+
+   // Input arguments:
+   const char * FileName,
+   uint64_t Partition,
+   uint64_t Partition_Ticks,
+
+   // Output argument:
+   TTE_Segment_File_type * Segment_ptr
+
+);
+
+
+void Write_TTE_Segment (
+
+   // Input/Output argument:
+   TTE_Segment_File_type * Segment_ptr,
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events
+
+);
+
+
+void Open_TTE_Segment_Input (
+
+   // Input argument:
+   const char * FileName,
+
+   // Output argument:
+   TTE_Segment_File_type * Segment_ptr
+
+);
+
+
+void Seek_TTE_Segment (
+
+   // Input/Output argument:
+   TTE_Segment_File_type * Segment_ptr,
+
+   // Input argument:
+   uint64_t Time
+
+);
+
+
+size_t Read_TTE_Segment (
+
+   // Input/Output argument:
+   TTE_Segment_File_type * Segment_ptr,
+
+   // Output argument:
+   Processed_TTE_v2_type Events [],
+
+   // Input argument:
+   size_t Max_Events
+
+);
+
+
+void Close_TTE_Segment (
+
+   // Input/Output argument:
+   TTE_Segment_File_type * Segment_ptr
+
+);
+
+
+_Bool Is_TTE_Columnar_File (
+
+   // Input argument:
+   const char * FileName
+
+);
+
+
+void Open_TTE_Columnar_Output (
+
+   // Input arguments:
+   const char * FileName,
+   uint32_t Rows_per_Group,
+
+   // Output argument:
+   TTE_Columnar_File_type * Columnar_ptr
+
+);
+
+
+void Write_TTE_Columnar (
+
+   // Input/Output argument:
+   TTE_Columnar_File_type * Columnar_ptr,
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events
+
+);
+
+
+void Open_TTE_Columnar_Input (
+
+   // Input argument:
+   const char * FileName,
+
+   // Output argument:
+   TTE_Columnar_File_type * Columnar_ptr
+
+);
+
+
+uint32_t Read_TTE_Columnar_Group (
+
+   // Input arguments:
+   TTE_Columnar_File_type * Columnar_ptr,
+   uint32_t i_Group,
+   uint32_t Columns,
+
+   // Output arguments:
+   uint64_t Times [],
+   uint8_t Detectors [],
+   uint8_t Channels []
+
+);
+
+
+void Close_TTE_Columnar (
+
+   // Input/Output argument:
+   TTE_Columnar_File_type * Columnar_ptr
+
+);
+
+
+size_t Max_Encoded_TTE_Block_Bytes (
+
+   // Input argument:
+   uint32_t Num_Events
+
+);
+
+
+size_t Encode_TTE_Block (
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   uint32_t Num_Events,
+
+   // Output argument:
+   uint64_t Block []
+
+);
+
+
+uint32_t Decode_TTE_Block (
+
+   // Input argument:
+   const uint64_t Block [],
+
+   // Output argument:
+   Processed_TTE_v2_type Events []
+
+);
+
+
+void Open_Arrow_Output (
+
+   // Input arguments:
+   const char * FileName,
+   uint32_t Num_Columns,
+   const Arrow_Column_type Columns [],
+
+   // Output argument:
+   Arrow_File_type * Arrow_ptr
+
+);
+
+
+void Write_Arrow_Batch (
+
+   // Input/Output argument:
+   Arrow_File_type * Arrow_ptr,
+
+   // Input arguments:
+   uint32_t Num_Rows,
+   const void * const Column_Data []
+
+);
+
+
+void Close_Arrow_Output (
+
+   // Input/Output argument:
+   Arrow_File_type * Arrow_ptr
+
+);
+
+
+void Output_Histogram_Arrow (
+
+   // Input arguments:
+   DataType_type DataType,
+   const uint16_t PacketData [],
+   uint16_t PacketDataLength,
+   uint32_t HeaderCoarseTime,
+   uint16_t HeaderFineTime,
+   uint16_t SequenceCount,
+   const char * Input_FileName_ptr
+
+);
+
+
+void Open_TTE_Event_Reader (
+
+   // Input arguments:
+   const char * FileName,
+   uint32_t Batch_Size,
+
+   // Output argument:
+   TTE_Event_Reader_type * Reader_ptr
+
+);
+
+
+void Select_TTE_Events (
+
+   // Input/Output argument:
+   TTE_Event_Reader_type * Reader_ptr,
+
+   // Input arguments:
+   uint64_t Begin_Time,
+   uint64_t End_Time,
+   uint32_t Detector_Mask,
+   uint32_t Min_Channel,
+   uint32_t Max_Channel
+
+);
+
+
+size_t Next_TTE_Event_Batch (
+
+   // Input/Output argument:
+   TTE_Event_Reader_type * Reader_ptr,
+
+   // Output argument:
+   const Processed_TTE_v2_type ** Batch_ptr
+
+);
+
+
+void Close_TTE_Event_Reader (
+
+   // Input/Output argument:
+   TTE_Event_Reader_type * Reader_ptr
+
+);
+
+
+void * Open_TTE_Reader_F (
+
+   // Input argument:
+   const char * FileName
+
+);
+
+
+void Select_TTE_Reader_F (
+
+   // Input/Output argument:
+   void * Handle,
+
+   // Input arguments:
+   int64_t Begin_Time,
+   int64_t End_Time,
+   int32_t Detector_Mask,
+   int32_t Min_Channel,
+   int32_t Max_Channel
+
+);
+
+
+int64_t Read_TTE_Events_F (
+
+   // Input/Output argument:
+   void * Handle,
+
+   // Input argument:
+   int64_t Max_Events,
+
+   // Output arguments:
+   int64_t Times [],
+   int16_t Detectors [],
+   int16_t Channels []
+
+);
+
+
+void Close_TTE_Reader_F (
+
+   // Input/Output argument:
+   void * Handle
+
+);
+
+
+void Build_TTE_Bitmap_Index (
+
+   // Input argument:
+   const char * FileName
+
+);
+
+
+_Bool Open_TTE_Bitmap_Index (
+
+   // Input arguments:
+   const char * FileName,
+   const void * Source,
+   size_t Source_Bytes,
+   uint64_t Num_Events,
+
+   // Output argument:
+   TTE_Bitmap_Index_type * Index_ptr
+
+);
+
+
+uint64_t Query_TTE_Bitmap_Index (
+
+   // Input arguments:
+   const TTE_Bitmap_Index_type * Index_ptr,
+   uint32_t Detector_Mask,
+   uint32_t Min_Channel,
+   uint32_t Max_Channel,
+
+   // Output argument:
+   uint32_t ** Ordinals_ptr
+
+);
+
+
+void Close_TTE_Bitmap_Index (
+
+   // Input/Output argument:
+   TTE_Bitmap_Index_type * Index_ptr
+
+);
+
+
+char * TTE_Bitmap_Index_FileName (
+
+   // Input argument:
+   const char * FileName
+
+);
+
+
+uint32_t CRC32C (
+
+   // Input arguments:
+   const void * Data,
+   size_t Num_Bytes
+
+);
+
+
+void Write_TTE_Checksums (
+
+   // Input argument:
+   const char * FileName
+
+);
+
+
+_Bool Read_TTE_Checksums (
+
+   // Input argument:
+   const char * FileName,
+
+   // Output arguments:
+   TTE_Checksum_Header_type * Header_ptr,
+   uint32_t ** Checksums_ptr
+
+);
+
+
+void Open_Result_Cache (
+
+   // Input argument:
+   const char * Program,
+
+   // Output argument:
+   Result_Cache_type * Cache_ptr
+
+);
+
+
+void Add_Cache_Parameter (
+
+   // Input/Output argument:
+   Result_Cache_type * Cache_ptr,
+
+   // Input arguments:
+   const char * Name,
+   const char * Value
+
+);
+
+
+void Add_Cache_Input (
+
+   // Input/Output argument:
+   Result_Cache_type * Cache_ptr,
+
+   // Input argument:
+   const char * FileName
+
+);
+
+
+void Add_Cache_Output (
+
+   // Input/Output argument:
+   Result_Cache_type * Cache_ptr,
+
+   // Input argument:
+   const char * FileName
+
+);
+
+
+_Bool Fetch_Cached_Results (
+
+   // Input/Output argument:
+   Result_Cache_type * Cache_ptr
+
+);
+
+
+void Store_Cached_Results (
+
+   // Input/Output argument:
+   Result_Cache_type * Cache_ptr
+
+);
+
+
+void Trim_Result_Cache (
+
+   // Input arguments:
+   const char * Directory,
+   uint64_t Max_Bytes
+
+);
+
+
+void Result_Cache_Statistics (
+
+   // Input argument:
+   const char * Directory
+
+);
+
+
+uint32_t Read_Trigger_Algorithms (
+
+   // Input argument:
+   const char * FileName,
+
+   // Output argument:
+   Trigger_Algorithm_type ** Algorithms_ptr
+
+);
+
+
+void Init_Trigger_Engine (
+
+   // Input arguments:
+   uint32_t Num_Algorithms,
+   const Trigger_Algorithm_type Algorithms [],
+
+   // Output argument:
+   Trigger_Engine_type * Engine_ptr
+
+);
+
+
+void Trigger_Engine_Events (
+
+   // Input/Output argument:
+   Trigger_Engine_type * Engine_ptr,
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events
+
+);
+
+
+void Trigger_Engine_Sharded (
+
+   // Input/Output argument:
+   Trigger_Engine_type * Engine_ptr,
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events,
+   uint32_t Num_Threads
+
+);
+
+
+void Trigger_Band_Starts (
+
+   // Input arguments:
+   const Trigger_Engine_type * Engine_ptr,
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events,
+
+   // Output arguments:
+   size_t First_in_Band [],
+   uint64_t BaseTimes []
+
+);
+
+
+size_t Trigger_Warm_Up_Begin (
+
+   // Input arguments:
+   const Trigger_Engine_type * Engine_ptr,
+   const Processed_TTE_v2_type Events [],
+   size_t Begin,
+   const size_t First_in_Band []
+
+);
+
+
+void Trigger_Background_Bins (
+
+   // Input argument:
+   int64_t Begin,
+
+   // Output arguments:
+   int64_t * Lo_ptr,
+   int64_t * Hi_ptr
+
+);
+
+
+void Copy_Trigger_Engine_State (
+
+   // Input/Output argument:
+   Trigger_Engine_type * Engine_ptr,
+
+   // Input argument:
+   const Trigger_Engine_type * From_Engine_ptr
+
+);
+
+
+void Report_Trigger_Engine (
+
+   // Input arguments:
+   const Trigger_Engine_type * Engine_ptr,
+   uint64_t Num_Events_Processed
+
+);
+
+
+void Close_Trigger_Engine (
+
+   // Input/Output argument:
+   Trigger_Engine_type * Engine_ptr
+
+);
+
+
+void Write_Trigger_Checkpoint (
+
+   // Input arguments:
+   const char * FileName,
+   const Trigger_Engine_type * Engine_ptr
+
+);
+
+
+_Bool Read_Trigger_Checkpoint (
+
+   // Input argument:
+   const char * FileName,
+
+   // Input/Output argument:
+   Trigger_Engine_type * Engine_ptr
+
+);
+
+
+uint32_t Read_Injection_Classes (
+
+   // Input argument:
+   const char * FileName,
+
+   // Output argument:
+   Injection_Class_type ** Classes_ptr
+
+);
+
+
+void Trigger_Injections (
+
+   // Input arguments:
+   const Trigger_Engine_type * Engine_ptr,
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events,
+   uint64_t Seed,
+   uint32_t Num_Threads,
+   uint32_t Num_Classes,
+
+   // Input/Output argument:
+   Injection_Class_type Classes []
+
+);
+
+
+void Report_Injections (
+
+   // Input arguments:
+   uint32_t Num_Classes,
+   const Injection_Class_type Classes [],
+   uint64_t Seed
+
+);
+
+
+
+const Poisson_Table_type * Poisson_Table (
+
+   // Input argument:
+   double Threshold
+
+);
+
+
+int Poisson_Deviation (
+
+   // Input arguments:
+   const Poisson_Table_type * Table_ptr,
+   uint32_t Counts,
+   double Expected,
+
+   // Output argument:
+   double * Significance_ptr
 
 );
@@ -0,0 +1,61 @@
+//  Manages the result cache of the programs -- see Result_Cache.c.
+
+//  Usage:
+//  ./Cache_TTE.exe  [-stats]  [-trim MB]  [-clear]
+
+//  The cache is the directory named by the environment variable HSSDB_CACHE_DIR.
+//  -stats (the default) lists the hits, misses, stored and evicted results, from the
+//  log of the cache; -trim removes the least recently used results until the cache
+//  holds at most MB megabytes; -clear removes all of the results.
+
+
+#define  _POSIX_C_SOURCE  200809L
+
+#include "HSSDB_Progs_Header.h"
+
+
+int main ( int argc, char * argv [] ) {
+
+   const char *  Directory;
+   _Bool  Show_Statistics = false;
+   _Bool  Trim = false;
+   uint64_t  Max_MB = 0;
+   int  i_arg;
+
+
+   // ********************************************************************************************
+
+
+   Directory = getenv ( "HSSDB_CACHE_DIR" );
+
+   for ( i_arg=1;  i_arg < argc;  i_arg++ ) {  // options
+
+      if ( strcmp ( argv [i_arg], "-stats" ) == 0 ) {
+         Show_Statistics = true;
+      } else if ( strcmp ( argv [i_arg], "-trim" ) == 0  &&  i_arg + 1 < argc ) {
+         Trim = true;
+         Max_MB = strtoull ( argv [++i_arg], NULL, 10 );
+      } else if ( strcmp ( argv [i_arg], "-clear" ) == 0 ) {
+         Trim = true;
+         Max_MB = 0;
+      } else {
+         break;
+      }
+
+   }  // options
+
+   if ( i_arg < argc  ||  Directory == NULL  ||  Directory [0] == '\0' ) {
+      printf ( "Bad command line arguments, or HSSDB_CACHE_DIR not set.\n" );
+      printf ( "Example usage:  HSSDB_CACHE_DIR=/data/hssdb_cache  ./Cache_TTE.exe  [-stats]  [-trim 2048]  [-clear]\n" );
+      printf ( "Lists the statistics of the result cache (default), or removes the least recently used\n" );
+      printf ( "results until it holds at most the given megabytes, or removes all of the results.\n" );
+      return 1;
+   }
+
+   if ( Trim )  Trim_Result_Cache ( Directory, Max_MB << 20 );
+
+   if ( Show_Statistics  ||  ! Trim )  Result_Cache_Statistics ( Directory );
+
+   return 0;
+
+}  // main ()
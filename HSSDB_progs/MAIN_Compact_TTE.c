@@ -0,0 +1,823 @@
+//  Maintains an archive of processed TTE, for studies spanning months of data.
+
+//  Usage:
+//  ./Compact_TTE.exe  -a ArchiveDir  [-m MemoryMB]  [-p PartitionHours]  InputFileName  [InputFileName ...]
+//  ./Compact_TTE.exe  -a ArchiveDir  -q  Begin_MET  End_MET  -o OutputFileName
+
+//  The archive is a directory of segment files, one per time partition (by default
+//  one day), each holding the time-ordered events of its partition, with a header
+//  and a time index (see TTE_Segment_IO.c), plus the human-readable file
+//  MANIFEST.txt listing the segments.
+
+//  Ingest (first form): the input files, processed TTE of either version, e.g.,
+//  the outputs of Merge_TTE for the datasets of the latest days, are added to the
+//  archive.   Like an LSM-tree, this is done in two steps, with a bounded amount of
+//  memory (option -m, default 1024 MB):
+//  1) the input events are read in chunks that fit in half of the memory; each
+//  chunk is sorted (Radix_Sort_Processed_TTE) and its events are written to new
+//  "run" segments, one per partition;
+//  2) for each partition that received runs, the existing segment and the runs are
+//  merged (a k-way merge with block-buffered reads) into one new segment.
+//  Only the partitions touched by the new data are rewritten, and all writes are
+//  sequential.   The new manifest replaces the old one (by rename) only after all
+//  of the new segments are complete, and only then are the replaced segments
+//  deleted, so an interrupted run leaves the archive as it was.
+//  The partition length, option -p, can only be chosen when the archive is created.
+
+//  Consecutive input files overlap at their edges, as do the L0 files, so the same
+//  event can be in two input files, or in an input file and the archive.   Such
+//  duplicates are suppressed as in Merge_TTE, treating the archive and each input
+//  file as a dataset: an event is dropped if an identical event (all of the record)
+//  of an earlier dataset has been output and not already paired with an event of
+//  this dataset.   Identical events of one dataset are all kept.   The duplicates
+//  within a chunk are suppressed after sorting it, those between the runs and the
+//  existing segment in the merge; in the runs, the Reserved field of each event holds
+//  the number of its input file (from 1; the archive is dataset 0), which the merge
+//  and the sort keep in order for events with the same time and detector.   So an
+//  input ingested again adds no events.
+
+//  Range query (second form): the events with Begin_MET <= time < End_MET (GBM MET,
+//  in seconds) are output, in time order, as version 2 processed TTE.   Only the
+//  segments of the partitions overlapping the range are opened, and the time index
+//  of each is used to start reading at the first event of the range.
+
+
+#define  _POSIX_C_SOURCE  200809L
+
+#include "HSSDB_Progs_Header.h"
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+#define  MANIFEST_NAME   "MANIFEST.txt"
+#define  MANIFEST_TEMP_NAME   "MANIFEST.tmp"
+
+#define  MAX_SEGMENT_NAME   64U
+#define  MAX_PATH_LENGTH   1024U
+
+#define  DEFAULT_PARTITION_HOURS   24U
+#define  DEFAULT_MEMORY_MB   1024U
+
+//  Smallest block of events read from each input of a merge:
+#define  MIN_MERGE_BLOCK   1024U
+
+//  Maximum number of events of one detector at one time that are remembered for
+//  the suppression of duplicates -- any more are output without comparison:
+#define  MAX_SAME_TIME   64U
+
+
+//  local typedefs:
+
+typedef struct  Manifest_Entry_type {
+   uint64_t  Partition;
+   uint64_t  First_Time;
+   uint64_t  Last_Time;
+   uint64_t  Num_Events;
+   uint32_t  Generation;
+   char  FileName [MAX_SEGMENT_NAME];
+} Manifest_Entry_type;
+
+typedef struct  Manifest_type {
+   uint64_t  Partition_Ticks;
+   uint32_t  Next_Generation;
+   uint32_t  Num_Entries;
+   uint32_t  Capacity;
+   Manifest_Entry_type * Entries;
+} Manifest_type;
+
+//  One input of the merge of a partition:
+typedef struct  Merge_Input_type {
+   TTE_Segment_File_type  Segment;
+   Processed_TTE_v2_type * Buffer;
+   size_t  Num_in_Buffer;
+   size_t  i_Buffer;
+} Merge_Input_type;
+
+//  The events output for one detector at the most recent time, for the suppression
+//  of duplicates, as in Merge_TTE.   Matched_Dataset is the last dataset whose copy
+//  of the event was suppressed, initially the dataset of the event itself.
+typedef struct  Same_Time_type {
+   uint64_t  Time_in_OneVariable;
+   uint32_t  Num;
+   uint8_t  SpecChannel [MAX_SAME_TIME];
+   uint16_t  Flags [MAX_SAME_TIME];
+   uint32_t  Matched_Dataset [MAX_SAME_TIME];
+} Same_Time_type;
+
+
+//  local function prototypes:
+
+static void  Archive_Path ( const char * ArchiveDir, const char * FileName, char Path [MAX_PATH_LENGTH] );
+
+static _Bool  Read_Manifest ( const char * ArchiveDir, Manifest_type * Manifest_ptr );
+
+static void  Write_Manifest ( const char * ArchiveDir, const Manifest_type * Manifest_ptr );
+
+static Manifest_Entry_type * Add_Manifest_Entry ( Manifest_type * Manifest_ptr );
+
+static void  Write_Runs ( const char * ArchiveDir, Processed_TTE_v2_type Chunk [], size_t Num_in_Chunk,
+                          Manifest_type * Archive_ptr, Manifest_type * Runs_ptr, uint64_t * Num_Duplicates_ptr );
+
+static void  Merge_Partition ( const char * ArchiveDir, Manifest_Entry_type * Inputs [], uint32_t Num_Inputs, _Bool Has_Existing,
+                               size_t Memory_Events, Manifest_type * Archive_ptr, Manifest_Entry_type * Output_ptr,
+                               uint64_t * Num_Duplicates_ptr );
+
+static _Bool  Duplicate_Event ( Same_Time_type Last_Output [NUM_DET], const Processed_TTE_v2_type * Event_ptr, uint32_t Dataset );
+
+static int  Compare_Entries ( const void * A_ptr, const void * B_ptr );
+
+static void  Query_Archive ( const char * ArchiveDir, const Manifest_type * Archive_ptr,
+                             uint64_t Begin_Time, uint64_t End_Time, const char * Output_FileName_ptr );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+int main ( int argc, char * argv [] ) {
+
+   char * ArchiveDir = NULL;
+   char * Output_FileName_ptr = NULL;
+   uint64_t  Memory_MB = DEFAULT_MEMORY_MB;
+   uint64_t  Partition_Hours = 0;
+   _Bool  Query = false;
+   double  Begin_MET = 0.0, End_MET = 0.0;
+   int  i_arg;
+
+   Manifest_type  Archive;
+   Manifest_type  Runs;
+   _Bool  Archive_Exists;
+
+   Processed_TTE_File_type  Input_File;
+   Processed_TTE_v2_type * Chunk;
+   size_t  Chunk_Capacity;
+   size_t  Num_in_Chunk = 0;
+   size_t  num_read;
+   size_t  i_read;
+   uint64_t  Num_Input_Events = 0;
+   uint64_t  Num_Duplicates = 0;
+   uint32_t  Dataset;
+
+   Manifest_Entry_type ** Merge_Inputs;
+   Manifest_Entry_type * Existing_ptr;
+   Manifest_Entry_type  New_Segment;
+   uint32_t  Num_Merge_Inputs;
+   uint32_t  i_run, j_run, i_entry;
+   uint32_t  Num_Partitions_Merged = 0;
+
+   char  ( * Obsolete_Files ) [MAX_SEGMENT_NAME];
+   uint32_t  Num_Obsolete = 0;
+   char  Path [MAX_PATH_LENGTH];
+
+
+   // ********************************************************************************************
+
+
+   for ( i_arg=1;  i_arg < argc;  i_arg++ ) {  // options
+
+      if ( strcmp ( argv [i_arg], "-a" ) == 0  &&  i_arg + 1 < argc ) {
+         ArchiveDir = argv [++i_arg];
+      } else if ( strcmp ( argv [i_arg], "-m" ) == 0  &&  i_arg + 1 < argc ) {
+         Memory_MB = strtoull ( argv [++i_arg], NULL, 10 );
+      } else if ( strcmp ( argv [i_arg], "-p" ) == 0  &&  i_arg + 1 < argc ) {
+         Partition_Hours = strtoull ( argv [++i_arg], NULL, 10 );
+      } else if ( strcmp ( argv [i_arg], "-o" ) == 0  &&  i_arg + 1 < argc ) {
+         Output_FileName_ptr = argv [++i_arg];
+      } else if ( strcmp ( argv [i_arg], "-q" ) == 0  &&  i_arg + 2 < argc ) {
+         Query = true;
+         Begin_MET = strtod ( argv [++i_arg], NULL );
+         End_MET = strtod ( argv [++i_arg], NULL );
+      } else {
+         break;
+      }
+
+   }  // options
+
+   if ( ArchiveDir == NULL  ||  Memory_MB == 0  ||
+        ( Query  &&  ( Output_FileName_ptr == NULL  ||  i_arg != argc  ||  End_MET <= Begin_MET  ||  Begin_MET < 0.0 ) )  ||
+        ( ! Query  &&  i_arg >= argc ) ) {
+      printf ( "Bad command line arguments.\n" );
+      printf ( "Example usages:\n" );
+      printf ( "./Compact_TTE  -a ArchiveDir  [-m MemoryMB]  [-p PartitionHours]  Day1_TTE.dat  Day2_TTE.dat\n" );
+      printf ( "./Compact_TTE  -a ArchiveDir  -q  Begin_MET  End_MET  -o Output.dat\n" );
+      return 1;
+   }
+
+
+   Archive_Exists = Read_Manifest ( ArchiveDir, &Archive );
+
+
+   if ( Query ) {  // query ?
+
+      if ( ! Archive_Exists ) {
+         printf ( "\nNo archive manifest found in %s\n", ArchiveDir );
+         return 2;
+      }
+
+      Query_Archive ( ArchiveDir, &Archive,
+                      (uint64_t) ( Begin_MET * TICKS_PER_SECOND + 0.5 ), (uint64_t) ( End_MET * TICKS_PER_SECOND + 0.5 ),
+                      Output_FileName_ptr );
+      return 0;
+
+   }  // query ?
+
+
+   //  Ingest:
+
+   if ( ! Archive_Exists ) {
+      if ( Partition_Hours == 0 )  Partition_Hours = DEFAULT_PARTITION_HOURS;
+      Archive.Partition_Ticks = Partition_Hours * 3600U * TICKS_PER_SECOND;
+      printf ( "\nCreating archive %s with partitions of %llu hours.\n", ArchiveDir, (long long unsigned int) Partition_Hours );
+      if ( mkdir ( ArchiveDir, 0755 ) != 0  &&  errno != EEXIST ) {
+         printf ( "\nFailed to create archive directory %s: %s\n", ArchiveDir, strerror (errno) );
+         return 3;
+      }
+   } else if ( Partition_Hours != 0  &&  Partition_Hours * 3600U * TICKS_PER_SECOND != Archive.Partition_Ticks ) {
+      printf ( "\nError: the archive has partitions of %.3f hours, which can't be changed.\n",
+               (double) Archive.Partition_Ticks / ( 3600.0 * TICKS_PER_SECOND ) );
+      return 3;
+   }
+
+   Runs.Partition_Ticks = Archive.Partition_Ticks;
+   Runs.Num_Entries = 0;
+   Runs.Capacity = 0;
+   Runs.Entries = NULL;
+
+
+   //  Step 1: sort the input in chunks, writing the runs.   Half of the memory is the
+   //  chunk, the other half the work buffer of the radix sort.
+
+   Chunk_Capacity = (size_t) ( Memory_MB * 1024U * 1024U / ( 2 * sizeof (Processed_TTE_v2_type) ) );
+   Chunk = malloc ( Chunk_Capacity * sizeof (Processed_TTE_v2_type) );
+   if ( Chunk == NULL ) {
+      printf ( "\n\nmalloc of %llu MB failed -- reduce option -m.  Exiting.\n", (long long unsigned int) Memory_MB );
+      return 4;
+   }
+
+   for ( Dataset=1;  i_arg < argc;  i_arg++, Dataset++ ) {  // loop over input files
+
+      Open_Processed_TTE_Input ( argv [i_arg], &Input_File );
+
+      while ( ( num_read = Read_Processed_TTE ( &Input_File, Chunk + Num_in_Chunk, Chunk_Capacity - Num_in_Chunk ) ) > 0 ) {
+         for ( i_read=0;  i_read < num_read;  i_read++ )  Chunk [Num_in_Chunk + i_read] .Reserved = Dataset;
+         Num_in_Chunk += num_read;
+         if ( Num_in_Chunk == Chunk_Capacity ) {
+            Write_Runs ( ArchiveDir, Chunk, Num_in_Chunk, &Archive, &Runs, &Num_Duplicates );
+            Num_in_Chunk = 0;
+         }
+      }
+
+      printf ( "Read %llu events (version %u) from %s\n",
+               (long long unsigned int) Input_File.Num_Events, Input_File.Version, argv [i_arg] );
+      Num_Input_Events += Input_File.Num_Events;
+
+      Close_Processed_TTE_File ( &Input_File );
+
+   }  // loop over input files
+
+   if ( Num_in_Chunk > 0 )  Write_Runs ( ArchiveDir, Chunk, Num_in_Chunk, &Archive, &Runs, &Num_Duplicates );
+
+   free ( Chunk );
+
+   printf ( "\n%llu events sorted into %u runs.\n", (long long unsigned int) Num_Input_Events, Runs.Num_Entries );
+
+
+   //  Step 2: for each partition with runs, merge the existing segment, if any, and the runs.
+   //  The runs are ordered by partition, then in the order written, which is the input order.
+
+   qsort ( Runs.Entries, Runs.Num_Entries, sizeof (Manifest_Entry_type), Compare_Entries );
+
+   Merge_Inputs = malloc ( ( Runs.Num_Entries + 1 ) * sizeof (Manifest_Entry_type *) );
+   Obsolete_Files = malloc ( ( Runs.Num_Entries + Archive.Num_Entries + 1 ) * MAX_SEGMENT_NAME );
+   if ( Merge_Inputs == NULL  ||  Obsolete_Files == NULL ) {
+      printf ( "\n\nmalloc failed. exiting.\n" );
+      return 4;
+   }
+
+   for ( i_run=0;  i_run < Runs.Num_Entries;  i_run = j_run ) {  // loop over partitions with runs
+
+      Existing_ptr = NULL;
+      for ( i_entry=0;  i_entry < Archive.Num_Entries;  i_entry++ ) {
+         if ( Archive.Entries [i_entry] .Partition == Runs.Entries [i_run] .Partition )  Existing_ptr = &Archive.Entries [i_entry];
+      }
+
+      Num_Merge_Inputs = 0;
+      if ( Existing_ptr != NULL )  Merge_Inputs [Num_Merge_Inputs++] = Existing_ptr;
+
+      for ( j_run = i_run;  j_run < Runs.Num_Entries  &&  Runs.Entries [j_run] .Partition == Runs.Entries [i_run] .Partition;  j_run++ )
+         Merge_Inputs [Num_Merge_Inputs++] = &Runs.Entries [j_run];
+
+      if ( Num_Merge_Inputs == 1 ) {  // single run / merge ?
+
+         //  A new partition with a single run: the run is the segment.
+         *Add_Manifest_Entry ( &Archive ) = Runs.Entries [i_run];
+
+      } else {  // single run / merge ?
+
+         Merge_Partition ( ArchiveDir, Merge_Inputs, Num_Merge_Inputs, Existing_ptr != NULL,
+                           (size_t) ( Memory_MB * 1024U * 1024U / sizeof (Processed_TTE_v2_type) ),
+                           &Archive, &New_Segment, &Num_Duplicates );
+         Num_Partitions_Merged++;
+
+         for ( i_entry=0;  i_entry < Num_Merge_Inputs;  i_entry++ )
+            strcpy ( Obsolete_Files [Num_Obsolete++], Merge_Inputs [i_entry] ->FileName );
+
+         if ( Existing_ptr != NULL ) {
+            *Existing_ptr = New_Segment;
+         } else {
+            *Add_Manifest_Entry ( &Archive ) = New_Segment;
+         }
+
+      }  // single run / merge ?
+
+   }  // loop over partitions with runs
+
+
+   qsort ( Archive.Entries, Archive.Num_Entries, sizeof (Manifest_Entry_type), Compare_Entries );
+
+   Write_Manifest ( ArchiveDir, &Archive );
+
+
+   //  The new manifest is in place; the merged runs and replaced segments can go:
+
+   for ( i_entry=0;  i_entry < Num_Obsolete;  i_entry++ ) {
+      Archive_Path ( ArchiveDir, Obsolete_Files [i_entry], Path );
+      if ( remove ( Path ) != 0 )  printf ( "Warning: failed to delete obsolete segment %s\n", Path );
+   }
+
+   printf ( "%llu duplicate events suppressed.\n", (long long unsigned int) Num_Duplicates );
+   printf ( "%u partitions merged, archive now has %u segments.\n", Num_Partitions_Merged, Archive.Num_Entries );
+
+   return 0;
+
+}  // main ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Archive_Path ( const char * ArchiveDir, const char * FileName, char Path [MAX_PATH_LENGTH] ) {
+
+   if ( snprintf ( Path, MAX_PATH_LENGTH, "%s/%s", ArchiveDir, FileName ) >= (int) MAX_PATH_LENGTH ) {
+      printf ( "\n\nArchive path too long: %s -- Exiting!\n", ArchiveDir );
+      exit (78);
+   }
+
+}  // Archive_Path ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Reads the manifest of the archive.   Returns false, with an empty manifest, if the
+//  archive doesn't exist yet.
+
+static _Bool  Read_Manifest ( const char * ArchiveDir, Manifest_type * Manifest_ptr ) {
+
+   FILE * Manifest_File_ptr;
+   char  Path [MAX_PATH_LENGTH];
+   uint32_t  Num_Entries;
+   uint32_t  i_entry;
+   long long unsigned int  Partition_Ticks, Partition, First_Time, Last_Time, Num_Events;
+   Manifest_Entry_type * Entry_ptr;
+
+
+   Manifest_ptr->Partition_Ticks = 0;
+   Manifest_ptr->Next_Generation = 1;
+   Manifest_ptr->Num_Entries = 0;
+   Manifest_ptr->Capacity = 0;
+   Manifest_ptr->Entries = NULL;
+
+   Archive_Path ( ArchiveDir, MANIFEST_NAME, Path );
+   Manifest_File_ptr = fopen ( Path, "r" );
+   if ( Manifest_File_ptr == NULL )  return false;
+
+   if ( fscanf ( Manifest_File_ptr, " TTE archive manifest -- written by Compact_TTE" ) != 0  ||
+        fscanf ( Manifest_File_ptr, " Partition_Ticks: %llu", &Partition_Ticks ) != 1  ||
+        fscanf ( Manifest_File_ptr, " Next_Generation: %u", &Manifest_ptr->Next_Generation ) != 1  ||
+        fscanf ( Manifest_File_ptr, " Num_Segments: %u", &Num_Entries ) != 1  ||
+        fscanf ( Manifest_File_ptr, " Partition First_Time Last_Time Num_Events Generation File" ) != 0 ) {
+      printf ( "\n\nBad archive manifest %s -- Exiting!\n", Path );
+      exit (79);
+   }
+
+   Manifest_ptr->Partition_Ticks = Partition_Ticks;
+
+   for ( i_entry=0;  i_entry < Num_Entries;  i_entry++ ) {
+
+      Entry_ptr = Add_Manifest_Entry ( Manifest_ptr );
+
+      if ( fscanf ( Manifest_File_ptr, "%llu %llu %llu %llu %u %63s", &Partition, &First_Time, &Last_Time, &Num_Events,
+                    &Entry_ptr->Generation, Entry_ptr->FileName ) != 6 ) {
+         printf ( "\n\nBad archive manifest %s, segment %u -- Exiting!\n", Path, i_entry );
+         exit (79);
+      }
+
+      Entry_ptr->Partition = Partition;
+      Entry_ptr->First_Time = First_Time;
+      Entry_ptr->Last_Time = Last_Time;
+      Entry_ptr->Num_Events = Num_Events;
+
+   }
+
+   fclose ( Manifest_File_ptr );
+
+   return true;
+
+}  // Read_Manifest ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Writes the manifest to a temporary file, flushes it to the disk, then renames it
+//  over the old manifest, so that the archive always has a complete manifest.   The
+//  new segments were flushed when closed, so they are on the disk before it.
+
+static void  Write_Manifest ( const char * ArchiveDir, const Manifest_type * Manifest_ptr ) {
+
+   FILE * Manifest_File_ptr;
+   char  Path [MAX_PATH_LENGTH];
+   char  Temp_Path [MAX_PATH_LENGTH];
+   uint32_t  i_entry;
+   const Manifest_Entry_type * Entry_ptr;
+
+
+   Archive_Path ( ArchiveDir, MANIFEST_NAME, Path );
+   Archive_Path ( ArchiveDir, MANIFEST_TEMP_NAME, Temp_Path );
+
+   Manifest_File_ptr = fopen ( Temp_Path, "w" );
+   if ( Manifest_File_ptr == NULL ) {
+      printf ( "\n\nFailed to open %s -- Exiting!\n", Temp_Path );
+      exit (79);
+   }
+
+   fprintf ( Manifest_File_ptr, "TTE archive manifest -- written by Compact_TTE\n" );
+   fprintf ( Manifest_File_ptr, "Partition_Ticks: %llu\n", (long long unsigned int) Manifest_ptr->Partition_Ticks );
+   fprintf ( Manifest_File_ptr, "Next_Generation: %u\n", Manifest_ptr->Next_Generation );
+   fprintf ( Manifest_File_ptr, "Num_Segments: %u\n", Manifest_ptr->Num_Entries );
+   fprintf ( Manifest_File_ptr, "   Partition         First_Time          Last_Time      Num_Events  Generation  File\n" );
+
+   for ( i_entry=0;  i_entry < Manifest_ptr->Num_Entries;  i_entry++ ) {
+      Entry_ptr = &Manifest_ptr->Entries [i_entry];
+      fprintf ( Manifest_File_ptr, "%12llu  %17llu  %17llu  %14llu  %10u  %s\n",
+                (long long unsigned int) Entry_ptr->Partition, (long long unsigned int) Entry_ptr->First_Time,
+                (long long unsigned int) Entry_ptr->Last_Time, (long long unsigned int) Entry_ptr->Num_Events,
+                Entry_ptr->Generation, Entry_ptr->FileName );
+   }
+
+   if ( fflush ( Manifest_File_ptr ) != 0  ||  fsync ( fileno ( Manifest_File_ptr ) ) != 0  ||
+        fclose ( Manifest_File_ptr ) != 0  ||  rename ( Temp_Path, Path ) != 0 ) {
+      printf ( "\n\nFailed to write archive manifest %s: %s -- Exiting!\n", Path, strerror (errno) );
+      exit (79);
+   }
+
+}  // Write_Manifest ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static Manifest_Entry_type * Add_Manifest_Entry ( Manifest_type * Manifest_ptr ) {
+
+   Manifest_Entry_type * New_Entries;
+
+
+   if ( Manifest_ptr->Num_Entries == Manifest_ptr->Capacity ) {
+      Manifest_ptr->Capacity = ( Manifest_ptr->Capacity == 0 )  ?  64  :  2 * Manifest_ptr->Capacity;
+      New_Entries = realloc ( Manifest_ptr->Entries, Manifest_ptr->Capacity * sizeof (Manifest_Entry_type) );
+      if ( New_Entries == NULL ) {
+         printf ( "\n\nmalloc of archive manifest failed. exiting.\n" );
+         exit (79);
+      }
+      Manifest_ptr->Entries = New_Entries;
+   }
+
+   return &Manifest_ptr->Entries [Manifest_ptr->Num_Entries++];
+
+}  // Add_Manifest_Entry ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Order of manifest entries: by partition, then by generation, i.e., the order written.
+
+static int  Compare_Entries ( const void * A_ptr, const void * B_ptr ) {
+
+   const Manifest_Entry_type * A = A_ptr;
+   const Manifest_Entry_type * B = B_ptr;
+
+
+   if ( A->Partition != B->Partition )  return ( A->Partition < B->Partition )  ?  -1  :  1;
+   if ( A->Generation != B->Generation )  return ( A->Generation < B->Generation )  ?  -1  :  1;
+   return 0;
+
+}  // Compare_Entries ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Sorts a chunk of events, suppresses the duplicates between its input files, and
+//  writes the events as runs, one per partition.   The new runs are added to the list
+//  Runs; the generation number, which makes the file names unique, is taken from the
+//  archive manifest.
+
+static void  Write_Runs ( const char * ArchiveDir, Processed_TTE_v2_type Chunk [], size_t Num_in_Chunk,
+                          Manifest_type * Archive_ptr, Manifest_type * Runs_ptr, uint64_t * Num_Duplicates_ptr ) {
+
+   static Same_Time_type  Last_Output [NUM_DET];
+
+   TTE_Segment_File_type  Segment;
+   Manifest_Entry_type * Run_ptr;
+   char  Path [MAX_PATH_LENGTH];
+   size_t  i_beg, i_end;
+   size_t  i_event, Num_Kept = 0;
+   uint64_t  Partition;
+
+
+   Radix_Sort_Processed_TTE ( Chunk, Num_in_Chunk, Number_of_Processors () );
+
+   memset ( Last_Output, 0, sizeof (Last_Output) );
+
+   for ( i_event=0;  i_event < Num_in_Chunk;  i_event++ ) {
+      if ( Duplicate_Event ( Last_Output, &Chunk [i_event], Chunk [i_event] .Reserved ) ) {
+         ( *Num_Duplicates_ptr ) ++;
+      } else {
+         Chunk [Num_Kept++] = Chunk [i_event];
+      }
+   }
+
+   Num_in_Chunk = Num_Kept;
+
+   for ( i_beg=0;  i_beg < Num_in_Chunk;  i_beg = i_end ) {
+
+      Partition = Chunk [i_beg] .Time_in_OneVariable / Archive_ptr->Partition_Ticks;
+      for ( i_end = i_beg + 1;
+            i_end < Num_in_Chunk  &&  Chunk [i_end] .Time_in_OneVariable / Archive_ptr->Partition_Ticks == Partition;
+            i_end++ );
+
+      Run_ptr = Add_Manifest_Entry ( Runs_ptr );
+      Run_ptr->Partition = Partition;
+      Run_ptr->Generation = Archive_ptr->Next_Generation++;
+      snprintf ( Run_ptr->FileName, MAX_SEGMENT_NAME, "P%010llu_G%08u.seg", (long long unsigned int) Partition, Run_ptr->Generation );
+
+      Archive_Path ( ArchiveDir, Run_ptr->FileName, Path );
+      Open_TTE_Segment_Output ( Path, Partition, Archive_ptr->Partition_Ticks, &Segment );
+      Write_TTE_Segment ( &Segment, Chunk + i_beg, i_end - i_beg );
+
+      Run_ptr->First_Time = Segment.Header.First_Time;
+      Run_ptr->Last_Time = Segment.Header.Last_Time;
+      Run_ptr->Num_Events = Segment.Header.Num_Events;
+
+      Close_TTE_Segment ( &Segment );
+
+   }
+
+}  // Write_Runs ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Merges the segments Inputs, all of one partition, into one new segment, described by *Output_ptr.
+//  The memory is divided between the read buffers of the inputs and the write buffer.
+//  Events with the same time are ordered by detector, and otherwise kept in the order of the inputs,
+//  as in Merge_TTE.   The number of inputs is small (the existing segment plus the runs
+//  of the new data), so the earliest input is found with a simple scan.   The first input is the
+//  existing segment if Has_Existing, dataset 0; the events of the runs are of the datasets in their
+//  Reserved fields, which are in increasing order over the runs.   The events of different datasets
+//  that are duplicates are suppressed, and the Reserved fields of the output are zero.
+
+static void  Merge_Partition ( const char * ArchiveDir, Manifest_Entry_type * Inputs [], uint32_t Num_Inputs, _Bool Has_Existing,
+                               size_t Memory_Events, Manifest_type * Archive_ptr, Manifest_Entry_type * Output_ptr,
+                               uint64_t * Num_Duplicates_ptr ) {
+
+   static Same_Time_type  Last_Output [NUM_DET];
+
+   Merge_Input_type * Merge;
+   TTE_Segment_File_type  Output_Segment;
+   Processed_TTE_v2_type * Output_Buffer;
+   size_t  Num_in_Output = 0;
+   size_t  Block_Events;
+   char  Path [MAX_PATH_LENGTH];
+   uint32_t  i_input, i_min;
+   const Processed_TTE_v2_type * Event_ptr;
+   const Processed_TTE_v2_type * Min_ptr;
+   uint32_t  Dataset;
+
+
+   memset ( Last_Output, 0, sizeof (Last_Output) );
+
+   Block_Events = Memory_Events / ( Num_Inputs + 1 );
+   if ( Block_Events < MIN_MERGE_BLOCK )  Block_Events = MIN_MERGE_BLOCK;
+
+   Merge = malloc ( Num_Inputs * sizeof (Merge_Input_type) );
+   Output_Buffer = malloc ( Block_Events * sizeof (Processed_TTE_v2_type) );
+   if ( Merge == NULL  ||  Output_Buffer == NULL ) {
+      printf ( "\n\nmalloc of merge buffers failed. exiting.\n" );
+      exit (79);
+   }
+
+   for ( i_input=0;  i_input < Num_Inputs;  i_input++ ) {
+      Archive_Path ( ArchiveDir, Inputs [i_input] ->FileName, Path );
+      Open_TTE_Segment_Input ( Path, &Merge [i_input] .Segment );
+      Merge [i_input] .Buffer = malloc ( Block_Events * sizeof (Processed_TTE_v2_type) );
+      if ( Merge [i_input] .Buffer == NULL ) {
+         printf ( "\n\nmalloc of merge buffers failed. exiting.\n" );
+         exit (79);
+      }
+      Merge [i_input] .Num_in_Buffer = Read_TTE_Segment ( &Merge [i_input] .Segment, Merge [i_input] .Buffer, Block_Events );
+      Merge [i_input] .i_Buffer = 0;
+   }
+
+   Output_ptr->Partition = Inputs [0] ->Partition;
+   Output_ptr->Generation = Archive_ptr->Next_Generation++;
+   snprintf ( Output_ptr->FileName, MAX_SEGMENT_NAME, "P%010llu_G%08u.seg",
+              (long long unsigned int) Output_ptr->Partition, Output_ptr->Generation );
+
+   Archive_Path ( ArchiveDir, Output_ptr->FileName, Path );
+   Open_TTE_Segment_Output ( Path, Output_ptr->Partition, Archive_ptr->Partition_Ticks, &Output_Segment );
+
+
+   while ( true ) {  // merge
+
+      //  find the input with the earliest event -- ties go to the earlier input:
+
+      Min_ptr = NULL;
+      i_min = 0;
+
+      for ( i_input=0;  i_input < Num_Inputs;  i_input++ ) {
+
+         if ( Merge [i_input] .i_Buffer == Merge [i_input] .Num_in_Buffer )  continue;   // input finished
+
+         Event_ptr = &Merge [i_input] .Buffer [Merge [i_input] .i_Buffer];
+         if ( Min_ptr == NULL  ||  Event_ptr->Time_in_OneVariable < Min_ptr->Time_in_OneVariable  ||
+              ( Event_ptr->Time_in_OneVariable == Min_ptr->Time_in_OneVariable  &&  Event_ptr->Detector < Min_ptr->Detector ) ) {
+            Min_ptr = Event_ptr;
+            i_min = i_input;
+         }
+
+      }
+
+      if ( Min_ptr == NULL )  break;   // all inputs finished
+
+      Dataset = ( Has_Existing  &&  i_min == 0 )  ?  0  :  Min_ptr->Reserved;
+
+      if ( Duplicate_Event ( Last_Output, Min_ptr, Dataset ) ) {  // duplicate ?
+
+         ( *Num_Duplicates_ptr ) ++;
+
+      } else {  // duplicate ?
+
+         Output_Buffer [Num_in_Output] = *Min_ptr;
+         Output_Buffer [Num_in_Output] .Reserved = 0;
+         Num_in_Output++;
+         if ( Num_in_Output == Block_Events ) {
+            Write_TTE_Segment ( &Output_Segment, Output_Buffer, Num_in_Output );
+            Num_in_Output = 0;
+         }
+
+      }  // duplicate ?
+
+      Merge [i_min] .i_Buffer++;
+      if ( Merge [i_min] .i_Buffer == Merge [i_min] .Num_in_Buffer ) {
+         Merge [i_min] .Num_in_Buffer = Read_TTE_Segment ( &Merge [i_min] .Segment, Merge [i_min] .Buffer, Block_Events );
+         Merge [i_min] .i_Buffer = 0;
+      }
+
+   }  // merge
+
+   Write_TTE_Segment ( &Output_Segment, Output_Buffer, Num_in_Output );
+
+   Output_ptr->First_Time = Output_Segment.Header.First_Time;
+   Output_ptr->Last_Time = Output_Segment.Header.Last_Time;
+   Output_ptr->Num_Events = Output_Segment.Header.Num_Events;
+
+   Close_TTE_Segment ( &Output_Segment );
+
+   printf ( "Partition %llu: merged %u segments into %s, %llu events.\n", (long long unsigned int) Output_ptr->Partition,
+            Num_Inputs, Output_ptr->FileName, (long long unsigned int) Output_ptr->Num_Events );
+
+   for ( i_input=0;  i_input < Num_Inputs;  i_input++ ) {
+      Close_TTE_Segment ( &Merge [i_input] .Segment );
+      free ( Merge [i_input] .Buffer );
+   }
+   free ( Merge );
+   free ( Output_Buffer );
+
+}  // Merge_Partition ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Is the event, of Dataset, a copy of an event of an earlier dataset that has been output ?
+//  If so, that event is paired with it; if not, it is remembered as output.   The events must
+//  come in time order, and those with the same time and detector in the order of their datasets.
+
+static _Bool  Duplicate_Event ( Same_Time_type Last_Output [NUM_DET], const Processed_TTE_v2_type * Event_ptr, uint32_t Dataset ) {
+
+   Same_Time_type * Last_ptr;
+   uint32_t  i_same;
+
+
+   if ( Event_ptr->Detector >= NUM_DET )  return false;
+
+   Last_ptr = &Last_Output [Event_ptr->Detector];
+
+   if ( Last_ptr->Num > 0  &&  Last_ptr->Time_in_OneVariable != Event_ptr->Time_in_OneVariable )
+      Last_ptr->Num = 0;
+
+   for ( i_same=0;  i_same < Last_ptr->Num;  i_same++ ) {
+      if ( Last_ptr->SpecChannel [i_same] == Event_ptr->SpecChannel  &&  Last_ptr->Flags [i_same] == Event_ptr->Flags  &&
+           Last_ptr->Matched_Dataset [i_same] < Dataset ) {
+         Last_ptr->Matched_Dataset [i_same] = Dataset;
+         return true;
+      }
+   }
+
+   if ( Last_ptr->Num < MAX_SAME_TIME ) {
+      Last_ptr->Time_in_OneVariable = Event_ptr->Time_in_OneVariable;
+      Last_ptr->SpecChannel [Last_ptr->Num] = Event_ptr->SpecChannel;
+      Last_ptr->Flags [Last_ptr->Num] = Event_ptr->Flags;
+      Last_ptr->Matched_Dataset [Last_ptr->Num] = Dataset;
+      Last_ptr->Num++;
+   }
+
+   return false;
+
+}  // Duplicate_Event ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Outputs the events with Begin_Time <= time < End_Time.   The manifest is in partition
+//  order, with one segment per partition, so the segments are simply read in turn.
+
+static void  Query_Archive ( const char * ArchiveDir, const Manifest_type * Archive_ptr,
+                             uint64_t Begin_Time, uint64_t End_Time, const char * Output_FileName_ptr ) {
+
+#define  QUERY_BLOCK   4096U
+
+   Processed_TTE_File_type  Output_File;
+   TTE_Segment_File_type  Segment;
+   Processed_TTE_v2_type  Events [QUERY_BLOCK];
+   size_t  num_read, Num_to_Write;
+   const Manifest_Entry_type * Entry_ptr;
+   char  Path [MAX_PATH_LENGTH];
+   uint32_t  i_entry;
+   uint32_t  Num_Segments_Read = 0;
+
+
+   Open_Processed_TTE_Output ( Output_FileName_ptr, 2, &Output_File );
+
+   for ( i_entry=0;  i_entry < Archive_ptr->Num_Entries;  i_entry++ ) {  // loop over segments
+
+      Entry_ptr = &Archive_ptr->Entries [i_entry];
+      if ( Entry_ptr->Last_Time < Begin_Time  ||  Entry_ptr->First_Time >= End_Time )  continue;
+
+      Archive_Path ( ArchiveDir, Entry_ptr->FileName, Path );
+      Open_TTE_Segment_Input ( Path, &Segment );
+      Seek_TTE_Segment ( &Segment, Begin_Time );
+      Num_Segments_Read++;
+
+      while ( ( num_read = Read_TTE_Segment ( &Segment, Events, QUERY_BLOCK ) ) > 0 ) {
+
+         //  (a segment that was a single run holds the input file numbers in Reserved)
+         for ( Num_to_Write=0;  Num_to_Write < num_read  &&  Events [Num_to_Write] .Time_in_OneVariable < End_Time;  Num_to_Write++ )
+            Events [Num_to_Write] .Reserved = 0;
+
+         Write_Processed_TTE ( &Output_File, Events, Num_to_Write );
+         if ( Num_to_Write < num_read )  break;
+
+      }
+
+      Close_TTE_Segment ( &Segment );
+
+   }  // loop over segments
+
+   Close_Processed_TTE_File ( &Output_File );
+
+   printf ( "%llu events from %u of %u segments output to %s\n", (long long unsigned int) Output_File.Num_Events,
+            Num_Segments_Read, Archive_ptr->Num_Entries, Output_FileName_ptr );
+
+}  // Query_Archive ()
@@ -0,0 +1,263 @@
+//  Converts a file of processed TTE events (as output by Merge_TTE) from
+//  any version of the format to the requested version, or to or from
+//  the columnar format (see TTE_Columnar_IO.c).   Version 3 is compressed;
+//  version 4 is compressed and seekable by time (see Select_Processed_TTE).
+//  -arrow exports the events as an Apache Arrow table with the columns Time (uint64,
+//  2 microsec ticks), Detector (uint8) and Channel (uint8), for reading by pyarrow,
+//  pandas, polars, etc.  (see Arrow_IPC_Writer.c).   The output is in the Arrow
+//  IPC file format, or the stream format if the name ends in .arrows.
+
+//  Usage:
+//  ./Convert_Processed_TTE.exe  [-v1 | -v2 | -v3 | -v4 | -col | -arrow]  InputFileName  OutputFileName
+//  The default output version is 2.  The version of the input file is
+//  identified automatically.
+
+//  Version 2 files hold the time as a single 64 bit integer in 2 microsec
+//  ticks, so that analysis programs can stream the events without
+//  recombining Coarse and Fine Time for every event; converting old v1 files
+//  once is cheaper than converting them on every read.
+
+
+#include "HSSDB_Progs_Header.h"
+
+
+#define  CONVERT_BUFFER_SIZE   65536U
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+int main ( int argc, char * argv [] ) {
+
+   uint32_t  Output_Version = 2;
+   _Bool  Columnar_Output = false;
+   _Bool  Columnar_Input;
+   _Bool  Arrow_Output = false;
+
+   Processed_TTE_File_type  Input_File;
+   Processed_TTE_File_type  Output_File;
+   TTE_Columnar_File_type  Columnar_File;
+   Arrow_File_type  Arrow_File;
+
+   Arrow_Column_type  Arrow_Columns [3] = {
+      { "Time", 64, 0 },
+      { "Detector", 8, 0 },
+      { "Channel", 8, 0 }
+   };
+
+   const void *  Arrow_Data [3];
+   uint64_t *  Times = NULL;
+   uint8_t *   Detectors = NULL;
+   uint8_t *   Channels = NULL;
+
+   Processed_TTE_v2_type * Events;
+   size_t  num_read;
+   uint64_t  Num_Converted = 0;
+   uint32_t  i_group;
+   uint32_t  i_row;
+
+
+   // ********************************************************************************************
+
+
+   if ( argc == 4  &&  strcmp ( argv [1], "-v1" ) == 0 ) {
+      Output_Version = 1;
+      argc--;
+      argv++;
+   } else if ( argc == 4  &&  strcmp ( argv [1], "-v2" ) == 0 ) {
+      argc--;
+      argv++;
+   } else if ( argc == 4  &&  strcmp ( argv [1], "-v3" ) == 0 ) {
+      Output_Version = 3;
+      argc--;
+      argv++;
+   } else if ( argc == 4  &&  strcmp ( argv [1], "-v4" ) == 0 ) {
+      Output_Version = 4;
+      argc--;
+      argv++;
+   } else if ( argc == 4  &&  strcmp ( argv [1], "-col" ) == 0 ) {
+      Columnar_Output = true;
+      argc--;
+      argv++;
+   } else if ( argc == 4  &&  strcmp ( argv [1], "-arrow" ) == 0 ) {
+      Arrow_Output = true;
+      argc--;
+      argv++;
+   }
+
+   if ( argc != 3 ) {
+      printf ( "Bad number of command line arguments: %d\n", argc - 1 );
+      printf ( "Example usage:  ./Convert_Processed_TTE  [-v1 | -v2 | -v3 | -v4 | -col | -arrow]  Processed_TTE.dat  Processed_TTE_v2.dat\n" );
+      printf ( "The default output version is 2, version 3 is compressed, version 4 is compressed and indexed,\n" );
+      printf ( "-col outputs the columnar format, -arrow an Arrow table (stream format if named .arrows).\n" );
+      return 1;
+   }
+
+   if ( strcmp ( argv [1], argv [2] ) == 0 ) {
+      printf ( "\nError: the input and output files must be different !\n" );
+      return 2;
+   }
+
+   Events = malloc ( CONVERT_BUFFER_SIZE * sizeof (Processed_TTE_v2_type) );
+   if ( Events == NULL ) {
+      printf ("\nmalloc call failed.\n");
+      return 3;
+   }
+
+
+   Columnar_Input = Is_TTE_Columnar_File ( argv [1] );
+
+   if ( Columnar_Input  &&  Columnar_Output ) {
+      printf ( "\nError: the input file is already columnar !\n" );
+      return 2;
+   }
+
+
+   if ( Arrow_Output ) {  // Arrow output / columnar input / output / neither ?
+
+      //  The columns of the Arrow table are the arrays of Columnar_File for
+      //  columnar input, otherwise they are split from the records.
+
+      Open_Arrow_Output ( argv [2], 3, Arrow_Columns, &Arrow_File );
+
+      if ( Columnar_Input ) {
+
+         Open_TTE_Columnar_Input ( argv [1], &Columnar_File );
+
+         printf ( "\nInput file %s is columnar, output file %s will be an Arrow table.\n", argv [1], argv [2] );
+
+         for ( i_group=0;  i_group < Columnar_File.Header.Num_Groups;  i_group++ ) {
+
+            num_read = Read_TTE_Columnar_Group ( &Columnar_File, i_group,
+                                                 TTE_COLUMN_TIME | TTE_COLUMN_DETECTOR | TTE_COLUMN_CHANNEL,
+                                                 Columnar_File.Times, Columnar_File.Detectors, Columnar_File.Channels );
+
+            Arrow_Data [0] = Columnar_File.Times;
+            Arrow_Data [1] = Columnar_File.Detectors;
+            Arrow_Data [2] = Columnar_File.Channels;
+            Write_Arrow_Batch ( &Arrow_File, (uint32_t) num_read, Arrow_Data );
+
+         }
+
+         Close_TTE_Columnar ( &Columnar_File );
+
+      } else {
+
+         Times = malloc ( CONVERT_BUFFER_SIZE * sizeof (uint64_t) );
+         Detectors = malloc ( CONVERT_BUFFER_SIZE );
+         Channels = malloc ( CONVERT_BUFFER_SIZE );
+         if ( Times == NULL  ||  Detectors == NULL  ||  Channels == NULL ) {
+            printf ("\nmalloc call failed.\n");
+            return 3;
+         }
+
+         Open_Processed_TTE_Input ( argv [1], &Input_File );
+
+         printf ( "\nInput file %s is version %u, output file %s will be an Arrow table.\n", argv [1], Input_File.Version, argv [2] );
+
+         while ( ( num_read = Read_Processed_TTE ( &Input_File, Events, CONVERT_BUFFER_SIZE ) )  >  0 ) {
+
+            for ( i_row=0;  i_row < num_read;  i_row++ ) {
+               Times [i_row] = Events [i_row] .Time_in_OneVariable;
+               Detectors [i_row] = Events [i_row] .Detector;
+               Channels [i_row] = Events [i_row] .SpecChannel;
+            }
+
+            Arrow_Data [0] = Times;
+            Arrow_Data [1] = Detectors;
+            Arrow_Data [2] = Channels;
+            Write_Arrow_Batch ( &Arrow_File, (uint32_t) num_read, Arrow_Data );
+
+         }
+
+         Close_Processed_TTE_File ( &Input_File );
+         free ( Times );
+         free ( Detectors );
+         free ( Channels );
+
+      }
+
+      Close_Arrow_Output ( &Arrow_File );
+      Num_Converted = Arrow_File.Num_Rows;
+
+   } else if ( Columnar_Input ) {  // Arrow output / columnar input / output / neither ?
+
+      //  Columnar to records: the columns of each row group are read into the
+      //  arrays of Columnar_File, then combined into records.
+
+      Open_TTE_Columnar_Input ( argv [1], &Columnar_File );
+
+      if ( Columnar_File.Header.Rows_per_Group > CONVERT_BUFFER_SIZE ) {
+         Events = realloc ( Events, Columnar_File.Header.Rows_per_Group * sizeof (Processed_TTE_v2_type) );
+         if ( Events == NULL ) {
+            printf ("\nmalloc call failed.\n");
+            return 3;
+         }
+      }
+
+      Open_Processed_TTE_Output ( argv [2], Output_Version, &Output_File );
+
+      printf ( "\nInput file %s is columnar, output file %s will be version %u.\n", argv [1], argv [2], Output_Version );
+
+      for ( i_group=0;  i_group < Columnar_File.Header.Num_Groups;  i_group++ ) {
+
+         num_read = Read_TTE_Columnar_Group ( &Columnar_File, i_group,
+                                              TTE_COLUMN_TIME | TTE_COLUMN_DETECTOR | TTE_COLUMN_CHANNEL,
+                                              Columnar_File.Times, Columnar_File.Detectors, Columnar_File.Channels );
+
+         for ( i_row=0;  i_row < num_read;  i_row++ ) {
+            Events [i_row] .Time_in_OneVariable = Columnar_File.Times [i_row];
+            Events [i_row] .Detector = Columnar_File.Detectors [i_row];
+            Events [i_row] .SpecChannel = Columnar_File.Channels [i_row];
+            Events [i_row] .Flags = 0;
+            Events [i_row] .Reserved = 0;
+         }
+
+         Write_Processed_TTE ( &Output_File, Events, num_read );
+
+      }
+
+      Close_TTE_Columnar ( &Columnar_File );
+      Close_Processed_TTE_File ( &Output_File );
+      Num_Converted = Output_File.Num_Events;
+
+   } else if ( Columnar_Output ) {  // Arrow output / columnar input / output / neither ?
+
+      Open_Processed_TTE_Input ( argv [1], &Input_File );
+      Open_TTE_Columnar_Output ( argv [2], 0, &Columnar_File );
+
+      printf ( "\nInput file %s is version %u, output file %s will be columnar.\n", argv [1], Input_File.Version, argv [2] );
+
+      while ( ( num_read = Read_Processed_TTE ( &Input_File, Events, CONVERT_BUFFER_SIZE ) )  >  0 ) {
+         Write_TTE_Columnar ( &Columnar_File, Events, num_read );
+      }
+
+      Close_Processed_TTE_File ( &Input_File );
+      Close_TTE_Columnar ( &Columnar_File );
+      Num_Converted = Columnar_File.Header.Num_Events;
+
+   } else {  // Arrow output / columnar input / output / neither ?
+
+      Open_Processed_TTE_Input ( argv [1], &Input_File );
+      Open_Processed_TTE_Output ( argv [2], Output_Version, &Output_File );
+
+      printf ( "\nInput file %s is version %u, output file %s will be version %u.\n",
+               argv [1], Input_File.Version, argv [2], Output_Version );
+
+      while ( ( num_read = Read_Processed_TTE ( &Input_File, Events, CONVERT_BUFFER_SIZE ) )  >  0 ) {
+         Write_Processed_TTE ( &Output_File, Events, num_read );
+      }
+
+      Close_Processed_TTE_File ( &Input_File );
+      Close_Processed_TTE_File ( &Output_File );
+      Num_Converted = Output_File.Num_Events;
+
+   }  // Arrow output / columnar input / output / neither ?
+
+   printf ( "%llu TTE events converted.\n", (long long unsigned int) Num_Converted );
+
+   free ( Events );
+
+   return 0;
+
+}  // main ()
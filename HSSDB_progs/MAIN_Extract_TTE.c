@@ -13,6 +13,25 @@
 //   For example:
 //   ./Extract_TTE  HSDAQ_BBE3D5A330A.dat
 
+//   With option -inmem, all TTE events are instead held in memory, sorted, and
+//   written to Processed_TTE.dat, making Merge_TTE unnecessary (see Output_TTE_InMemory):
+//   ./Extract_TTE  -inmem  HSDAQ_BBE3D5A330A.dat
+
+//   With option -z, the TTE files (per detector, or Processed_TTE.dat with -inmem) are
+//   written compressed, as version 3 processed TTE (see TTE_Codec.c); Merge_TTE and the
+//   other programs read them like the uncompressed files.
+
+//   Several files, e.g., the consecutive L0 files of a day, can be given: they are read
+//   as a single continuous stream (see File_Sequence.c), so that packets that straddle
+//   file boundaries are read correctly and the time corrections carry across the files.
+//   The names of the output files are formed from the name of the first file.
+//   Wildcard patterns (quoted) and @ListFile can also be used:
+//   ./Extract_TTE  'GLAST_2008289_*_VC09_GBTTE.dat'
+
+//   If the environment variable HSSDB_CACHE_DIR is set, the outputs of a run on the
+//   same input files with the same options are taken from the result cache instead of
+//   being computed again (see Result_Cache.c).
+
 //  This program reads the HSSDB data and extracts the TTE data, writing the TTE events
 //  to files, one file for each detector for which TTE data is encountered.
 //  The output data is simmplier and cleaner: there are only TTE events, rather than a mixture
@@ -80,6 +99,18 @@ int main ( int argc, char * argv [] ) {
    uint32_t  ErrorCounts [NUM_ERROR_TYPES];
    uint16_t  j_err;
 
+   _Bool  InMemory = false;
+   _Bool  Compress = false;
+
+   char ** Input_FileNames;
+   uint32_t  Num_Input_Files;
+   uint32_t  i_file;
+
+   Result_Cache_type  Cache;
+   char *  Cache_FileNames [2 * NUM_DET];
+   char  WorkString [40];
+   uint32_t  j_det;
+
 
 
    // ********************************************************************************************
@@ -93,20 +124,33 @@ int main ( int argc, char * argv [] ) {
    for ( j_err=0;  j_err < NUM_ERROR_TYPES;  j_err++ )  ErrorCounts[j_err] = 0;
 
 
-   if ( argc != 2 ) {
+   while ( argc >= 3  &&  ( strcmp ( argv [1], "-inmem" ) == 0  ||  strcmp ( argv [1], "-z" ) == 0 ) ) {
+      if ( strcmp ( argv [1], "-inmem" ) == 0 )  InMemory = true;
+      else  Compress = true;
+      argc--;
+      argv++;
+   }
+
+   if ( argc < 2 ) {
       printf ( "Bad number of command line arguments: %d\n", argc - 1 );
-      printf ( "Example usage:  ./Extract_TTE  FileName.dat\n" );
-      printf ( "The command-line argument is the name of the file to analyze,\n" );
+      printf ( "Example usage:  ./Extract_TTE  [-inmem]  [-z]  FileName.dat  [FileName.dat ...]\n" );
+      printf ( "The command-line arguments are the names of the files to analyze, read in order as one stream\n" );
+      printf ( "(wildcard patterns and @ListFile are accepted),\n" );
+      printf ( "option -inmem sorts all TTE events in memory and outputs Processed_TTE.dat,\n" );
+      printf ( "option -z writes the TTE output files compressed.\n" );
       return 1;
    }
 
+   Input_FileNames = Expand_File_List ( argc - 1, argv + 1, &Num_Input_Files );
 
 
-   FileName_Length = strlen ( argv [1] );
-   Input_FileName_ptr   = malloc ( FileName_Length );
-   Analysis_FileName_ptr = malloc ( FileName_Length );
-   Summary_FileName_ptr = malloc ( FileName_Length );
-   Anomaly_FileName_ptr = malloc ( FileName_Length );
+   //  The output file names are formed from the name of the first input file:
+
+   FileName_Length = strlen ( Input_FileNames [0] );
+   Input_FileName_ptr   = malloc ( FileName_Length + 1 );
+   Analysis_FileName_ptr = malloc ( FileName_Length + 1 );
+   Summary_FileName_ptr = malloc ( FileName_Length + 1 );
+   Anomaly_FileName_ptr = malloc ( FileName_Length + 1 );
 
    if ( Input_FileName_ptr == NULL  ||  Analysis_FileName_ptr == NULL  ||
         Summary_FileName_ptr == NULL  ||  Anomaly_FileName_ptr == NULL ) {
@@ -114,22 +158,81 @@ int main ( int argc, char * argv [] ) {
       return 2;
    }
 
-   memcpy ( Input_FileName_ptr,   argv [1], FileName_Length );
-   memcpy ( Analysis_FileName_ptr, argv [1], FileName_Length );
-   memcpy ( Summary_FileName_ptr, argv [1], FileName_Length );
-   memcpy ( Anomaly_FileName_ptr, argv [1], FileName_Length );
+   memcpy ( Input_FileName_ptr,   Input_FileNames [0], FileName_Length + 1 );
+   memcpy ( Analysis_FileName_ptr, Input_FileNames [0], FileName_Length + 1 );
+   memcpy ( Summary_FileName_ptr, Input_FileNames [0], FileName_Length + 1 );
+   memcpy ( Anomaly_FileName_ptr, Input_FileNames [0], FileName_Length + 1 );
+
+
+   for ( i_file=0;  i_file < Num_Input_Files;  i_file++ ) {
+      FileName_Length = strlen ( Input_FileNames [i_file] );
+      if ( FileName_Length < 4  ||  strcmp ( Input_FileNames [i_file] + FileName_Length - 4, ".dat" )  != 0  ) {
+         printf ( "\nError: the filetype must be .dat !  (%s)\n", Input_FileNames [i_file] );
+         return 3;
+      }
+   }
+
+   FileName_Length = strlen ( Input_FileName_ptr );
+   memcpy ( Analysis_FileName_ptr + FileName_Length - 4, ".txt", 4 );
+   memcpy ( Summary_FileName_ptr + FileName_Length - 4, ".sum", 4 );
+   memcpy ( Anomaly_FileName_ptr + FileName_Length - 4, ".err", 4 );
 
 
-   if ( strcmp ( Input_FileName_ptr + FileName_Length - 4, ".dat" )  != 0  ) {
-      printf ( "\nError: the filetype must be .dat !\n" );
-      return 3;
+   //  The result cache: the outputs depend on the contents of the input files, the
+   //  origin of the data, the options and the compile-time options, and contain the
+   //  names of the input files:
+
+   Open_Result_Cache ( "Extract_TTE", &Cache );
+
+   Add_Cache_Parameter ( &Cache, "data origin", Ask_Data_Origin () );
+   Add_Cache_Parameter ( &Cache, "option -inmem", InMemory ? "yes" : "no" );
+   Add_Cache_Parameter ( &Cache, "option -z", Compress ? "yes" : "no" );
+   #ifdef ALLOW_ERR_ONE
+      Add_Cache_Parameter ( &Cache, "compile-time option", "ALLOW_ERR_ONE" );
+   #endif
+   #ifdef ALLOW_ERR_TWO
+      Add_Cache_Parameter ( &Cache, "compile-time option", "ALLOW_ERR_TWO" );
+   #endif
+
+   for ( i_file=0;  i_file < Num_Input_Files;  i_file++ ) {
+      Add_Cache_Parameter ( &Cache, "input file name", Input_FileNames [i_file] );
+      Add_Cache_Input ( &Cache, Input_FileNames [i_file] );
    }
 
-   strncpy ( Analysis_FileName_ptr + FileName_Length - 4, ".txt", 4 );
-   strncpy ( Summary_FileName_ptr + FileName_Length - 4, ".sum", 4 );
-   strncpy ( Anomaly_FileName_ptr + FileName_Length - 4, ".err", 4 );
+   Add_Cache_Output ( &Cache, NULL );
+   Add_Cache_Output ( &Cache, Analysis_FileName_ptr );
+   Add_Cache_Output ( &Cache, Summary_FileName_ptr );
+
+   if ( InMemory ) {
+      Add_Cache_Output ( &Cache, "Processed_TTE.dat" );
+      Add_Cache_Output ( &Cache, "Processed_TTE.dat.crc" );
+   } else {
+      for ( j_det=0;  j_det < NUM_DET;  j_det++ ) {  // the files that Output_TTE may write
+         Cache_FileNames [2 * j_det] = malloc ( FileName_Length + 24 );
+         Cache_FileNames [2 * j_det + 1] = malloc ( FileName_Length + 24 );
+         if ( Cache_FileNames [2 * j_det] == NULL  ||  Cache_FileNames [2 * j_det + 1] == NULL ) {
+            printf ("\nmalloc call failed.\n");
+            return 2;
+         }
+         sprintf ( WorkString, ".TTE_Det_%02u.dat", j_det );
+         memcpy ( Cache_FileNames [2 * j_det], Analysis_FileName_ptr, FileName_Length - 4 );
+         strcpy ( Cache_FileNames [2 * j_det] + FileName_Length - 4, WorkString );
+         sprintf ( Cache_FileNames [2 * j_det + 1], "%s.crc", Cache_FileNames [2 * j_det] );
+         Add_Cache_Output ( &Cache, Cache_FileNames [2 * j_det] );
+         Add_Cache_Output ( &Cache, Cache_FileNames [2 * j_det + 1] );
+      }
+   }
+
+   if ( Fetch_Cached_Results ( &Cache ) )  return 0;
+
+   //  A single file is read directly, a sequence of files through the reading thread:
+
+   if ( Num_Input_Files == 1 ) {
+      ptr_to_InputFile =   fopen ( Input_FileName_ptr, "rb" );
+   } else {
+      ptr_to_InputFile = Open_File_Sequence ( Num_Input_Files, Input_FileNames );
+   }
 
-   ptr_to_InputFile =   fopen ( Input_FileName_ptr, "rb" );
    ptr_to_AnalysisFile = fopen ( Analysis_FileName_ptr, "w" );
    ptr_to_SummaryFile = fopen( Summary_FileName_ptr, "w" );
 
@@ -146,7 +249,10 @@ int main ( int argc, char * argv [] ) {
 
 
 
-   fprintf ( ptr_to_AnalysisFile, "\n\nAnalyzing File %s\n\n", Input_FileName_ptr );
+   fprintf ( ptr_to_AnalysisFile, "\n\nAnalyzing File %s\n", Input_FileName_ptr );
+   for ( i_file=1;  i_file < Num_Input_Files;  i_file++ )
+      fprintf ( ptr_to_AnalysisFile, "       and File %s\n", Input_FileNames [i_file] );
+   fprintf ( ptr_to_AnalysisFile, "\n" );
    fprintf ( ptr_to_AnalysisFile, "         Time\n  Coarse     Fine  det chan\n\n" );
 
 
@@ -233,15 +339,33 @@ int main ( int argc, char * argv [] ) {
                                         TTE_Detector
                                       );
 
-                  Output_TTE ( Number_TTE_DataWords,
-                               TTE_CoarseTime,
-                               TTE_FineTime,
-                               TTE_Channel,
-                               TTE_Detector,
-                               Analysis_FileName_ptr,
-                               ptr_to_AnalysisFile,
-                               ptr_to_SummaryFile
-                              );
+                  if ( InMemory ) {
+
+                     Output_TTE_InMemory ( Number_TTE_DataWords,
+                                           TTE_CoarseTime,
+                                           TTE_FineTime,
+                                           TTE_Channel,
+                                           TTE_Detector,
+                                           "Processed_TTE.dat",
+                                           ptr_to_AnalysisFile,
+                                           ptr_to_SummaryFile,
+                                           Compress
+                                          );
+
+                  } else {
+
+                     Output_TTE ( Number_TTE_DataWords,
+                                  TTE_CoarseTime,
+                                  TTE_FineTime,
+                                  TTE_Channel,
+                                  TTE_Detector,
+                                  Analysis_FileName_ptr,
+                                  ptr_to_AnalysisFile,
+                                  ptr_to_SummaryFile,
+                                  Compress
+                                 );
+
+                  }
 
                break;
 
@@ -293,15 +417,33 @@ int main ( int argc, char * argv [] ) {
    //  number of TTE data words.  (This value is impossible for
    //  a real TTE packet.)
 
-   Output_TTE ( UINT16_MAX,
-                TTE_CoarseTime,
-                TTE_FineTime,
-                TTE_Channel,
-                TTE_Detector,
-                Analysis_FileName_ptr,
-                ptr_to_AnalysisFile,
-                ptr_to_SummaryFile
-               );
+   if ( InMemory ) {
+
+      Output_TTE_InMemory ( UINT16_MAX,
+                            TTE_CoarseTime,
+                            TTE_FineTime,
+                            TTE_Channel,
+                            TTE_Detector,
+                            "Processed_TTE.dat",
+                            ptr_to_AnalysisFile,
+                            ptr_to_SummaryFile,
+                            Compress
+                           );
+
+   } else {
+
+      Output_TTE ( UINT16_MAX,
+                   TTE_CoarseTime,
+                   TTE_FineTime,
+                   TTE_Channel,
+                   TTE_Detector,
+                   Analysis_FileName_ptr,
+                   ptr_to_AnalysisFile,
+                   ptr_to_SummaryFile,
+                   Compress
+                  );
+
+   }
 
    //  Output info about timing errors detected and, for most types, corrected.
    //  Error types are numbered from 1, so we skip array element 0.
@@ -311,6 +453,17 @@ int main ( int argc, char * argv [] ) {
       fprintf ( ptr_to_AnalysisFile, "%u Timing Errors of Type %u detected.\n", ErrorCounts[j_err], j_err );
    }
 
+   if ( Num_Input_Files == 1 ) {
+      fclose ( ptr_to_InputFile );
+   } else {
+      Close_File_Sequence ( ptr_to_InputFile );
+   }
+
+   fclose ( ptr_to_AnalysisFile );
+   fclose ( ptr_to_SummaryFile );
+
+   Store_Cached_Results ( &Cache );
+
    return 0;
 
 
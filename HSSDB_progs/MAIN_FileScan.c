@@ -12,6 +12,9 @@
 //   FileScan filename
 //   For example:
 //   ./FileScan  HSDAQ_BBE3D5A330A.dat
+//   With the optional first argument -arrow, the CTIME and CSPEC packets are also
+//   output as Apache Arrow tables (see Output_Histogram_Arrow.c):
+//   ./FileScan  -arrow  HSDAQ_BBE3D5A330A.dat
 
 //   Michael S. Briggs, 2003 Sept 23, 24 & 26 & 30, Oct 7.
 //   MSB, 2003 Oct 13 & 14: add deducing times from words inside of TTE packets.
@@ -59,6 +62,7 @@ int main (int argc, char * argv [] ) {
    FILE * ptr_to_TTE_File;
 
    size_t  FileName_Length;
+   const char * Arg_FileName_ptr;
    char * Input_FileName_ptr;
    char * Summary_FileName_ptr;
    char * TTE_FileName_ptr;
@@ -83,6 +87,8 @@ int main (int argc, char * argv [] ) {
 
    uint16_t SequenceCount;
 
+   _Bool  Arrow_Output;
+
 
    //  This array is indexed by the enum type DataType_type:
 
@@ -99,16 +105,21 @@ int main (int argc, char * argv [] ) {
 
 
    //Validate number of args
-   if ( argc != 2 ) {
+   Arrow_Output = ( argc == 3  &&  strcmp ( argv [1], "-arrow" ) == 0 );
+
+   if ( argc != 2  &&  ! Arrow_Output ) {
       printf ( "Bad number of command line arguments: %d\n", argc - 1 );
       printf ( "Example usage:  ./FileScan  HSDAQ_BBE3D5A330A.dat\n" );
       printf ( "The command-line argument is the name of the file to analyze,\n" );
+      printf ( "optionally preceeded by -arrow to also output CTIME & CSPEC as Arrow tables.\n" );
       return 1;
    }
 
+   Arg_FileName_ptr = argv [argc - 1];
+
 
    //Check length of filename
-   FileName_Length = strlen ( argv [1] );
+   FileName_Length = strlen ( Arg_FileName_ptr );
    //Allocate memory for input filename (size=input filename length)
    //Return pointer to allocated memory
    Input_FileName_ptr   = malloc ( FileName_Length );
@@ -127,13 +138,13 @@ int main (int argc, char * argv [] ) {
 
    //Copy contents of argv[1] (input filename) to Input_FileName_ptr
    //upto size FileName_Length
-   memcpy ( Input_FileName_ptr,   argv [1], FileName_Length );
+   memcpy ( Input_FileName_ptr,   Arg_FileName_ptr, FileName_Length );
    //Copy contents of argv[1] (input filename) to Summary_FileName_ptr
    //upto size FileName_Length
-   memcpy ( Summary_FileName_ptr, argv [1], FileName_Length );
+   memcpy ( Summary_FileName_ptr, Arg_FileName_ptr, FileName_Length );
    //Copy contents of argv[1] (input filename) to TTE_FileName_ptr
    //upto size FileName_Length
-   memcpy ( TTE_FileName_ptr,     argv [1], FileName_Length );
+   memcpy ( TTE_FileName_ptr,     Arg_FileName_ptr, FileName_Length );
 
    //Validate that the input filename has '.dat' as the last 4 chars
    if ( strcmp ( Input_FileName_ptr + FileName_Length - 4, ".dat" )  != 0  ) {
@@ -275,6 +286,10 @@ int main (int argc, char * argv [] ) {
 
                   ProcessCSPEC ( PacketData, PacketDataLength, ptr_to_SummaryFile );
 
+                  if ( Arrow_Output )
+                     Output_Histogram_Arrow ( DataType, PacketData, PacketDataLength,
+                                              HeaderCoarseTime, HeaderFineTime, SequenceCount, Arg_FileName_ptr );
+
                break;
 
 
@@ -282,6 +297,10 @@ int main (int argc, char * argv [] ) {
 
                   ProcessCTIME ( PacketData, PacketDataLength, ptr_to_SummaryFile );
 
+                  if ( Arrow_Output )
+                     Output_Histogram_Arrow ( DataType, PacketData, PacketDataLength,
+                                              HeaderCoarseTime, HeaderFineTime, SequenceCount, Arg_FileName_ptr );
+
                break;
 
 
@@ -307,6 +326,12 @@ int main (int argc, char * argv [] ) {
    }   // loop while sync words available
 
 
+   //  Closeout: output the remaining rows of the Arrow tables:
+
+   if ( Arrow_Output )
+      Output_Histogram_Arrow ( BAD, PacketData, UINT16_MAX, 0, 0, 0, Arg_FileName_ptr );
+
+
    fprintf ( ptr_to_SummaryFile, "\n\nCount of APIDs found:\n\n" );
    fprintf ( ptr_to_SummaryFile, "APID 0x5A0: CSPEC: %6u\n", CountByAPID [ CSPEC ] );
    fprintf ( ptr_to_SummaryFile, "APID 0x5A1: CTIME: %6u\n", CountByAPID [ CTIME ] );
@@ -0,0 +1,439 @@
+//  Imports the TTE events of the .tte text files output by FileScan, converting them
+//  to a processed TTE file -- for the data whose .dat files are no longer available.
+
+//  Usage:
+//  ./Import_TTE_Text.exe  [-t NumThreads]  [-v1 | -v2 | -v3 | -v4]  -o OutputFileName  InputFile.tte  [InputFile.tte ...]
+
+//  Each TTE Data Word is a line of the .tte file:
+//     Sequence  Count  0xRawCoarse  FullCoarse  Fine  FloatTime  Det  Chan
+//  The time of the event is taken from the full coarse time and the fine time,
+//  the integers, rather than from the floating point time.   The other lines --
+//  headers, the "New chunk" times, and the data words output before the first
+//  Time Word of a chunk, which have no time -- are skipped.   As noted for
+//  ProcessTTE, the times are NOT corrected for the timing errors of the FPGAs,
+//  unlike those output by Extract_TTE and Merge_TTE.
+
+//  The events of all of the input files are sorted into time order (as by
+//  Sort_TTE) and output as a processed TTE file, by default of version 2.
+
+//  For speed, each input file is mapped into memory and divided at line boundaries
+//  into one piece per thread; the threads parse their pieces at the same time,
+//  with a simple integer parser instead of sscanf.
+
+
+#define  _POSIX_C_SOURCE  200809L
+
+#include "HSSDB_Progs_Header.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+
+#define  MAX_IMPORT_THREADS   64U
+
+//  Files smaller than this many bytes per thread are parsed with fewer threads:
+#define  MIN_BYTES_PER_THREAD   (1U << 20)
+
+#define  INITIAL_EVENT_CAPACITY   (1U << 16)
+
+
+//  local typedefs:
+
+typedef struct  Import_Thread_type {
+   const char *  Text_Beg;       // the piece of the text to parse
+   const char *  Text_End;
+   Processed_TTE_v2_type *  Events;
+   size_t  Num_Events;
+   size_t  Event_Capacity;
+   uint64_t  Num_No_Time;        // data words without a time
+   uint64_t  Num_Bad;            // data words with invalid values
+} Import_Thread_type;
+
+
+//  local function prototypes:
+
+static void * Import_Thread ( void * Arg_ptr );
+
+static const char *  Parse_Decimal ( const char * Char_ptr, const char * End_ptr, uint64_t * Value_ptr );
+
+static const char *  Parse_Hex ( const char * Char_ptr, const char * End_ptr, uint64_t * Value_ptr );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+int main ( int argc, char * argv [] ) {
+
+   char * Output_FileName_ptr = NULL;
+   uint32_t  Output_Version = 2;
+   uint32_t  Num_Threads;
+   uint32_t  Num_File_Threads;
+   uint32_t  j_thread;
+   int  i_arg;
+
+   int  fd;
+   struct stat  File_Status;
+   size_t  File_Bytes;
+   char *  Text;
+   const char *  Split_ptr;
+
+   pthread_t  Threads [MAX_IMPORT_THREADS];
+   Import_Thread_type  Thread_Args [MAX_IMPORT_THREADS];
+
+   Processed_TTE_File_type  Output_File;
+
+   Processed_TTE_v2_type * Events = NULL;
+   Processed_TTE_v2_type * New_Events;
+   size_t  Num_Events = 0;
+   size_t  Event_Capacity = 0;
+   size_t  Num_File_Events;
+   uint64_t  Num_No_Time = 0;
+   uint64_t  Num_Bad = 0;
+
+
+   // ********************************************************************************************
+
+
+   Num_Threads = Number_of_Processors ();
+
+   for ( i_arg=1;  i_arg < argc - 1;  i_arg++ ) {  // options
+
+      if ( strcmp ( argv [i_arg], "-o" ) == 0 ) {
+         Output_FileName_ptr = argv [++i_arg];
+      } else if ( strcmp ( argv [i_arg], "-t" ) == 0 ) {
+         Num_Threads = (uint32_t) strtoul ( argv [++i_arg], NULL, 10 );
+      } else if ( strcmp ( argv [i_arg], "-v1" ) == 0 ) {
+         Output_Version = 1;
+      } else if ( strcmp ( argv [i_arg], "-v2" ) == 0 ) {
+         Output_Version = 2;
+      } else if ( strcmp ( argv [i_arg], "-v3" ) == 0 ) {
+         Output_Version = 3;
+      } else if ( strcmp ( argv [i_arg], "-v4" ) == 0 ) {
+         Output_Version = 4;
+      } else {
+         break;
+      }
+
+   }  // options
+
+   if ( Output_FileName_ptr == NULL  ||  i_arg >= argc ) {
+      printf ( "Bad command line arguments.\n" );
+      printf ( "Example usage:  ./Import_TTE_Text  [-t NumThreads]  [-v1 | -v2 | -v3 | -v4]  -o Processed_TTE.dat  GLAST_2008289_053900_GBTTE.tte\n" );
+      return 1;
+   }
+
+   if ( Num_Threads < 1 )  Num_Threads = 1;
+   if ( Num_Threads > MAX_IMPORT_THREADS )  Num_Threads = MAX_IMPORT_THREADS;
+
+
+   for ( ;  i_arg < argc;  i_arg++ ) {  // loop over input files
+
+      if ( strcmp ( argv [i_arg], Output_FileName_ptr ) == 0 ) {
+         printf ( "\nError: the output file is also an input file !\n" );
+         return 2;
+      }
+
+      fd = open ( argv [i_arg], O_RDONLY );
+      if ( fd < 0  ||  fstat ( fd, &File_Status ) != 0 ) {
+         printf ( "\nFailed to open the input file %s !\n", argv [i_arg] );
+         return 4;
+      }
+
+      File_Bytes = (size_t) File_Status.st_size;
+
+      if ( File_Bytes == 0 ) {
+         close ( fd );
+         printf ( "Read 0 events from %s\n", argv [i_arg] );
+         continue;
+      }
+
+      Text = mmap ( NULL, File_Bytes, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( Text == MAP_FAILED ) {
+         printf ( "\nFailed to map the input file %s into memory !\n", argv [i_arg] );
+         return 4;
+      }
+      close ( fd );
+
+      posix_madvise ( Text, File_Bytes, POSIX_MADV_SEQUENTIAL );
+
+
+      //  Divide the text into one piece per thread, each piece ending after a newline:
+
+      Num_File_Threads = (uint32_t) ( File_Bytes / MIN_BYTES_PER_THREAD );
+      if ( Num_File_Threads > Num_Threads )  Num_File_Threads = Num_Threads;
+      if ( Num_File_Threads < 1 )  Num_File_Threads = 1;
+
+      Split_ptr = Text;
+
+      for ( j_thread=0;  j_thread < Num_File_Threads;  j_thread++ ) {
+
+         Thread_Args [j_thread] .Text_Beg = Split_ptr;
+
+         if ( j_thread == Num_File_Threads - 1 ) {
+            Split_ptr = Text + File_Bytes;
+         } else {
+            Split_ptr = Text + File_Bytes / Num_File_Threads * ( j_thread + 1 );
+            if ( Split_ptr < Thread_Args [j_thread] .Text_Beg )  Split_ptr = Thread_Args [j_thread] .Text_Beg;
+            Split_ptr = memchr ( Split_ptr, '\n', (size_t) ( Text + File_Bytes - Split_ptr ) );
+            Split_ptr = ( Split_ptr == NULL )  ?  Text + File_Bytes  :  Split_ptr + 1;
+         }
+
+         Thread_Args [j_thread] .Text_End = Split_ptr;
+
+      }
+
+      if ( Num_File_Threads == 1 ) {
+         Import_Thread ( &Thread_Args [0] );
+      } else {
+         for ( j_thread=0;  j_thread < Num_File_Threads;  j_thread++ ) {
+            if ( pthread_create ( &Threads [j_thread], NULL, Import_Thread, &Thread_Args [j_thread] ) != 0 ) {
+               printf ( "\n\nFailed to create import thread. exiting.\n" );
+               return 5;
+            }
+         }
+         for ( j_thread=0;  j_thread < Num_File_Threads;  j_thread++ )  pthread_join ( Threads [j_thread], NULL );
+      }
+
+      munmap ( Text, File_Bytes );
+
+
+      //  Append the events of the pieces, in order:
+
+      Num_File_Events = 0;
+
+      for ( j_thread=0;  j_thread < Num_File_Threads;  j_thread++ ) {
+
+         if ( Num_Events + Thread_Args [j_thread] .Num_Events > Event_Capacity ) {  // need more space ?
+
+            if ( Event_Capacity == 0 )  Event_Capacity = INITIAL_EVENT_CAPACITY;
+            while ( Event_Capacity < Num_Events + Thread_Args [j_thread] .Num_Events )  Event_Capacity *= 2;
+
+            New_Events = realloc ( Events, Event_Capacity * sizeof (Processed_TTE_v2_type) );
+            if ( New_Events == NULL ) {
+               printf ( "\n\nOut of memory holding %llu TTE events.  Exiting.\n", (long long unsigned int) Num_Events );
+               return 3;
+            }
+            Events = New_Events;
+
+         }  // need more space ?
+
+         if ( Thread_Args [j_thread] .Num_Events > 0 )
+            memcpy ( Events + Num_Events, Thread_Args [j_thread] .Events, Thread_Args [j_thread] .Num_Events * sizeof (Processed_TTE_v2_type) );
+
+         Num_Events += Thread_Args [j_thread] .Num_Events;
+         Num_File_Events += Thread_Args [j_thread] .Num_Events;
+         Num_No_Time += Thread_Args [j_thread] .Num_No_Time;
+         Num_Bad += Thread_Args [j_thread] .Num_Bad;
+
+         free ( Thread_Args [j_thread] .Events );
+
+      }
+
+      printf ( "Read %llu events from %s\n", (long long unsigned int) Num_File_Events, argv [i_arg] );
+
+   }  // loop over input files
+
+
+   if ( Num_No_Time > 0 )
+      printf ( "\n%llu data words without a time (before the first Time Word of a chunk) were skipped.\n",
+               (long long unsigned int) Num_No_Time );
+
+   if ( Num_Bad > 0 )
+      printf ( "\n%llu data words with an invalid detector, channel or fine time were skipped.\n", (long long unsigned int) Num_Bad );
+
+
+   printf ( "\nSorting %llu TTE events with %u threads ...\n", (long long unsigned int) Num_Events, Num_Threads );
+
+   Radix_Sort_Processed_TTE ( Events, Num_Events, Num_Threads );
+
+   Open_Processed_TTE_Output ( Output_FileName_ptr, Output_Version, &Output_File );
+   Write_Processed_TTE ( &Output_File, Events, Num_Events );
+   Close_Processed_TTE_File ( &Output_File );
+
+   printf ( "Events output to %s (version %u)\n", Output_FileName_ptr, Output_Version );
+
+   free ( Events );
+
+   return 0;
+
+}  // main ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Parses the lines of one piece of the text into events.
+
+static void * Import_Thread ( void * Arg_ptr ) {
+
+   Import_Thread_type * Thread_ptr = Arg_ptr;
+
+   const char *  Line_ptr;
+   const char *  Line_End_ptr;
+   const char *  Char_ptr;
+
+   uint64_t  Sequence, Count, Raw_Coarse, Coarse, Fine, Detector, Channel;
+
+   Processed_TTE_v2_type * New_Events;
+
+
+   Thread_ptr->Event_Capacity = INITIAL_EVENT_CAPACITY;
+   Thread_ptr->Events = malloc ( Thread_ptr->Event_Capacity * sizeof (Processed_TTE_v2_type) );
+   Thread_ptr->Num_Events = 0;
+   Thread_ptr->Num_No_Time = 0;
+   Thread_ptr->Num_Bad = 0;
+
+   if ( Thread_ptr->Events == NULL ) {
+      printf ( "\n\nOut of memory importing TTE events.  Exiting.\n" );
+      exit (3);
+   }
+
+
+   for ( Line_ptr = Thread_ptr->Text_Beg;  Line_ptr < Thread_ptr->Text_End;  Line_ptr = Line_End_ptr + 1 ) {  // lines
+
+      Line_End_ptr = memchr ( Line_ptr, '\n', (size_t) ( Thread_ptr->Text_End - Line_ptr ) );
+      if ( Line_End_ptr == NULL )  Line_End_ptr = Thread_ptr->Text_End;
+
+
+      //  Sequence and Count, then either "0x" and the raw coarse time, or "coarse time not avail":
+
+      Char_ptr = Parse_Decimal ( Line_ptr, Line_End_ptr, &Sequence );
+      if ( Char_ptr == NULL )  continue;    // not a data word
+      Char_ptr = Parse_Decimal ( Char_ptr, Line_End_ptr, &Count );
+      if ( Char_ptr == NULL )  continue;
+
+      while ( Char_ptr < Line_End_ptr  &&  *Char_ptr == ' ' )  Char_ptr++;
+
+      if ( Char_ptr < Line_End_ptr  &&  *Char_ptr == 'c' ) {
+         Thread_ptr->Num_No_Time++;
+         continue;
+      }
+
+      Char_ptr = Parse_Hex ( Char_ptr, Line_End_ptr, &Raw_Coarse );
+      if ( Char_ptr == NULL )  continue;
+      Char_ptr = Parse_Decimal ( Char_ptr, Line_End_ptr, &Coarse );
+      if ( Char_ptr == NULL )  continue;
+      Char_ptr = Parse_Decimal ( Char_ptr, Line_End_ptr, &Fine );
+      if ( Char_ptr == NULL )  continue;
+
+      //  Skip the floating point time:
+
+      while ( Char_ptr < Line_End_ptr  &&  *Char_ptr == ' ' )  Char_ptr++;
+      while ( Char_ptr < Line_End_ptr  &&  *Char_ptr != ' ' )  Char_ptr++;
+
+      Char_ptr = Parse_Decimal ( Char_ptr, Line_End_ptr, &Detector );
+      if ( Char_ptr == NULL )  continue;
+      Char_ptr = Parse_Decimal ( Char_ptr, Line_End_ptr, &Channel );
+      if ( Char_ptr == NULL )  continue;
+
+      if ( Coarse > UINT32_MAX  ||  Fine >= 50000  ||  Detector >= NUM_DET  ||  Channel >= NUM_SPEC_CHAN ) {
+         Thread_ptr->Num_Bad++;
+         continue;
+      }
+
+
+      if ( Thread_ptr->Num_Events == Thread_ptr->Event_Capacity ) {  // need more space ?
+
+         Thread_ptr->Event_Capacity *= 2;
+         New_Events = realloc ( Thread_ptr->Events, Thread_ptr->Event_Capacity * sizeof (Processed_TTE_v2_type) );
+         if ( New_Events == NULL ) {
+            printf ( "\n\nOut of memory importing TTE events.  Exiting.\n" );
+            exit (3);
+         }
+         Thread_ptr->Events = New_Events;
+
+      }  // need more space ?
+
+      Thread_ptr->Events [Thread_ptr->Num_Events] .Time_in_OneVariable = IntegerTime_from_CoarseFine ( (uint32_t) Coarse, (uint16_t) Fine );
+      Thread_ptr->Events [Thread_ptr->Num_Events] .Detector = (uint8_t) Detector;
+      Thread_ptr->Events [Thread_ptr->Num_Events] .SpecChannel = (uint8_t) Channel;
+      Thread_ptr->Events [Thread_ptr->Num_Events] .Flags = 0;
+      Thread_ptr->Events [Thread_ptr->Num_Events] .Reserved = 0;
+      Thread_ptr->Num_Events++;
+
+   }  // lines
+
+   return NULL;
+
+}  // Import_Thread ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Parses an unsigned decimal integer after any spaces.   Returns a pointer to the
+//  character after it, or NULL if there is no integer, i.e., not a data word.
+
+static const char *  Parse_Decimal ( const char * Char_ptr, const char * End_ptr, uint64_t * Value_ptr ) {
+
+   uint64_t  Value = 0;
+   const char *  Digits_ptr;
+
+
+   while ( Char_ptr < End_ptr  &&  *Char_ptr == ' ' )  Char_ptr++;
+
+   Digits_ptr = Char_ptr;
+
+   while ( Char_ptr < End_ptr  &&  *Char_ptr >= '0'  &&  *Char_ptr <= '9' ) {
+      Value = Value * 10 + (uint64_t) ( *Char_ptr - '0' );
+      Char_ptr++;
+   }
+
+   if ( Char_ptr == Digits_ptr  ||  Char_ptr - Digits_ptr > 19 )  return NULL;
+   if ( Char_ptr < End_ptr  &&  *Char_ptr != ' '  &&  *Char_ptr != '\r' )  return NULL;
+
+   *Value_ptr = Value;
+
+   return Char_ptr;
+
+}  // Parse_Decimal ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  As Parse_Decimal, for a hexadecimal integer written with 0x.
+
+static const char *  Parse_Hex ( const char * Char_ptr, const char * End_ptr, uint64_t * Value_ptr ) {
+
+   uint64_t  Value = 0;
+   const char *  Digits_ptr;
+   uint32_t  Digit;
+
+
+   while ( Char_ptr < End_ptr  &&  *Char_ptr == ' ' )  Char_ptr++;
+
+   if ( End_ptr - Char_ptr < 2  ||  Char_ptr [0] != '0'  ||  Char_ptr [1] != 'x' )  return NULL;
+   Char_ptr += 2;
+
+   Digits_ptr = Char_ptr;
+
+   for ( ;  Char_ptr < End_ptr;  Char_ptr++ ) {
+
+      if ( *Char_ptr >= '0'  &&  *Char_ptr <= '9' )
+         Digit = (uint32_t) ( *Char_ptr - '0' );
+      else if ( *Char_ptr >= 'A'  &&  *Char_ptr <= 'F' )
+         Digit = (uint32_t) ( *Char_ptr - 'A' + 10 );
+      else if ( *Char_ptr >= 'a'  &&  *Char_ptr <= 'f' )
+         Digit = (uint32_t) ( *Char_ptr - 'a' + 10 );
+      else
+         break;
+
+      Value = Value * 16 + Digit;
+
+   }
+
+   if ( Char_ptr == Digits_ptr  ||  Char_ptr - Digits_ptr > 16 )  return NULL;
+   if ( Char_ptr < End_ptr  &&  *Char_ptr != ' '  &&  *Char_ptr != '\r' )  return NULL;
+
+   *Value_ptr = Value;
+
+   return Char_ptr;
+
+}  // Parse_Hex ()
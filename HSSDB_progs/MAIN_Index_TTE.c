@@ -0,0 +1,45 @@
+//  Makes the bitmap indexes of processed TTE files -- see TTE_Bitmap_Index.c.
+
+//  Usage:
+//  ./Index_TTE.exe  FileName  [FileName ...]
+
+//  The index of each file is written to FileName.bix.   The files may be any version,
+//  but the index is used only for versions 1 and 2, by programs that read via
+//  TTE_Event_Reader.c and select events by detector or channel.   Run it again if a
+//  file is replaced: an index that does not match its file is ignored.   The block
+//  checksums of each index are written to FileName.bix.crc (see TTE_Checksum.c).
+
+
+#include "HSSDB_Progs_Header.h"
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+int main ( int argc, char * argv [] ) {
+
+   char *  Index_FileName_ptr;
+   int  i_arg;
+
+
+   // ********************************************************************************************
+
+
+   if ( argc < 2 ) {
+      printf ( "Bad command line arguments.\n" );
+      printf ( "Example usage:  ./Index_TTE.exe  Processed_TTE.dat\n" );
+      printf ( "Writes the bitmap index of each file, by detector and channel, to FileName.bix\n" );
+      return 1;
+   }
+
+   for ( i_arg=1;  i_arg < argc;  i_arg++ ) {
+      Build_TTE_Bitmap_Index ( argv [i_arg] );
+      Index_FileName_ptr = TTE_Bitmap_Index_FileName ( argv [i_arg] );
+      Write_TTE_Checksums ( Index_FileName_ptr );
+      free ( Index_FileName_ptr );
+      printf ( "Indexed %s\n", argv [i_arg] );
+   }
+
+   return 0;
+
+}  // main ()
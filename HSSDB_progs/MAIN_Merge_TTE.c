@@ -8,39 +8,120 @@
 //  Michael S. Briggs, 2008 June -- July 7.
 //  Work in progress.  Needs comments.  See AAA_DESCRIPTION.txt
 
+//  Usage:  ./Merge_TTE.exe  [-v1 | -v3 | -v4]  [-o OutputFileName]  FileName.sum  [FileName.sum ...]
+
+//  Merges the per-detector TTE files output by Extract_TTE into a single file in
+//  time order.   Any number of datasets can be merged in one pass, each identified
+//  by the .sum file output by Extract_TTE (or by the name of the .dat file that was
+//  input to Extract_TTE, from which the .sum name is derived).   The datasets are
+//  typically consecutive L0 files: all of the per-detector streams of all of the
+//  datasets are merged together in a single k-way merge, so that a day of data
+//  becomes a single ordered stream in one I/O pass.
+
+//  Neighbouring L0 files overlap at their edges, so the same TTE event can be
+//  present in two (or more) datasets.   Such duplicates are suppressed as they are
+//  merged: an event is dropped if an identical event (time, detector and channel)
+//  from an earlier dataset has been output and has not already been paired with an
+//  event of this dataset.   Identical events within one dataset are all kept -- two
+//  real events can have the same time and channel -- and each is paired with at
+//  most one copy per later dataset.   Since ties are broken by dataset number, all
+//  events of a detector at a given time from the earlier dataset are output before
+//  those from a later dataset are considered.
+
+//  The detector files can also be compressed (Extract_TTE -z): such a file is
+//  recognized by its header and read through Read_Processed_TTE.
+
+//  The output file, by default Processed_TTE.dat, is written as version 2 processed
+//  TTE (Processed_TTE_v2_type), unless option -v1 requests the original format,
+//  -v3 the compressed format, or -v4 the compressed format with the block
+//  directory that allows a time range to be read without reading the whole file.
+//  The block checksums of the output are written to OutputFileName.crc, for
+//  Verify_TTE (see TTE_Checksum.c).
+
+//  If the environment variable HSSDB_CACHE_DIR is set, the output of a merge of the
+//  same detector files to the same format is taken from the result cache instead of
+//  being computed again (see Result_Cache.c).
+
 
 #include "HSSDB_Progs_Header.h"
 
 #include <limits.h>
 
 
+//  Number of events read from a detector file by each fread, and
+//  number of merged events written by each fwrite:
+#define  STREAM_BUFFER_SIZE   4096U
+#define  OUTPUT_BUFFER_SIZE   4096U
+
+//  Maximum number of events of one detector at one time that are remembered for
+//  the suppression of duplicates -- any more are output without comparison:
+#define  MAX_SAME_TIME   64U
+
+
 //  local typedefs:
 
-typedef struct  Detector_Buffer_type {
-   _Bool  HaveData;
-   uint16_t  SpecChan;
+//  One input stream: the TTE file of one detector of one dataset, with a read buffer.
+
+typedef struct  Stream_type {
+   FILE *  File_ptr;
+   Processed_TTE_File_type *  Compressed_ptr;     // NULL unless the file is compressed
+   uint16_t  Detector;
+   uint16_t  Dataset;
+   TTE_Data_type  Buffer [STREAM_BUFFER_SIZE];
+   size_t  Num_in_Buffer;
+   size_t  i_Buffer;
+   uint64_t  Time_in_OneVariable;     // time of the current event, Buffer [i_Buffer]
+} Stream_type;
+
+
+//  The events output for one detector at the most recent time, for the suppression
+//  of duplicates.   Matched_Dataset is the last dataset whose copy of the event was
+//  suppressed, initially the dataset of the event itself.
+
+typedef struct  Same_Time_type {
    uint64_t  Time_in_OneVariable;
-   uint32_t CoarseTime;
-   uint16_t FineTime;
-} Detector_Buffer_type;
+   uint32_t  Num;
+   uint16_t  SpecChannel [MAX_SAME_TIME];
+   uint16_t  Matched_Dataset [MAX_SAME_TIME];
+} Same_Time_type;
 
 
 //  local function prototypes:
 
+void Open_Stream (
+
+   Stream_type * Stream_ptr,
+   const DetectorFile_type * DetectorFile_ptr
+
+);
+
 void ReadSummaryFile (
 
-   int argc,
-   char * argv [],
+   char * Summary_FileName_ptr,
    uint32_t  * First_Time_Coarse_ptr,
    uint16_t  * First_Time_Fine_ptr,
    DetectorFile_type  DetectorFiles [NUM_DET]
 
 );
 
-void Load_Detector_Buffer (
+_Bool Load_Stream (
+
+   Stream_type * Stream_ptr
+
+);
+
+_Bool Stream_Precedes (
 
-   DetectorFile_type  DetectorFiles [NUM_DET],
-   Detector_Buffer_type  Detector_Buffer [NUM_DET]
+   const Stream_type * Stream_A_ptr,
+   const Stream_type * Stream_B_ptr
+
+);
+
+void Sift_Down_Heap (
+
+   Stream_type * Heap [],
+   uint32_t Heap_Size,
+   uint32_t i_node
 
 );
 
@@ -64,20 +145,40 @@ int main ( int argc, char * argv [] ) {
    uint16_t  First_Time_Fine;
    DetectorFile_type  DetectorFiles [NUM_DET];
 
-   Detector_Buffer_type Detector_Buffer[NUM_DET];
+   char * Output_FileName_ptr = "Processed_TTE.dat";
+   char * Summary_FileName_ptr;
+   size_t  FileName_Length;
 
-   _Bool  ContinueFlag;
+   uint32_t  Num_Datasets;
+   int  i_arg;
 
-   uint64_t FirstTime;
-   uint16_t Det_of_FirstTime;
+   Stream_type * Streams;
+   Stream_type ** Heap;
+   Stream_type * Stream_ptr;
+   uint32_t  Num_Streams = 0;
+   uint32_t  Heap_Size;
+   uint32_t  i_stream;
 
    uint16_t j_det;
 
-   Processed_TTE_type  Processed_TTE;
+   Same_Time_type  Last_Output [NUM_DET];
+   Same_Time_type * Last_ptr;
+   uint16_t  SpecChan;
+   uint32_t  i_same;
+   _Bool  Duplicate;
 
-   size_t  num_written;
+   uint64_t  Num_Input_Events = 0;
+   uint64_t  Num_Duplicates = 0;
 
-   FILE * Output_File_ptr;
+   Processed_TTE_v2_type  Output_Buffer [OUTPUT_BUFFER_SIZE];
+   size_t  Num_in_Output_Buffer = 0;
+
+   Processed_TTE_File_type  Output_File;
+   uint32_t  Output_Version = 2;
+
+   Result_Cache_type  Cache;
+   char  Version_String [12];
+   char * Checksum_FileName_ptr;
 
 
    // * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -85,112 +186,229 @@ int main ( int argc, char * argv [] ) {
 
    //  Startup Initializations:
 
-   for ( j_det=0;  j_det<NUM_DET;  j_det++ )  Detector_Buffer [j_det] .HaveData = false;
+   for ( i_arg=1;  i_arg < argc;  i_arg++ ) {  // options
+
+      if ( strcmp ( argv [i_arg], "-v1" ) == 0 ) {
+         Output_Version = 1;
+      } else if ( strcmp ( argv [i_arg], "-v3" ) == 0 ) {
+         Output_Version = 3;
+      } else if ( strcmp ( argv [i_arg], "-v4" ) == 0 ) {
+         Output_Version = 4;
+      } else if ( strcmp ( argv [i_arg], "-o" ) == 0  &&  i_arg + 1 < argc ) {
+         i_arg++;
+         Output_FileName_ptr = argv [i_arg];
+      } else {
+         break;
+      }
+
+   }  // options
+
+   if ( i_arg >= argc ) {
+      printf ( "Bad number of command line arguments: %d\n", argc - 1 );
+      printf ( "Example usage:  ./Merge_TTE  [-v1 | -v3 | -v4]  [-o Output.dat]  FileName.sum  [FileName.sum ...]\n" );
+      printf ( "The command-line arguments are the names of the summary files of the datasets to merge,\n" );
+      printf ( "option -v1 outputs the original (version 1) processed TTE format, -v3 the compressed format,\n" );
+      printf ( "-v4 the compressed format with a block directory for selection by time,\n" );
+      printf ( "option -o names the output file (default Processed_TTE.dat).\n" );
+      exit (13);
+   }
+
+   Num_Datasets = (uint32_t) ( argc - i_arg );
+
+   Open_Result_Cache ( "Merge_TTE", &Cache );
+   sprintf ( Version_String, "%u", Output_Version );
+   Add_Cache_Parameter ( &Cache, "output version", Version_String );
+
+   Streams = malloc ( Num_Datasets * NUM_DET * sizeof (Stream_type) );
+   Heap = malloc ( Num_Datasets * NUM_DET * sizeof (Stream_type *) );
+   if ( Streams == NULL  ||  Heap == NULL ) {
+      printf ( "\n\nmalloc of stream buffers failed. exiting.\n" );
+      exit (6);
+   }
+
+
+   //  For each dataset, find out which detectors had TTE data, the names of the files, etc.
+   //  Every detector file opened becomes one input stream.
+
+   for ( ;  i_arg < argc;  i_arg++ ) {  // loop over datasets
+
+      FileName_Length = strlen ( argv [i_arg] );
+      Summary_FileName_ptr = malloc ( FileName_Length + 1 );
+      if ( Summary_FileName_ptr == NULL ) {
+         printf ( "\n\nmalloc to string failed. exiting.\n" );
+         exit (6);
+      }
+      strcpy ( Summary_FileName_ptr, argv [i_arg] );
+      if ( FileName_Length >= 4  &&  strcmp ( Summary_FileName_ptr + FileName_Length - 4, ".dat" ) == 0 )
+         memcpy ( Summary_FileName_ptr + FileName_Length - 4, ".sum", 4 );
+
+      printf ( "\nDataset %u: %s\n", Num_Datasets - (uint32_t) ( argc - i_arg ), Summary_FileName_ptr );
+
+      ReadSummaryFile ( Summary_FileName_ptr, &First_Time_Coarse, &First_Time_Fine, DetectorFiles );
+      Add_Cache_Input ( &Cache, Summary_FileName_ptr );
+
+      for ( j_det=0;  j_det<NUM_DET;  j_det++ ) {
+
+         if ( DetectorFiles [j_det] .DetectorFile_Opened ) {
+
+            Add_Cache_Input ( &Cache, DetectorFiles [j_det] .DetectorFileName_ptr );
+
+            Stream_ptr = &Streams [Num_Streams];
+            Open_Stream ( Stream_ptr, &DetectorFiles [j_det] );
+            Stream_ptr->Detector = j_det;
+            Stream_ptr->Dataset = (uint16_t) ( Num_Datasets - (uint32_t) ( argc - i_arg ) );
+            Stream_ptr->Num_in_Buffer = 0;
+            Stream_ptr->i_Buffer = 0;
+            Num_Streams++;
+
+         }
+
+         free ( DetectorFiles [j_det] .DetectorFileName_ptr );
+
+      }  // j_det
+
+      free ( Summary_FileName_ptr );
 
-   //  Find out which detectors had TTE data, the names of the files, etc.
+   }  // loop over datasets
 
-   ReadSummaryFile ( argc, argv, &First_Time_Coarse, &First_Time_Fine, DetectorFiles );
 
+   if ( Num_Streams == 0 ) {
+      printf ( "\n\n No Detectors have TTE Data -- Aborting !!\n" );
+      exit (5);
+   }
 
-   FirstTime = UINT64_MAX;
-   //printf ( "Test: 0x%16llx\n\n", FirstTime );
 
+   //  Load the first event of every stream and arrange the streams into a heap,
+   //  the stream with the earliest current event at the top:
 
-   Output_File_ptr = fopen ( "Processed_TTE.dat", "w" );
-   if ( Output_File_ptr == NULL ) {
-      printf ( "\n\nFailed to open output TTE File -- Exiting!\n" );
-      exit (1);
+   Heap_Size = 0;
+   for ( i_stream=0;  i_stream < Num_Streams;  i_stream++ ) {
+      if ( Load_Stream ( &Streams [i_stream] ) )  Heap [Heap_Size++] = &Streams [i_stream];
    }
 
+   for ( i_stream = Heap_Size / 2;  i_stream > 0;  i_stream-- )  Sift_Down_Heap ( Heap, Heap_Size, i_stream - 1 );
+
+   for ( j_det=0;  j_det<NUM_DET;  j_det++ )  Last_Output [j_det] .Num = 0;
+
+
+   Checksum_FileName_ptr = malloc ( strlen ( Output_FileName_ptr ) + 5 );
+   if ( Checksum_FileName_ptr == NULL ) {
+      printf ( "\n\nmalloc to string failed. exiting.\n" );
+      exit (6);
+   }
+   sprintf ( Checksum_FileName_ptr, "%s.crc", Output_FileName_ptr );
+
+   Add_Cache_Output ( &Cache, NULL );
+   Add_Cache_Output ( &Cache, Output_FileName_ptr );
+   Add_Cache_Output ( &Cache, Checksum_FileName_ptr );
+
+   if ( Fetch_Cached_Results ( &Cache ) )  return (0);
+
+
+   Open_Processed_TTE_Output ( Output_FileName_ptr, Output_Version, &Output_File );
+
    //  End of Startup Initializations.
 
 
 
-   //  Now process the TTE data, reading TTE events from the 1 to 14 DetectorFiles
-   //  until EOF for all of the DetectorFiles:
+   //  Now process the TTE data: repeatedly take the earliest event from the stream at the
+   //  top of the heap, output it (unless it duplicates an event of another dataset),
+   //  advance that stream and restore the heap -- until every stream is at EOF.
 
-   while ( true ) {  // do "forever" -- process data
+   while ( Heap_Size > 0 ) {  // process data
 
-      //  For any detector with TTE data, if the buffer is empty for that detector,
-      //  read from the file for that detector to fill the buffer entry -- if there
-      //  is still more data in the file.
-      //  (On the first pass, the buffer will be completely empty, and reads will
-      //  be done for all detectors.   On later passes, only a single read will be done,
-      //  to re-fill the entry that was used on the previous pass.)
+      Stream_ptr = Heap [0];
+      j_det = Stream_ptr->Detector;
 
-      Load_Detector_Buffer ( DetectorFiles, Detector_Buffer );
+      Num_Input_Events++;
 
+      Last_ptr = &Last_Output [j_det];
+      SpecChan = Stream_ptr->Buffer [Stream_ptr->i_Buffer] .SpecChannel;
 
+      if ( Last_ptr->Num > 0  &&  Last_ptr->Time_in_OneVariable != Stream_ptr->Time_in_OneVariable )
+         Last_ptr->Num = 0;
 
-      //  Is there any data in the Buffer? -- it could be empty if this routine drained the Buffer
-      //  on the last pass and Load_Detector_Buffer didn't refill any entries in the Buffer
-      //  because all of the input data files are at EOF.
-      //  If we find the Buffer empty, we will exit the program, here in the middle of the
-      //  apparently infinite loop of reading data.
 
-      ContinueFlag = false;
-      for ( j_det=0;  j_det<NUM_DET;  j_det++ ) {
-         if ( Detector_Buffer [j_det] .HaveData )  ContinueFlag = true;
-      }
+      //  Is this a copy of an event already output from an earlier dataset ?
 
-      if ( ! ContinueFlag ) {
-         printf ( "All of the input data has been processed.  Exiting.\n" );
-         return (0);                        // <---   THIS IS THE NORMAL EXIT FROM THIS PROGRAM !!!
-      }
+      Duplicate = false;
 
+      for ( i_same=0;  i_same < Last_ptr->Num;  i_same++ ) {
+         if ( Last_ptr->SpecChannel [i_same] == SpecChan  &&  Last_ptr->Matched_Dataset [i_same] < Stream_ptr->Dataset ) {
+            Last_ptr->Matched_Dataset [i_same] = Stream_ptr->Dataset;
+            Duplicate = true;
+            break;
+         }
+      }
 
 
-      //  Loop through the detectors with data, to determine which entry in the
-      //  buffer has the earliest time.    (Ties are implicitly broken by
-      //  using the smaller detector number -- we only replace the currently
-      //  selected detector if we encounter a smaller time.)
-      //  Having found an entry, output it to the output file.
+      if ( Duplicate ) {  // duplicate ?
 
-      FirstTime = UINT64_MAX;
-      Det_of_FirstTime = UINT16_MAX;
+         Num_Duplicates++;
 
-      for  ( j_det=0;  j_det<NUM_DET;  j_det++ ) {
+      } else {  // duplicate ?
 
-         if ( Detector_Buffer [j_det] .HaveData ) {  // detector has data ?
+         if ( Last_ptr->Num < MAX_SAME_TIME ) {
+            Last_ptr->Time_in_OneVariable = Stream_ptr->Time_in_OneVariable;
+            Last_ptr->SpecChannel [Last_ptr->Num] = SpecChan;
+            Last_ptr->Matched_Dataset [Last_ptr->Num] = Stream_ptr->Dataset;
+            Last_ptr->Num++;
+         }
 
-            if ( Detector_Buffer [j_det] .Time_in_OneVariable < FirstTime ) {
-               FirstTime = Detector_Buffer [j_det] .Time_in_OneVariable;
-               Det_of_FirstTime = j_det;
-            }
+         Output_Buffer [Num_in_Output_Buffer] .Time_in_OneVariable = Stream_ptr->Time_in_OneVariable;
+         Output_Buffer [Num_in_Output_Buffer] .Detector = (uint8_t) j_det;
+         Output_Buffer [Num_in_Output_Buffer] .SpecChannel = (uint8_t) SpecChan;
+         Output_Buffer [Num_in_Output_Buffer] .Flags = 0;
+         Output_Buffer [Num_in_Output_Buffer] .Reserved = 0;
+         Num_in_Output_Buffer++;
 
-         }  // detector has data ?
+         if ( Num_in_Output_Buffer == OUTPUT_BUFFER_SIZE ) {
+            Write_Processed_TTE ( &Output_File, Output_Buffer, Num_in_Output_Buffer );
+            Num_in_Output_Buffer = 0;
+         }
 
-      }  // j_det
+      }  // duplicate ?
 
 
+      //  Advance the stream; at EOF, replace it by the last stream of the heap:
 
-      //  The logic of the program guarantees that there is at least one detector in the buffer,
-      //  and that the above code will always find a detector.   Check..
-      if ( Det_of_FirstTime >= NUM_DET ) {
-         printf ( "\nFailure of program logic.  Detector number %u.  Aborting.\n", Det_of_FirstTime );
-         exit (2);
+      Stream_ptr->i_Buffer++;
+      if ( ! Load_Stream ( Stream_ptr ) ) {
+         Heap_Size--;
+         Heap [0] = Heap [Heap_Size];
       }
 
+      Sift_Down_Heap ( Heap, Heap_Size, 0 );
 
+   }  // process data
 
-      //  Output the detector with the smallest time & mark its entry as consumed:
 
-      Detector_Buffer [Det_of_FirstTime] .HaveData = false;
-      Processed_TTE.Detector = Det_of_FirstTime;
-      Processed_TTE.SpecChannel = Detector_Buffer [Det_of_FirstTime] .SpecChan;
-      //Processed_TTE.Time_in_OneVariable = Detector_Buffer [Det_of_FirstTime] .Time_in_OneVariable;
-      Processed_TTE.CoarseTime = Detector_Buffer [Det_of_FirstTime] .CoarseTime;
-      Processed_TTE.FineTime =  Detector_Buffer [Det_of_FirstTime] .FineTime;
+   Write_Processed_TTE ( &Output_File, Output_Buffer, Num_in_Output_Buffer );
+   Close_Processed_TTE_File ( &Output_File );
+   Write_TTE_Checksums ( Output_FileName_ptr );
 
-      num_written = fwrite ( &Processed_TTE, sizeof ( Processed_TTE ), 1, Output_File_ptr );
-      if ( num_written != 1 ) {
-         printf ( "\nWrite to output file failed !\n" );
-         exit (3);
+   for ( i_stream=0;  i_stream < Num_Streams;  i_stream++ ) {
+      if ( Streams [i_stream] .Compressed_ptr != NULL ) {
+         Close_Processed_TTE_File ( Streams [i_stream] .Compressed_ptr );
+         free ( Streams [i_stream] .Compressed_ptr );
+      } else {
+         fclose ( Streams [i_stream] .File_ptr );
       }
+   }
 
+   printf ( "\n%llu TTE events read from %u detector files of %u datasets.\n",
+            (long long unsigned int) Num_Input_Events, Num_Streams, Num_Datasets );
+   printf ( "%llu duplicate events suppressed.\n", (long long unsigned int) Num_Duplicates );
+   printf ( "%llu TTE events output to %s\n", (long long unsigned int) Output_File.Num_Events, Output_FileName_ptr );
+   printf ( "All of the input data has been processed.  Exiting.\n" );
 
-   }  // do "forever" -- process data
+   Store_Cached_Results ( &Cache );
 
+   free ( Checksum_FileName_ptr );
+   free ( Streams );
+   free ( Heap );
+
+   return (0);
 
 }  // main
 
@@ -201,8 +419,7 @@ int main ( int argc, char * argv [] ) {
 
 void ReadSummaryFile (
 
-   int argc,
-   char * argv [],
+   char * Summary_FileName_ptr,
    uint32_t  * First_Time_Coarse_ptr,
    uint16_t  * First_Time_Fine_ptr,
    DetectorFile_type  DetectorFiles [NUM_DET]
@@ -217,23 +434,16 @@ void ReadSummaryFile (
 
    //  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 
-   if ( argc != 2 ) {
-      printf ( "Bad number of command line arguments: %d\n", argc - 1 );
-      printf ( "Example usage:  ./Merge_TTE  FileName.sum\n" );
-      printf ( "The command-line argument is the name of the file to analyze,\n" );
-      exit (13);
-   }
-
-   FileName_Length = strlen ( argv [1] );
-   if ( strcmp ( argv [1] + FileName_Length - 4, ".sum" )  != 0  ) {
+   FileName_Length = strlen ( Summary_FileName_ptr );
+   if ( FileName_Length < 4  ||  strcmp ( Summary_FileName_ptr + FileName_Length - 4, ".sum" )  != 0  ) {
       printf ( "\nError: the filetype must be .sum !\n" );
       exit (14);
    }
 
 
-   ptr_to_SummaryFile = fopen ( argv [1], "r" );
+   ptr_to_SummaryFile = fopen ( Summary_FileName_ptr, "r" );
    if ( ptr_to_SummaryFile == NULL ) {
-      printf ( "\n\nFailed to open input Summary File '%s' -- Exiting!\n", argv [1] );
+      printf ( "\n\nFailed to open input Summary File '%s' -- Exiting!\n", Summary_FileName_ptr );
       exit (4);
    }
 
@@ -252,10 +462,7 @@ void ReadSummaryFile (
 
    printf ( "\nNumber of Detectors with TTE Data: %u\n", Detector_Output_Cnt );
 
-   if ( Detector_Output_Cnt == 0 ) {
-      printf ( "\n\n No Detectors have TTE Data -- Aborting !!\n" );
-      exit (5);
-   }
+   //  A dataset without TTE data is simply skipped -- main aborts if no dataset has any.
 
 
    //  1) Initialize the structure DetectorFiles,
@@ -340,58 +547,154 @@ void  SkipLines_v2 (
 //   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
 
 
-//  Argument is input and output !
+//  Sets up the stream of a detector file opened by ReadSummaryFile.   The first bytes of
+//  the file tell whether it is compressed: if so, the file is reopened as a processed
+//  TTE file.
 
-void Load_Detector_Buffer (
+void Open_Stream (
 
-   DetectorFile_type  DetectorFiles [NUM_DET],
-   Detector_Buffer_type  Detector_Buffer [NUM_DET]
+   Stream_type * Stream_ptr,
+   const DetectorFile_type * DetectorFile_ptr
 
 ) {
 
-   uint16_t j_det;
-   TTE_Data_type  TTE_Data;
+   char  Magic [sizeof (PROCESSED_TTE_Z_MAGIC)];
 
-   size_t  num_read;
 
+   Stream_ptr->File_ptr = DetectorFile_ptr->ptr_to_DetectorFile;
+   Stream_ptr->Compressed_ptr = NULL;
 
-   //  ***  ***  ***  ***  ***  ***  ***  ***  ***  ***  ***  ***  ***  ***
+   if ( fread ( Magic, sizeof (Magic), 1, Stream_ptr->File_ptr ) == 1  &&
+        memcmp ( Magic, PROCESSED_TTE_Z_MAGIC, sizeof (Magic) ) == 0 ) {  // compressed ?
+
+      fclose ( Stream_ptr->File_ptr );
+      Stream_ptr->File_ptr = NULL;
+
+      Stream_ptr->Compressed_ptr = malloc ( sizeof (Processed_TTE_File_type) );
+      if ( Stream_ptr->Compressed_ptr == NULL ) {
+         printf ( "\n\nmalloc of stream buffers failed. exiting.\n" );
+         exit (6);
+      }
+      Open_Processed_TTE_Input ( DetectorFile_ptr->DetectorFileName_ptr, Stream_ptr->Compressed_ptr );
 
-   for ( j_det=0;  j_det<NUM_DET;  j_det++ ) {
+   } else {  // compressed ?
 
-      //  We need to do a read 1) if this detector has data, i.e., a data file exists for it, and
-      //  2) if the entry in the Buffer for this detector is currently empty:
+      rewind ( Stream_ptr->File_ptr );
 
-      if ( DetectorFiles [j_det] .DetectorFile_Opened  &&  ! Detector_Buffer [j_det] .HaveData ) {  // buffer entry to fill ?
+   }  // compressed ?
 
-         num_read = fread ( &TTE_Data, sizeof (TTE_Data_type), 1, DetectorFiles [j_det] .ptr_to_DetectorFile );
+}  // Open_Stream ()
 
-         if ( num_read != 1 ) {  // successful read ?
 
-            //  We didn't read one item, as requested -- error or EOF -- we will assume EOF.
-            //  All that we do is leave DetectorFiles [j_det] .HaveData as FALSE to inform
-            //  the calling program that we didn't obtain data for this detector.
 
-         } else {  // successful read ?
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
 
-            //  The read was successful, so:
-            //  1) flag that entry now contains data,
-            //  2) transfer data, changing the format of the time:
 
-            Detector_Buffer [j_det] .HaveData = true;
-            Detector_Buffer [j_det] .SpecChan = TTE_Data.SpecChannel;
-            Detector_Buffer [j_det] .CoarseTime = TTE_Data.CoarseTime;
-            Detector_Buffer [j_det] .FineTime = TTE_Data.FineTime;
-            Detector_Buffer [j_det] .Time_in_OneVariable = IntegerTime_from_CoarseFine ( TTE_Data.CoarseTime, TTE_Data.FineTime );
+//  Makes Buffer [i_Buffer] the current event of the stream, refilling the buffer
+//  from the file if it has been used up.   Returns false at EOF (or error --
+//  we will assume EOF, as always).   The argument is input and output !
 
-         }  // successful read ?
+_Bool Load_Stream (
 
+   Stream_type * Stream_ptr
 
-      }  // buffer entry to fill ?
+) {
 
+   static Processed_TTE_v2_type  Decoded [STREAM_BUFFER_SIZE];
+   size_t  i_event;
 
-   }  // j_det
+
+   if ( Stream_ptr->i_Buffer == Stream_ptr->Num_in_Buffer ) {  // buffer used up ?
+
+      if ( Stream_ptr->Compressed_ptr != NULL ) {
+
+         Stream_ptr->Num_in_Buffer = Read_Processed_TTE ( Stream_ptr->Compressed_ptr, Decoded, STREAM_BUFFER_SIZE );
+         for ( i_event=0;  i_event < Stream_ptr->Num_in_Buffer;  i_event++ ) {
+            CoarseFine_from_IntegerTime ( Decoded [i_event] .Time_in_OneVariable,
+                                          &Stream_ptr->Buffer [i_event] .CoarseTime, &Stream_ptr->Buffer [i_event] .FineTime );
+            Stream_ptr->Buffer [i_event] .SpecChannel = Decoded [i_event] .SpecChannel;
+         }
+
+      } else {
+
+         Stream_ptr->Num_in_Buffer = fread ( Stream_ptr->Buffer, sizeof (TTE_Data_type), STREAM_BUFFER_SIZE,
+                                             Stream_ptr->File_ptr );
+
+      }
+
+      Stream_ptr->i_Buffer = 0;
+
+      if ( Stream_ptr->Num_in_Buffer == 0 )  return false;
+
+   }  // buffer used up ?
+
+   Stream_ptr->Time_in_OneVariable = IntegerTime_from_CoarseFine ( Stream_ptr->Buffer [Stream_ptr->i_Buffer] .CoarseTime,
+                                                                   Stream_ptr->Buffer [Stream_ptr->i_Buffer] .FineTime );
+
+   return true;
+
+}  // Load_Stream ()
 
 
-}  // subroutine Load_Detector_Buffer ()
 
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Order of the streams in the heap: by the time of the current event; ties are
+//  broken by the smaller detector number, then by the earlier dataset.
+
+_Bool Stream_Precedes (
+
+   const Stream_type * Stream_A_ptr,
+   const Stream_type * Stream_B_ptr
+
+) {
+
+   if ( Stream_A_ptr->Time_in_OneVariable != Stream_B_ptr->Time_in_OneVariable )
+      return Stream_A_ptr->Time_in_OneVariable < Stream_B_ptr->Time_in_OneVariable;
+
+   if ( Stream_A_ptr->Detector != Stream_B_ptr->Detector )
+      return Stream_A_ptr->Detector < Stream_B_ptr->Detector;
+
+   return Stream_A_ptr->Dataset < Stream_B_ptr->Dataset;
+
+}  // Stream_Precedes ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Standard binary heap: moves the stream at i_node down until it precedes both
+//  of its children.
+
+void Sift_Down_Heap (
+
+   Stream_type * Heap [],
+   uint32_t Heap_Size,
+   uint32_t i_node
+
+) {
+
+   uint32_t  i_child;
+   Stream_type * Temp_ptr;
+
+
+   while ( ( i_child = 2 * i_node + 1 )  <  Heap_Size ) {
+
+      if ( i_child + 1 < Heap_Size  &&  Stream_Precedes ( Heap [i_child + 1], Heap [i_child] ) )  i_child++;
+
+      if ( ! Stream_Precedes ( Heap [i_child], Heap [i_node] ) )  break;
+
+      Temp_ptr = Heap [i_node];
+      Heap [i_node] = Heap [i_child];
+      Heap [i_child] = Temp_ptr;
+
+      i_node = i_child;
+
+   }
+
+}  // Sift_Down_Heap ()
@@ -0,0 +1,132 @@
+//  Outputs the processed TTE events of a time range, optionally of only some detectors.
+
+//  Usage:
+//  ./Query_TTE.exe  [-d Det,Det,...]  [-o OutputFileName]  InputFileName  Begin_MET  End_MET
+
+//  Begin_MET and End_MET are in seconds; events with Begin_MET <= time < End_MET
+//  are selected.   Without -o, the selected events are listed on the screen, one per
+//  line: time (2 microsec ticks), MET (s), detector, channel.   With -o, they are
+//  written to OutputFileName as version 2 processed TTE.
+
+//  The input file may be any version (see Processed_TTE_IO.c), but only for version 4
+//  (Merge_TTE -v4 or Convert_Processed_TTE -v4) does the time to answer a query depend
+//  only on the length of the range and not on the length of the file: the block
+//  directory is searched for the first block of the range, and blocks that contain
+//  no events of the selected detectors are skipped.   The number of blocks read is
+//  listed at the end.
+
+
+#include "HSSDB_Progs_Header.h"
+
+
+#define  QUERY_BUFFER_SIZE   65536U
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+int main ( int argc, char * argv [] ) {
+
+   char * Output_FileName_ptr = NULL;
+   uint32_t  Detector_Mask = ALL_DETECTORS_MASK;
+   unsigned long  Detector;
+   char * Next_ptr;
+   int  i_arg;
+
+   double  Begin_MET;
+   double  End_MET;
+
+   Processed_TTE_File_type  Input_File;
+   Processed_TTE_File_type  Output_File;
+
+   Processed_TTE_v2_type * Events;
+   size_t  num_read;
+   size_t  i_event;
+
+
+   // ********************************************************************************************
+
+
+   for ( i_arg=1;  i_arg < argc - 1;  i_arg += 2 ) {  // options
+
+      if ( strcmp ( argv [i_arg], "-o" ) == 0 ) {
+
+         Output_FileName_ptr = argv [i_arg + 1];
+
+      } else if ( strcmp ( argv [i_arg], "-d" ) == 0 ) {
+
+         Detector_Mask = 0;
+         Next_ptr = argv [i_arg + 1];
+         do {
+            Detector = strtoul ( Next_ptr, &Next_ptr, 10 );
+            if ( Detector >= NUM_DET ) {
+               printf ( "\nError: bad detector number %lu !\n", Detector );
+               return 2;
+            }
+            Detector_Mask |= 1U << Detector;
+         } while ( *Next_ptr++ == ',' );
+
+      } else {
+         break;
+      }
+
+   }  // options
+
+   if ( argc - i_arg != 3 ) {
+      printf ( "Bad command line arguments.\n" );
+      printf ( "Example usage:  ./Query_TTE  [-d 0,3,12]  [-o Selected_TTE.dat]  Processed_TTE.dat  Begin_MET  End_MET\n" );
+      printf ( "Outputs the events with Begin_MET <= time < End_MET (in seconds), of the detectors given by -d\n" );
+      printf ( "(default all), to the screen, or to the file given by -o.\n" );
+      return 1;
+   }
+
+   Begin_MET = strtod ( argv [i_arg + 1], NULL );
+   End_MET = strtod ( argv [i_arg + 2], NULL );
+
+   if ( Begin_MET < 0.0  ||  End_MET <= Begin_MET ) {
+      printf ( "\nError: bad time range %f to %f !\n", Begin_MET, End_MET );
+      return 2;
+   }
+
+   Events = malloc ( QUERY_BUFFER_SIZE * sizeof (Processed_TTE_v2_type) );
+   if ( Events == NULL ) {
+      printf ("\nmalloc call failed.\n");
+      return 3;
+   }
+
+
+   Open_Processed_TTE_Input ( argv [i_arg], &Input_File );
+
+   Select_Processed_TTE ( &Input_File, (uint64_t) ( Begin_MET * TICKS_PER_SECOND + 0.5 ),
+                          (uint64_t) ( End_MET * TICKS_PER_SECOND + 0.5 ), Detector_Mask );
+
+   if ( Output_FileName_ptr != NULL )  Open_Processed_TTE_Output ( Output_FileName_ptr, 2, &Output_File );
+
+   while ( ( num_read = Read_Processed_TTE ( &Input_File, Events, QUERY_BUFFER_SIZE ) )  >  0 ) {
+
+      if ( Output_FileName_ptr != NULL ) {
+         Write_Processed_TTE ( &Output_File, Events, num_read );
+         continue;
+      }
+
+      for ( i_event=0;  i_event < num_read;  i_event++ )
+         printf ( "%20llu  %18.6f  %2u  %3u\n", (long long unsigned int) Events [i_event] .Time_in_OneVariable,
+                  (double) Events [i_event] .Time_in_OneVariable / TICKS_PER_SECOND,
+                  Events [i_event] .Detector, Events [i_event] .SpecChannel );
+
+   }
+
+   if ( Output_FileName_ptr != NULL )  Close_Processed_TTE_File ( &Output_File );
+
+   printf ( "\n%llu events selected from %s", (long long unsigned int) Input_File.Num_Events, argv [i_arg] );
+   if ( Input_File.Version == 4 )
+      printf ( ", %llu of %llu blocks read", (long long unsigned int) Input_File.Num_Blocks_Read,
+               (long long unsigned int) Input_File.Num_Blocks );
+   printf ( ".\n" );
+
+   Close_Processed_TTE_File ( &Input_File );
+   free ( Events );
+
+   return (0);
+
+}  // main ()
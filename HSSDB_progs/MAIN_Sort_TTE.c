@@ -0,0 +1,115 @@
+//  Sorts processed TTE events into time order, in memory.
+
+//  Usage:
+//  ./Sort_TTE.exe  [-t NumThreads]  -o OutputFileName  InputFileName  [InputFileName ...]
+
+//  All events of all of the input files (processed TTE of either version, see
+//  Processed_TTE_IO.c) are read into memory, sorted with Radix_Sort_Processed_TTE
+//  and written to the output file as version 2 processed TTE.   The input events
+//  need not be in any order, e.g., the input can be the concatenated outputs of
+//  several runs.   Events with the same time are ordered by detector number;
+//  otherwise the input order is kept.
+
+
+#include "HSSDB_Progs_Header.h"
+
+
+#define  INITIAL_EVENT_CAPACITY   (1U << 20)
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+int main ( int argc, char * argv [] ) {
+
+   char * Output_FileName_ptr = NULL;
+   uint32_t  Num_Threads;
+   int  i_arg;
+
+   Processed_TTE_File_type  Input_File;
+   Processed_TTE_File_type  Output_File;
+
+   Processed_TTE_v2_type * Events = NULL;
+   Processed_TTE_v2_type * New_Events;
+   size_t  Num_Events = 0;
+   size_t  Event_Capacity = 0;
+   size_t  num_read;
+
+
+   // ********************************************************************************************
+
+
+   Num_Threads = Number_of_Processors ();
+
+   for ( i_arg=1;  i_arg < argc - 1;  i_arg += 2 ) {  // options
+
+      if ( strcmp ( argv [i_arg], "-o" ) == 0 ) {
+         Output_FileName_ptr = argv [i_arg + 1];
+      } else if ( strcmp ( argv [i_arg], "-t" ) == 0 ) {
+         Num_Threads = (uint32_t) strtoul ( argv [i_arg + 1], NULL, 10 );
+      } else {
+         break;
+      }
+
+   }  // options
+
+   if ( Output_FileName_ptr == NULL  ||  i_arg >= argc ) {
+      printf ( "Bad command line arguments.\n" );
+      printf ( "Example usage:  ./Sort_TTE  [-t NumThreads]  -o Sorted_TTE.dat  Run1_TTE.dat  Run2_TTE.dat\n" );
+      return 1;
+   }
+
+
+   //  Read all of the input files:
+
+   for ( ;  i_arg < argc;  i_arg++ ) {  // loop over input files
+
+      if ( strcmp ( argv [i_arg], Output_FileName_ptr ) == 0 ) {
+         printf ( "\nError: the output file is also an input file !\n" );
+         return 2;
+      }
+
+      Open_Processed_TTE_Input ( argv [i_arg], &Input_File );
+
+      do {
+
+         if ( Num_Events == Event_Capacity ) {  // need more space ?
+
+            Event_Capacity = ( Event_Capacity == 0 ) ? INITIAL_EVENT_CAPACITY : 2 * Event_Capacity;
+            New_Events = realloc ( Events, Event_Capacity * sizeof (Processed_TTE_v2_type) );
+            if ( New_Events == NULL ) {
+               printf ( "\n\nOut of memory holding %llu TTE events.  Exiting.\n", (long long unsigned int) Num_Events );
+               return 3;
+            }
+            Events = New_Events;
+
+         }  // need more space ?
+
+         num_read = Read_Processed_TTE ( &Input_File, Events + Num_Events, Event_Capacity - Num_Events );
+         Num_Events += num_read;
+
+      } while ( num_read > 0 );
+
+      printf ( "Read %llu events (version %u) from %s\n",
+               (long long unsigned int) Input_File.Num_Events, Input_File.Version, argv [i_arg] );
+
+      Close_Processed_TTE_File ( &Input_File );
+
+   }  // loop over input files
+
+
+   printf ( "\nSorting %llu TTE events with %u threads ...\n", (long long unsigned int) Num_Events, Num_Threads );
+
+   Radix_Sort_Processed_TTE ( Events, Num_Events, Num_Threads );
+
+   Open_Processed_TTE_Output ( Output_FileName_ptr, 2, &Output_File );
+   Write_Processed_TTE ( &Output_File, Events, Num_Events );
+   Close_Processed_TTE_File ( &Output_File );
+
+   printf ( "Sorted events output to %s\n", Output_FileName_ptr );
+
+   free ( Events );
+
+   return 0;
+
+}  // main ()
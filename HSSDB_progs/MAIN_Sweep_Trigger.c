@@ -0,0 +1,713 @@
+//  Sweep of the parameters of the trigger: the rates of triggers on the events, as a
+//  function of the threshold, for every combination of the energy bands (contiguous
+//  SPEC channel ranges), timescales and offsets of a table, in one run -- the false
+//  alarm curves for the choice of the channel range, timescale and threshold of
+//  Trigger_from_TTE, instead of one run of Trigger_from_TTE for each combination.
+
+//  Usage:
+//  ./Sweep_Trigger.exe  [-t NumThreads]  Sweep_Trigger.txt
+//  reading Processed_TTE.dat.
+
+//  The table of the sweep has lines of a keyword and its values (see Sweep_Trigger.txt):
+//     channels     Edge_0  Edge_1 ... Edge_n     the bands: Edge_i to Edge_j - 1, for all i < j
+//     timescales   Timescale ...                  in 2 microsec ticks, multiples of 8000 (16 ms)
+//     offsets      Num_Offsets                    of each timescale: m * Timescale / Num_Offsets, default 1,
+//                                                 those that are multiples of 16 ms
+//     detectors    Min_Detectors                  the k of k of the 12 NaI detectors, default 2
+//     thresholds   Lowest  Highest  Step          in sigma
+//  blank lines and lines beginning with # are ignored.
+
+//  The events are read once, and binned into a cube of counts: 16 ms bins by the 12 NaI
+//  detectors by the channel segments between the edges.   For each band, the counts of
+//  its segments are summed and then accumulated over the bins, so that the counts of
+//  any range of bins -- a data accumulation of any of the timescales and offsets, or
+//  the background bins of its model -- are the difference of two cumulative sums.   The
+//  accumulations and the background model are those of the trigger engine
+//  (Trigger_Engine.c), with Gaussian significance: the accumulations that have events
+//  are evaluated, except the last, and each is compared with the average of the
+//  1.024 s bins with events that begin no more than 35.5 s and end at least 4.096 s
+//  before it.   The bins begin at the first event of the channels of the sweep, which
+//  for a band whose first event it is, e.g., the band of all of the channels, is the
+//  base time of the band of Trigger_from_TTE, so that the triggers are the same.
+//  Each evaluation finds the k-th largest significance of the detectors, and counts a
+//  trigger for each of the thresholds below it, so that a sweep of the thresholds costs
+//  one evaluation.
+
+//  The bands are divided among the NumThreads threads.
+
+//  If the environment variable HSSDB_CACHE_DIR is set, the report of a sweep of the same
+//  table over the same Processed_TTE.dat is taken from the result cache (see
+//  Result_Cache.c).
+
+
+#include "HSSDB_Progs_Header.h"
+
+#include <pthread.h>
+#include <math.h>
+
+
+#define  SWEEP_BIN_TICKS   8000LLU     /* 16 ms in 2 microsec ticks, the bins of the cube */
+
+#define  BINS_PER_BCKG_BIN   ( ONE_SEC_IN_TICKS / SWEEP_BIN_TICKS )
+
+#define  MAX_SWEEP_TIMESCALES   32U
+#define  MAX_SWEEP_THRESHOLDS   64U
+#define  MAX_SWEEP_THREADS      64U
+
+#define  MAX_TABLE_LINE   1024U
+
+#define  EVENT_BUFFER_SIZE   65536U
+
+
+//  local typedefs:
+
+typedef struct  Sweep_type {
+   uint32_t  Num_Edges;
+   uint32_t  Edges [NUM_SPEC_CHAN + 1];     // the band i, j is the channels Edges [i] to Edges [j] - 1
+   uint32_t  Num_Timescales;
+   uint64_t  Timescales [MAX_SWEEP_TIMESCALES];
+   uint32_t  Num_Offsets;
+   uint32_t  Min_Detectors;
+   uint32_t  Num_Thresholds;
+   double    Thresholds [MAX_SWEEP_THRESHOLDS];     // increasing
+} Sweep_type;
+
+typedef struct  Sweep_Cube_type {
+   uint32_t *  Counts;           // [bin] [detector] [segment]
+   uint32_t  Num_Segments;
+   size_t    Num_Bins;
+   size_t    Capacity;           // in bins
+   uint64_t  BaseTime;           // of bin 0: the first event
+} Sweep_Cube_type;
+
+typedef struct  Sweep_Result_type {     // of a band, timescale and offset
+   uint32_t  Beg_SPEC_Chan;
+   uint32_t  End_SPEC_Chan;
+   uint64_t  Timescale;
+   uint64_t  Offset;
+   uint64_t  Num_Accums;         // evaluated
+   uint64_t  Num_without_Bckg;   // with too few background bins
+   uint64_t  Num_Triggers [MAX_SWEEP_THRESHOLDS];
+} Sweep_Result_type;
+
+typedef struct  Sweep_Thread_type {
+   const Sweep_type *  Sweep_ptr;
+   const Sweep_Cube_type *  Cube_ptr;
+   Sweep_Result_type *  Results;     // of all of the bands
+   uint32_t  Num_per_Band;       // results: timescales and offsets
+   uint32_t  First_Band;         // the bands of the thread: First_Band, + Band_Step, ...
+   uint32_t  Band_Step;
+} Sweep_Thread_type;
+
+
+//  local function prototypes:
+
+static void  Read_Sweep ( const char * FileName, Sweep_type * Sweep_ptr );
+
+static void  Bin_Events ( const Sweep_type * Sweep_ptr, Sweep_Cube_type * Cube_ptr, uint64_t * Num_Events_ptr );
+
+static void * Sweep_Thread ( void * Arg_ptr );
+
+static void  Sum_Band ( const Sweep_Cube_type * Cube_ptr, uint32_t Beg_Segment, uint32_t End_Segment,
+                        uint64_t Cum_Counts [], uint32_t Cum_Good [] );
+
+static void  Sweep_Accumulations ( const Sweep_type * Sweep_ptr, size_t Num_Bins, const uint64_t Cum_Counts [],
+                                   const uint32_t Cum_Good [], Sweep_Result_type * Result_ptr );
+
+static void  Evaluate_Accumulation ( const Sweep_type * Sweep_ptr, size_t Num_Bins, const uint64_t Cum_Counts [],
+                                     const uint32_t Cum_Good [], int64_t Begin, size_t Beg_Bin, size_t End_Bin,
+                                     Sweep_Result_type * Result_ptr );
+
+static void  Report_Sweep ( const Sweep_type * Sweep_ptr, const Sweep_Cube_type * Cube_ptr, uint64_t Num_Events,
+                            uint32_t Num_Results, const Sweep_Result_type Results [] );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+int main ( int argc, char * argv [] ) {
+
+   Sweep_type  Sweep;
+   Sweep_Cube_type  Cube;
+   Sweep_Result_type *  Results;
+   Sweep_Result_type *  Result_ptr;
+   uint32_t  Num_Bands, Num_per_Band, Num_Results;
+   uint32_t  i_edge, j_edge, i_ts, i_off;
+
+   Sweep_Thread_type  Threads [MAX_SWEEP_THREADS];
+   pthread_t  Thread_IDs [MAX_SWEEP_THREADS];
+   uint32_t  Num_Threads = 1;
+   uint32_t  j_thread;
+   int  i_arg = 1;
+
+   uint64_t  Num_Events;
+
+   Result_Cache_type  Cache;
+
+
+   // ********************************************************************************************
+
+
+   if ( argc > 2  &&  strcmp ( argv [1], "-t" ) == 0 ) {
+      Num_Threads = (uint32_t) strtoul ( argv [2], NULL, 10 );
+      i_arg = 3;
+   }
+
+   if ( argc != i_arg + 1  ||  Num_Threads < 1 ) {
+      printf ( "Bad command line arguments.\n" );
+      printf ( "Example usage:  ./Sweep_Trigger.exe  [-t 4]  Sweep_Trigger.txt\n" );
+      printf ( "Outputs the rates of triggers on Processed_TTE.dat versus threshold, for the bands, timescales and\n" );
+      printf ( "offsets of the table; with -t, the bands are divided among that number of threads.\n" );
+      exit (1);
+   }
+
+   if ( Num_Threads > MAX_SWEEP_THREADS )  Num_Threads = MAX_SWEEP_THREADS;
+
+   Read_Sweep ( argv [i_arg], &Sweep );
+
+   Open_Result_Cache ( "Sweep_Trigger", &Cache );
+   Add_Cache_Input ( &Cache, argv [i_arg] );
+   Add_Cache_Input ( &Cache, "Processed_TTE.dat" );
+   Add_Cache_Output ( &Cache, NULL );
+
+   if ( Fetch_Cached_Results ( &Cache ) )  return (0);
+
+
+   //  The configurations, band by band:
+
+   Num_per_Band = 0;
+   for ( i_ts=0;  i_ts < Sweep.Num_Timescales;  i_ts++ )
+      for ( i_off=0;  i_off < Sweep.Num_Offsets;  i_off++ )
+         if ( ( Sweep.Timescales [i_ts] * i_off ) % ( Sweep.Num_Offsets * SWEEP_BIN_TICKS ) == 0 )  Num_per_Band++;
+
+   Num_Bands = Sweep.Num_Edges * ( Sweep.Num_Edges - 1 ) / 2;
+   Num_Results = Num_Bands * Num_per_Band;
+
+   Results = calloc ( Num_Results, sizeof (Sweep_Result_type) );
+   if ( Results == NULL ) {
+      printf ( "\n\nmalloc of the sweep failed. exiting.\n" );
+      exit (181);
+   }
+
+   Result_ptr = Results;
+   for ( i_edge=0;  i_edge < Sweep.Num_Edges;  i_edge++ ) {
+      for ( j_edge=i_edge+1;  j_edge < Sweep.Num_Edges;  j_edge++ ) {
+         for ( i_ts=0;  i_ts < Sweep.Num_Timescales;  i_ts++ ) {
+            for ( i_off=0;  i_off < Sweep.Num_Offsets;  i_off++ ) {
+               if ( ( Sweep.Timescales [i_ts] * i_off ) % ( Sweep.Num_Offsets * SWEEP_BIN_TICKS ) != 0 )  continue;
+               Result_ptr->Beg_SPEC_Chan = Sweep.Edges [i_edge];
+               Result_ptr->End_SPEC_Chan = Sweep.Edges [j_edge] - 1;
+               Result_ptr->Timescale = Sweep.Timescales [i_ts];
+               Result_ptr->Offset = Sweep.Timescales [i_ts] * i_off / Sweep.Num_Offsets;
+               Result_ptr++;
+            }
+         }
+      }
+   }
+
+
+   //  One read of the events, into the cube:
+
+   Bin_Events ( &Sweep, &Cube, &Num_Events );
+
+
+   //  The bands, on the threads:
+
+   for ( j_thread=0;  j_thread < Num_Threads;  j_thread++ ) {
+      Threads [j_thread] .Sweep_ptr = &Sweep;
+      Threads [j_thread] .Cube_ptr = &Cube;
+      Threads [j_thread] .Results = Results;
+      Threads [j_thread] .Num_per_Band = Num_per_Band;
+      Threads [j_thread] .First_Band = j_thread;
+      Threads [j_thread] .Band_Step = Num_Threads;
+   }
+
+   for ( j_thread=1;  j_thread < Num_Threads;  j_thread++ ) {
+      if ( pthread_create ( &Thread_IDs [j_thread], NULL, Sweep_Thread, &Threads [j_thread] ) != 0 ) {
+         printf ( "\n\nFailed to create thread -- Exiting!\n" );
+         exit (183);
+      }
+   }
+
+   Sweep_Thread ( &Threads [0] );
+
+   for ( j_thread=1;  j_thread < Num_Threads;  j_thread++ )  pthread_join ( Thread_IDs [j_thread], NULL );
+
+
+   Report_Sweep ( &Sweep, &Cube, Num_Events, Num_Results, Results );
+
+   free ( Cube.Counts );
+   free ( Results );
+
+   Store_Cached_Results ( &Cache );
+
+   return (0);
+
+}  // main ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Reads the table of the sweep (see above).
+
+static void  Read_Sweep ( const char * FileName, Sweep_type * Sweep_ptr ) {
+
+   FILE *  Table_File_ptr;
+   char  Line [MAX_TABLE_LINE];
+   char  Keyword [16];
+   char *  Next_ptr;
+   char *  End_ptr;
+   uint32_t  Line_Number = 0;
+   unsigned long  Value;
+   long long unsigned int  Timescale;
+   double  Lowest, Highest, Step;
+   uint32_t  i_thr;
+   _Bool  Bad;
+
+
+   Sweep_ptr->Num_Edges = 0;
+   Sweep_ptr->Num_Timescales = 0;
+   Sweep_ptr->Num_Offsets = 1;
+   Sweep_ptr->Min_Detectors = 2;
+   Sweep_ptr->Num_Thresholds = 0;
+
+   Table_File_ptr = fopen ( FileName, "r" );
+   if ( Table_File_ptr == NULL ) {
+      printf ( "\n\nFailed to open the table of the sweep '%s' -- Exiting!\n", FileName );
+      exit (180);
+   }
+
+   while ( fgets ( Line, sizeof (Line), Table_File_ptr ) != NULL ) {  // loop over lines
+
+      Line_Number++;
+
+      if ( sscanf ( Line, "%15s", Keyword ) != 1  ||  Keyword [0] == '#' )  continue;   // blank or comment
+
+      Next_ptr = strstr ( Line, Keyword ) + strlen ( Keyword );
+      Bad = false;
+
+      if ( strcmp ( Keyword, "channels" ) == 0 ) {  // keyword ?
+
+         Sweep_ptr->Num_Edges = 0;
+         while ( ( Value = strtoul ( Next_ptr, &End_ptr, 10 ) ), End_ptr != Next_ptr ) {
+            if ( Value > NUM_SPEC_CHAN  ||  Sweep_ptr->Num_Edges > NUM_SPEC_CHAN  ||
+                 ( Sweep_ptr->Num_Edges > 0  &&  Value <= Sweep_ptr->Edges [Sweep_ptr->Num_Edges - 1] ) )  Bad = true;
+            if ( ! Bad )  Sweep_ptr->Edges [Sweep_ptr->Num_Edges++] = (uint32_t) Value;
+            Next_ptr = End_ptr;
+         }
+         if ( Sweep_ptr->Num_Edges < 2 )  Bad = true;
+
+      } else if ( strcmp ( Keyword, "timescales" ) == 0 ) {  // keyword ?
+
+         Sweep_ptr->Num_Timescales = 0;
+         while ( ( Timescale = strtoull ( Next_ptr, &End_ptr, 10 ) ), End_ptr != Next_ptr ) {
+            if ( Timescale == 0  ||  Timescale % SWEEP_BIN_TICKS != 0  ||  Sweep_ptr->Num_Timescales == MAX_SWEEP_TIMESCALES )  Bad = true;
+            if ( ! Bad )  Sweep_ptr->Timescales [Sweep_ptr->Num_Timescales++] = Timescale;
+            Next_ptr = End_ptr;
+         }
+         if ( Sweep_ptr->Num_Timescales == 0 )  Bad = true;
+
+      } else if ( strcmp ( Keyword, "offsets" ) == 0 ) {  // keyword ?
+
+         if ( sscanf ( Next_ptr, "%u", &Sweep_ptr->Num_Offsets ) != 1  ||  Sweep_ptr->Num_Offsets < 1 )  Bad = true;
+
+      } else if ( strcmp ( Keyword, "detectors" ) == 0 ) {  // keyword ?
+
+         if ( sscanf ( Next_ptr, "%u", &Sweep_ptr->Min_Detectors ) != 1  ||
+              Sweep_ptr->Min_Detectors < 1  ||  Sweep_ptr->Min_Detectors > NUM_NAI_DET )  Bad = true;
+
+      } else if ( strcmp ( Keyword, "thresholds" ) == 0 ) {  // keyword ?
+
+         if ( sscanf ( Next_ptr, "%lf %lf %lf", &Lowest, &Highest, &Step ) != 3  ||  ! ( Lowest > 0 )  ||  ! ( Highest >= Lowest )  ||
+              ! ( Step > 0 )  ||  ( Highest - Lowest ) / Step + 1.5 > MAX_SWEEP_THRESHOLDS ) {
+            Bad = true;
+         } else {
+            Sweep_ptr->Num_Thresholds = (uint32_t) ( ( Highest - Lowest ) / Step + 1.5 );
+            for ( i_thr=0;  i_thr < Sweep_ptr->Num_Thresholds;  i_thr++ )  Sweep_ptr->Thresholds [i_thr] = Lowest + i_thr * Step;
+         }
+
+      } else {  // keyword ?
+
+         Bad = true;
+
+      }  // keyword ?
+
+      if ( Bad ) {
+         printf ( "\n\nBad line %u of the table of the sweep '%s':\n%s\n", Line_Number, FileName, Line );
+         printf ( "Expected: channels  Edge_0 ... Edge_n      (increasing, 0 to %u)\n", NUM_SPEC_CHAN );
+         printf ( "          timescales  Timescale ...        (ticks, multiples of %llu, at most %u)\n",
+                  SWEEP_BIN_TICKS, MAX_SWEEP_TIMESCALES );
+         printf ( "          offsets  Num_Offsets\n" );
+         printf ( "          detectors  Min_Detectors         (1 to %u)\n", NUM_NAI_DET );
+         printf ( "          thresholds  Lowest  Highest  Step  (sigma, above 0, at most %u) -- Exiting!\n", MAX_SWEEP_THRESHOLDS );
+         exit (180);
+      }
+
+   }  // loop over lines
+
+   fclose ( Table_File_ptr );
+
+   if ( Sweep_ptr->Num_Edges == 0  ||  Sweep_ptr->Num_Timescales == 0  ||  Sweep_ptr->Num_Thresholds == 0 ) {
+      printf ( "\n\nThe table of the sweep '%s' needs the channels, timescales and thresholds -- Exiting!\n", FileName );
+      exit (180);
+   }
+
+}  // Read_Sweep ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Reads the events of the NaI detectors in the channels of the sweep, and counts them
+//  in the cube, by 16 ms bin, detector and segment.
+
+static void  Bin_Events ( const Sweep_type * Sweep_ptr, Sweep_Cube_type * Cube_ptr, uint64_t * Num_Events_ptr ) {
+
+   TTE_Event_Reader_type  Reader;
+   const Processed_TTE_v2_type *  Event_Buffer = NULL;
+   size_t  Num_in_Buffer;
+   size_t  i_event;
+   size_t  Bin, New_Capacity;
+
+   uint32_t  Segment_of_Channel [NUM_SPEC_CHAN];
+   uint32_t  i_seg, i_chan;
+   uint64_t  Num_Binned = 0;
+
+
+   Cube_ptr->Num_Segments = Sweep_ptr->Num_Edges - 1;
+   Cube_ptr->Num_Bins = 0;
+   Cube_ptr->Capacity = 0;
+   Cube_ptr->Counts = NULL;
+   Cube_ptr->BaseTime = 0;
+
+   for ( i_seg=0;  i_seg < Cube_ptr->Num_Segments;  i_seg++ )
+      for ( i_chan=Sweep_ptr->Edges [i_seg];  i_chan < Sweep_ptr->Edges [i_seg + 1];  i_chan++ )  Segment_of_Channel [i_chan] = i_seg;
+
+   Open_TTE_Event_Reader ( "Processed_TTE.dat", EVENT_BUFFER_SIZE, &Reader );
+   Select_TTE_Events ( &Reader, 0, UINT64_MAX, ( 1U << NUM_NAI_DET ) - 1U,
+                       Sweep_ptr->Edges [0], Sweep_ptr->Edges [Sweep_ptr->Num_Edges - 1] - 1 );
+
+   while ( ( Num_in_Buffer = Next_TTE_Event_Batch ( &Reader, &Event_Buffer ) ) > 0 ) {  // loop over batches
+
+      if ( Num_Binned == 0 )  Cube_ptr->BaseTime = Event_Buffer [0] .Time_in_OneVariable;
+
+      for ( i_event=0;  i_event < Num_in_Buffer;  i_event++ ) {  // loop over events
+
+         Bin = (size_t) ( ( Event_Buffer [i_event] .Time_in_OneVariable - Cube_ptr->BaseTime ) / SWEEP_BIN_TICKS );
+
+         if ( Bin >= Cube_ptr->Capacity ) {
+            New_Capacity = 2 * Bin + 4096;
+            Cube_ptr->Counts = realloc ( Cube_ptr->Counts, New_Capacity * NUM_NAI_DET * Cube_ptr->Num_Segments * sizeof (uint32_t) );
+            if ( Cube_ptr->Counts == NULL ) {
+               printf ( "\n\nmalloc of the cube of counts failed. exiting.\n" );
+               exit (181);
+            }
+            memset ( Cube_ptr->Counts + Cube_ptr->Capacity * NUM_NAI_DET * Cube_ptr->Num_Segments, 0,
+                     ( New_Capacity - Cube_ptr->Capacity ) * NUM_NAI_DET * Cube_ptr->Num_Segments * sizeof (uint32_t) );
+            Cube_ptr->Capacity = New_Capacity;
+         }
+
+         Cube_ptr->Counts [ ( Bin * NUM_NAI_DET + Event_Buffer [i_event] .Detector ) * Cube_ptr->Num_Segments
+                            + Segment_of_Channel [Event_Buffer [i_event] .SpecChannel] ] ++;
+
+         if ( Bin >= Cube_ptr->Num_Bins )  Cube_ptr->Num_Bins = Bin + 1;
+
+      }  // loop over events
+
+      Num_Binned += Num_in_Buffer;
+
+   }  // loop over batches
+
+   Close_TTE_Event_Reader ( &Reader );
+
+   if ( Num_Binned == 0 ) {
+      printf ( "\n\nNo events of the NaI detectors in the channels of the sweep -- Exiting!\n" );
+      exit (182);
+   }
+
+   *Num_Events_ptr = Num_Binned;
+
+}  // Bin_Events ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The bands of a thread: for each, the cumulative counts, and all of its timescales and
+//  offsets.
+
+static void * Sweep_Thread ( void * Arg_ptr ) {
+
+   const Sweep_Thread_type *  Thread_ptr = Arg_ptr;
+   const Sweep_type *  Sweep_ptr = Thread_ptr->Sweep_ptr;
+   const Sweep_Cube_type *  Cube_ptr = Thread_ptr->Cube_ptr;
+   Sweep_Result_type *  Result_ptr;
+
+   uint64_t *  Cum_Counts;
+   uint32_t *  Cum_Good;
+   uint32_t  Num_Bands;
+   uint32_t  i_band, i_edge, j_edge;
+   uint32_t  i_config;
+
+
+   Cum_Counts = malloc ( ( Cube_ptr->Num_Bins + 1 ) * NUM_NAI_DET * sizeof (uint64_t) );
+   Cum_Good = malloc ( ( Cube_ptr->Num_Bins / BINS_PER_BCKG_BIN + 2 ) * sizeof (uint32_t) );
+   if ( Cum_Counts == NULL  ||  Cum_Good == NULL ) {
+      printf ( "\n\nmalloc of the sweep failed. exiting.\n" );
+      exit (181);
+   }
+
+   Num_Bands = Sweep_ptr->Num_Edges * ( Sweep_ptr->Num_Edges - 1 ) / 2;
+   for ( i_band=Thread_ptr->First_Band;  i_band < Num_Bands;  i_band += Thread_ptr->Band_Step ) {  // loop over bands
+
+      //  The edges of band i_band, in the order of main:
+
+      i_edge = 0;
+      j_edge = i_band + 1;
+      while ( j_edge >= Sweep_ptr->Num_Edges ) {
+         j_edge -= Sweep_ptr->Num_Edges - i_edge - 2;
+         i_edge++;
+      }
+
+      Sum_Band ( Cube_ptr, i_edge, j_edge, Cum_Counts, Cum_Good );
+
+      Result_ptr = &Thread_ptr->Results [i_band * Thread_ptr->Num_per_Band];
+      for ( i_config=0;  i_config < Thread_ptr->Num_per_Band;  i_config++ )
+         Sweep_Accumulations ( Sweep_ptr, Cube_ptr->Num_Bins, Cum_Counts, Cum_Good, &Result_ptr [i_config] );
+
+   }  // loop over bands
+
+   free ( Cum_Counts );
+   free ( Cum_Good );
+
+   return NULL;
+
+}  // Sweep_Thread ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The counts of the band of the segments Beg_Segment to End_Segment - 1, cumulative over
+//  the bins: Cum_Counts [bin * NUM_NAI_DET + j_det] are the counts of detector j_det in
+//  the bins before bin; and the number of the 1.024 s background bins with counts before
+//  each, Cum_Good.
+
+static void  Sum_Band ( const Sweep_Cube_type * Cube_ptr, uint32_t Beg_Segment, uint32_t End_Segment,
+                        uint64_t Cum_Counts [], uint32_t Cum_Good [] ) {
+
+   const uint32_t *  Counts;
+   uint64_t *  Cum_ptr;
+   uint64_t  Sum;
+   size_t  Bin, Bckg_Bin;
+   uint32_t  j_det, i_seg;
+   _Bool  Bckg_has_Counts = false;
+
+
+   for ( j_det=0;  j_det<NUM_NAI_DET;  j_det++ )  Cum_Counts [j_det] = 0;
+   Cum_Good [0] = 0;
+
+   for ( Bin=0;  Bin < Cube_ptr->Num_Bins;  Bin++ ) {  // loop over bins
+
+      Counts = &Cube_ptr->Counts [Bin * NUM_NAI_DET * Cube_ptr->Num_Segments];
+      Cum_ptr = &Cum_Counts [Bin * NUM_NAI_DET];
+
+      for ( j_det=0;  j_det<NUM_NAI_DET;  j_det++ ) {
+         Sum = 0;
+         for ( i_seg=Beg_Segment;  i_seg < End_Segment;  i_seg++ )  Sum += Counts [j_det * Cube_ptr->Num_Segments + i_seg];
+         Cum_ptr [NUM_NAI_DET + j_det] = Cum_ptr [j_det] + Sum;
+         if ( Sum > 0 )  Bckg_has_Counts = true;
+      }
+
+      //  At the end of each background bin, or of the last bin:
+
+      if ( ( Bin + 1 ) % BINS_PER_BCKG_BIN == 0  ||  Bin + 1 == Cube_ptr->Num_Bins ) {
+         Bckg_Bin = Bin / BINS_PER_BCKG_BIN;
+         Cum_Good [Bckg_Bin + 1] = Cum_Good [Bckg_Bin] + Bckg_has_Counts;
+         Bckg_has_Counts = false;
+      }
+
+   }  // loop over bins
+
+}  // Sum_Band ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The data accumulations of a timescale and offset of a band, as Trigger_Engine_Events:
+//  those with counts, each evaluated when the next with counts begins, so not the last.
+
+static void  Sweep_Accumulations ( const Sweep_type * Sweep_ptr, size_t Num_Bins, const uint64_t Cum_Counts [],
+                                   const uint32_t Cum_Good [], Sweep_Result_type * Result_ptr ) {
+
+   const uint64_t  Timescale = Result_ptr->Timescale;
+   const uint64_t  Phase = ( Timescale - Result_ptr->Offset ) % Timescale;
+   const int64_t  Bins_per_Accum = (int64_t) ( Timescale / SWEEP_BIN_TICKS );
+   const int64_t  Phase_Bins = (int64_t) ( Phase / SWEEP_BIN_TICKS );
+
+   int64_t  BinNum;
+   int64_t  Beg_Bin, End_Bin;
+   int64_t  Pending_BinNum = -1;
+   size_t  Pending_Beg = 0, Pending_End = 0;
+   uint64_t  Total;
+   uint32_t  j_det;
+
+
+   //  The accumulation BinNum is the bins of the band BinNum * Timescale - Phase and
+   //  after, the first beginning before the base time:
+
+   for ( BinNum=0;  BinNum * Bins_per_Accum - Phase_Bins < (int64_t) Num_Bins;  BinNum++ ) {  // loop over accumulations
+
+      Beg_Bin = BinNum * Bins_per_Accum - Phase_Bins;
+      End_Bin = Beg_Bin + Bins_per_Accum;
+      if ( Beg_Bin < 0 )  Beg_Bin = 0;
+      if ( End_Bin > (int64_t) Num_Bins )  End_Bin = (int64_t) Num_Bins;
+
+      Total = 0;
+      for ( j_det=0;  j_det<NUM_NAI_DET;  j_det++ )
+         Total += Cum_Counts [End_Bin * NUM_NAI_DET + j_det] - Cum_Counts [Beg_Bin * NUM_NAI_DET + j_det];
+
+      if ( Total == 0 )  continue;
+
+      if ( Pending_BinNum >= 0 )
+         Evaluate_Accumulation ( Sweep_ptr, Num_Bins, Cum_Counts, Cum_Good, Pending_BinNum * (int64_t) Timescale - (int64_t) Phase,
+                                 Pending_Beg, Pending_End, Result_ptr );
+
+      Pending_BinNum = BinNum;
+      Pending_Beg = (size_t) Beg_Bin;
+      Pending_End = (size_t) End_Bin;
+
+   }  // loop over accumulations
+
+}  // Sweep_Accumulations ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Compares the data accumulation of the bins Beg_Bin to End_Bin - 1, beginning at Begin
+//  ticks after the base time, with the background model, as Evaluate_Data_Accum, and
+//  counts a trigger for each threshold below the k-th largest significance.
+
+static void  Evaluate_Accumulation ( const Sweep_type * Sweep_ptr, size_t Num_Bins, const uint64_t Cum_Counts [],
+                                     const uint32_t Cum_Good [], int64_t Begin, size_t Beg_Bin, size_t End_Bin,
+                                     Sweep_Result_type * Result_ptr ) {
+
+   const double  Factor = (double) Result_ptr->Timescale / (double) ONE_SEC_IN_TICKS;
+
+   int64_t  Lo, Hi;
+   size_t  Bckg_Beg_Bin, Bckg_End_Bin;
+   uint32_t  Num_Good_Bckg_Bins;
+
+   double  Data, Bckg, Model, Expected, Sig;
+   double  Largest [NUM_NAI_DET];     // the positive significances, decreasing
+   uint32_t  Num_Positive = 0;
+   uint32_t  j_det, i_pos, i_thr;
+
+
+   //  The background bins of the model, those of Trigger_from_TTE:
+
+   Trigger_Background_Bins ( Begin, &Lo, &Hi );
+
+   Num_Good_Bckg_Bins = ( Hi < Lo )  ?  0  :  Cum_Good [Hi + 1] - Cum_Good [Lo];
+
+   if ( Num_Good_Bckg_Bins < MIN_REQ_GOOD_BCKG_BINS ) {
+      Result_ptr->Num_without_Bckg++;
+      return;
+   }
+
+   Result_ptr->Num_Accums++;
+
+   Bckg_Beg_Bin = (size_t) Lo * BINS_PER_BCKG_BIN;
+   Bckg_End_Bin = (size_t) ( Hi + 1 ) * BINS_PER_BCKG_BIN;
+   if ( Bckg_End_Bin > Num_Bins )  Bckg_End_Bin = Num_Bins;
+
+
+   //  The significances, as Significance_of_Data_Accum, the positive ones in decreasing
+   //  order:
+
+   for ( j_det=0;  j_det<NUM_NAI_DET;  j_det++ ) {
+
+      Data = (double) ( Cum_Counts [End_Bin * NUM_NAI_DET + j_det] - Cum_Counts [Beg_Bin * NUM_NAI_DET + j_det] );
+      Bckg = (double) ( Cum_Counts [Bckg_End_Bin * NUM_NAI_DET + j_det] - Cum_Counts [Bckg_Beg_Bin * NUM_NAI_DET + j_det] );
+
+      Model = Bckg / (double) Num_Good_Bckg_Bins;
+      Expected = Factor * Model;
+      Sig = ( Data - Expected ) / sqrt ( Expected );
+
+      if ( ! ( Sig > 0 ) )  continue;
+
+      for ( i_pos=Num_Positive;  i_pos > 0  &&  Largest [i_pos - 1] < Sig;  i_pos-- )  Largest [i_pos] = Largest [i_pos - 1];
+      Largest [i_pos] = Sig;
+      Num_Positive++;
+
+   }  // j_det
+
+   //  A positive deviation in k detectors is a trigger for the thresholds below the k-th
+   //  largest:
+
+   if ( Num_Positive < Sweep_ptr->Min_Detectors )  return;
+
+   Sig = Largest [Sweep_ptr->Min_Detectors - 1];
+
+   for ( i_thr=0;  i_thr < Sweep_ptr->Num_Thresholds  &&  Sig > Sweep_ptr->Thresholds [i_thr];  i_thr++ )
+      Result_ptr->Num_Triggers [i_thr] ++;
+
+}  // Evaluate_Accumulation ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The rates of triggers, per hour of the evaluated accumulations, of each band,
+//  timescale and offset, versus threshold.
+
+static void  Report_Sweep ( const Sweep_type * Sweep_ptr, const Sweep_Cube_type * Cube_ptr, uint64_t Num_Events,
+                            uint32_t Num_Results, const Sweep_Result_type Results [] ) {
+
+   const Sweep_Result_type *  Result_ptr;
+   double  Hours;
+   uint32_t  i_result, i_thr;
+
+
+   printf ( "\nSweep of %u trigger configurations over %llu events of the NaI detectors, %.3f s, SPEC channels %u to %u:\n",
+            Num_Results, (long long unsigned int) Num_Events, Cube_ptr->Num_Bins * SWEEP_BIN_TICKS * 2.0E-6,
+            Sweep_ptr->Edges [0], Sweep_ptr->Edges [Sweep_ptr->Num_Edges - 1] - 1 );
+   printf ( "rates of triggers (%u of %u NaI detectors above the threshold), per hour of the evaluated accumulations.\n",
+            Sweep_ptr->Min_Detectors, NUM_NAI_DET );
+
+   printf ( "\n SPEC chan    timescale       offset     accums  no bckg |  threshold in sigma:\n" );
+   printf ( "                                                         |" );
+   for ( i_thr=0;  i_thr < Sweep_ptr->Num_Thresholds;  i_thr++ )  printf ( " %9.2f", Sweep_ptr->Thresholds [i_thr] );
+   printf ( "\n" );
+
+   for ( i_result=0;  i_result < Num_Results;  i_result++ ) {  // loop over configurations
+
+      Result_ptr = &Results [i_result];
+
+      printf ( "%3u %3u %12llu %12llu %10llu %8llu |", Result_ptr->Beg_SPEC_Chan, Result_ptr->End_SPEC_Chan,
+               (long long unsigned int) Result_ptr->Timescale, (long long unsigned int) Result_ptr->Offset,
+               (long long unsigned int) Result_ptr->Num_Accums, (long long unsigned int) Result_ptr->Num_without_Bckg );
+
+      Hours = Result_ptr->Num_Accums * ( Result_ptr->Timescale * 2.0E-6 ) / 3600.0;
+
+      for ( i_thr=0;  i_thr < Sweep_ptr->Num_Thresholds;  i_thr++ ) {
+         if ( Hours > 0 )
+            printf ( " %9.4g", Result_ptr->Num_Triggers [i_thr] / Hours );
+         else
+            printf ( " %9s", "-" );
+      }
+      printf ( "\n" );
+
+   }  // loop over configurations
+
+}  // Report_Sweep ()
@@ -0,0 +1,253 @@
+//  Verifies files against their block checksums, FileName.crc -- see TTE_Checksum.c.
+
+//  Usage:
+//  ./Verify_TTE.exe  [-t NumThreads]  [-w]  FileName  [FileName ...]
+
+//  Each file is mapped into memory and its blocks are divided among the threads
+//  (default: the number of processors), each checking a contiguous range of blocks,
+//  so that a large archive is checked at the speed of reading it.   The damaged
+//  blocks are listed with their byte ranges.   With -w, the checksum files are
+//  written instead, e.g., for files output before there were checksums.
+
+//  Exit status: 0 if all of the files are good, 2 if any is damaged or lacks its
+//  checksums.
+
+
+#define  _POSIX_C_SOURCE  200809L
+
+#include "HSSDB_Progs_Header.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+
+#define  MAX_VERIFY_THREADS   64U
+
+
+//  local typedefs:
+
+typedef struct  Verify_Thread_type {
+   const unsigned char *  Map;
+   uint64_t  File_Bytes;
+   uint32_t  Block_Bytes;
+   uint64_t  First_Block;        // the range of blocks to check
+   uint64_t  End_Block;
+   uint32_t *  Computed;         // the checksums of all blocks, this thread's range filled
+} Verify_Thread_type;
+
+
+//  local function prototypes:
+
+static void * Verify_Thread ( void * Arg_ptr );
+
+static _Bool  Verify_File ( const char * FileName, uint32_t Num_Threads );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+int main ( int argc, char * argv [] ) {
+
+   uint32_t  Num_Threads;
+   _Bool  Write_Mode = false;
+   _Bool  All_Good = true;
+   int  i_arg;
+
+
+   // ********************************************************************************************
+
+
+   Num_Threads = Number_of_Processors ();
+
+   for ( i_arg=1;  i_arg < argc;  i_arg++ ) {  // options
+
+      if ( strcmp ( argv [i_arg], "-t" ) == 0  &&  i_arg + 1 < argc ) {
+         Num_Threads = (uint32_t) strtoul ( argv [++i_arg], NULL, 10 );
+      } else if ( strcmp ( argv [i_arg], "-w" ) == 0 ) {
+         Write_Mode = true;
+      } else {
+         break;
+      }
+
+   }  // options
+
+   if ( i_arg >= argc  ||  Num_Threads < 1 ) {
+      printf ( "Bad command line arguments.\n" );
+      printf ( "Example usage:  ./Verify_TTE.exe  [-t 4]  [-w]  Processed_TTE.dat  [...]\n" );
+      printf ( "Checks each file against its block checksums, FileName.crc, listing any damaged blocks;\n" );
+      printf ( "with -w, writes the checksum files instead.\n" );
+      return 1;
+   }
+
+   if ( Num_Threads > MAX_VERIFY_THREADS )  Num_Threads = MAX_VERIFY_THREADS;
+
+
+   for ( ;  i_arg < argc;  i_arg++ ) {  // loop over files
+
+      if ( Write_Mode ) {
+         Write_TTE_Checksums ( argv [i_arg] );
+         printf ( "%s: checksums written\n", argv [i_arg] );
+      } else {
+         if ( ! Verify_File ( argv [i_arg], Num_Threads ) )  All_Good = false;
+      }
+
+   }  // loop over files
+
+   if ( ! All_Good ) {
+      printf ( "\nDAMAGED OR UNVERIFIED FILES -- see above.\n" );
+      return 2;
+   }
+
+   return 0;
+
+}  // main ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Checks one file; returns true if it is good.
+
+static _Bool  Verify_File ( const char * FileName, uint32_t Num_Threads ) {
+
+   TTE_Checksum_Header_type  Header;
+   uint32_t *  Checksums;
+   uint32_t *  Computed;
+
+   int  fd;
+   struct stat  File_Status;
+   const unsigned char *  Map = NULL;
+   void *  Map_ptr;
+
+   pthread_t  Threads [MAX_VERIFY_THREADS];
+   Verify_Thread_type  Thread_Args [MAX_VERIFY_THREADS];
+   uint32_t  j_thread;
+
+   uint64_t  i_block;
+   uint64_t  Num_Bad = 0;
+   uint64_t  Block_End;
+
+
+   if ( ! Read_TTE_Checksums ( FileName, &Header, &Checksums ) )  return false;
+
+   fd = open ( FileName, O_RDONLY );
+   if ( fd < 0  ||  fstat ( fd, &File_Status ) != 0 ) {
+      printf ( "%s: failed to open\n", FileName );
+      free ( Checksums );
+      return false;
+   }
+
+   if ( (uint64_t) File_Status.st_size != Header.File_Bytes ) {
+      printf ( "%s: DAMAGED: %llu bytes, should be %llu\n", FileName,
+               (long long unsigned int) File_Status.st_size, (long long unsigned int) Header.File_Bytes );
+      close ( fd );
+      free ( Checksums );
+      return false;
+   }
+
+   if ( Header.File_Bytes > 0 ) {
+      Map_ptr = mmap ( NULL, (size_t) Header.File_Bytes, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( Map_ptr == MAP_FAILED ) {
+         printf ( "%s: failed to map into memory\n", FileName );
+         close ( fd );
+         free ( Checksums );
+         return false;
+      }
+      posix_madvise ( Map_ptr, (size_t) Header.File_Bytes, POSIX_MADV_SEQUENTIAL );
+      Map = Map_ptr;
+   }
+
+   close ( fd );
+
+   Computed = malloc ( ( Header.Num_Blocks + 1 ) * sizeof (uint32_t) );
+   if ( Computed == NULL ) {
+      printf ( "\n\nmalloc of checksums failed. exiting.\n" );
+      exit (131);
+   }
+
+
+   //  Each thread checks a contiguous range of blocks:
+
+   if ( Num_Threads > Header.Num_Blocks )  Num_Threads = ( Header.Num_Blocks > 0 )  ?  (uint32_t) Header.Num_Blocks  :  1;
+
+   CRC32C ( Computed, 0 );   // sets up CRC32C before the threads call it
+
+   for ( j_thread=0;  j_thread < Num_Threads;  j_thread++ ) {
+      Thread_Args [j_thread] .Map = Map;
+      Thread_Args [j_thread] .File_Bytes = Header.File_Bytes;
+      Thread_Args [j_thread] .Block_Bytes = Header.Block_Bytes;
+      Thread_Args [j_thread] .First_Block = Header.Num_Blocks * j_thread / Num_Threads;
+      Thread_Args [j_thread] .End_Block = Header.Num_Blocks * ( j_thread + 1 ) / Num_Threads;
+      Thread_Args [j_thread] .Computed = Computed;
+   }
+
+   for ( j_thread=1;  j_thread < Num_Threads;  j_thread++ ) {
+      if ( pthread_create ( &Threads [j_thread], NULL, Verify_Thread, &Thread_Args [j_thread] ) != 0 ) {
+         printf ( "\n\nFailed to create thread -- Exiting!\n" );
+         exit (133);
+      }
+   }
+
+   Verify_Thread ( &Thread_Args [0] );
+
+   for ( j_thread=1;  j_thread < Num_Threads;  j_thread++ )  pthread_join ( Threads [j_thread], NULL );
+
+   if ( Map != NULL )  munmap ( (void *) (uintptr_t) Map, (size_t) Header.File_Bytes );
+
+
+   for ( i_block=0;  i_block < Header.Num_Blocks;  i_block++ ) {  // report
+
+      if ( Computed [i_block] != Checksums [i_block] ) {
+         Block_End = ( i_block + 1 ) * Header.Block_Bytes;
+         if ( Block_End > Header.File_Bytes )  Block_End = Header.File_Bytes;
+         printf ( "%s: DAMAGED block %llu, bytes %llu to %llu: CRC32C %08X, should be %08X\n", FileName,
+                  (long long unsigned int) i_block, (long long unsigned int) ( i_block * Header.Block_Bytes ),
+                  (long long unsigned int) ( Block_End - 1 ), Computed [i_block], Checksums [i_block] );
+         Num_Bad++;
+      }
+
+   }  // report
+
+   if ( Num_Bad == 0 )
+      printf ( "%s: OK, %llu blocks\n", FileName, (long long unsigned int) Header.Num_Blocks );
+   else
+      printf ( "%s: DAMAGED, %llu of %llu blocks\n", FileName, (long long unsigned int) Num_Bad, (long long unsigned int) Header.Num_Blocks );
+
+   free ( Computed );
+   free ( Checksums );
+
+   return ( Num_Bad == 0 );
+
+}  // Verify_File ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void * Verify_Thread ( void * Arg_ptr ) {
+
+   Verify_Thread_type * Thread_ptr = Arg_ptr;
+
+   uint64_t  i_block;
+   uint64_t  Offset;
+   size_t  Block_Bytes;
+
+
+   for ( i_block = Thread_ptr->First_Block;  i_block < Thread_ptr->End_Block;  i_block++ ) {
+
+      Offset = i_block * Thread_ptr->Block_Bytes;
+      Block_Bytes = Thread_ptr->Block_Bytes;
+      if ( Block_Bytes > Thread_ptr->File_Bytes - Offset )  Block_Bytes = (size_t) ( Thread_ptr->File_Bytes - Offset );
+
+      Thread_ptr->Computed [i_block] = CRC32C ( Thread_ptr->Map + Offset, Block_Bytes );
+
+   }
+
+   return NULL;
+
+}  // Verify_Thread ()
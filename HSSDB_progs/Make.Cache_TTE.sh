@@ -0,0 +1,7 @@
+#  Manages the result cache of the programs -- see MAIN_Cache_TTE.c and Result_Cache.c
+
+gcc-mp-7  -O2  -std=c99  -pedantic  -Wall  -Wextra  \
+   -Wwrite-strings  -Wcast-qual  -Wpointer-arith    \
+   -Wstrict-prototypes  -Wmissing-prototypes  -Wconversion  \
+    MAIN_Cache_TTE.c   Result_Cache.c   TTE_Checksum.c   \
+  -lpthread  -o Cache_TTE.exe
@@ -0,0 +1,9 @@
+#  Archive of processed TTE in time partitions -- see MAIN_Compact_TTE.c
+
+gcc-mp-7  -O2  -std=c99  -pedantic  -Wall  -Wextra  \
+   -Wwrite-strings  -Wcast-qual  -Wpointer-arith    \
+   -Wstrict-prototypes  -Wmissing-prototypes  -Wconversion  \
+    MAIN_Compact_TTE.c   TTE_Segment_IO.c   \
+    Radix_Sort_TTE.c   Processed_TTE_IO.c   TTE_Codec.c   Number_of_Processors.c   \
+    IntegerTime_from_CoarseFine.c   CoarseFine_from_IntegerTime.c   \
+  -lpthread  -o Compact_TTE.exe
@@ -0,0 +1,10 @@
+#  Converts processed TTE files between versions 1 to 4, and the columnar format,
+#  and exports them as Arrow tables.
+
+gcc-mp-7  -O2  -std=c99  -pedantic  -Wall  -Wextra  \
+   -Wwrite-strings  -Wcast-qual  -Wpointer-arith    \
+   -Wstrict-prototypes  -Wmissing-prototypes  -Wconversion  \
+    MAIN_Convert_Processed_TTE.c   Processed_TTE_IO.c   TTE_Codec.c   TTE_Columnar_IO.c   \
+    Arrow_IPC_Writer.c   \
+    IntegerTime_from_CoarseFine.c   CoarseFine_from_IntegerTime.c   \
+  -o Convert_Processed_TTE.exe
@@ -1,6 +1,10 @@
 
 #  Michael S. Briggs, 2007 Sept 18 -- Oct 9, UAH / NSSTC.
 #  rev. 2010 May 22 -- more debug compile options.
+#  rev. 2026 Oct -- in-memory sort option, -inmem.
+#  rev. 2026 Oct -- sequences of input files, File_Sequence.c.
+#  rev. 2026 Oct -- compressed output, -z, TTE_Codec.c.
+#  rev. 2026 Oct -- result cache, Result_Cache.c.
 
 gcc-mp-7  -O2  -std=c99  -pedantic  -Wall  -Wextra  \
    -Wwrite-strings  -Wcast-qual  -Wpointer-arith    \
@@ -8,8 +12,11 @@ gcc-mp-7  -O2  -std=c99  -pedantic  -Wall  -Wextra  \
    -DALLOW_ERR_ONE  -DALLOW_ERR_TWO  \
     MAIN_Extract_TTE.c   ByteSwap.c   ReSync.c   \
     Extract_TTE_1packet.ALLOW_ERRs.c    \
-    ReadPacket.c   Output_TTE.c  \
+    ReadPacket.c   Output_TTE.c   Output_TTE_InMemory.c  \
+    Radix_Sort_TTE.c   Processed_TTE_IO.c   TTE_Codec.c   Number_of_Processors.c  \
+    TTE_Checksum.c   Result_Cache.c  \
+    File_Sequence.c  \
     FloatTime_from_CoarseFine.c   \
-    IntegerTime_from_CoarseFine.c  \
+    IntegerTime_from_CoarseFine.c   CoarseFine_from_IntegerTime.c  \
     GBM_MET_Time_to_JulianDay.c  JulianDay_to_Calendar_subr.c  \
-  -o Extract_TTE.ALLOW_ERRs.exe
+  -lpthread  -o Extract_TTE.ALLOW_ERRs.exe
@@ -2,6 +2,7 @@
 #  Michael S. Briggs, 2004 Oct 8, UAH / NSSTC.
 #  rev.  2008 Oct 2
 #  rev. 2010 May 22 -- more debug compile options.
+#  rev. 2026 Oct -- -arrow: Output_Histogram_Arrow.c, Arrow_IPC_Writer.c.
 
 gcc -O2  -std=c99  -pedantic  -Wall  -Wextra  \
    -Wwrite-strings  -Wcast-qual  -Wpointer-arith    \
@@ -14,4 +15,5 @@ gcc -O2  -std=c99  -pedantic  -Wall  -Wextra  \
     GBM_MET_Time_to_JulianDay.c  JulianDay_to_Calendar_subr.c  \
     GBM_UnifiedTime_from_TTE_Data.c  \
     GBM_UnifiedTime_to_JulianDay.c  \
+    Output_Histogram_Arrow.c  Arrow_IPC_Writer.c  \
   -o FileScan.exe
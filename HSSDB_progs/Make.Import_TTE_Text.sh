@@ -0,0 +1,9 @@
+#  Imports the TTE events of FileScan .tte text files -- see MAIN_Import_TTE_Text.c
+
+gcc-mp-7  -O2  -std=c99  -pedantic  -Wall  -Wextra  \
+   -Wwrite-strings  -Wcast-qual  -Wpointer-arith    \
+   -Wstrict-prototypes  -Wmissing-prototypes  -Wconversion  \
+    MAIN_Import_TTE_Text.c   Radix_Sort_TTE.c   Processed_TTE_IO.c   TTE_Codec.c   \
+    Number_of_Processors.c   \
+    IntegerTime_from_CoarseFine.c   CoarseFine_from_IntegerTime.c   \
+  -lpthread  -o Import_TTE_Text.exe
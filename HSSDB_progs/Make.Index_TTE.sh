@@ -0,0 +1,8 @@
+#  Makes the bitmap indexes of processed TTE files -- see MAIN_Index_TTE.c
+
+gcc-mp-7  -O2  -std=c99  -pedantic  -Wall  -Wextra  \
+   -Wwrite-strings  -Wcast-qual  -Wpointer-arith    \
+   -Wstrict-prototypes  -Wmissing-prototypes  -Wconversion  \
+    MAIN_Index_TTE.c   TTE_Bitmap_Index.c   TTE_Checksum.c   TTE_Event_Reader.c   Processed_TTE_IO.c   TTE_Codec.c   \
+    IntegerTime_from_CoarseFine.c   CoarseFine_from_IntegerTime.c   \
+  -lpthread  -o Index_TTE.exe
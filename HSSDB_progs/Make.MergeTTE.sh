@@ -1,6 +1,9 @@
-
 #  Michael S. Briggs, 2008 June 22, UAH / NSSTC.
+#  rev. 2026 Oct -- output via Processed_TTE_IO.c
+#  rev. 2026 Oct -- block checksums of the output, TTE_Checksum.c
+#  rev. 2026 Oct -- result cache, Result_Cache.c
 
 gcc-mp-7  -Wall -Wextra -O2  \
-    MAIN_Merge_TTE.c   IntegerTime_from_CoarseFine.c  \
-  -o Merge_TTE.exe
+    MAIN_Merge_TTE.c   Processed_TTE_IO.c   TTE_Codec.c   TTE_Checksum.c   Result_Cache.c   \
+    IntegerTime_from_CoarseFine.c   CoarseFine_from_IntegerTime.c   \
+  -lpthread  -o Merge_TTE.exe
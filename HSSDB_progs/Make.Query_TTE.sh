@@ -0,0 +1,9 @@
+
+#  Outputs the processed TTE events of a time range -- see MAIN_Query_TTE.c
+
+gcc-mp-7  -O2  -std=c99  -pedantic  -Wall  -Wextra  \
+   -Wwrite-strings  -Wcast-qual  -Wpointer-arith    \
+   -Wstrict-prototypes  -Wmissing-prototypes  -Wconversion  \
+    MAIN_Query_TTE.c   Processed_TTE_IO.c   TTE_Codec.c   \
+    IntegerTime_from_CoarseFine.c   CoarseFine_from_IntegerTime.c   \
+  -o Query_TTE.exe
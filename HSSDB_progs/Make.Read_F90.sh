@@ -0,0 +1,19 @@
+#  The Fortran examples of reading TTE files via the module TTE_Reader.
+
+gcc-mp-7  -O2  -std=c99  -pedantic  -Wall  -Wextra  \
+   -Wwrite-strings  -Wcast-qual  -Wpointer-arith    \
+   -Wstrict-prototypes  -Wmissing-prototypes  -Wconversion  -c  \
+    TTE_Reader_Fortran.c   TTE_Event_Reader.c   TTE_Bitmap_Index.c   TTE_Checksum.c   Processed_TTE_IO.c   TTE_Codec.c   \
+    IntegerTime_from_CoarseFine.c   CoarseFine_from_IntegerTime.c
+
+gfortran-mp-7  -O2  -Wall  -c  TTE_Reader_Module.f90
+
+gfortran-mp-7  -O2  -Wall  Read_Processed_F90.f90  \
+    TTE_Reader_Module.o   TTE_Reader_Fortran.o   TTE_Event_Reader.o   TTE_Bitmap_Index.o   TTE_Checksum.o   Processed_TTE_IO.o   TTE_Codec.o   \
+    IntegerTime_from_CoarseFine.o   CoarseFine_from_IntegerTime.o   \
+  -lpthread  -o Read_Processed_F90.exe
+
+gfortran-mp-7  -O2  -Wall  Read_TTE_1det_F90.f90  \
+    TTE_Reader_Module.o   TTE_Reader_Fortran.o   TTE_Event_Reader.o   TTE_Bitmap_Index.o   TTE_Checksum.o   Processed_TTE_IO.o   TTE_Codec.o   \
+    IntegerTime_from_CoarseFine.o   CoarseFine_from_IntegerTime.o   \
+  -lpthread  -o Read_TTE_1det_F90.exe
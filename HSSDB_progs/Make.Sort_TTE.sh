@@ -0,0 +1,9 @@
+#  Sorts processed TTE events in memory -- see MAIN_Sort_TTE.c
+
+gcc-mp-7  -O2  -std=c99  -pedantic  -Wall  -Wextra  \
+   -Wwrite-strings  -Wcast-qual  -Wpointer-arith    \
+   -Wstrict-prototypes  -Wmissing-prototypes  -Wconversion  \
+    MAIN_Sort_TTE.c   Radix_Sort_TTE.c   Processed_TTE_IO.c   TTE_Codec.c   \
+    Number_of_Processors.c   \
+    IntegerTime_from_CoarseFine.c   CoarseFine_from_IntegerTime.c   \
+  -lpthread  -o Sort_TTE.exe
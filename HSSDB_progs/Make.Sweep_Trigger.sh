@@ -0,0 +1,8 @@
+
+#  Sweep of the trigger parameters, false alarm rates versus threshold -- see MAIN_Sweep_Trigger.c
+
+gcc-mp-7  -Wall -Wextra -O2  \
+    MAIN_Sweep_Trigger.c   Trigger_Engine.c   Trigger_Poisson.c   TTE_Event_Reader.c   TTE_Bitmap_Index.c   Processed_TTE_IO.c   TTE_Codec.c   \
+    TTE_Checksum.c   Result_Cache.c   \
+    IntegerTime_from_CoarseFine.c   CoarseFine_from_IntegerTime.c   \
+  -lm  -lpthread  -o Sweep_Trigger.exe
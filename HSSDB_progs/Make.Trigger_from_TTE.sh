@@ -1,6 +1,16 @@
-
 #  Michael S. Briggs, 2008 July 7, UAH / NSSTC.
+#  rev. 2026 Oct -- reads processed TTE of either version via Processed_TTE_IO.c
+#  rev. 2026 Oct -- reads via TTE_Event_Reader.c
+#  rev. 2026 Oct -- with TTE_Bitmap_Index.c
+#  rev. 2026 Oct -- result cache, Result_Cache.c
+#  rev. 2026 Oct -- table of trigger algorithms, Trigger_Engine.c
+#  rev. 2026 Oct -- time slices on threads, -t
+#  rev. 2026 Oct -- checkpoints, Trigger_Checkpoint.c
+#  rev. 2026 Oct -- Poisson significance, Trigger_Poisson.c
+#  rev. 2026 Oct -- injections of synthetic bursts, Trigger_Injection.c
 
 gcc-mp-7  -Wall -Wextra -O2  \
-    Trigger_from_TTE.c     \
-  -o Trigger_from_TTE.exe
+    Trigger_from_TTE.c   Trigger_Engine.c   Trigger_Checkpoint.c   TTE_Event_Reader.c   TTE_Bitmap_Index.c   Processed_TTE_IO.c   TTE_Codec.c   \
+    TTE_Checksum.c   Result_Cache.c   Trigger_Poisson.c   Trigger_Injection.c   \
+    IntegerTime_from_CoarseFine.c   CoarseFine_from_IntegerTime.c   \
+  -lm  -lpthread  -o Trigger_from_TTE.exe
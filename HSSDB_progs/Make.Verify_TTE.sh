@@ -0,0 +1,7 @@
+#  Verifies files against their block checksums -- see MAIN_Verify_TTE.c
+
+gcc-mp-7  -O2  -std=c99  -pedantic  -Wall  -Wextra  \
+   -Wwrite-strings  -Wcast-qual  -Wpointer-arith    \
+   -Wstrict-prototypes  -Wmissing-prototypes  -Wconversion  \
+    MAIN_Verify_TTE.c   TTE_Checksum.c   Number_of_Processors.c   \
+  -lpthread  -o Verify_TTE.exe
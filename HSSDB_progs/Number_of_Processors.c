@@ -0,0 +1,23 @@
+//  Returns the number of processors available, as the default number of
+//  threads for the programs that can split their work across threads.
+//  Returns 1 if the number can't be determined.
+
+
+#define  _POSIX_C_SOURCE  200809L
+
+#include "HSSDB_Progs_Header.h"
+
+#include <unistd.h>
+
+
+uint32_t  Number_of_Processors ( void ) {
+
+   long  Num_Processors;
+
+   Num_Processors = sysconf ( _SC_NPROCESSORS_ONLN );
+
+   if ( Num_Processors < 1 )  return 1;
+
+   return (uint32_t) Num_Processors;
+
+}  // Number_of_Processors ()
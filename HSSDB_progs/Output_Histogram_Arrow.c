@@ -0,0 +1,176 @@
+//  Outputs the CTIME and CSPEC packets read by FileScan (option -arrow) as Apache
+//  Arrow tables (see Arrow_IPC_Writer.c), one row per packet:
+//     Time             uint64   header time, 2 microsec ticks (as Time_in_OneVariable)
+//     Sequence_Count   uint16
+//     Counts           fixed size list of uint16: CTIME 14 x 8 = 112, CSPEC 14 x 128 = 1792,
+//                      detector-major as in the packet: Counts [det * NUM_CHAN + chan]
+//  The tables are written to InputName.ctime.arrow and InputName.cspec.arrow
+//  (".dat" removed), each created at the first packet of its type.
+//  Packets with the wrong amount of data are reported by ProcessCTIME and
+//  ProcessCSPEC and are not output.
+
+//  Called once per packet, like Output_TTE, then once more with PacketDataLength =
+//  UINT16_MAX to write the last rows and close the files.
+
+
+#include "HSSDB_Progs_Header.h"
+
+#include <limits.h>
+
+
+//  Number of packets per record batch:
+#define  ARROW_BATCH_PACKETS   1024U
+
+
+//  local typedefs:
+
+typedef struct  Histogram_Table_type {
+   const char *  Extension;
+   uint32_t  Num_Counts;              // counts per packet
+   _Bool  Opened;
+   Arrow_File_type  Arrow_File;
+   uint64_t *  Times;
+   uint16_t *  Sequence_Counts;
+   uint16_t *  Counts;
+   uint32_t  Num_Rows;                // rows collected, not yet written
+} Histogram_Table_type;
+
+
+//  local function prototypes:
+
+static void  Open_Histogram_Table ( Histogram_Table_type * Table_ptr, const char * Input_FileName_ptr );
+
+static void  Write_Histogram_Batch ( Histogram_Table_type * Table_ptr );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Output_Histogram_Arrow (   // all arguments are input:
+
+   DataType_type DataType,
+   const uint16_t PacketData [],
+   uint16_t PacketDataLength,
+   uint32_t HeaderCoarseTime,
+   uint16_t HeaderFineTime,
+   uint16_t SequenceCount,
+   const char * Input_FileName_ptr
+
+) {
+
+   //  static since the tables are built across calls, i.e., across packets:
+
+   static Histogram_Table_type  Tables [2] = {
+      { ".ctime.arrow", NUM_DET * NUM_TIME_CHAN, false, { NULL, 0, { { NULL, 0, 0 } }, false, 0, 0, NULL, 0, 0 }, NULL, NULL, NULL, 0 },
+      { ".cspec.arrow", NUM_DET * NUM_SPEC_CHAN, false, { NULL, 0, { { NULL, 0, 0 } }, false, 0, 0, NULL, 0, 0 }, NULL, NULL, NULL, 0 }
+   };
+
+   Histogram_Table_type * Table_ptr;
+   uint32_t  i_table;
+
+
+   if ( PacketDataLength == UINT16_MAX ) {  // Closeout / Normal case ?
+
+      for ( i_table=0;  i_table < 2;  i_table++ ) {
+
+         Table_ptr = &Tables [i_table];
+         if ( ! Table_ptr->Opened )  continue;
+
+         Write_Histogram_Batch ( Table_ptr );
+         Close_Arrow_Output ( &Table_ptr->Arrow_File );
+
+         printf ( "\n%llu packets output to Arrow table %s\n",
+                  (long long unsigned int) Table_ptr->Arrow_File.Num_Rows, Table_ptr->Extension );
+
+         free ( Table_ptr->Times );
+         free ( Table_ptr->Sequence_Counts );
+         free ( Table_ptr->Counts );
+         Table_ptr->Opened = false;
+
+      }
+
+      return;
+
+   }  // Closeout / Normal case ?
+
+
+   if ( DataType == CTIME )
+      Table_ptr = &Tables [0];
+   else if ( DataType == CSPEC )
+      Table_ptr = &Tables [1];
+   else
+      return;
+
+   if ( PacketDataLength != 2 * Table_ptr->Num_Counts )  return;
+
+   if ( ! Table_ptr->Opened )  Open_Histogram_Table ( Table_ptr, Input_FileName_ptr );
+
+   Table_ptr->Times [Table_ptr->Num_Rows] = IntegerTime_from_CoarseFine ( HeaderCoarseTime, HeaderFineTime );
+   Table_ptr->Sequence_Counts [Table_ptr->Num_Rows] = SequenceCount;
+   memcpy ( Table_ptr->Counts + (size_t) Table_ptr->Num_Rows * Table_ptr->Num_Counts, PacketData, PacketDataLength );
+   Table_ptr->Num_Rows++;
+
+   if ( Table_ptr->Num_Rows == ARROW_BATCH_PACKETS )  Write_Histogram_Batch ( Table_ptr );
+
+}  // Output_Histogram_Arrow ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Open_Histogram_Table ( Histogram_Table_type * Table_ptr, const char * Input_FileName_ptr ) {
+
+   Arrow_Column_type  Columns [3] = {
+      { "Time", 64, 0 },
+      { "Sequence_Count", 16, 0 },
+      { "Counts", 16, 0 }
+   };
+
+   char * FileName_ptr;
+   size_t  FileName_Length;
+
+
+   Columns [2] .List_Size = Table_ptr->Num_Counts;
+
+   FileName_Length = strlen ( Input_FileName_ptr );
+   if ( FileName_Length >= 4  &&  strcmp ( Input_FileName_ptr + FileName_Length - 4, ".dat" ) == 0 )  FileName_Length -= 4;
+
+   FileName_ptr = malloc ( FileName_Length + strlen ( Table_ptr->Extension ) + 1 );
+   Table_ptr->Times = malloc ( ARROW_BATCH_PACKETS * sizeof (uint64_t) );
+   Table_ptr->Sequence_Counts = malloc ( ARROW_BATCH_PACKETS * sizeof (uint16_t) );
+   Table_ptr->Counts = malloc ( (size_t) ARROW_BATCH_PACKETS * Table_ptr->Num_Counts * sizeof (uint16_t) );
+
+   if ( FileName_ptr == NULL  ||  Table_ptr->Times == NULL  ||  Table_ptr->Sequence_Counts == NULL  ||  Table_ptr->Counts == NULL ) {
+      printf ( "\n\nmalloc of Arrow tables failed. exiting.\n" );
+      exit (102);
+   }
+
+   memcpy ( FileName_ptr, Input_FileName_ptr, FileName_Length );
+   strcpy ( FileName_ptr + FileName_Length, Table_ptr->Extension );
+
+   Open_Arrow_Output ( FileName_ptr, 3, Columns, &Table_ptr->Arrow_File );
+   printf ( "Opened Arrow output file %s\n", FileName_ptr );
+
+   Table_ptr->Num_Rows = 0;
+   Table_ptr->Opened = true;
+
+   free ( FileName_ptr );
+
+}  // Open_Histogram_Table ()
+
+
+
+static void  Write_Histogram_Batch ( Histogram_Table_type * Table_ptr ) {
+
+   const void *  Column_Data [3];
+
+
+   Column_Data [0] = Table_ptr->Times;
+   Column_Data [1] = Table_ptr->Sequence_Counts;
+   Column_Data [2] = Table_ptr->Counts;
+
+   Write_Arrow_Batch ( &Table_ptr->Arrow_File, Table_ptr->Num_Rows, Column_Data );
+   Table_ptr->Num_Rows = 0;
+
+}  // Write_Histogram_Batch ()
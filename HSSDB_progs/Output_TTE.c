@@ -22,6 +22,14 @@
 //  A secondary action of this program is to output the first and last times of the
 //  data stream.
 
+//  With Compress, each detector file is instead written as version 3 (compressed)
+//  processed TTE, through the routines of Processed_TTE_IO.c, with the detector
+//  number in every event; the files are then closed at closeout, which writes the
+//  last partial block.
+
+//  At closeout the detector files are closed and the checksums of their blocks are
+//  written to FileName.crc, see TTE_Checksum.c.
+
 
 #include <limits.h>
 
@@ -42,7 +50,8 @@ void Output_TTE (   // all arguments are input:
    uint16_t TTE_Detector [],
    char * Analysis_FileName_ptr,
    FILE * ptr_to_AnalysisFile,
-   FILE * ptr_to_SummaryFile
+   FILE * ptr_to_SummaryFile,
+   _Bool Compress
 
 ) {
 
@@ -63,6 +72,7 @@ void Output_TTE (   // all arguments are input:
    static  uint64_t  Last_CombinedTime = 0;
 
    static DetectorFile_type  DetectorFiles [NUM_DET];
+   static Processed_TTE_File_type  Compressed_Files [NUM_DET];
    static _Bool FirstCall = true;
 
 
@@ -74,6 +84,7 @@ void Output_TTE (   // all arguments are input:
    uint64_t  ThisTime;
 
    TTE_Data_type  TTE_Data;
+   Processed_TTE_v2_type  Event;
 
    size_t num_written;
 
@@ -114,7 +125,7 @@ void Output_TTE (   // all arguments are input:
          sprintf ( WorkString, ".TTE_Det_%02u.dat", j_det );
          FileName_Length = strlen ( Analysis_FileName_ptr );
          memcpy ( DetectorFiles [j_det] .DetectorFileName_ptr, Analysis_FileName_ptr, FileName_Length );
-         strncpy ( DetectorFiles [j_det] .DetectorFileName_ptr + FileName_Length - 4, WorkString, 15 );
+         strncpy ( DetectorFiles [j_det] .DetectorFileName_ptr + FileName_Length - 4, WorkString, 16 );   // including the terminating NUL
 
          TTE_count_by_det [j_det] = 0;
 
@@ -174,6 +185,20 @@ void Output_TTE (   // all arguments are input:
       for ( j_det=0;  j_det < NUM_DET;  j_det++ )
          printf ( "Output %u events for detector %2u.\n", TTE_count_by_det [j_det], j_det );
 
+      //  Close the detector files and write their block checksums (TTE_Checksum.c):
+
+      for ( j_det=0;  j_det < NUM_DET;  j_det++ ) {
+         if ( DetectorFiles [j_det] .DetectorFile_Opened ) {
+            if ( Compress )
+               Close_Processed_TTE_File ( &Compressed_Files [j_det] );
+            else if ( fclose ( DetectorFiles [j_det] .ptr_to_DetectorFile ) != 0 ) {
+               printf ( "\n\nClose of TTE output File for det %u failed!  Exiting!\n", j_det );
+               exit (2);
+            }
+            Write_TTE_Checksums ( DetectorFiles [j_det] .DetectorFileName_ptr );
+         }
+      }
+
       fprintf ( ptr_to_AnalysisFile, "\n%3u Detectors had TTE data.\n\n", Detector_Output_Cnt );
       fprintf ( ptr_to_SummaryFile, "\n%3u Detectors had TTE data.\n\n", Detector_Output_Cnt );
 
@@ -258,7 +283,13 @@ void Output_TTE (   // all arguments are input:
          //  detectors that aren't present in the input data stream.
 
 
-         if ( ! DetectorFiles [this_det] .DetectorFile_Opened ) {  // need to open output file ?
+         if ( ! DetectorFiles [this_det] .DetectorFile_Opened  &&  Compress ) {  // need to open output file ?
+
+            Open_Processed_TTE_Output ( DetectorFiles [this_det] .DetectorFileName_ptr, 3, &Compressed_Files [this_det] );
+            printf ( "Opened compressed TTE output file for det %u\n", this_det );
+            DetectorFiles [this_det] .DetectorFile_Opened = true;
+
+         } else if ( ! DetectorFiles [this_det] .DetectorFile_Opened ) {  // need to open output file ?
 
             DetectorFiles [this_det] .ptr_to_DetectorFile =
                     fopen ( DetectorFiles [this_det] .DetectorFileName_ptr, "w" );
@@ -278,6 +309,19 @@ void Output_TTE (   // all arguments are input:
          //  Primary action of this routine -- output the TTE data
          //  to files, one file per detector.
 
+         if ( Compress ) {  // compressed ?
+
+            Event.Time_in_OneVariable = ThisTime;
+            Event.Detector = (uint8_t) this_det;
+            Event.SpecChannel = (uint8_t) TTE_Channel [i_tte];
+            Event.Flags = 0;
+            Event.Reserved = 0;
+
+            Write_Processed_TTE ( &Compressed_Files [this_det], &Event, 1 );
+            continue;
+
+         }  // compressed ?
+
          TTE_Data.CoarseTime = TTE_CoarseTime [i_tte];
          TTE_Data.FineTime = TTE_FineTime [i_tte];
          TTE_Data.SpecChannel = TTE_Channel [i_tte];
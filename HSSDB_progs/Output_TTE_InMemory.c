@@ -0,0 +1,185 @@
+//  In-memory alternative to Output_TTE, selected by the -inmem option of Extract_TTE.
+
+//  Output_TTE writes the events of each detector to a separate file, so that
+//  Merge_TTE can later merge those files back into one time-ordered file.
+//  For a dataset that fits in memory, those two steps are pure overhead:
+//  this routine instead collects every TTE event, from all detectors, into one
+//  array, and at closeout sorts the array into time order (Radix_Sort_Processed_TTE)
+//  and writes the merged, version 2 processed TTE file in one sequential pass.
+
+//  The output is the same as Extract_TTE followed by Merge_TTE: time order,
+//  ties broken by the smaller detector number, and the events of each detector
+//  in the order in which they were extracted.
+
+//  Called exactly like Output_TTE: once per packet, then once more with
+//  Number_TTE_DataWords = UINT16_MAX to perform the closeout actions.
+//  With Compress, the file is written as version 3 (compressed) processed TTE.
+//  Its block checksums are written to FileName.crc, as by Output_TTE.
+
+
+#include "HSSDB_Progs_Header.h"
+
+
+//  Initial size of the event array, which doubles whenever it is full:
+#define  INITIAL_EVENT_CAPACITY   (1U << 20)
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Output_TTE_InMemory (   // all arguments are input:
+
+   uint16_t Number_TTE_DataWords,
+   uint32_t TTE_CoarseTime [],
+   uint16_t TTE_FineTime [],
+   uint16_t TTE_Channel [],
+   uint16_t TTE_Detector [],
+   const char * Output_FileName_ptr,
+   FILE * ptr_to_AnalysisFile,
+   FILE * ptr_to_SummaryFile,
+   _Bool Compress
+
+) {
+
+   //  ----------------------------------------------------------------------------------
+
+   //  static since the events accumulate across calls, i.e., across packets:
+
+   static  Processed_TTE_v2_type * Events = NULL;
+   static  size_t  Num_Events = 0;
+   static  size_t  Event_Capacity = 0;
+
+   static  uint32_t  TTE_count_by_det [NUM_DET];
+
+   //  ----------------------------------------------------------------------------------
+
+   Processed_TTE_v2_type * New_Events;
+
+   Processed_TTE_File_type  Output_File;
+
+   uint32_t  i_tte;
+   uint32_t  j_det;
+
+   uint32_t  Time_Coarse;
+   uint16_t  Time_Fine;
+
+   long double  JulianDay;
+   int32_t  year, month, day, hours, minutes;
+   long double  seconds;
+
+   //  ----------------------------------------------------------------------------------
+
+
+   if ( Number_TTE_DataWords == UINT16_MAX ) {  // Closeout / Normal case ?
+
+
+      //  ***** Closeout case: sort and write everything collected.
+
+      printf ( "\nSorting %llu TTE events in memory ...\n", (long long unsigned int) Num_Events );
+
+      Radix_Sort_Processed_TTE ( Events, Num_Events, Number_of_Processors () );
+
+      Open_Processed_TTE_Output ( Output_FileName_ptr, Compress ? 3U : 2U, &Output_File );
+      Write_Processed_TTE ( &Output_File, Events, Num_Events );
+      Close_Processed_TTE_File ( &Output_File );
+      Write_TTE_Checksums ( Output_FileName_ptr );
+
+
+      //  Summary information, like that of Output_TTE.   After the sort, the earliest
+      //  and last times are simply the first and last events.
+
+      if ( Num_Events > 0 ) {
+
+         CoarseFine_from_IntegerTime ( Events [0] .Time_in_OneVariable, &Time_Coarse, &Time_Fine );
+         JulianDay = GBM_MET_Time_to_JulianDay ( Time_Coarse, Time_Fine );
+         JulianDay_to_Calendar_subr ( JulianDay, &year, &month, &day, &hours, &minutes, &seconds );
+         printf ( "\nEarliest time in the TTE data:\n %11u : %6u  = %Lf  = %4d:%02d:%02d at %02d:%02d:%9Lf\n",
+            Time_Coarse, Time_Fine, JulianDay, year, month, day, hours, minutes, seconds );
+         fprintf ( ptr_to_AnalysisFile,
+             "\nEarliest time in the TTE data:\n %11u : %6u  =  %20llu  =  %Lf  = %4d:%02d:%02d at %02d:%02d:%9Lf\n",
+             Time_Coarse, Time_Fine, (long long unsigned int) Events [0] .Time_in_OneVariable,
+             JulianDay, year, month, day, hours, minutes, seconds );
+         fprintf ( ptr_to_SummaryFile,
+             "\nEarliest time in the TTE data:\n %11u : %6u  =  %20llu  =  %Lf  = %4d:%02d:%02d at %02d:%02d:%9Lf\n",
+             Time_Coarse, Time_Fine, (long long unsigned int) Events [0] .Time_in_OneVariable,
+             JulianDay, year, month, day, hours, minutes, seconds );
+
+         CoarseFine_from_IntegerTime ( Events [Num_Events - 1] .Time_in_OneVariable, &Time_Coarse, &Time_Fine );
+         JulianDay = GBM_MET_Time_to_JulianDay ( Time_Coarse, Time_Fine );
+         JulianDay_to_Calendar_subr ( JulianDay, &year, &month, &day, &hours, &minutes, &seconds );
+         printf ( "\nLast time in the TTE data:\n %11u : %6u  = %Lf  = %4d:%02d:%02d at %02d:%02d:%9Lf\n",
+            Time_Coarse, Time_Fine, JulianDay, year, month, day, hours, minutes, seconds );
+         fprintf ( ptr_to_AnalysisFile,
+             "\nLast time in the TTE data:\n%11u : %6u  =  %20llu  =  %Lf  = %4d:%02d:%02d at %02d:%02d:%9Lf\n",
+             Time_Coarse, Time_Fine, (long long unsigned int) Events [Num_Events - 1] .Time_in_OneVariable,
+             JulianDay, year, month, day, hours, minutes, seconds );
+         fprintf ( ptr_to_SummaryFile,
+             "\nLast time in the TTE data:\n%11u : %6u  =  %20llu  =  %Lf  = %4d:%02d:%02d at %02d:%02d:%9Lf\n",
+             Time_Coarse, Time_Fine, (long long unsigned int) Events [Num_Events - 1] .Time_in_OneVariable,
+             JulianDay, year, month, day, hours, minutes, seconds );
+
+      }
+
+      fprintf ( ptr_to_AnalysisFile, "\nSorted TTE events of all detectors output to %s\n", Output_FileName_ptr );
+      fprintf ( ptr_to_SummaryFile, "\nSorted TTE events of all detectors output to %s\n", Output_FileName_ptr );
+
+      fprintf ( ptr_to_AnalysisFile, "\nTable of number of TTE events.\nWARNING: data words before first time word are missing!\n" );
+      fprintf ( ptr_to_SummaryFile, "\nTable of number of TTE events.\nWARNING: data words before first time word are missing!\n" );
+      for ( j_det=0;  j_det < NUM_DET;  j_det++ ) {
+         printf ( "Output %u events for detector %2u.\n", TTE_count_by_det [j_det], j_det );
+         if ( TTE_count_by_det [j_det] > 0 ) {
+            fprintf ( ptr_to_AnalysisFile, "Detector %2u: %u events output\n", j_det, TTE_count_by_det [j_det] );
+            fprintf ( ptr_to_SummaryFile, "Detector %2u: %u events output\n", j_det, TTE_count_by_det [j_det] );
+         }
+      }  // j_det
+      fprintf ( ptr_to_AnalysisFile, "\nTotal number of TTE events output: %llu\n\n", (long long unsigned int) Num_Events );
+      fprintf ( ptr_to_SummaryFile, "\nTotal number of TTE events output: %llu\n\n", (long long unsigned int) Num_Events );
+      printf ( "\nTotal number of TTE events output: %llu\n\n", (long long unsigned int) Num_Events );
+
+      free ( Events );
+      Events = NULL;
+      Num_Events = 0;
+      Event_Capacity = 0;
+
+
+   } else {  // Closeout / Normal case ?
+
+
+      //  ***** Normal case: append the TTE events of this packet.
+
+      if ( Num_Events + Number_TTE_DataWords > Event_Capacity ) {  // need more space ?
+
+         if ( Event_Capacity == 0 )  Event_Capacity = INITIAL_EVENT_CAPACITY / 2;
+         while ( Num_Events + Number_TTE_DataWords > Event_Capacity )  Event_Capacity *= 2;
+
+         New_Events = realloc ( Events, Event_Capacity * sizeof (Processed_TTE_v2_type) );
+         if ( New_Events == NULL ) {
+            printf ( "\n\nOut of memory holding %llu TTE events -- use Extract_TTE without -inmem.  Exiting.\n",
+                     (long long unsigned int) Num_Events );
+            exit (4);
+         }
+         Events = New_Events;
+
+      }  // need more space ?
+
+
+      for ( i_tte=0;  i_tte < Number_TTE_DataWords;  i_tte++ ) {
+
+         TTE_count_by_det [ TTE_Detector [i_tte] ] ++;
+
+         Events [Num_Events] .Time_in_OneVariable = IntegerTime_from_CoarseFine ( TTE_CoarseTime [i_tte], TTE_FineTime [i_tte] );
+         Events [Num_Events] .Detector = (uint8_t) TTE_Detector [i_tte];
+         Events [Num_Events] .SpecChannel = (uint8_t) TTE_Channel [i_tte];
+         Events [Num_Events] .Flags = 0;
+         Events [Num_Events] .Reserved = 0;
+         Num_Events++;
+
+      }  // i_tte loop
+
+
+   }  // Closeout / Normal case ?
+
+
+   return;
+
+}  // Output_TTE_InMemory ()
@@ -0,0 +1,820 @@
+//  Routines to read and write files of processed (i.e., merged, time-ordered)
+//  TTE events, as output by Merge_TTE.
+
+//  There are two versions of the file format:
+
+//  Version 1: no file header, a sequence of Processed_TTE_type records (12 bytes),
+//  time held as the two native GBM MET counters, Coarse and Fine.
+
+//  Version 2: a 16 byte Processed_TTE_File_Header_type, then a sequence of
+//  Processed_TTE_v2_type records (16 bytes), time held as a single 64 bit
+//  integer in 2 microsec ticks.
+
+//  Version 3: the same file header as version 2, but with a different magic
+//  string, then the events in compressed blocks (see TTE_Codec.c), typically
+//  2 to 3 bytes per event.
+
+//  Version 4: version 3 with a zone map after each block and, at the end of the
+//  file, a directory of the blocks with their zone maps.   A program interested
+//  in a short time range, or in a few detectors, calls Select_Processed_TTE after
+//  opening the file: the reader then only returns the selected events, and for a
+//  version 4 file it finds the first block of the range by binary search of the
+//  directory and skips the blocks that the zone maps show contain no selected
+//  events, so the time to read a short range does not depend on the length of
+//  the file.   For the other versions, the selection is made by reading the
+//  whole file.
+
+//  The reader accepts any version and always returns v2 records, so the
+//  programs that use it never have to combine Coarse and Fine Time themselves,
+//  nor know whether the file is compressed.   The writer can produce any version.
+
+//  As elsewhere in these programs, I/O errors are fatal: a message is output
+//  and the program exits.
+
+
+#include "HSSDB_Progs_Header.h"
+
+
+//  Number of v1 records converted per fread; any value will do:
+#define  V1_CHUNK  1024U
+
+//  Initial number of directory entries of a version 4 output file, doubled as needed:
+#define  INITIAL_DIRECTORY_CAPACITY  1024U
+
+
+//  local function prototypes:
+
+static void  Allocate_Codec_Buffers ( Processed_TTE_File_type * File_ptr );
+
+static void  Write_Compressed_Block ( Processed_TTE_File_type * Output_ptr, const Processed_TTE_v2_type Events [], uint32_t Num_Events );
+
+static void  Read_Block_Directory ( Processed_TTE_File_type * Input_ptr, const char * FileName );
+
+static _Bool  Next_Selected_Block ( Processed_TTE_File_type * Input_ptr );
+
+static size_t  Keep_Selected_Events ( const Processed_TTE_File_type * Input_ptr, Processed_TTE_v2_type Events [], size_t Num_Events );
+
+static void  Seek_Processed_TTE ( Processed_TTE_File_type * File_ptr, uint64_t Offset );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Open_Processed_TTE_Input (
+
+   // Input argument:
+   const char * FileName,
+
+   // Output argument:
+   Processed_TTE_File_type * Input_ptr
+
+) {
+
+   Processed_TTE_File_Header_type  Header;
+   size_t  num_read;
+
+
+   Input_ptr->File_ptr = fopen ( FileName, "rb" );
+   if ( Input_ptr->File_ptr == NULL ) {
+      printf ( "\n\nFailed to open input processed TTE File '%s' -- Exiting!\n", FileName );
+      exit (40);
+   }
+
+   Input_ptr->Num_Events = 0;
+   Input_ptr->Block = NULL;
+   Input_ptr->Pending = NULL;
+   Input_ptr->Num_Pending = 0;
+   Input_ptr->i_Pending = 0;
+   Input_ptr->Output = false;
+   Input_ptr->Num_Blocks_Read = 0;
+   Input_ptr->Directory = NULL;
+   Input_ptr->Num_Blocks = 0;
+   Input_ptr->i_Block = 0;
+   Input_ptr->Time_Ordered = false;
+   Input_ptr->Selected = false;
+
+
+   //  Identify the version by the presence of the v2 file header.   If it is absent,
+   //  this is a v1 file and we rewind so that the first record is read as data.
+   //  (A v1 file shorter than the header is legal -- it has 0 or 1 events.)
+
+   num_read = fread ( &Header, sizeof (Header), 1, Input_ptr->File_ptr );
+
+   if ( num_read == 1  &&  memcmp ( Header.Magic, PROCESSED_TTE_MAGIC, sizeof (Header.Magic) ) == 0 ) {  // v2 ?
+
+      if ( Header.Version != 2  ||  Header.RecordBytes != sizeof (Processed_TTE_v2_type) ) {
+         printf ( "\n\nUnsupported processed TTE File '%s': version %u with %u byte records -- Exiting!\n",
+                  FileName, Header.Version, Header.RecordBytes );
+         exit (41);
+      }
+
+      Input_ptr->Version = 2;
+
+   } else if ( num_read == 1  &&  memcmp ( Header.Magic, PROCESSED_TTE_Z_MAGIC, sizeof (Header.Magic) ) == 0 ) {  // v2 ?
+
+      if ( Header.Version != 3  ||  Header.RecordBytes != sizeof (Processed_TTE_v2_type) ) {
+         printf ( "\n\nUnsupported processed TTE File '%s': version %u with %u byte records -- Exiting!\n",
+                  FileName, Header.Version, Header.RecordBytes );
+         exit (41);
+      }
+
+      Input_ptr->Version = 3;
+      Allocate_Codec_Buffers ( Input_ptr );
+
+   } else if ( num_read == 1  &&  memcmp ( Header.Magic, PROCESSED_TTE_I_MAGIC, sizeof (Header.Magic) ) == 0 ) {  // v2 ?
+
+      if ( Header.Version != 4  ||  Header.RecordBytes != sizeof (Processed_TTE_v2_type) ) {
+         printf ( "\n\nUnsupported processed TTE File '%s': version %u with %u byte records -- Exiting!\n",
+                  FileName, Header.Version, Header.RecordBytes );
+         exit (41);
+      }
+
+      Input_ptr->Version = 4;
+      Allocate_Codec_Buffers ( Input_ptr );
+      Read_Block_Directory ( Input_ptr, FileName );
+
+   } else {  // v2 ?
+
+      Input_ptr->Version = 1;
+      rewind ( Input_ptr->File_ptr );
+
+   }  // v2 ?
+
+
+}  // Open_Processed_TTE_Input ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Reads up to Max_Events events into Events, converting v1 records as needed.
+//  Returns the number of events read; 0 signals EOF.   After Select_Processed_TTE,
+//  only the selected events are returned.
+
+size_t Read_Processed_TTE (
+
+   // Input/Output argument:
+   Processed_TTE_File_type * Input_ptr,
+
+   // Output arguments:
+   Processed_TTE_v2_type Events [],
+
+   // Input argument:
+   size_t Max_Events
+
+) {
+
+   Processed_TTE_type  V1_Events [V1_CHUNK];
+
+   size_t  num_read;
+   size_t  Total_Read;
+   size_t  Num2Read;
+   size_t  Num_Decoded;
+   size_t  i;
+
+   TTE_Block_Header_type * Block_Header_ptr;
+   TTE_Zone_Map_type  Zone_Map;
+
+
+   if ( Input_ptr->Version == 2 ) {  // version ?
+
+      //  With a selection, read until some events are selected, or EOF:
+
+      do {
+         num_read = fread ( Events, sizeof (Processed_TTE_v2_type), Max_Events, Input_ptr->File_ptr );
+         Total_Read = Input_ptr->Selected  ?  Keep_Selected_Events ( Input_ptr, Events, num_read )  :  num_read;
+      } while ( Total_Read == 0  &&  num_read > 0 );
+
+   } else if ( Input_ptr->Version >= 3 ) {  // version ?
+
+      //  First return any events left from the previous block, then decode blocks.
+      //  A block is decoded directly into Events when it fits, otherwise into Pending.
+      //  With a selection, the events not selected are removed from each block as it
+      //  is decoded.
+
+      Total_Read = 0;
+      Block_Header_ptr = (TTE_Block_Header_type *) Input_ptr->Block;
+
+      while ( Total_Read < Max_Events ) {
+
+         if ( Input_ptr->i_Pending < Input_ptr->Num_Pending ) {  // pending events ?
+
+            Num2Read = Input_ptr->Num_Pending - Input_ptr->i_Pending;
+            if ( Num2Read > Max_Events - Total_Read )  Num2Read = Max_Events - Total_Read;
+
+            memcpy ( Events + Total_Read, Input_ptr->Pending + Input_ptr->i_Pending, Num2Read * sizeof (Processed_TTE_v2_type) );
+            Input_ptr->i_Pending += (uint32_t) Num2Read;
+            Total_Read += Num2Read;
+            continue;
+
+         }  // pending events ?
+
+         if ( Input_ptr->Version == 4  &&  ! Next_Selected_Block ( Input_ptr ) )  break;   // no more blocks
+
+         if ( fread ( Block_Header_ptr, sizeof (TTE_Block_Header_type), 1, Input_ptr->File_ptr ) != 1 )  break;   // EOF
+
+         if ( Block_Header_ptr->Block_Bytes < sizeof (TTE_Block_Header_type)  ||  Block_Header_ptr->Block_Bytes % 8 != 0  ||
+              Block_Header_ptr->Block_Bytes > Max_Encoded_TTE_Block_Bytes ( TTE_CODEC_BLOCK_EVENTS )  ||
+              fread ( Input_ptr->Block + sizeof (TTE_Block_Header_type) / 8, 1,
+                      Block_Header_ptr->Block_Bytes - sizeof (TTE_Block_Header_type), Input_ptr->File_ptr )
+                  != Block_Header_ptr->Block_Bytes - sizeof (TTE_Block_Header_type)  ||
+              ( Input_ptr->Version == 4  &&  fread ( &Zone_Map, sizeof (Zone_Map), 1, Input_ptr->File_ptr ) != 1 ) ) {
+            printf ( "\n\nCorrupt or truncated compressed processed TTE File -- Exiting!\n" );
+            exit (49);
+         }
+
+         Input_ptr->Num_Blocks_Read++;
+
+         if ( Max_Events - Total_Read >= Block_Header_ptr->Num_Events ) {
+            Num_Decoded = Decode_TTE_Block ( Input_ptr->Block, Events + Total_Read );
+            if ( Input_ptr->Selected )  Num_Decoded = Keep_Selected_Events ( Input_ptr, Events + Total_Read, Num_Decoded );
+            Total_Read += Num_Decoded;
+         } else {
+            Num_Decoded = Decode_TTE_Block ( Input_ptr->Block, Input_ptr->Pending );
+            if ( Input_ptr->Selected )  Num_Decoded = Keep_Selected_Events ( Input_ptr, Input_ptr->Pending, Num_Decoded );
+            Input_ptr->Num_Pending = (uint32_t) Num_Decoded;
+            Input_ptr->i_Pending = 0;
+         }
+
+      }  // Total_Read < Max_Events
+
+   } else {  // version ?
+
+      Total_Read = 0;
+
+      while ( Total_Read < Max_Events ) {
+
+         Num2Read = Max_Events - Total_Read;
+         if ( Num2Read > V1_CHUNK )  Num2Read = V1_CHUNK;
+
+         num_read = fread ( V1_Events, sizeof (Processed_TTE_type), Num2Read, Input_ptr->File_ptr );
+
+         for ( i=0;  i < num_read;  i++ ) {
+            Events [Total_Read + i] .Time_in_OneVariable =
+                     IntegerTime_from_CoarseFine ( V1_Events [i] .CoarseTime, V1_Events [i] .FineTime );
+            Events [Total_Read + i] .Detector = (uint8_t) V1_Events [i] .Detector;
+            Events [Total_Read + i] .SpecChannel = (uint8_t) V1_Events [i] .SpecChannel;
+            Events [Total_Read + i] .Flags = 0;
+            Events [Total_Read + i] .Reserved = 0;
+         }
+
+         if ( Input_ptr->Selected )
+            Total_Read += Keep_Selected_Events ( Input_ptr, Events + Total_Read, num_read );
+         else
+            Total_Read += num_read;
+
+         if ( num_read != Num2Read )  break;
+
+      }  // Total_Read < Max_Events
+
+   }  // version ?
+
+
+   if ( ferror (Input_ptr->File_ptr) ) {
+      printf ( "\n\nError reading processed TTE File -- Exiting!\n" );
+      exit (42);
+   }
+
+   Input_ptr->Num_Events += Total_Read;
+
+   return Total_Read;
+
+}  // Read_Processed_TTE ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Open_Processed_TTE_Output (
+
+   // Input arguments:
+   const char * FileName,
+   uint32_t Version,
+
+   // Output argument:
+   Processed_TTE_File_type * Output_ptr
+
+) {
+
+   Processed_TTE_File_Header_type  Header;
+
+
+   if ( Version < 1  ||  Version > 4 ) {
+      printf ( "\n\nProgram logic error: processed TTE version %u requested -- Exiting!\n", Version );
+      exit (43);
+   }
+
+   Output_ptr->File_ptr = fopen ( FileName, "wb" );
+   if ( Output_ptr->File_ptr == NULL ) {
+      printf ( "\n\nFailed to open output processed TTE File '%s' -- Exiting!\n", FileName );
+      exit (44);
+   }
+
+   Output_ptr->Version = Version;
+   Output_ptr->Num_Events = 0;
+   Output_ptr->Block = NULL;
+   Output_ptr->Pending = NULL;
+   Output_ptr->Num_Pending = 0;
+   Output_ptr->i_Pending = 0;
+   Output_ptr->Output = true;
+   Output_ptr->Num_Blocks_Read = 0;
+   Output_ptr->Directory = NULL;
+   Output_ptr->Num_Blocks = 0;
+   Output_ptr->Directory_Capacity = 0;
+   Output_ptr->Offset = sizeof (Header);
+   Output_ptr->Selected = false;
+
+   if ( Version >= 3 )  Allocate_Codec_Buffers ( Output_ptr );
+
+   if ( Version >= 2 ) {
+
+      memset ( &Header, 0, sizeof (Header) );
+      if ( Version == 2 )
+         memcpy ( Header.Magic, PROCESSED_TTE_MAGIC, sizeof (PROCESSED_TTE_MAGIC) );
+      else if ( Version == 3 )
+         memcpy ( Header.Magic, PROCESSED_TTE_Z_MAGIC, sizeof (PROCESSED_TTE_Z_MAGIC) );
+      else
+         memcpy ( Header.Magic, PROCESSED_TTE_I_MAGIC, sizeof (PROCESSED_TTE_I_MAGIC) );
+      Header.Version = Version;
+      Header.RecordBytes = sizeof (Processed_TTE_v2_type);
+
+      if ( fwrite ( &Header, sizeof (Header), 1, Output_ptr->File_ptr ) != 1 ) {
+         printf ( "\nWrite to output file failed !\n" );
+         exit (45);
+      }
+
+   }
+
+}  // Open_Processed_TTE_Output ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Write_Processed_TTE (
+
+   // Input/Output argument:
+   Processed_TTE_File_type * Output_ptr,
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events
+
+) {
+
+   Processed_TTE_type  V1_Events [V1_CHUNK];
+
+   size_t  num_written;
+   size_t  Num2Write;
+   size_t  i_beg, i;
+
+
+   if ( Output_ptr->Version == 2 ) {  // version ?
+
+      num_written = fwrite ( Events, sizeof (Processed_TTE_v2_type), Num_Events, Output_ptr->File_ptr );
+
+   } else if ( Output_ptr->Version >= 3 ) {  // version ?
+
+      //  Events are collected in Pending until there is a full block to compress;
+      //  full blocks of the caller's events are compressed directly.
+
+      for ( i_beg=0;  i_beg < Num_Events;  i_beg += Num2Write ) {
+
+         if ( Output_ptr->Num_Pending == 0  &&  Num_Events - i_beg >= TTE_CODEC_BLOCK_EVENTS ) {
+            Num2Write = TTE_CODEC_BLOCK_EVENTS;
+            Write_Compressed_Block ( Output_ptr, Events + i_beg, TTE_CODEC_BLOCK_EVENTS );
+            continue;
+         }
+
+         Num2Write = TTE_CODEC_BLOCK_EVENTS - Output_ptr->Num_Pending;
+         if ( Num2Write > Num_Events - i_beg )  Num2Write = Num_Events - i_beg;
+
+         memcpy ( Output_ptr->Pending + Output_ptr->Num_Pending, Events + i_beg, Num2Write * sizeof (Processed_TTE_v2_type) );
+         Output_ptr->Num_Pending += (uint32_t) Num2Write;
+
+         if ( Output_ptr->Num_Pending == TTE_CODEC_BLOCK_EVENTS ) {
+            Write_Compressed_Block ( Output_ptr, Output_ptr->Pending, TTE_CODEC_BLOCK_EVENTS );
+            Output_ptr->Num_Pending = 0;
+         }
+
+      }
+
+      num_written = Num_Events;
+
+   } else {  // version ?
+
+      num_written = 0;
+
+      for ( i_beg=0;  i_beg < Num_Events;  i_beg += Num2Write ) {
+
+         Num2Write = Num_Events - i_beg;
+         if ( Num2Write > V1_CHUNK )  Num2Write = V1_CHUNK;
+
+         for ( i=0;  i < Num2Write;  i++ ) {
+            CoarseFine_from_IntegerTime ( Events [i_beg + i] .Time_in_OneVariable,
+                                          &V1_Events [i] .CoarseTime, &V1_Events [i] .FineTime );
+            V1_Events [i] .Detector = Events [i_beg + i] .Detector;
+            V1_Events [i] .SpecChannel = Events [i_beg + i] .SpecChannel;
+            V1_Events [i] .PADDING = 0;
+         }
+
+         num_written += fwrite ( V1_Events, sizeof (Processed_TTE_type), Num2Write, Output_ptr->File_ptr );
+
+      }
+
+   }  // version ?
+
+
+   if ( num_written != Num_Events ) {
+      printf ( "\nWrite to output file failed !\n" );
+      exit (46);
+   }
+
+   Output_ptr->Num_Events += Num_Events;
+
+}  // Write_Processed_TTE ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Close_Processed_TTE_File (
+   Processed_TTE_File_type * File_ptr
+) {
+
+   TTE_Block_Trailer_type  Trailer;
+
+
+   if ( File_ptr->Version >= 3 ) {
+
+      if ( File_ptr->Output  &&  File_ptr->Num_Pending > 0 )
+         Write_Compressed_Block ( File_ptr, File_ptr->Pending, File_ptr->Num_Pending );
+
+      free ( File_ptr->Block );
+      free ( File_ptr->Pending );
+      File_ptr->Block = NULL;
+      File_ptr->Pending = NULL;
+
+   }
+
+   if ( File_ptr->Version == 4 ) {
+
+      if ( File_ptr->Output ) {
+
+         memset ( &Trailer, 0, sizeof (Trailer) );
+         Trailer.Directory_Offset = File_ptr->Offset;
+         Trailer.Num_Blocks = File_ptr->Num_Blocks;
+         memcpy ( Trailer.Magic, TTE_DIRECTORY_MAGIC, sizeof (TTE_DIRECTORY_MAGIC) );
+
+         if ( fwrite ( File_ptr->Directory, sizeof (TTE_Block_Directory_type), File_ptr->Num_Blocks, File_ptr->File_ptr )
+                  != File_ptr->Num_Blocks  ||
+              fwrite ( &Trailer, sizeof (Trailer), 1, File_ptr->File_ptr ) != 1 ) {
+            printf ( "\nWrite to output file failed !\n" );
+            exit (46);
+         }
+
+      }
+
+      free ( File_ptr->Directory );
+      File_ptr->Directory = NULL;
+
+   }
+
+   if ( fclose ( File_ptr->File_ptr ) != 0 ) {
+      printf ( "\nClose of processed TTE file failed !\n" );
+      exit (47);
+   }
+
+   File_ptr->File_ptr = NULL;
+
+}  // Close_Processed_TTE_File ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Allocate_Codec_Buffers ( Processed_TTE_File_type * File_ptr ) {
+
+   File_ptr->Block = malloc ( Max_Encoded_TTE_Block_Bytes ( TTE_CODEC_BLOCK_EVENTS ) );
+   File_ptr->Pending = malloc ( TTE_CODEC_BLOCK_EVENTS * sizeof (Processed_TTE_v2_type) );
+
+   if ( File_ptr->Block == NULL  ||  File_ptr->Pending == NULL ) {
+      printf ( "\n\nmalloc of compression buffers failed. exiting.\n" );
+      exit (48);
+   }
+
+}  // Allocate_Codec_Buffers ()
+
+
+
+static void  Write_Compressed_Block ( Processed_TTE_File_type * Output_ptr, const Processed_TTE_v2_type Events [], uint32_t Num_Events ) {
+
+   size_t  Block_Bytes;
+
+
+   TTE_Block_Directory_type * New_Directory;
+   TTE_Block_Directory_type * Entry_ptr;
+
+
+   Block_Bytes = Encode_TTE_Block ( Events, Num_Events, Output_ptr->Block );
+
+   if ( fwrite ( Output_ptr->Block, 1, Block_Bytes, Output_ptr->File_ptr ) != Block_Bytes ) {
+      printf ( "\nWrite to output file failed !\n" );
+      exit (46);
+   }
+
+   if ( Output_ptr->Version == 3 )  return;
+
+
+   //  Version 4: the zone map follows the block, and is also kept for the directory.
+
+   if ( Output_ptr->Num_Blocks == Output_ptr->Directory_Capacity ) {
+      Output_ptr->Directory_Capacity = ( Output_ptr->Directory_Capacity == 0 )  ?
+                                          INITIAL_DIRECTORY_CAPACITY  :  2 * Output_ptr->Directory_Capacity;
+      New_Directory = realloc ( Output_ptr->Directory, Output_ptr->Directory_Capacity * sizeof (TTE_Block_Directory_type) );
+      if ( New_Directory == NULL ) {
+         printf ( "\n\nmalloc of block directory failed. exiting.\n" );
+         exit (48);
+      }
+      Output_ptr->Directory = New_Directory;
+   }
+
+   Entry_ptr = &Output_ptr->Directory [Output_ptr->Num_Blocks];
+   Entry_ptr->Offset = Output_ptr->Offset;
+   Zone_Map_of_TTE_Events ( Events, Num_Events, &Entry_ptr->Zone_Map );
+
+   if ( fwrite ( &Entry_ptr->Zone_Map, sizeof (TTE_Zone_Map_type), 1, Output_ptr->File_ptr ) != 1 ) {
+      printf ( "\nWrite to output file failed !\n" );
+      exit (46);
+   }
+
+   Output_ptr->Num_Blocks++;
+   Output_ptr->Offset += Block_Bytes + sizeof (TTE_Zone_Map_type);
+
+}  // Write_Compressed_Block ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Reads the trailer and the block directory of a version 4 file, then returns to
+//  the first block.
+
+static void  Read_Block_Directory ( Processed_TTE_File_type * Input_ptr, const char * FileName ) {
+
+   TTE_Block_Trailer_type  Trailer;
+   long  File_Size;
+   uint64_t  i_block;
+
+
+   if ( fseek ( Input_ptr->File_ptr, 0, SEEK_END ) != 0  ||  ( File_Size = ftell ( Input_ptr->File_ptr ) ) < 0  ||
+        (uint64_t) File_Size < sizeof (Processed_TTE_File_Header_type) + sizeof (Trailer) ) {
+      printf ( "\n\nCorrupt or truncated compressed processed TTE File '%s' -- Exiting!\n", FileName );
+      exit (49);
+   }
+
+   Seek_Processed_TTE ( Input_ptr, (uint64_t) File_Size - sizeof (Trailer) );
+
+   if ( fread ( &Trailer, sizeof (Trailer), 1, Input_ptr->File_ptr ) != 1  ||
+        memcmp ( Trailer.Magic, TTE_DIRECTORY_MAGIC, sizeof (Trailer.Magic) ) != 0  ||
+        Trailer.Directory_Offset < sizeof (Processed_TTE_File_Header_type)  ||
+        Trailer.Num_Blocks > ( (uint64_t) File_Size - sizeof (Trailer) ) / sizeof (TTE_Block_Directory_type)  ||
+        Trailer.Directory_Offset + Trailer.Num_Blocks * sizeof (TTE_Block_Directory_type) + sizeof (Trailer)
+            != (uint64_t) File_Size ) {
+      printf ( "\n\nCorrupt or truncated compressed processed TTE File '%s': bad block directory -- Exiting!\n", FileName );
+      exit (49);
+   }
+
+   Input_ptr->Num_Blocks = Trailer.Num_Blocks;
+   Input_ptr->Directory = malloc ( ( Trailer.Num_Blocks + 1 ) * sizeof (TTE_Block_Directory_type) );
+   if ( Input_ptr->Directory == NULL ) {
+      printf ( "\n\nmalloc of block directory failed. exiting.\n" );
+      exit (48);
+   }
+
+   Seek_Processed_TTE ( Input_ptr, Trailer.Directory_Offset );
+
+   if ( fread ( Input_ptr->Directory, sizeof (TTE_Block_Directory_type), Trailer.Num_Blocks, Input_ptr->File_ptr )
+            != Trailer.Num_Blocks ) {
+      printf ( "\n\nError reading processed TTE File '%s' -- Exiting!\n", FileName );
+      exit (42);
+   }
+
+   //  The binary search of Select_Processed_TTE requires that the blocks be in time order
+   //  and not overlap -- true of a time-ordered file:
+
+   Input_ptr->Time_Ordered = true;
+   for ( i_block=1;  i_block < Trailer.Num_Blocks;  i_block++ ) {
+      if ( Input_ptr->Directory [i_block] .Zone_Map.Min_Time < Input_ptr->Directory [i_block-1] .Zone_Map.Max_Time )
+         Input_ptr->Time_Ordered = false;
+   }
+
+   Input_ptr->i_Block = 0;
+   Seek_Processed_TTE ( Input_ptr, sizeof (Processed_TTE_File_Header_type) );
+
+}  // Read_Block_Directory ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Restricts the events returned by Read_Processed_TTE to those with
+//  Begin_Time <= time < End_Time, of the detectors in Detector_Mask
+//  (bit j for detector j; ALL_DETECTORS_MASK selects all).   Call it right after
+//  opening the file.   For a time-ordered version 4 file, the file is positioned
+//  at the first block that can contain Begin_Time.
+
+void Select_Processed_TTE (
+
+   // Input/Output argument:
+   Processed_TTE_File_type * Input_ptr,
+
+   // Input arguments:
+   uint64_t Begin_Time,
+   uint64_t End_Time,
+   uint32_t Detector_Mask
+
+) {
+
+   uint64_t  i_low, i_high, i_mid;
+
+
+   Input_ptr->Selected = true;
+   Input_ptr->Begin_Time = Begin_Time;
+   Input_ptr->End_Time = End_Time;
+   Input_ptr->Detector_Mask = Detector_Mask;
+
+   if ( Input_ptr->Version != 4  ||  ! Input_ptr->Time_Ordered )  return;
+
+
+   //  Binary search for the first block whose last time is >= Begin_Time:
+
+   i_low = 0;
+   i_high = Input_ptr->Num_Blocks;
+
+   while ( i_low < i_high ) {
+      i_mid = i_low + ( i_high - i_low ) / 2;
+      if ( Input_ptr->Directory [i_mid] .Zone_Map.Max_Time < Begin_Time )
+         i_low = i_mid + 1;
+      else
+         i_high = i_mid;
+   }
+
+   Input_ptr->Num_Pending = 0;
+   Input_ptr->i_Pending = 0;
+   Input_ptr->i_Block = i_low;
+   if ( i_low < Input_ptr->Num_Blocks )  Seek_Processed_TTE ( Input_ptr, Input_ptr->Directory [i_low] .Offset );
+
+}  // Select_Processed_TTE ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Version 4: advances to the next block to be read, skipping the blocks that
+//  can contain no selected events, and seeking if any were skipped.
+//  Returns false when there are no more blocks to read.
+
+static _Bool  Next_Selected_Block ( Processed_TTE_File_type * Input_ptr ) {
+
+   uint64_t  i_block;
+   const TTE_Zone_Map_type * Zone_ptr;
+   uint32_t  j_det;
+   _Bool  Has_Detector;
+
+
+   i_block = Input_ptr->i_Block;
+
+   if ( Input_ptr->Selected ) {  // selection ?
+
+      for ( ;  i_block < Input_ptr->Num_Blocks;  i_block++ ) {
+
+         Zone_ptr = &Input_ptr->Directory [i_block] .Zone_Map;
+
+         if ( Zone_ptr->Min_Time >= Input_ptr->End_Time ) {
+            if ( Input_ptr->Time_Ordered ) {
+               i_block = Input_ptr->Num_Blocks;   // no later block can contain selected events
+               break;
+            }
+            continue;
+         }
+
+         if ( Zone_ptr->Max_Time < Input_ptr->Begin_Time )  continue;
+
+         Has_Detector = false;
+         for ( j_det=0;  j_det < NUM_DET;  j_det++ ) {
+            if ( Zone_ptr->Det_Counts [j_det] > 0  &&  ( ( Input_ptr->Detector_Mask >> j_det ) & 1U ) )  Has_Detector = true;
+         }
+
+         if ( Has_Detector )  break;
+
+      }
+
+      if ( i_block != Input_ptr->i_Block  &&  i_block < Input_ptr->Num_Blocks )
+         Seek_Processed_TTE ( Input_ptr, Input_ptr->Directory [i_block] .Offset );
+
+   }  // selection ?
+
+   if ( i_block >= Input_ptr->Num_Blocks ) {
+      Input_ptr->i_Block = Input_ptr->Num_Blocks;
+      return false;
+   }
+
+   Input_ptr->i_Block = i_block + 1;
+
+   return true;
+
+}  // Next_Selected_Block ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Removes from Events the events not selected; returns the number kept.
+
+static size_t  Keep_Selected_Events ( const Processed_TTE_File_type * Input_ptr, Processed_TTE_v2_type Events [], size_t Num_Events ) {
+
+   size_t  i_event;
+   size_t  Num_Kept = 0;
+
+
+   for ( i_event=0;  i_event < Num_Events;  i_event++ ) {
+
+      if ( Events [i_event] .Time_in_OneVariable >= Input_ptr->Begin_Time  &&
+           Events [i_event] .Time_in_OneVariable < Input_ptr->End_Time  &&
+           Events [i_event] .Detector < 32  &&  ( ( Input_ptr->Detector_Mask >> Events [i_event] .Detector ) & 1U ) ) {
+         Events [Num_Kept] = Events [i_event];
+         Num_Kept++;
+      }
+
+   }
+
+   return Num_Kept;
+
+}  // Keep_Selected_Events ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The zone map of a block of events: the range of times, the number of events of
+//  each detector and the numbers of events in bins of 16 channels.
+
+void Zone_Map_of_TTE_Events (
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   uint32_t Num_Events,
+
+   // Output argument:
+   TTE_Zone_Map_type * Zone_Map_ptr
+
+) {
+
+   uint32_t  i_event;
+   uint32_t  i_bin;
+
+
+   memset ( Zone_Map_ptr, 0, sizeof (TTE_Zone_Map_type) );
+
+   Zone_Map_ptr->Num_Events = Num_Events;
+   Zone_Map_ptr->Min_Time = UINT64_MAX;
+
+   for ( i_event=0;  i_event < Num_Events;  i_event++ ) {
+
+      if ( Events [i_event] .Time_in_OneVariable < Zone_Map_ptr->Min_Time )  Zone_Map_ptr->Min_Time = Events [i_event] .Time_in_OneVariable;
+      if ( Events [i_event] .Time_in_OneVariable > Zone_Map_ptr->Max_Time )  Zone_Map_ptr->Max_Time = Events [i_event] .Time_in_OneVariable;
+
+      if ( Events [i_event] .Detector < NUM_DET )  Zone_Map_ptr->Det_Counts [Events [i_event] .Detector] ++;
+
+      i_bin = Events [i_event] .SpecChannel / 16U;
+      if ( i_bin >= TTE_ZONE_CHANNEL_BINS )  i_bin = TTE_ZONE_CHANNEL_BINS - 1;
+      Zone_Map_ptr->Channel_Counts [i_bin] ++;
+
+   }
+
+}  // Zone_Map_of_TTE_Events ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Seek_Processed_TTE ( Processed_TTE_File_type * File_ptr, uint64_t Offset ) {
+
+   if ( fseek ( File_ptr->File_ptr, (long) Offset, SEEK_SET ) != 0 ) {
+      printf ( "\n\nSeek in processed TTE File failed -- Exiting!\n" );
+      exit (42);
+   }
+
+}  // Seek_Processed_TTE ()
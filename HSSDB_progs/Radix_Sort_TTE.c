@@ -0,0 +1,256 @@
+//  Sorts an array of processed TTE events into time order, in memory, with a
+//  parallel LSD (least-significant digit first) radix sort.
+
+//  The sort key of an event is its 64 bit time with the detector number as the
+//  least significant byte:   key = ( Time_in_OneVariable << 8 ) | Detector.
+//  GBM Unified Time fits in 48 bits (13.6 years of 2 microsec ticks), so the
+//  key can't overflow.   Sorting on this key gives the same order as Merge_TTE:
+//  time order, and if two detectors have an event with the same time, the event
+//  from the smaller detector number is first.   Because an LSD radix sort is
+//  stable, events with identical keys stay in their input order -- so the events
+//  of each detector stay in the order in which they were read.
+
+//  The key is sorted one byte ("digit") per pass, 7 passes for 56 bits.   A pass
+//  is skipped when every event has the same value of that digit, e.g., the most
+//  significant time bytes of any realistic dataset, so typically 5 or fewer
+//  passes are done.   Each pass is split across threads: every thread counts the
+//  digits of its own contiguous slice of the array, the counts are combined into
+//  the output offset of each (digit, thread) pair, which keeps the order stable,
+//  then every thread scatters its slice.
+
+//  Not specific to any one program: any unsorted list of events can be sorted,
+//  e.g., the concatenated output of several runs.
+
+
+#include "HSSDB_Progs_Header.h"
+
+#include <pthread.h>
+
+
+#define  RADIX_BITS     8U
+#define  RADIX_BUCKETS  256U
+#define  RADIX_PASSES   7U
+
+#define  MAX_SORT_THREADS  64U
+
+//  Arrays smaller than this are sorted with a single thread -- creating threads
+//  would cost more than it saves:
+#define  MIN_EVENTS_PER_THREAD  65536U
+
+
+//  local typedefs:
+
+typedef struct  Radix_Thread_type {
+   const Processed_TTE_v2_type * Source;
+   Processed_TTE_v2_type * Destination;
+   size_t  i_Beg;
+   size_t  i_End;
+   uint32_t  Shift;
+   size_t  Count [RADIX_BUCKETS];      // count pass: output;  scatter pass: input offsets
+} Radix_Thread_type;
+
+
+//  local function prototypes:
+
+static void * Radix_Count_Thread ( void * Arg_ptr );
+
+static void * Radix_Scatter_Thread ( void * Arg_ptr );
+
+static void  Radix_Run_Threads ( void * (* Thread_Function) ( void * ),
+                                 Radix_Thread_type  Thread_Args [], uint32_t Num_Threads );
+
+
+//  The sort key, as explained above:
+
+static inline uint64_t  Radix_Key ( const Processed_TTE_v2_type * Event_ptr ) {
+   return ( Event_ptr->Time_in_OneVariable << RADIX_BITS ) | Event_ptr->Detector;
+}
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Radix_Sort_Processed_TTE (
+
+   // Input/Output argument:
+   Processed_TTE_v2_type Events [],
+
+   // Input arguments:
+   size_t Num_Events,
+   uint32_t Num_Threads
+
+) {
+
+   Processed_TTE_v2_type * Work_Buffer;
+   Processed_TTE_v2_type * Source;
+   Processed_TTE_v2_type * Destination;
+   Processed_TTE_v2_type * Temp_ptr;
+
+   Radix_Thread_type  Thread_Args [MAX_SORT_THREADS];
+
+   size_t  Digit_Totals [RADIX_PASSES] [RADIX_BUCKETS];
+   size_t  Offset;
+   size_t  i;
+
+   uint32_t  i_pass, j_thread, k_digit;
+   _Bool  Pass_Needed;
+
+
+   if ( Num_Events < 2 )  return;
+
+   if ( Num_Threads < 1 )  Num_Threads = 1;
+   if ( Num_Threads > MAX_SORT_THREADS )  Num_Threads = MAX_SORT_THREADS;
+   if ( Num_Events / Num_Threads < MIN_EVENTS_PER_THREAD ) {
+      Num_Threads = (uint32_t) ( Num_Events / MIN_EVENTS_PER_THREAD );
+      if ( Num_Threads < 1 )  Num_Threads = 1;
+   }
+
+
+   //  One preliminary scan tabulates every digit of every key, so that we know
+   //  in advance which passes can be skipped.   The digits of the whole array don't
+   //  change from pass to pass, only their order.
+
+   memset ( Digit_Totals, 0, sizeof (Digit_Totals) );
+
+   for ( i=0;  i < Num_Events;  i++ ) {
+      uint64_t  Key = Radix_Key ( &Events [i] );
+      for ( i_pass=0;  i_pass < RADIX_PASSES;  i_pass++ )
+         Digit_Totals [i_pass] [ ( Key >> (RADIX_BITS * i_pass) ) & (RADIX_BUCKETS - 1) ] ++;
+   }
+
+
+   Work_Buffer = malloc ( Num_Events * sizeof (Processed_TTE_v2_type) );
+   if ( Work_Buffer == NULL ) {
+      printf ( "\n\nmalloc of radix sort work buffer failed. exiting.\n" );
+      exit (50);
+   }
+
+   Source = Events;
+   Destination = Work_Buffer;
+
+
+   for ( i_pass=0;  i_pass < RADIX_PASSES;  i_pass++ ) {  // loop over digits
+
+
+      //  Skip the pass if all of the events have the same value of this digit:
+
+      Pass_Needed = true;
+      for ( k_digit=0;  k_digit < RADIX_BUCKETS;  k_digit++ ) {
+         if ( Digit_Totals [i_pass] [k_digit] == Num_Events )  Pass_Needed = false;
+      }
+      if ( ! Pass_Needed )  continue;
+
+
+      //  Each thread counts the digits of its slice:
+
+      for ( j_thread=0;  j_thread < Num_Threads;  j_thread++ ) {
+         Thread_Args [j_thread] .Source = Source;
+         Thread_Args [j_thread] .Destination = Destination;
+         Thread_Args [j_thread] .i_Beg = Num_Events * j_thread / Num_Threads;
+         Thread_Args [j_thread] .i_End = Num_Events * (j_thread + 1) / Num_Threads;
+         Thread_Args [j_thread] .Shift = RADIX_BITS * i_pass;
+      }
+
+      Radix_Run_Threads ( Radix_Count_Thread, Thread_Args, Num_Threads );
+
+
+      //  Convert the counts into output offsets:  for each digit value in increasing order,
+      //  the slices in increasing order -- this is what makes the parallel sort stable.
+
+      Offset = 0;
+      for ( k_digit=0;  k_digit < RADIX_BUCKETS;  k_digit++ ) {
+         for ( j_thread=0;  j_thread < Num_Threads;  j_thread++ ) {
+            size_t  Count = Thread_Args [j_thread] .Count [k_digit];
+            Thread_Args [j_thread] .Count [k_digit] = Offset;
+            Offset += Count;
+         }
+      }
+
+      Radix_Run_Threads ( Radix_Scatter_Thread, Thread_Args, Num_Threads );
+
+      Temp_ptr = Source;
+      Source = Destination;
+      Destination = Temp_ptr;
+
+   }  // loop over digits
+
+
+   //  After an odd number of passes the sorted events are in the work buffer:
+
+   if ( Source != Events )  memcpy ( Events, Source, Num_Events * sizeof (Processed_TTE_v2_type) );
+
+   free ( Work_Buffer );
+
+}  // Radix_Sort_Processed_TTE ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void * Radix_Count_Thread ( void * Arg_ptr ) {
+
+   Radix_Thread_type * Thread_ptr = Arg_ptr;
+   size_t  i;
+
+
+   memset ( Thread_ptr->Count, 0, sizeof (Thread_ptr->Count) );
+
+   for ( i=Thread_ptr->i_Beg;  i < Thread_ptr->i_End;  i++ )
+      Thread_ptr->Count [ ( Radix_Key ( &Thread_ptr->Source [i] ) >> Thread_ptr->Shift ) & (RADIX_BUCKETS - 1) ] ++;
+
+   return NULL;
+
+}  // Radix_Count_Thread ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void * Radix_Scatter_Thread ( void * Arg_ptr ) {
+
+   Radix_Thread_type * Thread_ptr = Arg_ptr;
+   size_t  i;
+   uint64_t  k_digit;
+
+
+   for ( i=Thread_ptr->i_Beg;  i < Thread_ptr->i_End;  i++ ) {
+      k_digit = ( Radix_Key ( &Thread_ptr->Source [i] ) >> Thread_ptr->Shift ) & (RADIX_BUCKETS - 1);
+      Thread_ptr->Destination [ Thread_ptr->Count [k_digit] ++ ] = Thread_ptr->Source [i];
+   }
+
+   return NULL;
+
+}  // Radix_Scatter_Thread ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Runs Thread_Function on each of the Thread_Args and waits for all to finish.
+//  With one thread, the work is done on the calling thread.
+
+static void  Radix_Run_Threads ( void * (* Thread_Function) ( void * ),
+                                 Radix_Thread_type  Thread_Args [], uint32_t Num_Threads ) {
+
+   pthread_t  Threads [MAX_SORT_THREADS];
+   uint32_t  j_thread;
+
+
+   if ( Num_Threads == 1 ) {
+      Thread_Function ( &Thread_Args [0] );
+      return;
+   }
+
+   for ( j_thread=0;  j_thread < Num_Threads;  j_thread++ ) {
+      if ( pthread_create ( &Threads [j_thread], NULL, Thread_Function, &Thread_Args [j_thread] ) != 0 ) {
+         printf ( "\n\nFailed to create radix sort thread. exiting.\n" );
+         exit (51);
+      }
+   }
+
+   for ( j_thread=0;  j_thread < Num_Threads;  j_thread++ )  pthread_join ( Threads [j_thread], NULL );
+
+}  // Radix_Run_Threads ()
@@ -69,43 +69,28 @@ typedef enum {
 
 
 
-_Bool  ReSync (
-
-   FILE * file_pointer,
-   uint32_t * ExcessBytes,
-   uint32_t * ExcessNonZeroCnt
+//  The origin of the data, asked of the user once, by Ask_Data_Origin:
 
-) {
+static Data_Origin_type  DataOrigin = DATAORIGIN_UNDEFINED;
 
+static uint8_t CF_Byte1, CF_Byte2, CF_Byte3, CF_Byte4;
 
-   _Bool FoundSyncWord = false;
 
-   size_t num_read;
-   uint8_t Byte1, Byte2, Byte3, Byte4;
-   static uint8_t CF_Byte1, CF_Byte2, CF_Byte3, CF_Byte4;
-   uint32_t TwoWords [2];
 
-   char DataOriginChars [3];
-   static _Bool  FirstCall = true;
-   static Data_Origin_type  DataOrigin = DATAORIGIN_UNDEFINED;
 
+//  Asks the user about the origin of the data file -- from I&T, either from our SIIS
+//  or GD, or Level 0 data from the MOC pipeline, regardless of whether the SC was on
+//  the ground or in orbit.   The two data origins have different file layouts and
+//  ReSync will sync to the GBM HSSDB packets differently, as explained in the
+//  comments.   Asks only on the first call (ReSync calls it if the program hasn't);
+//  returns "IT" or "L0".
 
-   uint32_t TotBytesRead = 0;
+const char * Ask_Data_Origin ( void ) {
 
+   char DataOriginChars [3];
 
-   // ********************************************************************
-
-
-   //  On the first call, ask the user about the origin of the data file --
-   //  from I&T, either from our SIIS or GD, or Level 0 data from the MOC
-   //  pipeline, regardless of whether the SC was on the ground or in orbit.
-   //  The two data origins have different file layouts and this routine
-   //  will sync to the GBM HSSDB packets differently, as explained in the
-   //  comments.
-
-   if ( FirstCall ) {
 
-      FirstCall = false;
+   if ( DataOrigin == DATAORIGIN_UNDEFINED ) {
 
       printf ( "\nIs the origin of the data file I&T or Level 0 from the MOC?\n" );
       printf ( "Input either IT or L0: " );
@@ -141,7 +126,41 @@ _Bool  ReSync (
          exit (17);
       }
 
-   }  // FirstCall ?
+   }  // first call ?
+
+   return ( DataOrigin == DATAORIGIN_LEVEL0 )  ?  "L0"  :  "IT";
+
+}  // Ask_Data_Origin ()
+
+
+
+
+_Bool  ReSync (
+
+   FILE * file_pointer,
+   uint32_t * ExcessBytes,
+   uint32_t * ExcessNonZeroCnt
+
+) {
+
+
+   _Bool FoundSyncWord = false;
+
+   size_t num_read;
+   uint8_t Byte1, Byte2, Byte3, Byte4;
+   uint32_t TwoWords [2];
+
+
+   uint32_t TotBytesRead = 0;
+
+
+   // ********************************************************************
+
+
+   //  On the first call, ask the user about the origin of the data file, unless
+   //  the program already has.
+
+   if ( DataOrigin == DATAORIGIN_UNDEFINED )  Ask_Data_Origin ();
 
 
    if ( DataOrigin == DATAORIGIN_UNDEFINED )  exit (19);
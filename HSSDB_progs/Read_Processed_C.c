@@ -1,49 +1,61 @@
-
 #include "HSSDB_Progs_Header.h"
 
 
 //   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
 
 
-int main ( ) {
+//  Reads any version of the processed TTE file -- see TTE_Event_Reader.c
+
+//  Usage:
+//  ./Read_Processed.exe  [FileName  [Max_Events]]
+//  The default file is Processed_TTE.dat; by default all of the events are output.
+
+
+int main ( int argc, char * argv [] ) {
+
 
+   const char * Input_FileName_ptr = "Processed_TTE.dat";
+   uint64_t  Max_Events = UINT64_MAX;
 
-   FILE * ptr_to_DetectorFile;
+   TTE_Event_Reader_type  Reader;
 
-   Processed_TTE_type  TTE_Data;
+   const Processed_TTE_v2_type * Events;
 
-   uint32_t  i;
+   uint32_t  CoarseTime;
+   uint16_t  FineTime;
+
+   size_t  i;
    size_t  num_read;
 
    // ********************************************************************************************
 
-   ptr_to_DetectorFile = fopen ( "Processed_TTE.dat", "rb" );
-
-   if (ptr_to_DetectorFile == NULL ) {
-      printf ( "\n\nFailed to input TTE File.  Exiting!\n" );
-      exit (2);
+   if ( argc > 3 ) {
+      printf ( "Bad number of command line arguments: %d\n", argc - 1 );
+      printf ( "Example usage:  ./Read_Processed.exe  [Processed_TTE.dat  [1000]]\n" );
+      return 1;
    }
 
+   if ( argc >= 2 )  Input_FileName_ptr = argv [1];
+   if ( argc == 3 )  Max_Events = strtoull ( argv [2], NULL, 10 );
+
+   Open_TTE_Event_Reader ( Input_FileName_ptr, 0, &Reader );
 
-   for ( i=0; i < 1000; i++ ) {
 
-      num_read = fread ( &TTE_Data,
-                         sizeof ( TTE_Data ),
-                         1,
-                         ptr_to_DetectorFile );
+   while ( Reader.Num_Returned < Max_Events  &&  ( num_read = Next_TTE_Event_Batch ( &Reader, &Events ) ) > 0 ) {
 
-      if ( num_read == 1 ) {
+      if ( Reader.Num_Returned > Max_Events )  num_read -= (size_t) ( Reader.Num_Returned - Max_Events );
 
+      for ( i=0; i < num_read; i++ ) {
 
-         printf ( "%u  %u  %u  %u\n", TTE_Data.CoarseTime,  TTE_Data.FineTime, TTE_Data.Detector, TTE_Data.SpecChannel );
-      } else {
+         CoarseFine_from_IntegerTime ( Events [i] .Time_in_OneVariable, &CoarseTime, &FineTime );
 
-         printf ( "\n\nRead failed.  Exiting!\n" );
-         exit (3);
+         printf ( "%u  %u  %u  %u\n", CoarseTime,  FineTime, Events [i] .Detector, Events [i] .SpecChannel );
 
-      }
+      }  // i
+
+   }
 
-   }  // i
+   Close_TTE_Event_Reader ( &Reader );
 
 
    return (0);
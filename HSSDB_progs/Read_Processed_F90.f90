@@ -5,64 +5,74 @@ program Read_Processed
 
    use, intrinsic :: ISO_C_BINDING
 
+   use TTE_Reader
+
    implicit none
 
 
    ! - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-!   typedef struct   Processed_TTE_type {
-!      uint32_t CoarseTime;
-!      uint16_t FineTime;
-!      uint16_t  Detector;
-!      uint16_t  SpecChannel;
-!!      //uint64_t  Time_in_OneVariable;
-!   uint16_t PADDING;   // required for compatibility with other languages
-!   }  Processed_TTE_type;
-
-
-   !  should be unsigned integers, but those are not available in Fortran.
-   !  This will need "fixing" for both times.  The most-significant
-   !  bit should not get set for the other items.
+!   Reads any version of the processed TTE file, as output by Merge_TTE,
+!   via the module TTE_Reader (TTE_Reader_Module.f90).
 
-   type, bind (C) :: Processed_TTE_type
+!   Usage:
+!   ./Read_Processed_F90.exe  [FileName  [Max_Events]]
+!   The default file is Processed_TTE.dat; by default all of the events are output.
 
-      integer (C_INT32_T) :: CoarseTime
-      integer (C_INT16_T) :: FineTime
-      integer (C_INT16_T) :: Detector
-      integer (C_INT16_T) :: SpecChannel
-      integer (C_INT16_T) :: PADDING
+   !  Number of events read per call:
+   integer, parameter :: CHUNK = 1000000
 
-   end type
+   integer (int64), dimension (:), allocatable :: Times
+   integer (int16), dimension (:), allocatable :: Detectors, Channels
 
-   type (Processed_TTE_type) :: TTE_data
+   type (C_PTR) :: Reader
 
-   integer :: in_LUN
-   integer :: i
+   integer (int64) :: Num_Read, Num_Output, Max_Events
+   integer (int64) :: i
 
    integer (int64) :: CoarseTime_64
    integer (int32) :: FineTime_32
 
+   character (len=200) :: FileName, Arg
+
    ! - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 
-   open ( newunit=in_LUN, file="Processed_TTE.dat",  status="old", access="stream",   &
-             form="unformatted", action="read" )
+   FileName = "Processed_TTE.dat"
+   if ( COMMAND_ARGUMENT_COUNT () >= 1 )  call GET_COMMAND_ARGUMENT ( 1, FileName )
+
+   Max_Events = huge (Max_Events)
+   if ( COMMAND_ARGUMENT_COUNT () >= 2 ) then
+      call GET_COMMAND_ARGUMENT ( 2, Arg )
+      read (Arg, *)  Max_Events
+   end if
 
+   allocate ( Times (CHUNK), Detectors (CHUNK), Channels (CHUNK) )
 
-   do i=1,1000
+   Reader = Open_TTE_Reader ( FileName )
 
-      read (in_LUN)  TTE_data
+   Num_Output = 0
 
-      CoarseTime_64 = TTE_Data % CoarseTime
-      if ( CoarseTime_64 < 0_int64 )  CoarseTime_64 = CoarseTime_64  +  2_int64 ** 32_int64
+   do while ( Num_Output < Max_Events )
 
-      FineTime_32 = TTE_Data % FineTime
-      if ( FineTime_32 < 0_int32 )  FineTime_32 = FineTime_32  +  2_int32 ** 16_int32
+      Num_Read = Read_TTE_Events ( Reader, Times, Detectors, Channels )
+      if ( Num_Read == 0 )  exit
 
-      write (*, '( I10, 2X, I5, 3X, I2, 2X, I3 )' )   &
-         CoarseTime_64, FineTime_32, TTE_Data % Detector, TTE_Data % SpecChannel
+      do i=1, min ( Num_Read, Max_Events - Num_Output )
+
+         CoarseTime_64 = Times (i) / 50000_int64
+         FineTime_32 = int ( mod ( Times (i), 50000_int64 ), int32 )
+
+         write (*, '( I10, 2X, I5, 3X, I2, 2X, I3 )' )   &
+            CoarseTime_64, FineTime_32, Detectors (i), Channels (i)
+
+      end do
+
+      Num_Output = Num_Output + min ( Num_Read, Max_Events - Num_Output )
 
    end do
 
+   call Close_TTE_Reader ( Reader )
+
 
 end program Read_Processed
@@ -1,61 +1,56 @@
-
 #include "HSSDB_Progs_Header.h"
 
 
 //   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
 
 
+//  Reads a per-detector TTE file as output by Extract_TTE, e.g.,
+//  ./Read_TTE_1det.exe  GLAST_2008289_053900_GBTTE.TTE_Det_03.dat  [Max_Events]
+//  -- see TTE_Event_Reader.c.   By default all of the events are output.
+
+
 int main ( int argc, char * argv [] ) {
 
 
-   size_t  FileName_Length;
-   char * Input_FileName_ptr;
+   uint64_t  Max_Events = UINT64_MAX;
+
+   TTE_Event_Reader_type  Reader;
 
-   FILE * ptr_to_DetectorFile;
+   const Processed_TTE_v2_type * Events;
 
-   TTE_Data_type  TTE_Data;
+   uint32_t  CoarseTime;
+   uint16_t  FineTime;
 
-   uint32_t  i;
+   size_t  i;
    size_t  num_read;
 
    // ********************************************************************************************
 
-   if ( argc != 2 ) {
+   if ( argc != 2  &&  argc != 3 ) {
       printf ( "Bad number of command line arguments: %d\n", argc - 1 );
       return 1;
    }
 
-   FileName_Length = strlen ( argv [1] );
-   Input_FileName_ptr   = malloc ( FileName_Length );
-   memcpy ( Input_FileName_ptr,  argv [1], FileName_Length );
+   if ( argc == 3 )  Max_Events = strtoull ( argv [2], NULL, 10 );
 
-   ptr_to_DetectorFile = fopen ( Input_FileName_ptr, "rb" );
-
-   if (ptr_to_DetectorFile == NULL ) {
-      printf ( "\n\nFailed to input TTE File.  Exiting!\n" );
-      exit (2);
-   }
+   Open_TTE_Event_Reader ( argv [1], 0, &Reader );
 
 
-   for ( i=0; i < 1000; i++ ) {
+   while ( Reader.Num_Returned < Max_Events  &&  ( num_read = Next_TTE_Event_Batch ( &Reader, &Events ) ) > 0 ) {
 
-      num_read = fread ( &TTE_Data,
-                         sizeof ( TTE_Data ),
-                         1,
-                         ptr_to_DetectorFile );
+      if ( Reader.Num_Returned > Max_Events )  num_read -= (size_t) ( Reader.Num_Returned - Max_Events );
 
-      if ( num_read == 1 ) {
+      for ( i=0; i < num_read; i++ ) {
 
+         CoarseFine_from_IntegerTime ( Events [i] .Time_in_OneVariable, &CoarseTime, &FineTime );
 
-         printf ( "%u  %u  %u\n", TTE_Data.CoarseTime, TTE_Data.FineTime, TTE_Data.SpecChannel );
-      } else {
+         printf ( "%u  %u  %u\n", CoarseTime, FineTime, Events [i] .SpecChannel );
 
-         printf ( "\n\nRead failed.  Exiting!\n" );
-         exit (3);
+      }  // i
 
-      }
+   }
 
-   }  // i
+   Close_TTE_Event_Reader ( &Reader );
 
 
    return (0);
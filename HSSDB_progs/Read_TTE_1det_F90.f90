@@ -1,38 +1,30 @@
-program Read_Processed
+program Read_TTE_1det
 
 
    use, intrinsic :: ISO_FORTRAN_ENV
 
    use, intrinsic :: ISO_C_BINDING
 
+   use TTE_Reader
+
    implicit none
 
 
    ! - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-!   typedef  struct   TTE_Data_type {
-!      uint32_t CoarseTime;
-!      uint16_t FineTime;
-!      uint16_t SpecChannel;
-!   } TTE_Data_type;
-
-
-   !  should be unsigned integers, but those are not available in Fortran.
-   !  This will need "fixing" for the Coarse time.  The most-significant
-   !  bit should not get set for the other items.
-
-   type, bind (C) :: TTE_Data_type
+!   Reads a per-detector TTE file as output by Extract_TTE (the name must contain
+!   .TTE_Det_NN, as output), via the module TTE_Reader (TTE_Reader_Module.f90),
+!   and outputs the first 1000 events.
 
-      integer (C_INT32_T) :: CoarseTime
-      integer (C_INT16_T) :: FineTime
-      integer (C_INT16_T) :: SpecChannel
+   integer, parameter :: NUM_EVENTS = 1000
 
-   end type
+   integer (int64), dimension (NUM_EVENTS) :: Times
+   integer (int16), dimension (NUM_EVENTS) :: Detectors, Channels
 
-   type (TTE_Data_type) :: TTE_data
+   type (C_PTR) :: Reader
 
-   integer :: in_LUN
-   integer :: i
+   integer (int64) :: Num_Read
+   integer (int64) :: i
 
    integer (int64) :: CoarseTime_64
    integer (int32) :: FineTime_32
@@ -45,24 +37,21 @@ program Read_Processed
 
    call GET_COMMAND_ARGUMENT ( 1, FileName )
 
-   open ( newunit=in_LUN, file=FileName,  status="old", access="stream",   &
-             form="unformatted", action="read" )
+   Reader = Open_TTE_Reader ( FileName )
 
+   Num_Read = Read_TTE_Events ( Reader, Times, Detectors, Channels )
 
-   do i=1,1000
+   do i=1,Num_Read
 
-      read (in_LUN)  TTE_data
-
-      CoarseTime_64 = TTE_Data % CoarseTime
-      if ( CoarseTime_64 < 0_int64 )  CoarseTime_64 = CoarseTime_64  +  2_int64 ** 32_int64
-
-      FineTime_32 = TTE_Data % FineTime
-      if ( FineTime_32 < 0_int32 )  FineTime_32 = FineTime_32  +  2_int32 ** 16_int32
+      CoarseTime_64 = Times (i) / 50000_int64
+      FineTime_32 = int ( mod ( Times (i), 50000_int64 ), int32 )
 
       write (*, '( I10, 2X, I5, 3X, I3 )' )   &
-         CoarseTime_64, FineTime_32, TTE_Data % SpecChannel
+         CoarseTime_64, FineTime_32, Channels (i)
 
    end do
 
+   call Close_TTE_Reader ( Reader )
+
 
-end program Read_Processed
+end program Read_TTE_1det
@@ -0,0 +1,1090 @@
+//  Local cache of the results of the programs, so that running a program again on the
+//  same input files with the same parameters -- from another script, or by another
+//  user -- takes the outputs of the first run instead of computing them again.
+
+//  The cache is used only if the environment variable HSSDB_CACHE_DIR names a
+//  directory (created if needed), e.g.,
+//     export HSSDB_CACHE_DIR=/data/gbm/hssdb_cache
+//  Its size is limited to HSSDB_CACHE_MAX_MB megabytes (default 10240): when a new
+//  result takes it over the limit, the results least recently used are removed.
+
+//  The key of a result is a hash of a description of the run: the program and
+//  HSSDB_PROGS_VERSION, the parameters, the size and a hash (64 bit XXH64) of the
+//  contents of each input file, and the names of the output files.   The inputs are
+//  identified by their contents, not their names, so a copy of an L0 file elsewhere
+//  finds the same result; a program whose outputs contain the names of its inputs
+//  adds them as parameters.   Each result is a directory, HSSDB_CACHE_DIR/Key:
+//     description   the description, compared in full when the key is found,
+//     manifest      for each output, whether it was written, its size and CRC32C,
+//     0, 1, ...     the outputs.
+
+//  Usage:
+//     Open_Result_Cache ( "Merge_TTE", &Cache );
+//     Add_Cache_Parameter ( &Cache, "version", "2" );     // ... all that affect the outputs
+//     Add_Cache_Input ( &Cache, InputFileName );           // ... for each input
+//     Add_Cache_Output ( &Cache, OutputFileName );         // ... for each possible output
+//     if ( Fetch_Cached_Results ( &Cache ) )  return 0;   // outputs now in place
+//     ... compute and write the outputs ...
+//     Store_Cached_Results ( &Cache );
+
+//  On a hit, the stored outputs are checked against their sizes and CRC32Cs, then copied
+//  to the output names, replacing any old files.   The outputs are stored as copies made
+//  read-only, so the files the user receives never share an inode with the cache and
+//  keep their usual permissions; writing to them later cannot alter the cache.   On a
+//  miss the old outputs are removed first.   An output named NULL is the
+//  standard output: on a miss it is captured to a file and shown when the program
+//  finishes (or exits), on a hit the stored copy is shown.
+
+//  Each hit, miss, store and eviction is logged to HSSDB_CACHE_DIR/cache.log, from
+//  which Cache_TTE.exe reports the statistics.   Problems with the cache itself are
+//  reported but are not fatal: the program then simply computes its results.
+
+
+#define  _POSIX_C_SOURCE  200809L
+
+#include "HSSDB_Progs_Header.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+
+#define  DEFAULT_CACHE_MAX_MB   10240U
+
+#define  CACHE_LOG_NAME   "cache.log"
+
+#define  PRIME64_1   UINT64_C(0x9E3779B185EBCA87)
+#define  PRIME64_2   UINT64_C(0xC2B2AE3D27D4EB4F)
+#define  PRIME64_3   UINT64_C(0x165667B19E3779F9)
+#define  PRIME64_4   UINT64_C(0x85EBCA77C2B2AE63)
+#define  PRIME64_5   UINT64_C(0x27D4EB2F165667C5)
+
+
+//  local typedefs:
+
+typedef struct  Cache_Entry_type {
+   char  Key [17];
+   time_t  Last_Used;
+   uint64_t  Bytes;
+} Cache_Entry_type;
+
+
+//  local function prototypes:
+
+static void  Add_to_Description ( Result_Cache_type * Cache_ptr, const char * Text );
+
+static char *  Cache_Path ( const char * Directory, const char * Name, const char * Name2 );
+
+static _Bool  Map_File ( const char * FileName, const unsigned char ** Map_ptr, size_t * Bytes_ptr );
+
+static void  Unmap_File ( const unsigned char * Map, size_t Bytes );
+
+static _Bool  Copy_File ( const char * From_FileName, const char * To_FileName );
+
+static void  Show_File ( const char * FileName );
+
+static void  Log_Cache_Event ( const char * Directory, const char * Event, const char * Key, uint64_t Bytes, const char * Program );
+
+static void  Remove_Cache_Entry ( const char * Directory, const char * Key );
+
+static _Bool  Check_Cache_Entry ( const Result_Cache_type * Cache_ptr, const char * Entry, _Bool Present [], uint64_t * Bytes_ptr );
+
+static void  Release_Captured_Stdout ( void );
+
+static void  Release_Captured_Stdout_at_Exit ( void );
+
+static int  Compare_Last_Used ( const void * A_ptr, const void * B_ptr );
+
+static uint64_t  Hash64 ( const void * Data, size_t Num_Bytes );
+
+
+//  The cache whose standard output is being captured, for Release_Captured_Stdout:
+
+static Result_Cache_type *  Capturing_Cache_ptr = NULL;
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Open_Result_Cache (
+
+   // Input argument:
+   const char * Program,
+
+   // Output argument:
+   Result_Cache_type * Cache_ptr
+
+) {
+
+   const char *  Directory;
+
+
+   memset ( Cache_ptr, 0, sizeof (Result_Cache_type) );
+   Cache_ptr->Program = Program;
+   Cache_ptr->Saved_Stdout = -1;
+
+   Directory = getenv ( "HSSDB_CACHE_DIR" );
+   if ( Directory == NULL  ||  Directory [0] == '\0' )  return;
+
+   mkdir ( Directory, 0777 );
+
+   Cache_ptr->Directory = Cache_Path ( Directory, NULL, NULL );
+   Cache_ptr->Enabled = true;
+
+   Add_Cache_Parameter ( Cache_ptr, "program", Program );
+   Add_Cache_Parameter ( Cache_ptr, "programs version", HSSDB_PROGS_VERSION );
+
+}  // Open_Result_Cache ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Adds a parameter that affects the outputs, e.g., "timescale" and "8000".
+
+void Add_Cache_Parameter (
+
+   // Input/Output argument:
+   Result_Cache_type * Cache_ptr,
+
+   // Input arguments:
+   const char * Name,
+   const char * Value
+
+) {
+
+   if ( ! Cache_ptr->Enabled )  return;
+
+   Add_to_Description ( Cache_ptr, Name );
+   Add_to_Description ( Cache_ptr, ": " );
+   Add_to_Description ( Cache_ptr, Value );
+   Add_to_Description ( Cache_ptr, "\n" );
+
+}  // Add_Cache_Parameter ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Adds an input file, by the hash of its contents.   If it can't be read, the cache
+//  is not used.
+
+void Add_Cache_Input (
+
+   // Input/Output argument:
+   Result_Cache_type * Cache_ptr,
+
+   // Input argument:
+   const char * FileName
+
+) {
+
+   const unsigned char *  Map;
+   size_t  Bytes;
+   char  Line [80];
+
+
+   if ( ! Cache_ptr->Enabled )  return;
+
+   if ( ! Map_File ( FileName, &Map, &Bytes ) ) {
+      Cache_ptr->Enabled = false;
+      return;
+   }
+
+   sprintf ( Line, "input: %llu bytes, hash %016llx\n", (long long unsigned int) Bytes, (long long unsigned int) Hash64 ( Map, Bytes ) );
+   Add_to_Description ( Cache_ptr, Line );
+
+   Unmap_File ( Map, Bytes );
+
+}  // Add_Cache_Input ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Adds a file that the program may output; NULL for the standard output.   The
+//  name must remain valid until Store_Cached_Results.
+
+void Add_Cache_Output (
+
+   // Input/Output argument:
+   Result_Cache_type * Cache_ptr,
+
+   // Input argument:
+   const char * FileName
+
+) {
+
+   if ( ! Cache_ptr->Enabled )  return;
+
+   if ( Cache_ptr->Num_Outputs == MAX_CACHE_OUTPUTS ) {
+      printf ( "\n\nToo many outputs for the result cache -- Exiting!\n" );
+      exit (140);
+   }
+
+   Cache_ptr->Outputs [Cache_ptr->Num_Outputs++] = FileName;
+
+   Add_Cache_Parameter ( Cache_ptr, "output", ( FileName == NULL )  ?  "(standard output)"  :  FileName );
+
+}  // Add_Cache_Output ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Looks for the result in the cache.   If found (true), the outputs are put in
+//  place.   If not (false), the old outputs are removed and the capture of the
+//  standard output, if it is an output, is started.
+
+_Bool Fetch_Cached_Results (
+
+   // Input/Output argument:
+   Result_Cache_type * Cache_ptr
+
+) {
+
+   char *  Entry;
+   char *  Stored_FileName;
+   char  Name [40];
+   _Bool  Present [MAX_CACHE_OUTPUTS];
+   uint64_t  Bytes = 0;
+   uint32_t  i_output;
+   int  fd;
+
+
+   if ( ! Cache_ptr->Enabled )  return false;
+
+   sprintf ( Cache_ptr->Key, "%016llx", (long long unsigned int) Hash64 ( Cache_ptr->Description, Cache_ptr->Description_Length ) );
+
+   Entry = Cache_Path ( Cache_ptr->Directory, Cache_ptr->Key, NULL );
+
+
+   if ( Check_Cache_Entry ( Cache_ptr, Entry, Present, &Bytes ) ) {  // hit ?
+
+      printf ( "\nResults of %s found in the result cache, %s\n", Cache_ptr->Program, Entry );
+
+      for ( i_output=0;  i_output < Cache_ptr->Num_Outputs;  i_output++ ) {
+
+         sprintf ( Name, "%u", i_output );
+         Stored_FileName = Cache_Path ( Entry, Name, NULL );
+
+         if ( Cache_ptr->Outputs [i_output] == NULL ) {
+            if ( Present [i_output] )  Show_File ( Stored_FileName );
+         } else {
+            unlink ( Cache_ptr->Outputs [i_output] );
+            if ( Present [i_output]  &&  ! Copy_File ( Stored_FileName, Cache_ptr->Outputs [i_output] ) ) {
+               printf ( "\n\nFailed to output '%s' from the result cache -- Exiting!\n", Cache_ptr->Outputs [i_output] );
+               exit (141);
+            }
+         }
+
+         free ( Stored_FileName );
+
+      }
+
+      //  The time of last use, for the eviction of the least recently used:
+
+      utimensat ( AT_FDCWD, Entry, NULL, 0 );
+
+      Log_Cache_Event ( Cache_ptr->Directory, "hit", Cache_ptr->Key, Bytes, Cache_ptr->Program );
+      free ( Entry );
+
+      return true;
+
+   }  // hit ?
+
+
+   //  Miss:
+
+   free ( Entry );
+
+   Log_Cache_Event ( Cache_ptr->Directory, "miss", Cache_ptr->Key, 0, Cache_ptr->Program );
+
+   for ( i_output=0;  i_output < Cache_ptr->Num_Outputs;  i_output++ ) {  // prepare outputs
+
+      if ( Cache_ptr->Outputs [i_output] != NULL ) {
+         unlink ( Cache_ptr->Outputs [i_output] );
+      } else if ( Cache_ptr->Stdout_FileName == NULL ) {
+
+         //  Capture the standard output to a file in the cache directory:
+
+         sprintf ( Name, "stdout.%ld", (long) getpid () );
+         Cache_ptr->Stdout_FileName = Cache_Path ( Cache_ptr->Directory, Name, NULL );
+
+         fflush ( stdout );
+         fd = open ( Cache_ptr->Stdout_FileName, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+         Cache_ptr->Saved_Stdout = dup ( STDOUT_FILENO );
+
+         if ( fd < 0  ||  Cache_ptr->Saved_Stdout < 0  ||  dup2 ( fd, STDOUT_FILENO ) < 0 ) {
+            printf ( "\nFailed to capture the standard output for the result cache; the cache is not used.\n" );
+            if ( fd >= 0 )  close ( fd );
+            if ( Cache_ptr->Saved_Stdout >= 0 )  close ( Cache_ptr->Saved_Stdout );
+            Cache_ptr->Saved_Stdout = -1;
+            Cache_ptr->Enabled = false;
+            return false;
+         }
+
+         close ( fd );
+
+         atexit ( Release_Captured_Stdout_at_Exit );
+         Capturing_Cache_ptr = Cache_ptr;
+
+      }
+
+   }  // prepare outputs
+
+   return false;
+
+}  // Fetch_Cached_Results ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Stores the outputs, once written and closed, after a miss; then removes the
+//  least recently used results if the cache is over its size limit.
+
+void Store_Cached_Results (
+
+   // Input/Output argument:
+   Result_Cache_type * Cache_ptr
+
+) {
+
+   char  Name [40];
+   char *  Temporary_Entry;
+   char *  Entry;
+   char *  Stored_FileName;
+   const char *  Output_FileName;
+   FILE *  File_ptr;
+   struct stat  File_Status;
+
+   const unsigned char *  Map;
+   size_t  Bytes;
+   uint64_t  Total_Bytes = 0;
+   uint32_t  i_output;
+
+   const char *  Max_MB_ptr;
+   uint64_t  Max_MB = DEFAULT_CACHE_MAX_MB;
+
+
+   if ( ! Cache_ptr->Enabled )  return;
+
+   Release_Captured_Stdout ();
+
+   //  The entry is made under a temporary name, then renamed, so that other programs
+   //  never see a partial entry:
+
+   sprintf ( Name, "tmp.%s.%ld", Cache_ptr->Key, (long) getpid () );
+   Temporary_Entry = Cache_Path ( Cache_ptr->Directory, Name, NULL );
+
+   if ( mkdir ( Temporary_Entry, 0755 ) != 0 ) {
+      printf ( "\nFailed to create '%s'; the results are not stored in the cache.\n", Temporary_Entry );
+      free ( Temporary_Entry );
+      return;
+   }
+
+   Stored_FileName = Cache_Path ( Temporary_Entry, "manifest", NULL );
+   File_ptr = fopen ( Stored_FileName, "w" );
+   free ( Stored_FileName );
+   if ( File_ptr == NULL ) {
+      printf ( "\nFailed to write to '%s'; the results are not stored in the cache.\n", Temporary_Entry );
+      Remove_Cache_Entry ( Cache_ptr->Directory, Name );
+      free ( Temporary_Entry );
+      return;
+   }
+
+   for ( i_output=0;  i_output < Cache_ptr->Num_Outputs;  i_output++ ) {  // loop over outputs
+
+      Output_FileName = ( Cache_ptr->Outputs [i_output] == NULL )  ?  Cache_ptr->Stdout_FileName  :  Cache_ptr->Outputs [i_output];
+
+      sprintf ( Name, "%u", i_output );
+      Stored_FileName = Cache_Path ( Temporary_Entry, Name, NULL );
+
+      if ( Output_FileName != NULL  &&  stat ( Output_FileName, &File_Status ) == 0  &&  S_ISREG ( File_Status.st_mode )  &&
+           Copy_File ( Output_FileName, Stored_FileName )  &&
+           Map_File ( Stored_FileName, &Map, &Bytes ) ) {
+         chmod ( Stored_FileName, 0444 );
+         fprintf ( File_ptr, "%u 1 %llu %08X\n", i_output, (long long unsigned int) Bytes, CRC32C ( Map, Bytes ) );
+         Unmap_File ( Map, Bytes );
+         Total_Bytes += Bytes;
+      } else {
+         fprintf ( File_ptr, "%u 0 0 00000000\n", i_output );
+      }
+
+      free ( Stored_FileName );
+
+   }  // loop over outputs
+
+   fclose ( File_ptr );
+
+   Stored_FileName = Cache_Path ( Temporary_Entry, "description", NULL );
+   File_ptr = fopen ( Stored_FileName, "w" );
+   free ( Stored_FileName );
+   if ( File_ptr != NULL ) {
+      fwrite ( Cache_ptr->Description, 1, Cache_ptr->Description_Length, File_ptr );
+      fclose ( File_ptr );
+   }
+
+   Entry = Cache_Path ( Cache_ptr->Directory, Cache_ptr->Key, NULL );
+
+   if ( File_ptr == NULL  ||  rename ( Temporary_Entry, Entry ) != 0 ) {
+      //  e.g., another program stored the same result meanwhile
+      sprintf ( Name, "tmp.%s.%ld", Cache_ptr->Key, (long) getpid () );
+      Remove_Cache_Entry ( Cache_ptr->Directory, Name );
+   } else {
+      Log_Cache_Event ( Cache_ptr->Directory, "store", Cache_ptr->Key, Total_Bytes, Cache_ptr->Program );
+   }
+
+   free ( Entry );
+   free ( Temporary_Entry );
+
+   if ( Cache_ptr->Stdout_FileName != NULL ) {
+      unlink ( Cache_ptr->Stdout_FileName );
+      free ( Cache_ptr->Stdout_FileName );
+      Cache_ptr->Stdout_FileName = NULL;
+   }
+
+   Max_MB_ptr = getenv ( "HSSDB_CACHE_MAX_MB" );
+   if ( Max_MB_ptr != NULL  &&  Max_MB_ptr [0] != '\0' )  Max_MB = strtoull ( Max_MB_ptr, NULL, 10 );
+
+   Trim_Result_Cache ( Cache_ptr->Directory, Max_MB << 20 );
+
+}  // Store_Cached_Results ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Removes the least recently used results until the cache holds at most Max_Bytes.
+
+void Trim_Result_Cache (
+
+   // Input arguments:
+   const char * Directory,
+   uint64_t Max_Bytes
+
+) {
+
+   DIR *  Dir_ptr;
+   DIR *  Entry_Dir_ptr;
+   struct dirent *  Dir_Entry_ptr;
+   struct stat  File_Status;
+   char *  Entry;
+   char *  File_Path;
+
+   Cache_Entry_type *  Entries = NULL;
+   Cache_Entry_type *  New_Entries;
+   size_t  Num_Entries = 0;
+   size_t  Capacity = 0;
+   size_t  i_entry;
+   uint64_t  Total_Bytes = 0;
+
+
+   Dir_ptr = opendir ( Directory );
+   if ( Dir_ptr == NULL )  return;
+
+   while ( ( Dir_Entry_ptr = readdir ( Dir_ptr ) ) != NULL ) {  // loop over results
+
+      //  The results are the directories named by a key, 16 hex digits:
+
+      if ( strlen ( Dir_Entry_ptr->d_name ) != 16  ||  strspn ( Dir_Entry_ptr->d_name, "0123456789abcdef" ) != 16 )  continue;
+
+      Entry = Cache_Path ( Directory, Dir_Entry_ptr->d_name, NULL );
+
+      if ( stat ( Entry, &File_Status ) == 0  &&  S_ISDIR ( File_Status.st_mode ) ) {
+
+         if ( Num_Entries == Capacity ) {
+            Capacity = ( Capacity == 0 )  ?  256  :  2 * Capacity;
+            New_Entries = realloc ( Entries, Capacity * sizeof (Cache_Entry_type) );
+            if ( New_Entries == NULL ) {
+               printf ( "\n\nmalloc of result cache list failed. exiting.\n" );
+               exit (142);
+            }
+            Entries = New_Entries;
+         }
+
+         strcpy ( Entries [Num_Entries] .Key, Dir_Entry_ptr->d_name );
+         Entries [Num_Entries] .Last_Used = File_Status.st_mtime;
+         Entries [Num_Entries] .Bytes = 0;
+
+         Entry_Dir_ptr = opendir ( Entry );
+         if ( Entry_Dir_ptr != NULL ) {
+            while ( ( Dir_Entry_ptr = readdir ( Entry_Dir_ptr ) ) != NULL ) {
+               File_Path = Cache_Path ( Entry, Dir_Entry_ptr->d_name, NULL );
+               if ( stat ( File_Path, &File_Status ) == 0  &&  S_ISREG ( File_Status.st_mode ) )
+                  Entries [Num_Entries] .Bytes += (uint64_t) File_Status.st_size;
+               free ( File_Path );
+            }
+            closedir ( Entry_Dir_ptr );
+         }
+
+         Total_Bytes += Entries [Num_Entries] .Bytes;
+         Num_Entries++;
+
+      }
+
+      free ( Entry );
+
+   }  // loop over results
+
+   closedir ( Dir_ptr );
+
+
+   //  Remove the least recently used first:
+
+   if ( Total_Bytes > Max_Bytes ) {
+
+      qsort ( Entries, Num_Entries, sizeof (Cache_Entry_type), Compare_Last_Used );
+
+      for ( i_entry=0;  i_entry < Num_Entries  &&  Total_Bytes > Max_Bytes;  i_entry++ ) {
+         Remove_Cache_Entry ( Directory, Entries [i_entry] .Key );
+         Log_Cache_Event ( Directory, "evict", Entries [i_entry] .Key, Entries [i_entry] .Bytes, "-" );
+         Total_Bytes -= Entries [i_entry] .Bytes;
+      }
+
+   }
+
+   free ( Entries );
+
+}  // Trim_Result_Cache ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Lists the statistics of the cache from its log, and its current size.
+
+void Result_Cache_Statistics (
+
+   // Input argument:
+   const char * Directory
+
+) {
+
+   char *  Log_FileName;
+   FILE *  Log_File_ptr;
+   char  Line [256];
+   char  Event [16];
+   char  Program [128];
+   long long unsigned int  Bytes;
+   long long int  Time;
+
+   uint64_t  Num_Hits = 0, Num_Misses = 0, Num_Stores = 0, Num_Evictions = 0;
+   uint64_t  Bytes_Hit = 0, Bytes_Stored = 0, Bytes_Evicted = 0;
+
+   DIR *  Dir_ptr;
+   struct dirent *  Dir_Entry_ptr;
+   uint64_t  Num_Entries = 0;
+
+
+   Log_FileName = Cache_Path ( Directory, CACHE_LOG_NAME, NULL );
+   Log_File_ptr = fopen ( Log_FileName, "r" );
+
+   if ( Log_File_ptr != NULL ) {
+
+      while ( fgets ( Line, sizeof (Line), Log_File_ptr ) != NULL ) {
+
+         if ( sscanf ( Line, "%lld %15s %*s %llu %127s", &Time, Event, &Bytes, Program ) != 4 )  continue;
+
+         if ( strcmp ( Event, "hit" ) == 0 ) {
+            Num_Hits++;
+            Bytes_Hit += Bytes;
+         } else if ( strcmp ( Event, "miss" ) == 0 ) {
+            Num_Misses++;
+         } else if ( strcmp ( Event, "store" ) == 0 ) {
+            Num_Stores++;
+            Bytes_Stored += Bytes;
+         } else if ( strcmp ( Event, "evict" ) == 0 ) {
+            Num_Evictions++;
+            Bytes_Evicted += Bytes;
+         }
+
+      }
+
+      fclose ( Log_File_ptr );
+
+   }
+
+   free ( Log_FileName );
+
+   Dir_ptr = opendir ( Directory );
+   if ( Dir_ptr != NULL ) {
+      while ( ( Dir_Entry_ptr = readdir ( Dir_ptr ) ) != NULL )
+         if ( strlen ( Dir_Entry_ptr->d_name ) == 16  &&  strspn ( Dir_Entry_ptr->d_name, "0123456789abcdef" ) == 16 )  Num_Entries++;
+      closedir ( Dir_ptr );
+   }
+
+   printf ( "Result cache %s:\n", Directory );
+   printf ( "%10llu hits, %.1f MB of outputs reused\n", (long long unsigned int) Num_Hits, (double) Bytes_Hit / 1048576.0 );
+   printf ( "%10llu misses\n", (long long unsigned int) Num_Misses );
+   if ( Num_Hits + Num_Misses > 0 )
+      printf ( "%10.1f %% hit rate\n", 100.0 * (double) Num_Hits / (double) ( Num_Hits + Num_Misses ) );
+   printf ( "%10llu results stored, %.1f MB\n", (long long unsigned int) Num_Stores, (double) Bytes_Stored / 1048576.0 );
+   printf ( "%10llu results evicted, %.1f MB\n", (long long unsigned int) Num_Evictions, (double) Bytes_Evicted / 1048576.0 );
+   printf ( "%10llu results now in the cache\n", (long long unsigned int) Num_Entries );
+
+}  // Result_Cache_Statistics ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Add_to_Description ( Result_Cache_type * Cache_ptr, const char * Text ) {
+
+   size_t  Length;
+   char *  New_Description;
+
+
+   Length = strlen ( Text );
+
+   if ( Cache_ptr->Description_Length + Length + 1 > Cache_ptr->Description_Capacity ) {
+      Cache_ptr->Description_Capacity = 2 * ( Cache_ptr->Description_Length + Length + 1 ) + 1024;
+      New_Description = realloc ( Cache_ptr->Description, Cache_ptr->Description_Capacity );
+      if ( New_Description == NULL ) {
+         printf ( "\n\nmalloc of result cache description failed. exiting.\n" );
+         exit (142);
+      }
+      Cache_ptr->Description = New_Description;
+   }
+
+   memcpy ( Cache_ptr->Description + Cache_ptr->Description_Length, Text, Length + 1 );
+   Cache_ptr->Description_Length += Length;
+
+}  // Add_to_Description ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Returns Directory/Name/Name2 (Name and Name2 optional) in a new string.
+
+static char *  Cache_Path ( const char * Directory, const char * Name, const char * Name2 ) {
+
+   char *  Path;
+
+
+   Path = malloc ( strlen ( Directory ) + ( Name != NULL  ?  strlen ( Name ) + 1  :  0 ) + ( Name2 != NULL  ?  strlen ( Name2 ) + 1  :  0 ) + 1 );
+   if ( Path == NULL ) {
+      printf ( "\n\nmalloc call failed.  Exiting.\n" );
+      exit (142);
+   }
+
+   strcpy ( Path, Directory );
+   if ( Name != NULL ) {
+      strcat ( Path, "/" );
+      strcat ( Path, Name );
+   }
+   if ( Name2 != NULL ) {
+      strcat ( Path, "/" );
+      strcat ( Path, Name2 );
+   }
+
+   return Path;
+
+}  // Cache_Path ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Maps the whole file into memory; an empty file gives *Map_ptr = NULL.
+
+static _Bool  Map_File ( const char * FileName, const unsigned char ** Map_ptr, size_t * Bytes_ptr ) {
+
+   int  fd;
+   struct stat  File_Status;
+   void *  Mapped_ptr;
+
+
+   *Map_ptr = NULL;
+   *Bytes_ptr = 0;
+
+   fd = open ( FileName, O_RDONLY );
+   if ( fd < 0 )  return false;
+
+   if ( fstat ( fd, &File_Status ) != 0 ) {
+      close ( fd );
+      return false;
+   }
+
+   if ( File_Status.st_size > 0 ) {
+      Mapped_ptr = mmap ( NULL, (size_t) File_Status.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( Mapped_ptr == MAP_FAILED ) {
+         close ( fd );
+         return false;
+      }
+      posix_madvise ( Mapped_ptr, (size_t) File_Status.st_size, POSIX_MADV_SEQUENTIAL );
+      *Map_ptr = Mapped_ptr;
+      *Bytes_ptr = (size_t) File_Status.st_size;
+   }
+
+   close ( fd );
+
+   return true;
+
+}  // Map_File ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Unmap_File ( const unsigned char * Map, size_t Bytes ) {
+
+   if ( Map != NULL )  munmap ( (void *) (uintptr_t) Map, Bytes );
+
+}  // Unmap_File ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static _Bool  Copy_File ( const char * From_FileName, const char * To_FileName ) {
+
+   const unsigned char *  Map;
+   size_t  Bytes;
+   FILE *  File_ptr;
+   _Bool  OK_Copy;
+
+
+   if ( ! Map_File ( From_FileName, &Map, &Bytes ) )  return false;
+
+   File_ptr = fopen ( To_FileName, "wb" );
+   if ( File_ptr == NULL ) {
+      Unmap_File ( Map, Bytes );
+      return false;
+   }
+
+   OK_Copy = ( Bytes == 0  ||  fwrite ( Map, 1, Bytes, File_ptr ) == Bytes );
+   if ( fclose ( File_ptr ) != 0 )  OK_Copy = false;
+
+   Unmap_File ( Map, Bytes );
+
+   return OK_Copy;
+
+}  // Copy_File ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Show_File ( const char * FileName ) {
+
+   const unsigned char *  Map;
+   size_t  Bytes;
+
+
+   if ( ! Map_File ( FileName, &Map, &Bytes ) )  return;
+
+   if ( Bytes > 0 )  fwrite ( Map, 1, Bytes, stdout );
+   fflush ( stdout );
+
+   Unmap_File ( Map, Bytes );
+
+}  // Show_File ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Appends a line to the log, in a single write, so that the lines of programs
+//  running at the same time are not mixed.
+
+static void  Log_Cache_Event ( const char * Directory, const char * Event, const char * Key, uint64_t Bytes, const char * Program ) {
+
+   char *  Log_FileName;
+   char  Line [256];
+   int  fd;
+   int  Length;
+
+
+   Log_FileName = Cache_Path ( Directory, CACHE_LOG_NAME, NULL );
+   fd = open ( Log_FileName, O_WRONLY | O_CREAT | O_APPEND, 0666 );
+   free ( Log_FileName );
+   if ( fd < 0 )  return;
+
+   Length = snprintf ( Line, sizeof (Line), "%lld %s %s %llu %s\n", (long long int) time ( NULL ), Event, Key,
+                       (long long unsigned int) Bytes, Program );
+   if ( Length > 0  &&  (size_t) Length < sizeof (Line) ) {
+      if ( write ( fd, Line, (size_t) Length ) != Length )  printf ( "\nWrite to the result cache log failed.\n" );
+   }
+
+   close ( fd );
+
+}  // Log_Cache_Event ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Removes the files of a result, then its directory.
+
+static void  Remove_Cache_Entry ( const char * Directory, const char * Key ) {
+
+   char *  Entry;
+   char *  File_Path;
+   DIR *  Dir_ptr;
+   struct dirent *  Dir_Entry_ptr;
+
+
+   Entry = Cache_Path ( Directory, Key, NULL );
+
+   Dir_ptr = opendir ( Entry );
+   if ( Dir_ptr != NULL ) {
+      while ( ( Dir_Entry_ptr = readdir ( Dir_ptr ) ) != NULL ) {
+         if ( strcmp ( Dir_Entry_ptr->d_name, "." ) == 0  ||  strcmp ( Dir_Entry_ptr->d_name, ".." ) == 0 )  continue;
+         File_Path = Cache_Path ( Entry, Dir_Entry_ptr->d_name, NULL );
+         unlink ( File_Path );
+         free ( File_Path );
+      }
+      closedir ( Dir_ptr );
+   }
+
+   rmdir ( Entry );
+   free ( Entry );
+
+}  // Remove_Cache_Entry ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Whether the entry holds this result, intact: the same description, and each
+//  output stored with its size and CRC32C.   A damaged entry is removed.
+
+static _Bool  Check_Cache_Entry ( const Result_Cache_type * Cache_ptr, const char * Entry, _Bool Present [], uint64_t * Bytes_ptr ) {
+
+   char *  File_Path;
+   char  Name [16];
+   FILE *  Manifest_File_ptr;
+   const unsigned char *  Map;
+   size_t  Bytes;
+   _Bool  Intact = true;
+
+   unsigned int  i_listed, Is_Present, Stored_CRC;
+   long long unsigned int  Stored_Bytes;
+   uint32_t  i_output;
+
+
+   //  The description, i.e., the same parameters and inputs:
+
+   File_Path = Cache_Path ( Entry, "description", NULL );
+   if ( ! Map_File ( File_Path, &Map, &Bytes ) ) {
+      free ( File_Path );
+      return false;   // not in the cache
+   }
+   free ( File_Path );
+
+   if ( Bytes != Cache_ptr->Description_Length  ||  memcmp ( Map, Cache_ptr->Description, Bytes ) != 0 ) {
+      Unmap_File ( Map, Bytes );
+      return false;   // a different result with the same hash
+   }
+   Unmap_File ( Map, Bytes );
+
+
+   //  The outputs:
+
+   File_Path = Cache_Path ( Entry, "manifest", NULL );
+   Manifest_File_ptr = fopen ( File_Path, "r" );
+   free ( File_Path );
+   if ( Manifest_File_ptr == NULL )  return false;
+
+   for ( i_output=0;  i_output < Cache_ptr->Num_Outputs  &&  Intact;  i_output++ ) {
+
+      if ( fscanf ( Manifest_File_ptr, "%u %u %llu %X", &i_listed, &Is_Present, &Stored_Bytes, &Stored_CRC ) != 4  ||  i_listed != i_output ) {
+         Intact = false;
+         break;
+      }
+
+      Present [i_output] = ( Is_Present != 0 );
+      if ( ! Present [i_output] )  continue;
+
+      sprintf ( Name, "%u", i_output );
+      File_Path = Cache_Path ( Entry, Name, NULL );
+      Intact = Map_File ( File_Path, &Map, &Bytes );
+      if ( Intact ) {
+         Intact = ( Bytes == Stored_Bytes  &&  CRC32C ( Map, Bytes ) == Stored_CRC );
+         Unmap_File ( Map, Bytes );
+      }
+      free ( File_Path );
+
+      *Bytes_ptr += Stored_Bytes;
+
+   }
+
+   fclose ( Manifest_File_ptr );
+
+   if ( ! Intact ) {
+      printf ( "\nResult %s of the cache is damaged -- removed.\n", Entry );
+      Remove_Cache_Entry ( Cache_ptr->Directory, Cache_ptr->Key );
+      Log_Cache_Event ( Cache_ptr->Directory, "damaged", Cache_ptr->Key, 0, Cache_ptr->Program );
+   }
+
+   return Intact;
+
+}  // Check_Cache_Entry ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Ends the capture of the standard output and shows what was captured.   Called by
+//  Store_Cached_Results, or at exit if the program exits before storing its results.
+
+static void  Release_Captured_Stdout ( void ) {
+
+   Result_Cache_type *  Cache_ptr = Capturing_Cache_ptr;
+
+
+   if ( Cache_ptr == NULL  ||  Cache_ptr->Saved_Stdout < 0 )  return;
+
+   fflush ( stdout );
+   dup2 ( Cache_ptr->Saved_Stdout, STDOUT_FILENO );
+   close ( Cache_ptr->Saved_Stdout );
+   Cache_ptr->Saved_Stdout = -1;
+
+   Show_File ( Cache_ptr->Stdout_FileName );
+
+   Capturing_Cache_ptr = NULL;
+
+}  // Release_Captured_Stdout ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Release_Captured_Stdout_at_Exit ( void ) {
+
+   Result_Cache_type *  Cache_ptr = Capturing_Cache_ptr;
+
+
+   if ( Cache_ptr == NULL )  return;
+
+   Release_Captured_Stdout ();
+
+   if ( Cache_ptr->Stdout_FileName != NULL )  unlink ( Cache_ptr->Stdout_FileName );
+
+}  // Release_Captured_Stdout_at_Exit ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static int  Compare_Last_Used ( const void * A_ptr, const void * B_ptr ) {
+
+   const Cache_Entry_type *  A = A_ptr;
+   const Cache_Entry_type *  B = B_ptr;
+
+
+   if ( A->Last_Used < B->Last_Used )  return -1;
+   if ( A->Last_Used > B->Last_Used )  return  1;
+   return strcmp ( A->Key, B->Key );
+
+}  // Compare_Last_Used ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The 64 bit hash XXH64 (seed 0) of Yann Collet, which hashes several GB per
+//  second: 4 independent lanes of 8 bytes.
+
+static uint64_t  Hash64 ( const void * Data, size_t Num_Bytes ) {
+
+   const unsigned char *  Bytes = Data;
+   const unsigned char *  End = Bytes + Num_Bytes;
+   uint64_t  Lanes [4];
+   uint64_t  Hash;
+   uint64_t  Word;
+   uint32_t  Half_Word;
+   uint32_t  j;
+
+   #define  ROTATE_LEFT(x,r)   ( ( (x) << (r) ) | ( (x) >> ( 64 - (r) ) ) )
+   #define  XXH64_ROUND(acc,input)   ( ROTATE_LEFT ( (acc) + (input) * PRIME64_2, 31 ) * PRIME64_1 )
+
+
+   if ( Num_Bytes >= 32 ) {
+
+      Lanes [0] = PRIME64_1 + PRIME64_2;
+      Lanes [1] = PRIME64_2;
+      Lanes [2] = 0;
+      Lanes [3] = 0 - PRIME64_1;
+
+      while ( End - Bytes >= 32 ) {
+         for ( j=0;  j < 4;  j++ ) {
+            memcpy ( &Word, Bytes + 8 * j, 8 );
+            Lanes [j] = XXH64_ROUND ( Lanes [j], Word );
+         }
+         Bytes += 32;
+      }
+
+      Hash = ROTATE_LEFT ( Lanes [0], 1 ) + ROTATE_LEFT ( Lanes [1], 7 ) + ROTATE_LEFT ( Lanes [2], 12 ) + ROTATE_LEFT ( Lanes [3], 18 );
+
+      for ( j=0;  j < 4;  j++ ) {
+         Hash ^= XXH64_ROUND ( 0, Lanes [j] );
+         Hash = Hash * PRIME64_1 + PRIME64_4;
+      }
+
+   } else {
+
+      Hash = PRIME64_5;
+
+   }
+
+   Hash += Num_Bytes;
+
+   while ( End - Bytes >= 8 ) {
+      memcpy ( &Word, Bytes, 8 );
+      Hash ^= XXH64_ROUND ( 0, Word );
+      Hash = ROTATE_LEFT ( Hash, 27 ) * PRIME64_1 + PRIME64_4;
+      Bytes += 8;
+   }
+
+   if ( End - Bytes >= 4 ) {
+      memcpy ( &Half_Word, Bytes, 4 );
+      Hash ^= (uint64_t) Half_Word * PRIME64_1;
+      Hash = ROTATE_LEFT ( Hash, 23 ) * PRIME64_2 + PRIME64_3;
+      Bytes += 4;
+   }
+
+   while ( Bytes < End ) {
+      Hash ^= *Bytes * PRIME64_5;
+      Hash = ROTATE_LEFT ( Hash, 11 ) * PRIME64_1;
+      Bytes++;
+   }
+
+   Hash ^= Hash >> 33;
+   Hash *= PRIME64_2;
+   Hash ^= Hash >> 29;
+   Hash *= PRIME64_3;
+   Hash ^= Hash >> 32;
+
+   #undef  ROTATE_LEFT
+   #undef  XXH64_ROUND
+
+   return Hash;
+
+}  // Hash64 ()
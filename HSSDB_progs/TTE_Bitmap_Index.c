@@ -0,0 +1,773 @@
+//  Bitmap indexes of processed TTE files, by detector and by channel.
+
+//  Programs often select the same kinds of subsets of the events: the NaI detectors,
+//  a range of channels, one detector.   The index of a file holds, for each detector
+//  and for each channel, the set of the positions in the file ("ordinals") of its
+//  events.   The positions of the events of a selection are then the union of the
+//  sets of the selected detectors, intersected with the union of the sets of the
+//  selected channels -- found without reading the events.
+
+//  The sets are compressed bitmaps in the manner of Roaring bitmaps: the ordinals are
+//  divided by their upper 16 bits into containers, each held as a sorted array of the
+//  lower 16 bits if it has at most TTE_BITMAP_ARRAY_MAX events, else as a bitmap of
+//  65536 bits.   The index takes about 4 bytes per event.   See the header file for
+//  the layout of the file, FileName.bix.
+
+//  A query works container by container, so the time taken depends on the number of
+//  containers holding selected events, not on the length of the file.   When more
+//  than half of the detectors (or channels) are selected, the union of those NOT
+//  selected is removed instead, e.g., the NaI detectors are all events except those
+//  of the 2 BGO detectors.
+
+//  TTE_Event_Reader.c uses the index, if present, for a selection by detector or
+//  channel of an uncompressed (version 1 or 2) file, which it can read at any event.
+//  An index is made by Index_TTE.exe (MAIN_Index_TTE.c); it must be made again if
+//  the file is replaced.   The index holds the size and the time of last modification
+//  of the file, and the CRC32C of samples of it: the first SAMPLE_HEAD_BYTES, then
+//  NUM_SAMPLES blocks of SAMPLE_BYTES spread evenly over the rest, ending with its
+//  last block.   The index is ignored unless all three are those of the file read,
+//  so a file replaced by another, even of the same size, is read without it -- while
+//  opening the index reads only about 130 kB of the file, so that the time of a query
+//  remains proportional to the events selected.   The ordinals are 32 bits: at most
+//  2**32 events per file.
+
+
+#define  _POSIX_C_SOURCE  200809L
+
+#include "HSSDB_Progs_Header.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+
+#define  INITIAL_ARRAY_CAPACITY   16U
+
+#define  SAMPLE_HEAD_BYTES   65536U
+#define  NUM_SAMPLES            16U
+#define  SAMPLE_BYTES         4096U
+
+
+//  local typedefs:
+
+//  A container or bitmap under construction:
+
+typedef struct  Build_Container_type {
+   uint16_t  Key;
+   uint32_t  Cardinality;
+   uint32_t  Capacity;           // of Array
+   uint16_t *  Array;
+   uint64_t *  Bits;             // not NULL once converted to a bitmap
+} Build_Container_type;
+
+typedef struct  Build_Bitmap_type {
+   Build_Container_type *  Containers;
+   uint32_t  Num_Containers;
+   uint32_t  Capacity;
+} Build_Bitmap_type;
+
+
+//  local function prototypes:
+
+static void  Add_Ordinal ( Build_Bitmap_type * Bitmap_ptr, uint32_t Ordinal );
+
+static void  Write_Index_Bytes ( FILE * File_ptr, const void * Data_ptr, size_t Num_Bytes );
+
+static void  Source_Signature ( const char * FileName, TTE_Bitmap_Index_Header_type * Header_ptr );
+
+static uint32_t  Sampled_CRC ( const unsigned char * Source, size_t Source_Bytes );
+
+static _Bool  Valid_Index_Layout ( const TTE_Bitmap_Index_type * Index_ptr );
+
+static void  Union_of_Bitmaps ( const TTE_Bitmap_Index_type * Index_ptr, const uint32_t Bitmaps [], uint32_t Num_Bitmaps,
+                                uint32_t Cursors [], uint16_t Key, uint64_t Words [], _Bool * Found_ptr );
+
+static uint32_t  Lowest_Bit ( uint64_t Word );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Reads the processed TTE file (any version) and writes its index, FileName.bix.
+
+void Build_TTE_Bitmap_Index (
+
+   // Input argument:
+   const char * FileName
+
+) {
+
+   static Build_Bitmap_type  Bitmaps [NUM_TTE_BITMAPS];
+
+   TTE_Event_Reader_type  Reader;
+   const Processed_TTE_v2_type * Events;
+   size_t  Num_Read;
+   size_t  i;
+   uint64_t  Ordinal = 0;
+
+   TTE_Bitmap_Index_Header_type  Header;
+   TTE_Bitmap_Directory_type  Directory [NUM_TTE_BITMAPS];
+   TTE_Container_Header_type  Container_Header;
+   const Build_Container_type *  Container_ptr;
+   uint64_t  Offset;
+   uint64_t  Padding = 0;
+   size_t  Container_Bytes;
+   uint32_t  j_bitmap;
+   uint32_t  k_container;
+
+   char *  Index_FileName_ptr;
+   FILE *  Index_File_ptr;
+
+
+   memset ( Bitmaps, 0, sizeof (Bitmaps) );
+
+   Open_TTE_Event_Reader ( FileName, 0, &Reader );
+
+   while ( ( Num_Read = Next_TTE_Event_Batch ( &Reader, &Events ) ) > 0 ) {
+
+      if ( Ordinal + Num_Read > UINT32_MAX ) {
+         printf ( "\n\nToo many events to index in '%s' -- Exiting!\n", FileName );
+         exit (120);
+      }
+
+      for ( i=0;  i < Num_Read;  i++, Ordinal++ ) {
+         if ( Events [i] .Detector < NUM_DET )  Add_Ordinal ( &Bitmaps [Events [i] .Detector], (uint32_t) Ordinal );
+         if ( Events [i] .SpecChannel < NUM_SPEC_CHAN )  Add_Ordinal ( &Bitmaps [NUM_DET + Events [i] .SpecChannel], (uint32_t) Ordinal );
+      }
+
+   }
+
+   Close_TTE_Event_Reader ( &Reader );
+
+
+   //  The layout: the header, the directory, then the bitmaps:
+
+   memset ( &Header, 0, sizeof (Header) );
+   memcpy ( Header.Magic, TTE_BITMAP_INDEX_MAGIC, sizeof (TTE_BITMAP_INDEX_MAGIC) );
+   Header.Version = 3;
+   Header.Num_Bitmaps = NUM_TTE_BITMAPS;
+   Header.Num_Events = Ordinal;
+   Source_Signature ( FileName, &Header );
+
+   Offset = sizeof (Header) + sizeof (Directory);
+
+   for ( j_bitmap=0;  j_bitmap < NUM_TTE_BITMAPS;  j_bitmap++ ) {
+
+      Directory [j_bitmap] .Offset = Offset;
+      Directory [j_bitmap] .Num_Containers = Bitmaps [j_bitmap] .Num_Containers;
+      Directory [j_bitmap] .Reserved = 0;
+
+      Offset += Bitmaps [j_bitmap] .Num_Containers * sizeof (TTE_Container_Header_type);
+
+      for ( k_container=0;  k_container < Bitmaps [j_bitmap] .Num_Containers;  k_container++ ) {
+         Container_ptr = &Bitmaps [j_bitmap] .Containers [k_container];
+         Offset += ( Container_ptr->Bits != NULL )  ?  TTE_BITMAP_WORDS * 8  :  ( Container_ptr->Cardinality * 2 + 7 ) / 8 * 8;
+      }
+
+   }
+
+
+   Index_FileName_ptr = TTE_Bitmap_Index_FileName ( FileName );
+
+   Index_File_ptr = fopen ( Index_FileName_ptr, "wb" );
+   if ( Index_File_ptr == NULL ) {
+      printf ( "\n\nFailed to open output index file '%s' -- Exiting!\n", Index_FileName_ptr );
+      exit (121);
+   }
+
+   Write_Index_Bytes ( Index_File_ptr, &Header, sizeof (Header) );
+   Write_Index_Bytes ( Index_File_ptr, Directory, sizeof (Directory) );
+
+   for ( j_bitmap=0;  j_bitmap < NUM_TTE_BITMAPS;  j_bitmap++ ) {  // write bitmaps
+
+      Offset = Directory [j_bitmap] .Offset + Bitmaps [j_bitmap] .Num_Containers * sizeof (TTE_Container_Header_type);
+
+      for ( k_container=0;  k_container < Bitmaps [j_bitmap] .Num_Containers;  k_container++ ) {
+
+         Container_ptr = &Bitmaps [j_bitmap] .Containers [k_container];
+
+         Container_Header.Key = Container_ptr->Key;
+         Container_Header.Is_Bitmap = ( Container_ptr->Bits != NULL );
+         Container_Header.Cardinality = Container_ptr->Cardinality;
+         Container_Header.Offset = Offset;
+         Write_Index_Bytes ( Index_File_ptr, &Container_Header, sizeof (Container_Header) );
+
+         Offset += ( Container_ptr->Bits != NULL )  ?  TTE_BITMAP_WORDS * 8  :  ( Container_ptr->Cardinality * 2 + 7 ) / 8 * 8;
+
+      }
+
+      for ( k_container=0;  k_container < Bitmaps [j_bitmap] .Num_Containers;  k_container++ ) {
+
+         Container_ptr = &Bitmaps [j_bitmap] .Containers [k_container];
+
+         if ( Container_ptr->Bits != NULL ) {
+            Write_Index_Bytes ( Index_File_ptr, Container_ptr->Bits, TTE_BITMAP_WORDS * 8 );
+         } else {
+            Container_Bytes = Container_ptr->Cardinality * 2U;
+            Write_Index_Bytes ( Index_File_ptr, Container_ptr->Array, Container_Bytes );
+            Write_Index_Bytes ( Index_File_ptr, &Padding, ( Container_Bytes + 7 ) / 8 * 8 - Container_Bytes );
+         }
+
+         free ( Container_ptr->Array );
+         free ( Container_ptr->Bits );
+
+      }
+
+      free ( Bitmaps [j_bitmap] .Containers );
+
+   }  // write bitmaps
+
+   if ( fclose ( Index_File_ptr ) != 0 ) {
+      printf ( "\n\nClose of index file '%s' failed -- Exiting!\n", Index_FileName_ptr );
+      exit (121);
+   }
+
+   free ( Index_FileName_ptr );
+
+}  // Build_TTE_Bitmap_Index ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Opens the index of FileName, whose contents, Source_Bytes mapped at Source, have
+//  Num_Events events.   Returns false if there is no index, it is not for these
+//  contents, or it is damaged (e.g., truncated).
+
+_Bool Open_TTE_Bitmap_Index (
+
+   // Input arguments:
+   const char * FileName,
+   const void * Source,
+   size_t Source_Bytes,
+   uint64_t Num_Events,
+
+   // Output argument:
+   TTE_Bitmap_Index_type * Index_ptr
+
+) {
+
+   char *  Index_FileName_ptr;
+   int  fd;
+   struct stat  Index_Status;
+   struct stat  Source_Status;
+   void *  Map_ptr;
+
+
+   Index_ptr->Map = NULL;
+
+   if ( Source == NULL )  return false;   // too short to have events
+
+   if ( stat ( FileName, &Source_Status ) != 0 )  return false;
+
+   Index_FileName_ptr = TTE_Bitmap_Index_FileName ( FileName );
+   fd = open ( Index_FileName_ptr, O_RDONLY );
+   free ( Index_FileName_ptr );
+
+   if ( fd < 0 )  return false;
+
+   if ( fstat ( fd, &Index_Status ) != 0  ||
+        (size_t) Index_Status.st_size < sizeof (TTE_Bitmap_Index_Header_type) + NUM_TTE_BITMAPS * sizeof (TTE_Bitmap_Directory_type) ) {
+      close ( fd );
+      return false;
+   }
+
+   Map_ptr = mmap ( NULL, (size_t) Index_Status.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+   close ( fd );
+   if ( Map_ptr == MAP_FAILED )  return false;
+
+   Index_ptr->Map = Map_ptr;
+   Index_ptr->Map_Bytes = (size_t) Index_Status.st_size;
+   Index_ptr->Header = Map_ptr;
+   Index_ptr->Directory = (const TTE_Bitmap_Directory_type *) ( Index_ptr->Map + sizeof (TTE_Bitmap_Index_Header_type) );
+
+   if ( memcmp ( Index_ptr->Header->Magic, TTE_BITMAP_INDEX_MAGIC, sizeof (TTE_BITMAP_INDEX_MAGIC) ) != 0  ||
+        Index_ptr->Header->Version != 3  ||  Index_ptr->Header->Num_Bitmaps != NUM_TTE_BITMAPS  ||
+        Index_ptr->Header->Num_Events != Num_Events  ||  Index_ptr->Header->Source_Bytes != (uint64_t) Source_Bytes  ||
+        Index_ptr->Header->Source_Mtime != (int64_t) Source_Status.st_mtime  ||
+        Index_ptr->Header->Source_CRC != Sampled_CRC ( Source, Source_Bytes )  ||
+        ! Valid_Index_Layout ( Index_ptr ) ) {
+      Close_TTE_Bitmap_Index ( Index_ptr );
+      return false;
+   }
+
+   return true;
+
+}  // Open_TTE_Bitmap_Index ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Finds the ordinals of the events of the detectors of Detector_Mask (bit j for
+//  detector j) with Min_Channel <= channel <= Max_Channel.   Returns the number found;
+//  *Ordinals_ptr is set to an array of them, in increasing order, to be freed by
+//  the caller (NULL if none).
+
+uint64_t Query_TTE_Bitmap_Index (
+
+   // Input arguments:
+   const TTE_Bitmap_Index_type * Index_ptr,
+   uint32_t Detector_Mask,
+   uint32_t Min_Channel,
+   uint32_t Max_Channel,
+
+   // Output argument:
+   uint32_t ** Ordinals_ptr
+
+) {
+
+   uint32_t  Det_Bitmaps [NUM_DET];
+   uint32_t  Chan_Bitmaps [NUM_SPEC_CHAN];
+   uint32_t  Num_Det_Bitmaps = 0;
+   uint32_t  Num_Chan_Bitmaps = 0;
+   uint32_t  Num_Det_Selected = 0;
+   uint32_t  Num_Chan_Selected = 0;
+   _Bool  Det_Complement, Chan_Complement;
+
+   uint32_t  Cursors [NUM_TTE_BITMAPS];
+   uint64_t  Det_Words [TTE_BITMAP_WORDS];
+   uint64_t  Chan_Words [TTE_BITMAP_WORDS];
+   uint64_t  Universe_Words [TTE_BITMAP_WORDS];
+   _Bool  Det_Found, Chan_Found;
+
+   uint64_t  Num_Keys;
+   uint64_t  Key;
+   uint64_t  Num_in_Key;
+   uint64_t  Word;
+   uint32_t  i_word;
+   uint32_t  j;
+
+   uint32_t *  Ordinals = NULL;
+   uint32_t *  New_Ordinals;
+   uint64_t  Num_Ordinals = 0;
+   uint64_t  Capacity = 0;
+
+
+   *Ordinals_ptr = NULL;
+
+   for ( j=0;  j < NUM_DET;  j++ )
+      if ( ( Detector_Mask >> j ) & 1U )  Num_Det_Selected++;
+
+   for ( j=0;  j < NUM_SPEC_CHAN;  j++ )
+      if ( j >= Min_Channel  &&  j <= Max_Channel )  Num_Chan_Selected++;
+
+   if ( Num_Det_Selected == 0  ||  Num_Chan_Selected == 0 )  return 0;
+
+
+   //  Use the smaller of the selected and not selected sets:
+
+   Det_Complement = ( Num_Det_Selected > NUM_DET / 2 );
+   Chan_Complement = ( Num_Chan_Selected > NUM_SPEC_CHAN / 2 );
+
+   for ( j=0;  j < NUM_DET;  j++ )
+      if ( ( ( Detector_Mask >> j ) & 1U ) != Det_Complement )  Det_Bitmaps [Num_Det_Bitmaps++] = j;
+
+   for ( j=0;  j < NUM_SPEC_CHAN;  j++ )
+      if ( ( j >= Min_Channel  &&  j <= Max_Channel ) != Chan_Complement )  Chan_Bitmaps [Num_Chan_Bitmaps++] = NUM_DET + j;
+
+   memset ( Cursors, 0, sizeof (Cursors) );
+
+   Num_Keys = ( Index_ptr->Header->Num_Events + 65535 ) >> 16;
+
+
+   for ( Key=0;  Key < Num_Keys;  Key++ ) {  // loop over containers
+
+      Union_of_Bitmaps ( Index_ptr, Det_Bitmaps, Num_Det_Bitmaps, Cursors, (uint16_t) Key, Det_Words, &Det_Found );
+      if ( ! Det_Found  &&  ! Det_Complement )  continue;
+
+      Union_of_Bitmaps ( Index_ptr, Chan_Bitmaps, Num_Chan_Bitmaps, Cursors, (uint16_t) Key, Chan_Words, &Chan_Found );
+      if ( ! Chan_Found  &&  ! Chan_Complement )  continue;
+
+      if ( Det_Complement  ||  Chan_Complement ) {  // need the events of this container ?
+
+         Num_in_Key = Index_ptr->Header->Num_Events - ( Key << 16 );
+         if ( Num_in_Key > 65536 )  Num_in_Key = 65536;
+
+         for ( i_word=0;  i_word < TTE_BITMAP_WORDS;  i_word++ ) {
+            if ( ( i_word + 1 ) * 64U <= Num_in_Key )
+               Universe_Words [i_word] = UINT64_MAX;
+            else if ( i_word * 64U < Num_in_Key )
+               Universe_Words [i_word] = ( UINT64_C(1) << ( Num_in_Key - i_word * 64U ) ) - 1;
+            else
+               Universe_Words [i_word] = 0;
+         }
+
+      }  // need the events of this container ?
+
+      for ( i_word=0;  i_word < TTE_BITMAP_WORDS;  i_word++ ) {  // loop over words
+
+         Word = ( Det_Complement  ?  Universe_Words [i_word] & ~ Det_Words [i_word]  :  Det_Words [i_word] )  &
+                ( Chan_Complement  ?  Universe_Words [i_word] & ~ Chan_Words [i_word]  :  Chan_Words [i_word] );
+
+         while ( Word != 0 ) {
+
+            if ( Num_Ordinals == Capacity ) {
+               Capacity = ( Capacity == 0 )  ?  65536  :  2 * Capacity;
+               New_Ordinals = realloc ( Ordinals, Capacity * sizeof (uint32_t) );
+               if ( New_Ordinals == NULL ) {
+                  printf ( "\n\nOut of memory for the events of a bitmap index query.  Exiting.\n" );
+                  exit (122);
+               }
+               Ordinals = New_Ordinals;
+            }
+
+            Ordinals [Num_Ordinals++] = (uint32_t) ( ( Key << 16 ) | ( i_word * 64U + Lowest_Bit ( Word ) ) );
+            Word &= Word - 1;
+
+         }
+
+      }  // loop over words
+
+   }  // loop over containers
+
+   *Ordinals_ptr = Ordinals;
+
+   return Num_Ordinals;
+
+}  // Query_TTE_Bitmap_Index ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Close_TTE_Bitmap_Index (
+
+   // Input/Output argument:
+   TTE_Bitmap_Index_type * Index_ptr
+
+) {
+
+   if ( Index_ptr->Map != NULL )  munmap ( (void *) (uintptr_t) Index_ptr->Map, Index_ptr->Map_Bytes );
+
+   Index_ptr->Map = NULL;
+
+}  // Close_TTE_Bitmap_Index ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The name of the index of FileName, FileName.bix, to be freed by the caller.
+
+char * TTE_Bitmap_Index_FileName (
+
+   // Input argument:
+   const char * FileName
+
+) {
+
+   char *  Index_FileName_ptr;
+
+
+   Index_FileName_ptr = malloc ( strlen ( FileName ) + sizeof (TTE_BITMAP_INDEX_EXTENSION) );
+   if ( Index_FileName_ptr == NULL ) {
+      printf ( "\n\nmalloc call failed.  Exiting.\n" );
+      exit (122);
+   }
+
+   strcpy ( Index_FileName_ptr, FileName );
+   strcat ( Index_FileName_ptr, TTE_BITMAP_INDEX_EXTENSION );
+
+   return Index_FileName_ptr;
+
+}  // TTE_Bitmap_Index_FileName ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Adds an ordinal, larger than any already added, to a bitmap under construction.
+
+static void  Add_Ordinal ( Build_Bitmap_type * Bitmap_ptr, uint32_t Ordinal ) {
+
+   Build_Container_type *  Container_ptr;
+   uint16_t  Key;
+   uint16_t  Low;
+   uint32_t  i;
+
+
+   Key = (uint16_t) ( Ordinal >> 16 );
+   Low = (uint16_t) ( Ordinal & 0xFFFFU );
+
+   if ( Bitmap_ptr->Num_Containers == 0  ||  Bitmap_ptr->Containers [Bitmap_ptr->Num_Containers - 1] .Key != Key ) {  // new container ?
+
+      if ( Bitmap_ptr->Num_Containers == Bitmap_ptr->Capacity ) {
+         Bitmap_ptr->Capacity = ( Bitmap_ptr->Capacity == 0 )  ?  16  :  2 * Bitmap_ptr->Capacity;
+         Bitmap_ptr->Containers = realloc ( Bitmap_ptr->Containers, Bitmap_ptr->Capacity * sizeof (Build_Container_type) );
+         if ( Bitmap_ptr->Containers == NULL ) {
+            printf ( "\n\nOut of memory building bitmap index.  Exiting.\n" );
+            exit (122);
+         }
+      }
+
+      Container_ptr = &Bitmap_ptr->Containers [Bitmap_ptr->Num_Containers++];
+      memset ( Container_ptr, 0, sizeof (Build_Container_type) );
+      Container_ptr->Key = Key;
+
+   }  // new container ?
+
+   Container_ptr = &Bitmap_ptr->Containers [Bitmap_ptr->Num_Containers - 1];
+
+
+   if ( Container_ptr->Bits == NULL  &&  Container_ptr->Cardinality == TTE_BITMAP_ARRAY_MAX ) {  // array full ?
+
+      //  Convert the array to a bitmap:
+
+      Container_ptr->Bits = calloc ( TTE_BITMAP_WORDS, sizeof (uint64_t) );
+      if ( Container_ptr->Bits == NULL ) {
+         printf ( "\n\nOut of memory building bitmap index.  Exiting.\n" );
+         exit (122);
+      }
+
+      for ( i=0;  i < Container_ptr->Cardinality;  i++ )
+         Container_ptr->Bits [Container_ptr->Array [i] >> 6] |= UINT64_C(1) << ( Container_ptr->Array [i] & 63U );
+
+      free ( Container_ptr->Array );
+      Container_ptr->Array = NULL;
+
+   }  // array full ?
+
+
+   if ( Container_ptr->Bits != NULL ) {  // bitmap / array ?
+
+      Container_ptr->Bits [Low >> 6] |= UINT64_C(1) << ( Low & 63U );
+
+   } else {  // bitmap / array ?
+
+      if ( Container_ptr->Cardinality == Container_ptr->Capacity ) {
+         Container_ptr->Capacity = ( Container_ptr->Capacity == 0 )  ?  INITIAL_ARRAY_CAPACITY  :  2 * Container_ptr->Capacity;
+         Container_ptr->Array = realloc ( Container_ptr->Array, Container_ptr->Capacity * sizeof (uint16_t) );
+         if ( Container_ptr->Array == NULL ) {
+            printf ( "\n\nOut of memory building bitmap index.  Exiting.\n" );
+            exit (122);
+         }
+      }
+
+      Container_ptr->Array [Container_ptr->Cardinality] = Low;
+
+   }  // bitmap / array ?
+
+   Container_ptr->Cardinality++;
+
+}  // Add_Ordinal ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Write_Index_Bytes ( FILE * File_ptr, const void * Data_ptr, size_t Num_Bytes ) {
+
+   if ( Num_Bytes > 0  &&  fwrite ( Data_ptr, 1, Num_Bytes, File_ptr ) != Num_Bytes ) {
+      printf ( "\nWrite to index file failed !\n" );
+      exit (121);
+   }
+
+}  // Write_Index_Bytes ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The size, time of last modification and sampled CRC32C of the file indexed, for
+//  the header of the index.
+
+static void  Source_Signature ( const char * FileName, TTE_Bitmap_Index_Header_type * Header_ptr ) {
+
+   int  fd;
+   struct stat  File_Status;
+   void *  Map_ptr;
+
+
+   fd = open ( FileName, O_RDONLY );
+   if ( fd < 0  ||  fstat ( fd, &File_Status ) != 0 ) {
+      printf ( "\n\nFailed to stat '%s' -- Exiting!\n", FileName );
+      exit (120);
+   }
+
+   Header_ptr->Source_Bytes = (uint64_t) File_Status.st_size;
+   Header_ptr->Source_Mtime = (int64_t) File_Status.st_mtime;
+   Header_ptr->Source_CRC = 0;   // of no bytes
+
+   if ( File_Status.st_size > 0 ) {
+      Map_ptr = mmap ( NULL, (size_t) File_Status.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( Map_ptr == MAP_FAILED ) {
+         printf ( "\n\nFailed to map '%s' into memory -- Exiting!\n", FileName );
+         exit (120);
+      }
+      Header_ptr->Source_CRC = Sampled_CRC ( Map_ptr, (size_t) File_Status.st_size );
+      munmap ( Map_ptr, (size_t) File_Status.st_size );
+   }
+
+   close ( fd );
+
+}  // Source_Signature ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The CRC32C of the samples of a file: of its first SAMPLE_HEAD_BYTES, then of NUM_SAMPLES
+//  blocks of SAMPLE_BYTES evenly spaced over the rest, the last ending at the end of the
+//  file, combined as the CRC32C of their CRC32Cs.   A short file is taken whole.
+
+static uint32_t  Sampled_CRC ( const unsigned char * Source, size_t Source_Bytes ) {
+
+   uint32_t  CRCs [NUM_SAMPLES + 1];
+   size_t  Rest_Bytes;
+   size_t  Start;
+   uint32_t  i_sample;
+
+
+   if ( Source_Bytes <= SAMPLE_HEAD_BYTES + NUM_SAMPLES * SAMPLE_BYTES )  return CRC32C ( Source, Source_Bytes );
+
+   CRCs [0] = CRC32C ( Source, SAMPLE_HEAD_BYTES );
+
+   Rest_Bytes = Source_Bytes - SAMPLE_HEAD_BYTES - SAMPLE_BYTES;
+
+   for ( i_sample=1;  i_sample <= NUM_SAMPLES;  i_sample++ ) {
+      Start = SAMPLE_HEAD_BYTES + (size_t) ( (uint64_t) Rest_Bytes / NUM_SAMPLES * i_sample );
+      if ( i_sample == NUM_SAMPLES )  Start = Source_Bytes - SAMPLE_BYTES;
+      CRCs [i_sample] = CRC32C ( Source + Start, SAMPLE_BYTES );
+   }
+
+   return CRC32C ( CRCs, sizeof (CRCs) );
+
+}  // Sampled_CRC ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Checks that the directory and every container header and container of an index lie
+//  within the file, aligned, with the keys of each bitmap increasing and no more than
+//  the events of the file, so that a query never reads outside of the map.
+
+static _Bool  Valid_Index_Layout ( const TTE_Bitmap_Index_type * Index_ptr ) {
+
+   const TTE_Container_Header_type *  Headers;
+   uint64_t  Map_Bytes;
+   uint64_t  Num_Keys;
+   uint64_t  Container_Bytes;
+   uint32_t  j_bitmap;
+   uint32_t  k_container;
+
+
+   if ( Index_ptr->Header->Num_Events > UINT32_MAX )  return false;
+
+   Map_Bytes = Index_ptr->Map_Bytes;
+   Num_Keys = ( Index_ptr->Header->Num_Events + 65535 ) >> 16;
+
+   for ( j_bitmap=0;  j_bitmap < NUM_TTE_BITMAPS;  j_bitmap++ ) {  // loop over bitmaps
+
+      if ( Index_ptr->Directory [j_bitmap] .Offset % 8 != 0  ||  Index_ptr->Directory [j_bitmap] .Offset > Map_Bytes  ||
+           Index_ptr->Directory [j_bitmap] .Num_Containers > Num_Keys  ||
+           Index_ptr->Directory [j_bitmap] .Num_Containers * (uint64_t) sizeof (TTE_Container_Header_type) >
+              Map_Bytes - Index_ptr->Directory [j_bitmap] .Offset )  return false;
+
+      Headers = (const TTE_Container_Header_type *) ( Index_ptr->Map + Index_ptr->Directory [j_bitmap] .Offset );
+
+      for ( k_container=0;  k_container < Index_ptr->Directory [j_bitmap] .Num_Containers;  k_container++ ) {
+
+         if ( Headers [k_container] .Key >= Num_Keys  ||  ( k_container > 0  &&  Headers [k_container] .Key <= Headers [k_container - 1] .Key ) )
+            return false;
+
+         if ( Headers [k_container] .Is_Bitmap == 1 )
+            Container_Bytes = TTE_BITMAP_WORDS * 8;
+         else if ( Headers [k_container] .Is_Bitmap == 0  &&  Headers [k_container] .Cardinality <= TTE_BITMAP_ARRAY_MAX )
+            Container_Bytes = Headers [k_container] .Cardinality * UINT64_C(2);
+         else
+            return false;
+
+         if ( Headers [k_container] .Offset % 8 != 0  ||  Headers [k_container] .Offset > Map_Bytes  ||
+              Container_Bytes > Map_Bytes - Headers [k_container] .Offset )  return false;
+
+      }
+
+   }  // loop over bitmaps
+
+   return true;
+
+}  // Valid_Index_Layout ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The union of the containers with Key of the listed bitmaps, as a bitmap of 65536
+//  bits.   Cursors [j] is the next container of bitmap j: the keys are visited in
+//  increasing order, so each container is visited once over the whole query.
+//  *Found_ptr is set to whether any of the bitmaps has a container with Key.
+
+static void  Union_of_Bitmaps ( const TTE_Bitmap_Index_type * Index_ptr, const uint32_t Bitmaps [], uint32_t Num_Bitmaps,
+                                uint32_t Cursors [], uint16_t Key, uint64_t Words [], _Bool * Found_ptr ) {
+
+   const TTE_Container_Header_type *  Headers;
+   const TTE_Container_Header_type *  Header_ptr;
+   const uint64_t *  Bits;
+   const uint16_t *  Array;
+   uint32_t  j, i_bitmap;
+   uint32_t  i;
+
+
+   *Found_ptr = false;
+
+   for ( j=0;  j < Num_Bitmaps;  j++ ) {  // loop over bitmaps
+
+      i_bitmap = Bitmaps [j];
+      Headers = (const TTE_Container_Header_type *) ( Index_ptr->Map + Index_ptr->Directory [i_bitmap] .Offset );
+
+      while ( Cursors [i_bitmap] < Index_ptr->Directory [i_bitmap] .Num_Containers  &&  Headers [Cursors [i_bitmap]] .Key < Key )
+         Cursors [i_bitmap] ++;
+
+      if ( Cursors [i_bitmap] == Index_ptr->Directory [i_bitmap] .Num_Containers  ||  Headers [Cursors [i_bitmap]] .Key != Key )  continue;
+
+      Header_ptr = &Headers [Cursors [i_bitmap]];
+      Cursors [i_bitmap] ++;
+
+      if ( ! *Found_ptr )  memset ( Words, 0, TTE_BITMAP_WORDS * sizeof (uint64_t) );
+      *Found_ptr = true;
+
+      if ( Header_ptr->Is_Bitmap ) {
+         Bits = (const uint64_t *) ( Index_ptr->Map + Header_ptr->Offset );
+         for ( i=0;  i < TTE_BITMAP_WORDS;  i++ )  Words [i] |= Bits [i];
+      } else {
+         Array = (const uint16_t *) ( Index_ptr->Map + Header_ptr->Offset );
+         for ( i=0;  i < Header_ptr->Cardinality;  i++ )  Words [Array [i] >> 6] |= UINT64_C(1) << ( Array [i] & 63U );
+      }
+
+   }  // loop over bitmaps
+
+   if ( ! *Found_ptr )  memset ( Words, 0, TTE_BITMAP_WORDS * sizeof (uint64_t) );
+
+}  // Union_of_Bitmaps ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The position of the lowest set bit of a non-zero word, by the de Bruijn method.
+
+static uint32_t  Lowest_Bit ( uint64_t Word ) {
+
+   static const uint8_t  Position [64] = {
+       0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+      62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+      63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+      46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6 };
+
+   return Position [ ( ( Word & ( ~ Word + 1 ) ) * UINT64_C(0x03F79D71B4CB0A89) ) >> 58 ];
+
+}  // Lowest_Bit ()
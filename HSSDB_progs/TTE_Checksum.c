@@ -0,0 +1,369 @@
+//  Block checksums of output files, so that an archive of them can be verified after
+//  copying without rerunning the programs (see Verify_TTE.exe, MAIN_Verify_TTE.c).
+
+//  The file is divided into blocks of TTE_CHECKSUM_BLOCK_BYTES (1 MiB) and the CRC32C
+//  (the Castagnoli polynomial, as used by iSCSI and ext4) of each block is written to
+//  the sidecar file FileName.crc -- see the header file for its layout.   The output
+//  file itself is unchanged, so that all of the programs read it as before.   A
+//  damaged block is then found to within 1 MiB.
+
+//  CRC32C is computed by the crc32 instruction of SSE4.2 when the processor has it
+//  (x86-64, compiled by gcc), 8 bytes per instruction, else by tables 8 bytes at a
+//  time ("slicing by 8").   Both give the same values.   The method is chosen, and the
+//  tables made, once per run by pthread_once, so that the first call may be made from
+//  any thread.
+
+//  The checksums are written by Extract_TTE, Merge_TTE and Index_TTE after closing
+//  their outputs, while the data is still in the file cache.
+
+
+#define  _POSIX_C_SOURCE  200809L
+
+#include "HSSDB_Progs_Header.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
+
+#if defined (__GNUC__)  &&  defined (__x86_64__)
+#define  HAVE_SSE42_CRC32C
+#include <nmmintrin.h>
+#endif
+
+
+#define  CHECKSUM_EXTENSION   ".crc"
+
+#define  CRC32C_POLYNOMIAL    0x82F63B78U     // reversed
+
+
+//  local function prototypes:
+
+static void  Init_CRC32C ( void );
+
+static uint32_t  CRC32C_Tables ( uint32_t CRC, const unsigned char * Bytes, size_t Num_Bytes );
+
+#ifdef HAVE_SSE42_CRC32C
+static uint32_t  CRC32C_SSE42 ( uint32_t CRC, const unsigned char * Bytes, size_t Num_Bytes );
+#endif
+
+static char *  Checksum_FileName ( const char * FileName );
+
+
+//  The method of CRC32C, 1: tables or 2: SSE4.2, and the tables, set by Init_CRC32C:
+
+static pthread_once_t  CRC32C_Once = PTHREAD_ONCE_INIT;
+static int  CRC32C_Method = 0;
+static uint32_t  CRC32C_Table [8] [256];
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Returns the CRC32C of Num_Bytes of Data.   Thread-safe.
+
+uint32_t CRC32C (
+
+   // Input arguments:
+   const void * Data,
+   size_t Num_Bytes
+
+) {
+
+   pthread_once ( &CRC32C_Once, Init_CRC32C );
+
+#ifdef HAVE_SSE42_CRC32C
+   if ( CRC32C_Method == 2 )  return ~ CRC32C_SSE42 ( UINT32_MAX, Data, Num_Bytes );
+#endif
+
+   return ~ CRC32C_Tables ( UINT32_MAX, Data, Num_Bytes );
+
+}  // CRC32C ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Writes the checksums of the (closed) file FileName to FileName.crc.
+
+void Write_TTE_Checksums (
+
+   // Input argument:
+   const char * FileName
+
+) {
+
+   int  fd;
+   struct stat  File_Status;
+   const unsigned char *  Map = NULL;
+   void *  Map_ptr;
+
+   TTE_Checksum_Header_type  Header;
+   uint32_t *  Checksums;
+   uint64_t  i_block;
+   size_t  Block_Bytes;
+
+   char *  Checksum_FileName_ptr;
+   FILE *  Checksum_File_ptr;
+
+
+   fd = open ( FileName, O_RDONLY );
+   if ( fd < 0  ||  fstat ( fd, &File_Status ) != 0 ) {
+      printf ( "\n\nFailed to open file '%s' for checksums -- Exiting!\n", FileName );
+      exit (130);
+   }
+
+   memset ( &Header, 0, sizeof (Header) );
+   memcpy ( Header.Magic, TTE_CHECKSUM_MAGIC, sizeof (TTE_CHECKSUM_MAGIC) );
+   Header.Version = 1;
+   Header.Block_Bytes = TTE_CHECKSUM_BLOCK_BYTES;
+   Header.File_Bytes = (uint64_t) File_Status.st_size;
+   Header.Num_Blocks = ( Header.File_Bytes + TTE_CHECKSUM_BLOCK_BYTES - 1 ) / TTE_CHECKSUM_BLOCK_BYTES;
+
+   Checksums = malloc ( ( Header.Num_Blocks + 1 ) * sizeof (uint32_t) );
+   if ( Checksums == NULL ) {
+      printf ( "\n\nmalloc of checksums failed. exiting.\n" );
+      exit (131);
+   }
+
+   if ( Header.File_Bytes > 0 ) {
+      Map_ptr = mmap ( NULL, (size_t) Header.File_Bytes, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( Map_ptr == MAP_FAILED ) {
+         printf ( "\n\nFailed to map file '%s' into memory for checksums -- Exiting!\n", FileName );
+         exit (130);
+      }
+      posix_madvise ( Map_ptr, (size_t) Header.File_Bytes, POSIX_MADV_SEQUENTIAL );
+      Map = Map_ptr;
+   }
+
+   close ( fd );
+
+   for ( i_block=0;  i_block < Header.Num_Blocks;  i_block++ ) {
+      Block_Bytes = TTE_CHECKSUM_BLOCK_BYTES;
+      if ( Block_Bytes > Header.File_Bytes - i_block * TTE_CHECKSUM_BLOCK_BYTES )
+         Block_Bytes = (size_t) ( Header.File_Bytes - i_block * TTE_CHECKSUM_BLOCK_BYTES );
+      Checksums [i_block] = CRC32C ( Map + i_block * TTE_CHECKSUM_BLOCK_BYTES, Block_Bytes );
+   }
+
+   if ( Map != NULL )  munmap ( (void *) (uintptr_t) Map, (size_t) Header.File_Bytes );
+
+   Header.Table_CRC = CRC32C ( Checksums, Header.Num_Blocks * sizeof (uint32_t) );
+
+
+   Checksum_FileName_ptr = Checksum_FileName ( FileName );
+
+   Checksum_File_ptr = fopen ( Checksum_FileName_ptr, "wb" );
+   if ( Checksum_File_ptr == NULL ) {
+      printf ( "\n\nFailed to open output checksum file '%s' -- Exiting!\n", Checksum_FileName_ptr );
+      exit (132);
+   }
+
+   if ( fwrite ( &Header, sizeof (Header), 1, Checksum_File_ptr ) != 1  ||
+        fwrite ( Checksums, sizeof (uint32_t), Header.Num_Blocks, Checksum_File_ptr ) != Header.Num_Blocks  ||
+        fclose ( Checksum_File_ptr ) != 0 ) {
+      printf ( "\n\nWrite to checksum file '%s' failed -- Exiting!\n", Checksum_FileName_ptr );
+      exit (132);
+   }
+
+   free ( Checksum_FileName_ptr );
+   free ( Checksums );
+
+}  // Write_TTE_Checksums ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Reads the checksums of FileName from FileName.crc; *Checksums_ptr is set to an
+//  array of Header_ptr->Num_Blocks of them, to be freed by the caller.   Returns false,
+//  with a message, if there is no checksum file or it is damaged.
+
+_Bool Read_TTE_Checksums (
+
+   // Input argument:
+   const char * FileName,
+
+   // Output arguments:
+   TTE_Checksum_Header_type * Header_ptr,
+   uint32_t ** Checksums_ptr
+
+) {
+
+   char *  Checksum_FileName_ptr;
+   FILE *  Checksum_File_ptr;
+   uint32_t *  Checksums;
+   _Bool  Valid;
+
+
+   *Checksums_ptr = NULL;
+
+   Checksum_FileName_ptr = Checksum_FileName ( FileName );
+
+   Checksum_File_ptr = fopen ( Checksum_FileName_ptr, "rb" );
+   if ( Checksum_File_ptr == NULL ) {
+      printf ( "%s: no checksum file %s\n", FileName, Checksum_FileName_ptr );
+      free ( Checksum_FileName_ptr );
+      return false;
+   }
+
+   Valid = ( fread ( Header_ptr, sizeof (TTE_Checksum_Header_type), 1, Checksum_File_ptr ) == 1  &&
+             memcmp ( Header_ptr->Magic, TTE_CHECKSUM_MAGIC, sizeof (TTE_CHECKSUM_MAGIC) ) == 0  &&
+             Header_ptr->Version == 1  &&  Header_ptr->Block_Bytes > 0  &&
+             Header_ptr->Num_Blocks == ( Header_ptr->File_Bytes + Header_ptr->Block_Bytes - 1 ) / Header_ptr->Block_Bytes );
+
+   Checksums = NULL;
+
+   if ( Valid ) {
+      Checksums = malloc ( ( Header_ptr->Num_Blocks + 1 ) * sizeof (uint32_t) );
+      if ( Checksums == NULL ) {
+         printf ( "\n\nmalloc of checksums failed. exiting.\n" );
+         exit (131);
+      }
+      Valid = ( fread ( Checksums, sizeof (uint32_t), Header_ptr->Num_Blocks, Checksum_File_ptr ) == Header_ptr->Num_Blocks  &&
+                CRC32C ( Checksums, Header_ptr->Num_Blocks * sizeof (uint32_t) ) == Header_ptr->Table_CRC );
+   }
+
+   fclose ( Checksum_File_ptr );
+
+   if ( ! Valid ) {
+      printf ( "%s: checksum file %s is damaged\n", FileName, Checksum_FileName_ptr );
+      free ( Checksums );
+      free ( Checksum_FileName_ptr );
+      return false;
+   }
+
+   free ( Checksum_FileName_ptr );
+
+   *Checksums_ptr = Checksums;
+
+   return true;
+
+}  // Read_TTE_Checksums ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Chooses the method of CRC32C, by the processor, and makes the tables: called once,
+//  by pthread_once.
+
+static void  Init_CRC32C ( void ) {
+
+   uint32_t  Value;
+   uint32_t  i, j;
+
+
+#ifdef HAVE_SSE42_CRC32C
+   __builtin_cpu_init ();
+   CRC32C_Method = __builtin_cpu_supports ( "sse4.2" )  ?  2  :  1;
+#else
+   CRC32C_Method = 1;
+#endif
+
+   for ( i=0;  i < 256;  i++ ) {
+      Value = i;
+      for ( j=0;  j < 8;  j++ )  Value = ( Value >> 1 ) ^ ( CRC32C_POLYNOMIAL & ( 0U - ( Value & 1U ) ) );
+      CRC32C_Table [0] [i] = Value;
+   }
+
+   for ( i=0;  i < 256;  i++ )
+      for ( j=1;  j < 8;  j++ )  CRC32C_Table [j] [i] = ( CRC32C_Table [j-1] [i] >> 8 ) ^ CRC32C_Table [0] [CRC32C_Table [j-1] [i] & 0xFFU];
+
+}  // Init_CRC32C ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  CRC32C without the initial and final inversions, by tables, 8 bytes at a time.
+
+static uint32_t  CRC32C_Tables ( uint32_t CRC, const unsigned char * Bytes, size_t Num_Bytes ) {
+
+   while ( Num_Bytes >= 8 ) {
+
+      CRC ^= (uint32_t) Bytes [0] | (uint32_t) Bytes [1] << 8 | (uint32_t) Bytes [2] << 16 | (uint32_t) Bytes [3] << 24;
+
+      CRC = CRC32C_Table [7] [CRC & 0xFFU] ^ CRC32C_Table [6] [( CRC >> 8 ) & 0xFFU] ^
+            CRC32C_Table [5] [( CRC >> 16 ) & 0xFFU] ^ CRC32C_Table [4] [CRC >> 24] ^
+            CRC32C_Table [3] [Bytes [4]] ^ CRC32C_Table [2] [Bytes [5]] ^ CRC32C_Table [1] [Bytes [6]] ^ CRC32C_Table [0] [Bytes [7]];
+
+      Bytes += 8;
+      Num_Bytes -= 8;
+
+   }
+
+   while ( Num_Bytes > 0 ) {
+      CRC = ( CRC >> 8 ) ^ CRC32C_Table [0] [( CRC ^ *Bytes ) & 0xFFU];
+      Bytes++;
+      Num_Bytes--;
+   }
+
+   return CRC;
+
+}  // CRC32C_Tables ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+#ifdef HAVE_SSE42_CRC32C
+
+//  CRC32C without the initial and final inversions, by the crc32 instruction.   Only
+//  this function is compiled for SSE4.2, so the program runs on any x86-64.
+
+__attribute__ (( target ("sse4.2") ))
+static uint32_t  CRC32C_SSE42 ( uint32_t CRC, const unsigned char * Bytes, size_t Num_Bytes ) {
+
+   uint64_t  CRC64 = CRC;
+   uint64_t  Word;
+
+
+   while ( Num_Bytes >= 8 ) {
+      memcpy ( &Word, Bytes, 8 );
+      CRC64 = _mm_crc32_u64 ( CRC64, Word );
+      Bytes += 8;
+      Num_Bytes -= 8;
+   }
+
+   CRC = (uint32_t) CRC64;
+
+   while ( Num_Bytes > 0 ) {
+      CRC = _mm_crc32_u8 ( CRC, *Bytes );
+      Bytes++;
+      Num_Bytes--;
+   }
+
+   return CRC;
+
+}  // CRC32C_SSE42 ()
+
+#endif
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static char *  Checksum_FileName ( const char * FileName ) {
+
+   char *  Checksum_FileName_ptr;
+
+
+   Checksum_FileName_ptr = malloc ( strlen ( FileName ) + sizeof (CHECKSUM_EXTENSION) );
+   if ( Checksum_FileName_ptr == NULL ) {
+      printf ( "\n\nmalloc call failed.  Exiting.\n" );
+      exit (131);
+   }
+
+   strcpy ( Checksum_FileName_ptr, FileName );
+   strcat ( Checksum_FileName_ptr, CHECKSUM_EXTENSION );
+
+   return Checksum_FileName_ptr;
+
+}  // Checksum_FileName ()
@@ -0,0 +1,348 @@
+//  Compression codec for blocks of TTE events: used for version 3 processed TTE
+//  files (see Processed_TTE_IO.c), which Extract_TTE (option -z) also uses for
+//  its per-detector files.
+
+//  TTE events are nearly incompressible by general purpose methods, but have a
+//  simple structure: the times are in order with small gaps (2 microsec ticks),
+//  the channel fits in 7 bits, and the detector in 4 bits -- or 0 bits in a
+//  per-detector file.   So each block stores the time of its first event, then
+//  "frame of reference" bit-packed fields:
+//     the differences between successive times, each in Time_Bits bits;
+//     Detector - Det_Base, in Det_Bits bits;
+//     the channel, in Chan_Bits bits;
+//     the flags, in Flag_Bits bits (0 when all are zero, the usual case).
+//  The widths are the smallest that hold every value of the block.   If the times
+//  of a block are not in order, the differences are instead stored "zigzag" coded
+//  ( 2 * difference for >= 0, -2 * difference - 1 for < 0 ), so any sequence
+//  of events is stored exactly.   The Reserved field of the events must be zero.
+
+//  Each field is packed into its own array of 64 bit words, which makes decoding a
+//  tight loop of shifts and masks with no branches that depend on the data,
+//  decoding several hundred million events per second.   Typically an event takes
+//  2 to 3 bytes instead of 16.
+
+//  Every block is independent: it can be decoded without any other block.
+//  Block layout: TTE_Block_Header_type, then the four packed arrays, each a whole
+//  number of 64 bit words.   Block_Bytes in the header is the size of the whole block.
+
+
+#include "HSSDB_Progs_Header.h"
+
+
+#define  BIT_MASK(b)   ( (b) == 64  ?  UINT64_MAX  :  ( (uint64_t) 1 << (b) ) - 1 )
+
+//  Number of 64 bit words of an array of n values of b bits:
+#define  ARRAY_WORDS(n,b)   ( ( (uint64_t) (n) * (b) + 63 ) / 64 )
+
+
+//  local function prototypes:
+
+static uint32_t  Bits_Needed ( uint64_t Max_Value );
+
+static uint64_t * Pack_Bits ( uint64_t * Words, uint64_t Value, uint32_t Bits, uint64_t * Accum_ptr, uint32_t * Used_ptr );
+
+static uint64_t * Flush_Bits ( uint64_t * Words, uint64_t Accum, uint32_t Used );
+
+static inline uint64_t  Get_Bits ( const uint64_t * Words, uint64_t Bit_Pos, uint32_t Bits, uint64_t Mask );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Upper limit of the size of an encoded block of Num_Events events, in bytes:
+//  the header and four arrays of up to 64 bits per event.
+
+size_t Max_Encoded_TTE_Block_Bytes (
+
+   // Input argument:
+   uint32_t Num_Events
+
+) {
+
+   return sizeof (TTE_Block_Header_type) + 4 * 8 * ( (size_t) Num_Events + 1 );
+
+}  // Max_Encoded_TTE_Block_Bytes ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Encodes Num_Events (1 to TTE_CODEC_BLOCK_EVENTS) events into Block, which must
+//  have room for Max_Encoded_TTE_Block_Bytes.   Returns the size of the block in bytes.
+
+size_t Encode_TTE_Block (
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   uint32_t Num_Events,
+
+   // Output argument:
+   uint64_t Block []
+
+) {
+
+   TTE_Block_Header_type * Header_ptr = (TTE_Block_Header_type *) Block;
+   uint64_t * Words;
+   uint64_t  Accum;
+   uint32_t  Used;
+
+   uint64_t  Delta;
+   uint64_t  Max_Delta = 0;
+   uint8_t   Min_Det = UINT8_MAX, Max_Det = 0;
+   uint8_t   Max_Chan = 0;
+   uint16_t  Max_Flags = 0;
+   _Bool  In_Order = true;
+   uint32_t  i;
+
+
+   if ( Num_Events == 0  ||  Num_Events > TTE_CODEC_BLOCK_EVENTS ) {
+      printf ( "\n\nProgram logic error: TTE block of %u events -- Exiting!\n", Num_Events );
+      exit (90);
+   }
+
+
+   //  Pass 1: the range of each field, to choose the widths:
+
+   for ( i=0;  i < Num_Events;  i++ ) {
+
+      if ( i > 0  &&  Events [i] .Time_in_OneVariable < Events [i-1] .Time_in_OneVariable )  In_Order = false;
+      if ( Events [i] .Detector < Min_Det )  Min_Det = Events [i] .Detector;
+      if ( Events [i] .Detector > Max_Det )  Max_Det = Events [i] .Detector;
+      if ( Events [i] .SpecChannel > Max_Chan )  Max_Chan = Events [i] .SpecChannel;
+      if ( Events [i] .Flags > Max_Flags )  Max_Flags = Events [i] .Flags;
+
+      if ( Events [i] .Reserved != 0 ) {
+         printf ( "\n\nError: TTE event with non-zero Reserved field can't be encoded -- Exiting!\n" );
+         exit (91);
+      }
+
+   }
+
+   for ( i=1;  i < Num_Events;  i++ ) {
+      Delta = Events [i] .Time_in_OneVariable - Events [i-1] .Time_in_OneVariable;
+      if ( ! In_Order )  Delta = ( Delta << 1 ) ^ (uint64_t) ( - (int64_t) ( Delta >> 63 ) );    // zigzag
+      if ( Delta > Max_Delta )  Max_Delta = Delta;
+   }
+
+   memset ( Header_ptr, 0, sizeof (TTE_Block_Header_type) );
+   Header_ptr->Num_Events = Num_Events;
+   Header_ptr->First_Time = Events [0] .Time_in_OneVariable;
+   Header_ptr->Time_Bits = (uint8_t) Bits_Needed ( Max_Delta );
+   Header_ptr->Time_Mode = In_Order  ?  0  :  1;
+   Header_ptr->Det_Base = Min_Det;
+   Header_ptr->Det_Bits = (uint8_t) Bits_Needed ( (uint64_t) ( Max_Det - Min_Det ) );
+   Header_ptr->Chan_Bits = (uint8_t) Bits_Needed ( Max_Chan );
+   Header_ptr->Flag_Bits = (uint8_t) Bits_Needed ( Max_Flags );
+
+
+   //  Pass 2: pack the fields, one array after the other:
+
+   Words = Block + sizeof (TTE_Block_Header_type) / 8;
+
+   Accum = 0;  Used = 0;
+   for ( i=1;  i < Num_Events;  i++ ) {
+      Delta = Events [i] .Time_in_OneVariable - Events [i-1] .Time_in_OneVariable;
+      if ( ! In_Order )  Delta = ( Delta << 1 ) ^ (uint64_t) ( - (int64_t) ( Delta >> 63 ) );
+      Words = Pack_Bits ( Words, Delta, Header_ptr->Time_Bits, &Accum, &Used );
+   }
+   Words = Flush_Bits ( Words, Accum, Used );
+
+   Accum = 0;  Used = 0;
+   for ( i=0;  i < Num_Events;  i++ )
+      Words = Pack_Bits ( Words, (uint64_t) ( Events [i] .Detector - Min_Det ), Header_ptr->Det_Bits, &Accum, &Used );
+   Words = Flush_Bits ( Words, Accum, Used );
+
+   Accum = 0;  Used = 0;
+   for ( i=0;  i < Num_Events;  i++ )
+      Words = Pack_Bits ( Words, Events [i] .SpecChannel, Header_ptr->Chan_Bits, &Accum, &Used );
+   Words = Flush_Bits ( Words, Accum, Used );
+
+   Accum = 0;  Used = 0;
+   for ( i=0;  i < Num_Events;  i++ )
+      Words = Pack_Bits ( Words, Events [i] .Flags, Header_ptr->Flag_Bits, &Accum, &Used );
+   Words = Flush_Bits ( Words, Accum, Used );
+
+   Header_ptr->Block_Bytes = (uint32_t) ( 8 * (size_t) ( Words - Block ) );
+
+   return Header_ptr->Block_Bytes;
+
+}  // Encode_TTE_Block ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Decodes a block into Events, which must have room for the Num_Events of the
+//  block header.   Returns the number of events.   The block must be complete:
+//  Block_Bytes bytes, as checked by the caller.
+
+uint32_t Decode_TTE_Block (
+
+   // Input argument:
+   const uint64_t Block [],
+
+   // Output argument:
+   Processed_TTE_v2_type Events []
+
+) {
+
+   const TTE_Block_Header_type * Header_ptr = (const TTE_Block_Header_type *) Block;
+   const uint64_t * Words;
+   uint32_t  Num_Events = Header_ptr->Num_Events;
+   uint32_t  Bits;
+   uint64_t  Mask;
+   uint64_t  Bit_Pos;
+   uint64_t  Time;
+   uint64_t  Delta;
+   uint32_t  i;
+
+
+   if ( Num_Events == 0  ||  Num_Events > TTE_CODEC_BLOCK_EVENTS  ||  Header_ptr->Time_Bits > 64  ||
+        Header_ptr->Det_Bits > 8  ||  Header_ptr->Chan_Bits > 8  ||  Header_ptr->Flag_Bits > 16 ) {
+      printf ( "\n\nCorrupt compressed TTE block -- Exiting!\n" );
+      exit (92);
+   }
+
+   if ( Header_ptr->Block_Bytes != sizeof (TTE_Block_Header_type) +
+           8 * ( ARRAY_WORDS ( Num_Events - 1, Header_ptr->Time_Bits ) + ARRAY_WORDS ( Num_Events, Header_ptr->Det_Bits ) +
+                 ARRAY_WORDS ( Num_Events, Header_ptr->Chan_Bits ) + ARRAY_WORDS ( Num_Events, Header_ptr->Flag_Bits ) ) ) {
+      printf ( "\n\nCorrupt compressed TTE block: inconsistent size -- Exiting!\n" );
+      exit (92);
+   }
+
+   Words = Block + sizeof (TTE_Block_Header_type) / 8;
+
+
+   //  Times: a running sum of the differences.
+
+   Bits = Header_ptr->Time_Bits;
+   Mask = BIT_MASK (Bits);
+   Time = Header_ptr->First_Time;
+   Events [0] .Time_in_OneVariable = Time;
+
+   if ( Bits == 0 ) {
+      for ( i=1;  i < Num_Events;  i++ )  Events [i] .Time_in_OneVariable = Time;
+   } else if ( Header_ptr->Time_Mode == 0 ) {
+      for ( i=1, Bit_Pos=0;  i < Num_Events;  i++, Bit_Pos += Bits ) {
+         Time += Get_Bits ( Words, Bit_Pos, Bits, Mask );
+         Events [i] .Time_in_OneVariable = Time;
+      }
+   } else {
+      for ( i=1, Bit_Pos=0;  i < Num_Events;  i++, Bit_Pos += Bits ) {
+         Delta = Get_Bits ( Words, Bit_Pos, Bits, Mask );
+         Time += ( Delta >> 1 ) ^ (uint64_t) ( - (int64_t) ( Delta & 1 ) );
+         Events [i] .Time_in_OneVariable = Time;
+      }
+   }
+   Words += ARRAY_WORDS ( Num_Events - 1, Bits );
+
+
+   Bits = Header_ptr->Det_Bits;
+   Mask = BIT_MASK (Bits);
+   if ( Bits == 0 ) {
+      for ( i=0;  i < Num_Events;  i++ )  Events [i] .Detector = Header_ptr->Det_Base;
+   } else {
+      for ( i=0, Bit_Pos=0;  i < Num_Events;  i++, Bit_Pos += Bits )
+         Events [i] .Detector = (uint8_t) ( Header_ptr->Det_Base + Get_Bits ( Words, Bit_Pos, Bits, Mask ) );
+   }
+   Words += ARRAY_WORDS ( Num_Events, Bits );
+
+   Bits = Header_ptr->Chan_Bits;
+   Mask = BIT_MASK (Bits);
+   if ( Bits == 0 ) {
+      for ( i=0;  i < Num_Events;  i++ )  Events [i] .SpecChannel = 0;
+   } else {
+      for ( i=0, Bit_Pos=0;  i < Num_Events;  i++, Bit_Pos += Bits )
+         Events [i] .SpecChannel = (uint8_t) Get_Bits ( Words, Bit_Pos, Bits, Mask );
+   }
+   Words += ARRAY_WORDS ( Num_Events, Bits );
+
+   Bits = Header_ptr->Flag_Bits;
+   Mask = BIT_MASK (Bits);
+   for ( i=0, Bit_Pos=0;  i < Num_Events;  i++, Bit_Pos += Bits ) {
+      Events [i] .Flags = ( Bits == 0 )  ?  0  :  (uint16_t) Get_Bits ( Words, Bit_Pos, Bits, Mask );
+      Events [i] .Reserved = 0;
+   }
+
+   return Num_Events;
+
+}  // Decode_TTE_Block ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static uint32_t  Bits_Needed ( uint64_t Max_Value ) {
+
+   uint32_t  Bits = 0;
+
+   while ( Bits < 64  &&  ( Max_Value >> Bits ) != 0 )  Bits++;
+
+   return Bits;
+
+}  // Bits_Needed ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Appends the low Bits bits of Value to the packed array: *Accum_ptr holds the
+//  *Used_ptr bits not yet stored.   Returns the position of the next word to store.
+
+static uint64_t * Pack_Bits ( uint64_t * Words, uint64_t Value, uint32_t Bits, uint64_t * Accum_ptr, uint32_t * Used_ptr ) {
+
+   if ( Bits == 0 )  return Words;
+
+   *Accum_ptr |= Value << *Used_ptr;
+
+   if ( *Used_ptr + Bits >= 64 ) {
+      *Words++ = *Accum_ptr;
+      *Accum_ptr = ( *Used_ptr == 0 )  ?  0  :  Value >> ( 64 - *Used_ptr );
+      *Used_ptr = *Used_ptr + Bits - 64;
+   } else {
+      *Used_ptr += Bits;
+   }
+
+   return Words;
+
+}  // Pack_Bits ()
+
+
+
+static uint64_t * Flush_Bits ( uint64_t * Words, uint64_t Accum, uint32_t Used ) {
+
+   if ( Used > 0 )  *Words++ = Accum;
+
+   return Words;
+
+}  // Flush_Bits ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The Bits bits starting at bit Bit_Pos of the packed array.   A value can straddle
+//  two words; the second word is only read in that case, so the array isn't over-read.
+//  Bits must not be 0 -- an array of 0 bit values has no words at all.
+
+static inline uint64_t  Get_Bits ( const uint64_t * Words, uint64_t Bit_Pos, uint32_t Bits, uint64_t Mask ) {
+
+   uint64_t  i_Word = Bit_Pos >> 6;
+   uint32_t  Shift = (uint32_t) ( Bit_Pos & 63 );
+   uint64_t  Value;
+
+
+   Value = Words [i_Word] >> Shift;
+   if ( Shift + Bits > 64 )  Value |= Words [i_Word + 1] << ( 64 - Shift );
+
+   return Value & Mask;
+
+}  // Get_Bits ()
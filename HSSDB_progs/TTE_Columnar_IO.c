@@ -0,0 +1,338 @@
+//  Routines to write and read columnar files of processed TTE events -- see
+//  HSSDB_Progs_Header.h (TTE_Columnar_Header_type) for the format.
+
+//  The record formats (Processed_TTE_type, Processed_TTE_v2_type) store each
+//  event as a struct, so a program that needs only some of the fields, e.g.,
+//  the detectors and channels to select NaI events in a band, must still read
+//  every byte of every record.   In the columnar format the events are stored in
+//  row groups, and within a row group each field is a separate, contiguous
+//  column, so that a reader can read just the columns it needs (10 bytes per event
+//  for all three columns, 9 for time and detector, 2 for detector and channel),
+//  and can loop over plain arrays.   The time column is in time order, so it is
+//  also well suited to delta coding.
+
+//  Rows_per_Group is chosen by the writer, 0 selects the default.
+
+//  As elsewhere in these programs, I/O errors are fatal: a message is output
+//  and the program exits.
+
+
+#include "HSSDB_Progs_Header.h"
+
+
+#define  DEFAULT_ROWS_PER_GROUP   65536U
+
+
+//  local function prototypes:
+
+static void  Flush_TTE_Columnar_Group ( TTE_Columnar_File_type * Columnar_ptr );
+
+static void  Allocate_TTE_Columns ( TTE_Columnar_File_type * Columnar_ptr );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Returns true if the file exists and starts with the columnar magic string.
+
+_Bool Is_TTE_Columnar_File (
+
+   // Input argument:
+   const char * FileName
+
+) {
+
+   FILE * File_ptr;
+   char  Magic [8];
+   _Bool  Columnar;
+
+
+   File_ptr = fopen ( FileName, "rb" );
+   if ( File_ptr == NULL )  return false;
+
+   Columnar = fread ( Magic, sizeof (Magic), 1, File_ptr ) == 1  &&
+              memcmp ( Magic, TTE_COLUMNAR_MAGIC, sizeof (Magic) ) == 0;
+
+   fclose ( File_ptr );
+
+   return Columnar;
+
+}  // Is_TTE_Columnar_File ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Open_TTE_Columnar_Output (
+
+   // Input arguments:
+   const char * FileName,
+   uint32_t Rows_per_Group,
+
+   // Output argument:
+   TTE_Columnar_File_type * Columnar_ptr
+
+) {
+
+   if ( Rows_per_Group == 0 )  Rows_per_Group = DEFAULT_ROWS_PER_GROUP;
+
+   if ( Rows_per_Group % 8 != 0 ) {
+      printf ( "\n\nProgram logic error: %u rows per group is not a multiple of 8 -- Exiting!\n", Rows_per_Group );
+      exit (80);
+   }
+
+   memset ( &Columnar_ptr->Header, 0, sizeof (TTE_Columnar_Header_type) );
+   memcpy ( Columnar_ptr->Header.Magic, TTE_COLUMNAR_MAGIC, sizeof (Columnar_ptr->Header.Magic) );
+   Columnar_ptr->Header.Version = 1;
+   Columnar_ptr->Header.Rows_per_Group = Rows_per_Group;
+
+   Columnar_ptr->Num_in_Group = 0;
+   Columnar_ptr->Output = true;
+   Allocate_TTE_Columns ( Columnar_ptr );
+
+   Columnar_ptr->File_ptr = fopen ( FileName, "wb" );
+   if ( Columnar_ptr->File_ptr == NULL ) {
+      printf ( "\n\nFailed to open output columnar TTE file '%s' -- Exiting!\n", FileName );
+      exit (81);
+   }
+
+   //  placeholder, rewritten by Close_TTE_Columnar:
+   if ( fwrite ( &Columnar_ptr->Header, sizeof (TTE_Columnar_Header_type), 1, Columnar_ptr->File_ptr ) != 1 ) {
+      printf ( "\n\nError writing columnar TTE file -- Exiting!\n" );
+      exit (82);
+   }
+
+}  // Open_TTE_Columnar_Output ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Appends events: they are split into the columns of the current row group, which
+//  is written whenever it is full.
+
+void Write_TTE_Columnar (
+
+   // Input/Output argument:
+   TTE_Columnar_File_type * Columnar_ptr,
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events
+
+) {
+
+   size_t  i_event;
+   uint32_t  i_row;
+
+
+   for ( i_event=0;  i_event < Num_Events;  i_event++ ) {
+
+      i_row = Columnar_ptr->Num_in_Group;
+      Columnar_ptr->Times [i_row] = Events [i_event] .Time_in_OneVariable;
+      Columnar_ptr->Detectors [i_row] = Events [i_event] .Detector;
+      Columnar_ptr->Channels [i_row] = Events [i_event] .SpecChannel;
+      Columnar_ptr->Num_in_Group++;
+
+      if ( Columnar_ptr->Num_in_Group == Columnar_ptr->Header.Rows_per_Group )  Flush_TTE_Columnar_Group ( Columnar_ptr );
+
+   }
+
+}  // Write_TTE_Columnar ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Flush_TTE_Columnar_Group ( TTE_Columnar_File_type * Columnar_ptr ) {
+
+   static const uint8_t  Zeros [8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+   uint32_t  Num_Rows = Columnar_ptr->Num_in_Group;
+   FILE * File_ptr = Columnar_ptr->File_ptr;
+
+
+   if ( Num_Rows == 0 )  return;
+
+   if ( fwrite ( Columnar_ptr->Times, sizeof (uint64_t), Num_Rows, File_ptr ) != Num_Rows  ||
+        fwrite ( Columnar_ptr->Detectors, 1, Num_Rows, File_ptr ) != Num_Rows  ||
+        fwrite ( Columnar_ptr->Channels, 1, Num_Rows, File_ptr ) != Num_Rows  ||
+        fwrite ( Zeros, 1, ( 8 - 2 * Num_Rows % 8 ) % 8, File_ptr ) != ( 8 - 2 * Num_Rows % 8 ) % 8 ) {
+      printf ( "\n\nError writing columnar TTE file -- Exiting!\n" );
+      exit (82);
+   }
+
+   Columnar_ptr->Header.Num_Events += Num_Rows;
+   Columnar_ptr->Header.Num_Groups++;
+   Columnar_ptr->Num_in_Group = 0;
+
+}  // Flush_TTE_Columnar_Group ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Allocate_TTE_Columns ( TTE_Columnar_File_type * Columnar_ptr ) {
+
+   uint32_t  Rows = Columnar_ptr->Header.Rows_per_Group;
+
+
+   Columnar_ptr->Times = malloc ( Rows * sizeof (uint64_t) );
+   Columnar_ptr->Detectors = malloc ( Rows );
+   Columnar_ptr->Channels = malloc ( Rows );
+
+   if ( Columnar_ptr->Times == NULL  ||  Columnar_ptr->Detectors == NULL  ||  Columnar_ptr->Channels == NULL ) {
+      printf ( "\n\nmalloc of columnar TTE buffers failed. exiting.\n" );
+      exit (83);
+   }
+
+}  // Allocate_TTE_Columns ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Opens a columnar file for reading.   The file's column arrays are allocated,
+//  one row group each, for the convenience of the caller, who may read into them.
+
+void Open_TTE_Columnar_Input (
+
+   // Input argument:
+   const char * FileName,
+
+   // Output argument:
+   TTE_Columnar_File_type * Columnar_ptr
+
+) {
+
+   TTE_Columnar_Header_type * Header_ptr = &Columnar_ptr->Header;
+
+
+   Columnar_ptr->File_ptr = fopen ( FileName, "rb" );
+   if ( Columnar_ptr->File_ptr == NULL ) {
+      printf ( "\n\nFailed to open input columnar TTE file '%s' -- Exiting!\n", FileName );
+      exit (84);
+   }
+
+   if ( fread ( Header_ptr, sizeof (TTE_Columnar_Header_type), 1, Columnar_ptr->File_ptr ) != 1  ||
+        memcmp ( Header_ptr->Magic, TTE_COLUMNAR_MAGIC, sizeof (Header_ptr->Magic) ) != 0  ||
+        Header_ptr->Version != 1  ||  Header_ptr->Rows_per_Group == 0  ||  Header_ptr->Rows_per_Group % 8 != 0 ) {
+      printf ( "\n\nFile '%s' is not a columnar TTE file (or is incomplete) -- Exiting!\n", FileName );
+      exit (85);
+   }
+
+   Columnar_ptr->Num_in_Group = 0;
+   Columnar_ptr->Output = false;
+   Allocate_TTE_Columns ( Columnar_ptr );
+
+}  // Open_TTE_Columnar_Input ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Reads the requested columns (Columns: OR of TTE_COLUMN_TIME, _DETECTOR, _CHANNEL)
+//  of row group i_Group; the arrays of columns not requested are not used and
+//  may be NULL.   Returns the number of rows of the group.
+
+uint32_t Read_TTE_Columnar_Group (
+
+   // Input arguments:
+   TTE_Columnar_File_type * Columnar_ptr,
+   uint32_t i_Group,
+   uint32_t Columns,
+
+   // Output arguments:
+   uint64_t Times [],
+   uint8_t Detectors [],
+   uint8_t Channels []
+
+) {
+
+   const TTE_Columnar_Header_type * Header_ptr = &Columnar_ptr->Header;
+   FILE * File_ptr = Columnar_ptr->File_ptr;
+   uint64_t  Group_Offset;
+   uint32_t  Num_Rows;
+   _Bool  Error = false;
+
+
+   if ( i_Group >= Header_ptr->Num_Groups )  return 0;
+
+   Num_Rows = Header_ptr->Rows_per_Group;
+   if ( i_Group == Header_ptr->Num_Groups - 1 )
+      Num_Rows = (uint32_t) ( Header_ptr->Num_Events - (uint64_t) i_Group * Header_ptr->Rows_per_Group );
+
+   Group_Offset = sizeof (TTE_Columnar_Header_type) + (uint64_t) i_Group * 10 * Header_ptr->Rows_per_Group;
+
+   if ( Columns & TTE_COLUMN_TIME ) {
+      Error = Error  ||  fseek ( File_ptr, (long) Group_Offset, SEEK_SET ) != 0  ||
+                         fread ( Times, sizeof (uint64_t), Num_Rows, File_ptr ) != Num_Rows;
+   }
+
+   if ( Columns & TTE_COLUMN_DETECTOR ) {
+      Error = Error  ||  fseek ( File_ptr, (long) ( Group_Offset + 8 * (uint64_t) Num_Rows ), SEEK_SET ) != 0  ||
+                         fread ( Detectors, 1, Num_Rows, File_ptr ) != Num_Rows;
+   }
+
+   if ( Columns & TTE_COLUMN_CHANNEL ) {
+      Error = Error  ||  fseek ( File_ptr, (long) ( Group_Offset + 9 * (uint64_t) Num_Rows ), SEEK_SET ) != 0  ||
+                         fread ( Channels, 1, Num_Rows, File_ptr ) != Num_Rows;
+   }
+
+   if ( Error ) {
+      printf ( "\n\nError reading row group %u of columnar TTE file -- Exiting!\n", i_Group );
+      exit (86);
+   }
+
+   return Num_Rows;
+
+}  // Read_TTE_Columnar_Group ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  For an output file, writes the last (partial) row group and the completed header.
+
+void Close_TTE_Columnar (
+
+   // Input/Output argument:
+   TTE_Columnar_File_type * Columnar_ptr
+
+) {
+
+   if ( Columnar_ptr->Output ) {  // output ?
+
+      Flush_TTE_Columnar_Group ( Columnar_ptr );
+
+      if ( fseek ( Columnar_ptr->File_ptr, 0, SEEK_SET ) != 0  ||
+           fwrite ( &Columnar_ptr->Header, sizeof (TTE_Columnar_Header_type), 1, Columnar_ptr->File_ptr ) != 1 ) {
+         printf ( "\n\nError writing columnar TTE file -- Exiting!\n" );
+         exit (82);
+      }
+
+   }  // output ?
+
+   if ( fclose ( Columnar_ptr->File_ptr ) != 0 ) {
+      printf ( "\n\nError closing columnar TTE file -- Exiting!\n" );
+      exit (82);
+   }
+
+   free ( Columnar_ptr->Times );
+   free ( Columnar_ptr->Detectors );
+   free ( Columnar_ptr->Channels );
+   Columnar_ptr->File_ptr = NULL;
+
+}  // Close_TTE_Columnar ()
@@ -0,0 +1,488 @@
+//  Reader of files of TTE events, for the analysis programs: returns the events
+//  in batches, as v2 records (see Processed_TTE_IO.c), from any of:
+
+//  processed TTE files of versions 1 and 2 (as output by Merge_TTE): the file is
+//  mapped into memory, so a batch of a v2 file without a selection is returned in
+//  place, without any copying, and with a selection only the selected events are
+//  copied, from the map to the batch;
+
+//  processed TTE files of versions 3 and 4 (compressed): read via Processed_TTE_IO.c;
+
+//  the per-detector files output by Extract_TTE, identified by the ".TTE_Det_NN"
+//  in their names and the absence of a processed TTE header: TTE_Data_type records
+//  without a header, also mapped.   The detector number, which the records lack, is
+//  taken from the name.   (Compressed per-detector files, Extract_TTE -z, have the
+//  same names but are version 3 processed files, found by their header.)
+
+//  After opening the file, a program may call Select_TTE_Events to receive only
+//  the events with Begin_Time <= time < End_Time, of the detectors in Detector_Mask
+//  (bit j for detector j) and with Min_Channel <= channel <= Max_Channel.   The
+//  selection is made by a loop without branches, which the compiler can vectorize.
+//  For a version 4 file a selection by time also skips the blocks outside of the
+//  time range, and for a per-detector file a selection that excludes the detector
+//  ends the file at once.   For a file of version 1 or 2 with a bitmap index (see
+//  TTE_Bitmap_Index.c), a selection by detector or channel reads only the events
+//  found by the index.
+
+//  Usage:
+//     Open_TTE_Event_Reader ( FileName, Batch_Size, &Reader );
+//     Select_TTE_Events ( &Reader, ... );                 // optional
+//     while ( ( Num_Events = Next_TTE_Event_Batch ( &Reader, &Events ) ) > 0 ) {
+//        ... Events [0] to Events [Num_Events-1] ...
+//     }
+//     Close_TTE_Event_Reader ( &Reader );
+//  The events of a batch remain valid until the next call.
+
+//  As elsewhere in these programs, errors are fatal: a message is output and the
+//  program exits.
+
+
+#define  _POSIX_C_SOURCE  200809L
+
+#include "HSSDB_Progs_Header.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+
+#define  DEFAULT_BATCH_SIZE   65536U
+
+
+//  local function prototypes:
+
+static uint32_t  Detector_from_FileName ( const char * FileName );
+
+static void  Map_TTE_File ( TTE_Event_Reader_type * Reader_ptr, const char * FileName, size_t Header_Bytes, size_t Record_Bytes );
+
+static size_t  Gather_Indexed_TTE_Events ( TTE_Event_Reader_type * Reader_ptr );
+
+static size_t  Keep_Selected_TTE_Events ( const TTE_Event_Reader_type * Reader_ptr,
+                                          const Processed_TTE_v2_type Events [], size_t Num_Events,
+                                          Processed_TTE_v2_type Kept [] );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Batch_Size is the largest number of events returned at a time; 0 for the default.
+
+void Open_TTE_Event_Reader (
+
+   // Input arguments:
+   const char * FileName,
+   uint32_t Batch_Size,
+
+   // Output argument:
+   TTE_Event_Reader_type * Reader_ptr
+
+) {
+
+   Processed_TTE_File_type  Probe;
+
+
+   memset ( Reader_ptr, 0, sizeof (TTE_Event_Reader_type) );
+
+   Reader_ptr->Batch_Size = ( Batch_Size > 0 )  ?  Batch_Size  :  DEFAULT_BATCH_SIZE;
+   Reader_ptr->Batch = malloc ( Reader_ptr->Batch_Size * sizeof (Processed_TTE_v2_type) );
+   if ( Reader_ptr->Batch == NULL ) {
+      printf ( "\n\nmalloc of TTE event batch failed. exiting.\n" );
+      exit (112);
+   }
+
+   Reader_ptr->FileName = malloc ( strlen ( FileName ) + 1 );
+   if ( Reader_ptr->FileName == NULL ) {
+      printf ( "\n\nmalloc of TTE file name failed. exiting.\n" );
+      exit (112);
+   }
+   strcpy ( Reader_ptr->FileName, FileName );
+
+   //  Processed_TTE_IO identifies the version by the header; a file without one is
+   //  of version 1 or, if so named, a per-detector file:
+
+   Open_Processed_TTE_Input ( FileName, &Probe );
+
+   Reader_ptr->Detector = ( Probe.Version == 1 )  ?  Detector_from_FileName ( FileName )  :  UINT32_MAX;
+
+   if ( Probe.Version >= 3 ) {  // kind of file ?
+      Reader_ptr->Kind = TTE_READER_STREAM;
+      Reader_ptr->Stream = Probe;
+   } else if ( Probe.Version == 2 ) {
+      Close_Processed_TTE_File ( &Probe );
+      Reader_ptr->Kind = TTE_READER_MAPPED_V2;
+      Map_TTE_File ( Reader_ptr, FileName, sizeof (Processed_TTE_File_Header_type), sizeof (Processed_TTE_v2_type) );
+   } else if ( Reader_ptr->Detector < NUM_DET ) {
+      Close_Processed_TTE_File ( &Probe );
+      Reader_ptr->Kind = TTE_READER_DETECTOR;
+      Map_TTE_File ( Reader_ptr, FileName, 0, sizeof (TTE_Data_type) );
+   } else {
+      Close_Processed_TTE_File ( &Probe );
+      Reader_ptr->Kind = TTE_READER_MAPPED_V1;
+      Map_TTE_File ( Reader_ptr, FileName, 0, sizeof (Processed_TTE_type) );
+   }  // kind of file ?
+
+}  // Open_TTE_Event_Reader ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Selects the events with Begin_Time <= time < End_Time, of the detectors of
+//  Detector_Mask and with Min_Channel <= channel <= Max_Channel.   To select on
+//  only some of these, use 0 and UINT64_MAX, ALL_DETECTORS_MASK, and 0 and
+//  NUM_SPEC_CHAN - 1.   Call it before reading the first batch.
+
+void Select_TTE_Events (
+
+   // Input/Output argument:
+   TTE_Event_Reader_type * Reader_ptr,
+
+   // Input arguments:
+   uint64_t Begin_Time,
+   uint64_t End_Time,
+   uint32_t Detector_Mask,
+   uint32_t Min_Channel,
+   uint32_t Max_Channel
+
+) {
+
+   TTE_Bitmap_Index_type  Index;
+
+
+   if ( Begin_Time > End_Time  ||  Min_Channel > Max_Channel ) {
+      printf ( "\n\nInvalid selection of TTE events: times %llu to %llu, channels %u to %u -- Exiting!\n",
+               (long long unsigned int) Begin_Time, (long long unsigned int) End_Time, Min_Channel, Max_Channel );
+      exit (113);
+   }
+
+   Reader_ptr->Selected = true;
+   Reader_ptr->Begin_Time = Begin_Time;
+   Reader_ptr->End_Time = End_Time;
+   Reader_ptr->Detector_Mask = Detector_Mask;
+   Reader_ptr->Min_Channel = Min_Channel;
+   Reader_ptr->Max_Channel = Max_Channel;
+
+   //  A per-detector file has only the one detector:
+
+   if ( Reader_ptr->Kind == TTE_READER_DETECTOR  &&  ( ( Detector_Mask >> Reader_ptr->Detector ) & 1U ) == 0 )
+      Reader_ptr->i_Record = Reader_ptr->Num_Records;
+
+   //  For version 4, let Processed_TTE_IO skip the blocks outside of the time range.
+   //  The detectors and channels are selected here, so that Num_Scanned counts all
+   //  of the events of the time range.
+
+   if ( Reader_ptr->Kind == TTE_READER_STREAM  &&  ( Begin_Time > 0  ||  End_Time < UINT64_MAX ) )
+      Select_Processed_TTE ( &Reader_ptr->Stream, Begin_Time, End_Time, UINT32_MAX );
+
+   //  For a mapped processed file, find the selected detectors and channels with the
+   //  index, if there is a current one.   The time range is still selected below.
+
+   if ( ( Reader_ptr->Kind == TTE_READER_MAPPED_V1  ||  Reader_ptr->Kind == TTE_READER_MAPPED_V2 )  &&
+        ( ( Detector_Mask & ALL_DETECTORS_MASK ) != ALL_DETECTORS_MASK  ||  Min_Channel > 0  ||  Max_Channel < NUM_SPEC_CHAN - 1 )  &&
+        Reader_ptr->Ordinals == NULL  &&  Reader_ptr->i_Record == 0  &&
+        Open_TTE_Bitmap_Index ( Reader_ptr->FileName, Reader_ptr->Map, Reader_ptr->Map_Bytes, Reader_ptr->Num_Records, &Index ) ) {
+
+      Reader_ptr->Num_Ordinals = Query_TTE_Bitmap_Index ( &Index, Detector_Mask, Min_Channel, Max_Channel, &Reader_ptr->Ordinals );
+      Reader_ptr->i_Ordinal = 0;
+      Close_TTE_Bitmap_Index ( &Index );
+
+      if ( Reader_ptr->Ordinals == NULL ) {   // none selected
+         Reader_ptr->i_Record = Reader_ptr->Num_Records;
+         Reader_ptr->Num_Scanned = Reader_ptr->Num_Records;
+      }
+
+   }
+
+}  // Select_TTE_Events ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Returns the number of events of the next batch, with *Batch_ptr pointing to
+//  them; 0 at the end of the file.   With a selection, a batch has at least one
+//  event unless the end of the file has been reached.
+
+size_t Next_TTE_Event_Batch (
+
+   // Input/Output argument:
+   TTE_Event_Reader_type * Reader_ptr,
+
+   // Output argument:
+   const Processed_TTE_v2_type ** Batch_ptr
+
+) {
+
+   const Processed_TTE_v2_type *  Source_ptr;
+   const Processed_TTE_type *  V1_ptr;
+   const TTE_Data_type *  Det_ptr;
+
+   size_t  Num_Read;
+   size_t  Num_Kept;
+   size_t  i;
+
+
+   do {
+
+      Source_ptr = Reader_ptr->Batch;
+
+      if ( Reader_ptr->Kind == TTE_READER_STREAM ) {  // kind ?
+
+         Num_Read = Read_Processed_TTE ( &Reader_ptr->Stream, Reader_ptr->Batch, Reader_ptr->Batch_Size );
+         Reader_ptr->Num_Scanned += Num_Read;
+
+      } else if ( Reader_ptr->Ordinals != NULL ) {  // kind ?
+
+         Num_Read = Gather_Indexed_TTE_Events ( Reader_ptr );
+
+      } else {  // kind ?
+
+         Num_Read = Reader_ptr->Batch_Size;
+         if ( Num_Read > Reader_ptr->Num_Records - Reader_ptr->i_Record )  Num_Read = Reader_ptr->Num_Records - Reader_ptr->i_Record;
+
+         if ( Reader_ptr->Kind == TTE_READER_MAPPED_V2 ) {  // mapped kind ?
+
+            //  In place: returned as is, or the selected events copied from the map:
+
+            Source_ptr = (const Processed_TTE_v2_type *) Reader_ptr->Records + Reader_ptr->i_Record;
+
+         } else if ( Reader_ptr->Kind == TTE_READER_MAPPED_V1 ) {  // mapped kind ?
+
+            V1_ptr = (const Processed_TTE_type *) Reader_ptr->Records + Reader_ptr->i_Record;
+
+            for ( i=0;  i < Num_Read;  i++ ) {
+               Reader_ptr->Batch [i] .Time_in_OneVariable = IntegerTime_from_CoarseFine ( V1_ptr [i] .CoarseTime, V1_ptr [i] .FineTime );
+               Reader_ptr->Batch [i] .Detector = (uint8_t) V1_ptr [i] .Detector;
+               Reader_ptr->Batch [i] .SpecChannel = (uint8_t) V1_ptr [i] .SpecChannel;
+               Reader_ptr->Batch [i] .Flags = 0;
+               Reader_ptr->Batch [i] .Reserved = 0;
+            }
+
+         } else {  // mapped kind ?
+
+            Det_ptr = (const TTE_Data_type *) Reader_ptr->Records + Reader_ptr->i_Record;
+
+            for ( i=0;  i < Num_Read;  i++ ) {
+               Reader_ptr->Batch [i] .Time_in_OneVariable = IntegerTime_from_CoarseFine ( Det_ptr [i] .CoarseTime, Det_ptr [i] .FineTime );
+               Reader_ptr->Batch [i] .Detector = (uint8_t) Reader_ptr->Detector;
+               Reader_ptr->Batch [i] .SpecChannel = (uint8_t) Det_ptr [i] .SpecChannel;
+               Reader_ptr->Batch [i] .Flags = 0;
+               Reader_ptr->Batch [i] .Reserved = 0;
+            }
+
+         }  // mapped kind ?
+
+         Reader_ptr->i_Record += Num_Read;
+         Reader_ptr->Num_Scanned += Num_Read;
+
+      }  // kind ?
+
+      if ( Reader_ptr->Selected ) {
+         Num_Kept = Keep_Selected_TTE_Events ( Reader_ptr, Source_ptr, Num_Read, Reader_ptr->Batch );
+         *Batch_ptr = Reader_ptr->Batch;
+      } else {
+         Num_Kept = Num_Read;
+         *Batch_ptr = Source_ptr;
+      }
+
+   } while ( Num_Kept == 0  &&  Num_Read > 0 );
+
+   Reader_ptr->Num_Returned += Num_Kept;
+
+   return Num_Kept;
+
+}  // Next_TTE_Event_Batch ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Close_TTE_Event_Reader (
+
+   // Input/Output argument:
+   TTE_Event_Reader_type * Reader_ptr
+
+) {
+
+   if ( Reader_ptr->Kind == TTE_READER_STREAM )
+      Close_Processed_TTE_File ( &Reader_ptr->Stream );
+   else if ( Reader_ptr->Map != NULL )
+      munmap ( (void *) (uintptr_t) Reader_ptr->Map, Reader_ptr->Map_Bytes );
+
+   free ( Reader_ptr->Batch );
+   free ( Reader_ptr->Ordinals );
+   free ( Reader_ptr->FileName );
+
+   Reader_ptr->Map = NULL;
+   Reader_ptr->Batch = NULL;
+   Reader_ptr->Ordinals = NULL;
+   Reader_ptr->FileName = NULL;
+
+}  // Close_TTE_Event_Reader ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The detector number of a per-detector file named ....TTE_Det_NN.dat, else UINT32_MAX.
+
+static uint32_t  Detector_from_FileName ( const char * FileName ) {
+
+   const char *  Found_ptr;
+   unsigned int  Detector;
+
+
+   Found_ptr = strstr ( FileName, ".TTE_Det_" );
+
+   if ( Found_ptr == NULL  ||  sscanf ( Found_ptr, ".TTE_Det_%2u", &Detector ) != 1  ||  Detector >= NUM_DET )  return UINT32_MAX;
+
+   return Detector;
+
+}  // Detector_from_FileName ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Maps the whole file; the records start after Header_Bytes.   A partial record
+//  at the end of the file is ignored, as fread would.
+
+static void  Map_TTE_File ( TTE_Event_Reader_type * Reader_ptr, const char * FileName, size_t Header_Bytes, size_t Record_Bytes ) {
+
+   int  fd;
+   struct stat  File_Status;
+   void *  Map_ptr;
+
+
+   fd = open ( FileName, O_RDONLY );
+   if ( fd < 0  ||  fstat ( fd, &File_Status ) != 0 ) {
+      printf ( "\n\nFailed to open input TTE File '%s' -- Exiting!\n", FileName );
+      exit (110);
+   }
+
+   Reader_ptr->Map_Bytes = (size_t) File_Status.st_size;
+
+   if ( Reader_ptr->Map_Bytes > Header_Bytes ) {
+
+      Map_ptr = mmap ( NULL, Reader_ptr->Map_Bytes, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( Map_ptr == MAP_FAILED ) {
+         printf ( "\n\nFailed to map input TTE File '%s' into memory -- Exiting!\n", FileName );
+         exit (111);
+      }
+
+      //  The events are read in order: have the OS read ahead.
+
+      posix_madvise ( Map_ptr, Reader_ptr->Map_Bytes, POSIX_MADV_SEQUENTIAL );
+
+      Reader_ptr->Map = Map_ptr;
+      Reader_ptr->Records = Reader_ptr->Map + Header_Bytes;
+      Reader_ptr->Num_Records = ( Reader_ptr->Map_Bytes - Header_Bytes ) / Record_Bytes;
+
+   }
+
+   close ( fd );
+
+}  // Map_TTE_File ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Copies the events at the next ordinals found by the index to the batch; returns
+//  the number copied.   Num_Scanned counts the events passed over, as if read, so
+//  that it is the same as without the index.
+
+static size_t  Gather_Indexed_TTE_Events ( TTE_Event_Reader_type * Reader_ptr ) {
+
+   const Processed_TTE_v2_type *  V2_ptr;
+   const Processed_TTE_type *  V1_ptr;
+   const uint32_t *  Ordinals;
+   size_t  Num_Read;
+   size_t  i;
+
+
+   Num_Read = Reader_ptr->Batch_Size;
+   if ( Num_Read > Reader_ptr->Num_Ordinals - Reader_ptr->i_Ordinal )  Num_Read = Reader_ptr->Num_Ordinals - Reader_ptr->i_Ordinal;
+
+   Ordinals = Reader_ptr->Ordinals + Reader_ptr->i_Ordinal;
+
+   if ( Reader_ptr->Kind == TTE_READER_MAPPED_V2 ) {  // version ?
+
+      V2_ptr = (const Processed_TTE_v2_type *) Reader_ptr->Records;
+
+      for ( i=0;  i < Num_Read;  i++ )  Reader_ptr->Batch [i] = V2_ptr [Ordinals [i]];
+
+   } else {  // version ?
+
+      V1_ptr = (const Processed_TTE_type *) Reader_ptr->Records;
+
+      for ( i=0;  i < Num_Read;  i++ ) {
+         Reader_ptr->Batch [i] .Time_in_OneVariable = IntegerTime_from_CoarseFine ( V1_ptr [Ordinals [i]] .CoarseTime, V1_ptr [Ordinals [i]] .FineTime );
+         Reader_ptr->Batch [i] .Detector = (uint8_t) V1_ptr [Ordinals [i]] .Detector;
+         Reader_ptr->Batch [i] .SpecChannel = (uint8_t) V1_ptr [Ordinals [i]] .SpecChannel;
+         Reader_ptr->Batch [i] .Flags = 0;
+         Reader_ptr->Batch [i] .Reserved = 0;
+      }
+
+   }  // version ?
+
+   Reader_ptr->i_Ordinal += Num_Read;
+
+   if ( Reader_ptr->i_Ordinal == Reader_ptr->Num_Ordinals )
+      Reader_ptr->Num_Scanned = Reader_ptr->Num_Records;
+   else
+      Reader_ptr->Num_Scanned = (uint64_t) Ordinals [Num_Read - 1] + 1;
+
+   return Num_Read;
+
+}  // Gather_Indexed_TTE_Events ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Copies the selected events of Events to Kept, which may be Events itself;
+//  returns the number kept.   Each event is copied, and kept by advancing the
+//  count or not, so that the loop has no branches.   The ranges are tested with
+//  a single unsigned comparison each: x - Low <= High - Low.
+
+static size_t  Keep_Selected_TTE_Events ( const TTE_Event_Reader_type * Reader_ptr,
+                                          const Processed_TTE_v2_type Events [], size_t Num_Events,
+                                          Processed_TTE_v2_type Kept [] ) {
+
+   const uint64_t  Begin_Time = Reader_ptr->Begin_Time;
+   const uint64_t  Time_Width = Reader_ptr->End_Time - Reader_ptr->Begin_Time;
+   const uint32_t  Detector_Mask = Reader_ptr->Detector_Mask;
+   const uint32_t  Min_Channel = Reader_ptr->Min_Channel;
+   const uint32_t  Channel_Width = Reader_ptr->Max_Channel - Reader_ptr->Min_Channel;
+
+   size_t  i_event;
+   size_t  Num_Kept = 0;
+   uint32_t  Detector;
+   uint32_t  Keep;
+
+
+   for ( i_event=0;  i_event < Num_Events;  i_event++ ) {
+
+      Detector = Events [i_event] .Detector;
+
+      Keep = (uint32_t) ( Events [i_event] .Time_in_OneVariable - Begin_Time < Time_Width )  &
+             (uint32_t) ( Detector < 32 )  &  ( Detector_Mask >> ( Detector & 31U ) )  &
+             (uint32_t) ( (uint32_t) Events [i_event] .SpecChannel - Min_Channel <= Channel_Width );
+
+      Kept [Num_Kept] = Events [i_event];
+      Num_Kept += Keep & 1U;
+
+   }
+
+   return Num_Kept;
+
+}  // Keep_Selected_TTE_Events ()
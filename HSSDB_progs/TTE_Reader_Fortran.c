@@ -0,0 +1,170 @@
+//  Interface of TTE_Event_Reader.c for Fortran programs, via ISO_C_BINDING --
+//  see the module TTE_Reader in TTE_Reader_Module.f90, which declares these routines
+//  with bind(C).
+
+//  Fortran lacks unsigned integers, so the events are returned as separate arrays
+//  of signed integers wide enough to hold the unsigned values: the times as
+//  int64 (2 microsec ticks, far below 2**63) and the detectors and channels as
+//  int16.   The caller provides the arrays; each call fills as many elements as
+//  it can, up to Max_Events, converting whole batches of the reader at a time,
+//  so a program can read millions of events per call.
+
+//  The reader is passed to Fortran as an opaque pointer, type (C_PTR).
+
+
+#include "HSSDB_Progs_Header.h"
+
+
+//  local typedefs:
+
+typedef struct  TTE_Reader_Fortran_type {
+   TTE_Event_Reader_type  Reader;
+   const Processed_TTE_v2_type *  Batch;     // the current batch of the reader
+   size_t  Num_in_Batch;
+   size_t  i_Batch;                          // next event of the batch to return
+} TTE_Reader_Fortran_type;
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  FileName is a C string, i.e., terminated by C_NULL_CHAR.
+
+void * Open_TTE_Reader_F (
+
+   // Input argument:
+   const char * FileName
+
+) {
+
+   TTE_Reader_Fortran_type * Handle_ptr;
+
+
+   Handle_ptr = malloc ( sizeof (TTE_Reader_Fortran_type) );
+   if ( Handle_ptr == NULL ) {
+      printf ( "\n\nmalloc of TTE reader failed. exiting.\n" );
+      exit (112);
+   }
+
+   Open_TTE_Event_Reader ( FileName, 0, &Handle_ptr->Reader );
+
+   Handle_ptr->Batch = NULL;
+   Handle_ptr->Num_in_Batch = 0;
+   Handle_ptr->i_Batch = 0;
+
+   return Handle_ptr;
+
+}  // Open_TTE_Reader_F ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  As Select_TTE_Events.   Call it before reading any events.
+
+void Select_TTE_Reader_F (
+
+   // Input/Output argument:
+   void * Handle,
+
+   // Input arguments:
+   int64_t Begin_Time,
+   int64_t End_Time,
+   int32_t Detector_Mask,
+   int32_t Min_Channel,
+   int32_t Max_Channel
+
+) {
+
+   TTE_Reader_Fortran_type * Handle_ptr = Handle;
+
+
+   if ( Begin_Time < 0  ||  End_Time < 0  ||  Min_Channel < 0  ||  Max_Channel < 0 ) {
+      printf ( "\n\nInvalid selection of TTE events: negative time or channel -- Exiting!\n" );
+      exit (113);
+   }
+
+   Select_TTE_Events ( &Handle_ptr->Reader, (uint64_t) Begin_Time, (uint64_t) End_Time,
+                       (uint32_t) Detector_Mask, (uint32_t) Min_Channel, (uint32_t) Max_Channel );
+
+}  // Select_TTE_Reader_F ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Fills up to Max_Events elements of the arrays with the next events.   Returns the
+//  number of events; fewer than Max_Events only at the end of the file, 0 after it.
+
+int64_t Read_TTE_Events_F (
+
+   // Input/Output argument:
+   void * Handle,
+
+   // Input argument:
+   int64_t Max_Events,
+
+   // Output arguments:
+   int64_t Times [],
+   int16_t Detectors [],
+   int16_t Channels []
+
+) {
+
+   TTE_Reader_Fortran_type * Handle_ptr = Handle;
+
+   int64_t  Num_Filled = 0;
+   size_t  Num2Copy;
+   size_t  i;
+   const Processed_TTE_v2_type *  Event_ptr;
+
+
+   while ( Num_Filled < Max_Events ) {
+
+      if ( Handle_ptr->i_Batch == Handle_ptr->Num_in_Batch ) {
+         Handle_ptr->Num_in_Batch = Next_TTE_Event_Batch ( &Handle_ptr->Reader, &Handle_ptr->Batch );
+         Handle_ptr->i_Batch = 0;
+         if ( Handle_ptr->Num_in_Batch == 0 )  break;   // end of file
+      }
+
+      Num2Copy = Handle_ptr->Num_in_Batch - Handle_ptr->i_Batch;
+      if ( Num2Copy > (uint64_t) ( Max_Events - Num_Filled ) )  Num2Copy = (size_t) ( Max_Events - Num_Filled );
+
+      Event_ptr = Handle_ptr->Batch + Handle_ptr->i_Batch;
+
+      for ( i=0;  i < Num2Copy;  i++ ) {
+         Times [Num_Filled + (int64_t) i] = (int64_t) Event_ptr [i] .Time_in_OneVariable;
+         Detectors [Num_Filled + (int64_t) i] = Event_ptr [i] .Detector;
+         Channels [Num_Filled + (int64_t) i] = Event_ptr [i] .SpecChannel;
+      }
+
+      Handle_ptr->i_Batch += Num2Copy;
+      Num_Filled += (int64_t) Num2Copy;
+
+   }
+
+   return Num_Filled;
+
+}  // Read_TTE_Events_F ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Close_TTE_Reader_F (
+
+   // Input/Output argument:
+   void * Handle
+
+) {
+
+   TTE_Reader_Fortran_type * Handle_ptr = Handle;
+
+
+   Close_TTE_Event_Reader ( &Handle_ptr->Reader );
+   free ( Handle_ptr );
+
+}  // Close_TTE_Reader_F ()
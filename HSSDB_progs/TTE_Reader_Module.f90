@@ -0,0 +1,149 @@
+module TTE_Reader
+
+
+   !  Fortran interface to the C reader of TTE event files, TTE_Event_Reader.c,
+   !  via TTE_Reader_Fortran.c.   Reads processed TTE files of any version and the
+   !  per-detector files output by Extract_TTE.   The file is mapped into memory
+   !  and each call fills the caller's arrays with as many events as they hold:
+
+   !     type (C_PTR) :: Reader
+   !     integer (int64) :: Times (N), Num_Read
+   !     integer (int16) :: Detectors (N), Channels (N)
+   !
+   !     Reader = Open_TTE_Reader ( "Processed_TTE.dat" )
+   !     call Select_TTE_Reader ( Reader, Begin_Time, End_Time, Detector_Mask )   ! optional
+   !     do
+   !        Num_Read = Read_TTE_Events ( Reader, Times, Detectors, Channels )
+   !        if ( Num_Read == 0 )  exit
+   !        ... Times (1:Num_Read), etc. ...
+   !     end do
+   !     call Close_TTE_Reader ( Reader )
+
+   !  The times are in 2 microsec ticks (GBM Unified Time, see
+   !  IntegerTime_from_CoarseFine.c); the values are unsigned in the files, but
+   !  all fit in these signed kinds, so no "fixing" of the sign is needed.
+   !  The selection is of Begin_Time <= time < End_Time, of the detectors with
+   !  their bit set in Detector_Mask (bit j for detector j, as with IBSET),
+   !  and optionally of Min_Channel <= channel <= Max_Channel.
+
+
+   use, intrinsic :: ISO_FORTRAN_ENV
+
+   use, intrinsic :: ISO_C_BINDING
+
+   implicit none
+
+   private
+
+   public :: Open_TTE_Reader, Select_TTE_Reader, Read_TTE_Events, Close_TTE_Reader
+
+   integer (int32), parameter, public :: ALL_DETECTORS_MASK = 2_int32 ** 14_int32 - 1_int32
+
+
+   interface
+
+      function Open_TTE_Reader_F ( FileName )  bind ( C, name="Open_TTE_Reader_F" )
+         import :: C_PTR, C_CHAR
+         type (C_PTR) :: Open_TTE_Reader_F
+         character (kind=C_CHAR), dimension (*), intent (in) :: FileName
+      end function Open_TTE_Reader_F
+
+      subroutine Select_TTE_Reader_F ( Handle, Begin_Time, End_Time, Detector_Mask, Min_Channel, Max_Channel )   &
+            bind ( C, name="Select_TTE_Reader_F" )
+         import :: C_PTR, C_INT64_T, C_INT32_T
+         type (C_PTR), value :: Handle
+         integer (C_INT64_T), value :: Begin_Time, End_Time
+         integer (C_INT32_T), value :: Detector_Mask, Min_Channel, Max_Channel
+      end subroutine Select_TTE_Reader_F
+
+      function Read_TTE_Events_F ( Handle, Max_Events, Times, Detectors, Channels )  bind ( C, name="Read_TTE_Events_F" )
+         import :: C_PTR, C_INT64_T, C_INT16_T
+         integer (C_INT64_T) :: Read_TTE_Events_F
+         type (C_PTR), value :: Handle
+         integer (C_INT64_T), value :: Max_Events
+         integer (C_INT64_T), dimension (*), intent (out) :: Times
+         integer (C_INT16_T), dimension (*), intent (out) :: Detectors, Channels
+      end function Read_TTE_Events_F
+
+      subroutine Close_TTE_Reader_F ( Handle )  bind ( C, name="Close_TTE_Reader_F" )
+         import :: C_PTR
+         type (C_PTR), value :: Handle
+      end subroutine Close_TTE_Reader_F
+
+   end interface
+
+
+contains
+
+
+   ! - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+   function Open_TTE_Reader ( FileName )  result ( Reader )
+
+      character (len=*), intent (in) :: FileName
+      type (C_PTR) :: Reader
+
+      Reader = Open_TTE_Reader_F ( trim (FileName) // C_NULL_CHAR )
+
+   end function Open_TTE_Reader
+
+
+   ! - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+   subroutine Select_TTE_Reader ( Reader, Begin_Time, End_Time, Detector_Mask, Min_Channel, Max_Channel )
+
+      type (C_PTR), intent (in) :: Reader
+      integer (int64), intent (in) :: Begin_Time, End_Time
+      integer (int32), intent (in) :: Detector_Mask
+      integer (int32), intent (in), optional :: Min_Channel, Max_Channel
+
+      integer (int32) :: Min_Chan, Max_Chan
+
+      Min_Chan = 0
+      Max_Chan = 127
+      if ( present (Min_Channel) )  Min_Chan = Min_Channel
+      if ( present (Max_Channel) )  Max_Chan = Max_Channel
+
+      call Select_TTE_Reader_F ( Reader, Begin_Time, End_Time, Detector_Mask, Min_Chan, Max_Chan )
+
+   end subroutine Select_TTE_Reader
+
+
+   ! - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+   !  Fills the arrays with the next events, as many as the smallest array holds;
+   !  returns the number read, fewer only at the end of the file, 0 after it.
+
+   function Read_TTE_Events ( Reader, Times, Detectors, Channels )  result ( Num_Read )
+
+      type (C_PTR), intent (in) :: Reader
+      integer (int64), dimension (:), intent (out) :: Times
+      integer (int16), dimension (:), intent (out) :: Detectors, Channels
+      integer (int64) :: Num_Read
+
+      integer (int64) :: Max_Events
+
+      Max_Events = min ( size (Times, kind=int64), size (Detectors, kind=int64), size (Channels, kind=int64) )
+
+      Num_Read = Read_TTE_Events_F ( Reader, Max_Events, Times, Detectors, Channels )
+
+   end function Read_TTE_Events
+
+
+   ! - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+
+   subroutine Close_TTE_Reader ( Reader )
+
+      type (C_PTR), intent (inout) :: Reader
+
+      call Close_TTE_Reader_F ( Reader )
+      Reader = C_NULL_PTR
+
+   end subroutine Close_TTE_Reader
+
+
+end module TTE_Reader
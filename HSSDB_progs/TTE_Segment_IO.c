@@ -0,0 +1,344 @@
+//  Routines to write and read the segment files of a TTE archive -- see
+//  MAIN_Compact_TTE.c for the archive, and HSSDB_Progs_Header.h for the
+//  segment format (TTE_Segment_Header_type).
+
+//  A segment holds the events of one time partition, in time order.   It is
+//  written sequentially: the header is written as a placeholder, then the
+//  events, then the time index, and finally the completed header is written
+//  over the placeholder.   The placeholder has no magic or version: these are
+//  written only with the completed header, after the events and the index have
+//  been flushed to the disk (fsync), and the header is flushed in turn, so a
+//  segment cut off by a crash is never taken for a complete one.   A reader
+//  uses the index to start reading at any time after reading at most
+//  Index_Stride events.   The offsets are off_t (fseeko), for segments larger
+//  than 2 GB.
+
+//  As elsewhere in these programs, I/O errors are fatal: a message is output
+//  and the program exits.
+
+
+#define  _POSIX_C_SOURCE  200809L
+#define  _FILE_OFFSET_BITS  64
+
+#include "HSSDB_Progs_Header.h"
+
+#include <sys/types.h>
+#include <unistd.h>
+
+
+//  Events per index entry: 4096 events are 64 kB, a reasonable unit to read
+//  when seeking.
+#define  SEGMENT_INDEX_STRIDE   4096U
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Open_TTE_Segment_Output (
+
+   // Input arguments:
+   const char * FileName,
+   uint64_t Partition,
+   uint64_t Partition_Ticks,
+
+   // Output argument:
+   TTE_Segment_File_type * Segment_ptr
+
+) {
+
+   //  The magic and version are set by Close_TTE_Segment:
+   memset ( &Segment_ptr->Header, 0, sizeof (TTE_Segment_Header_type) );
+   Segment_ptr->Header.RecordBytes = sizeof (Processed_TTE_v2_type);
+   Segment_ptr->Header.Partition = Partition;
+   Segment_ptr->Header.Partition_Ticks = Partition_Ticks;
+   Segment_ptr->Header.Index_Stride = SEGMENT_INDEX_STRIDE;
+
+   Segment_ptr->Index = NULL;
+   Segment_ptr->Index_Capacity = 0;
+   Segment_ptr->Next_Event = 0;
+   Segment_ptr->Output = true;
+
+   Segment_ptr->File_ptr = fopen ( FileName, "wb" );
+   if ( Segment_ptr->File_ptr == NULL ) {
+      printf ( "\n\nFailed to open output TTE segment '%s' -- Exiting!\n", FileName );
+      exit (70);
+   }
+
+   //  placeholder, rewritten by Close_TTE_Segment:
+   if ( fwrite ( &Segment_ptr->Header, sizeof (TTE_Segment_Header_type), 1, Segment_ptr->File_ptr ) != 1 ) {
+      printf ( "\n\nError writing TTE segment header -- Exiting!\n" );
+      exit (71);
+   }
+
+}  // Open_TTE_Segment_Output ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Appends events, which must be in time order and in the partition of the segment.
+
+void Write_TTE_Segment (
+
+   // Input/Output argument:
+   TTE_Segment_File_type * Segment_ptr,
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events
+
+) {
+
+   TTE_Segment_Header_type * Header_ptr = &Segment_ptr->Header;
+   uint64_t * New_Index;
+   size_t  i_event;
+
+
+   for ( i_event=0;  i_event < Num_Events;  i_event++ ) {  // check & index events
+
+      if ( Events [i_event] .Time_in_OneVariable / Header_ptr->Partition_Ticks  !=  Header_ptr->Partition  ||
+           ( Segment_ptr->Next_Event > 0  &&  Events [i_event] .Time_in_OneVariable < Header_ptr->Last_Time ) ) {
+         printf ( "\n\nError: event out of order or outside of partition %llu of TTE segment -- Exiting!\n",
+                  (long long unsigned int) Header_ptr->Partition );
+         exit (72);
+      }
+
+      if ( Segment_ptr->Next_Event % Header_ptr->Index_Stride == 0 ) {  // start of index interval ?
+
+         if ( Header_ptr->Num_Index == Segment_ptr->Index_Capacity ) {
+            Segment_ptr->Index_Capacity = ( Segment_ptr->Index_Capacity == 0 )  ?  1024  :  2 * Segment_ptr->Index_Capacity;
+            New_Index = realloc ( Segment_ptr->Index, Segment_ptr->Index_Capacity * sizeof (uint64_t) );
+            if ( New_Index == NULL ) {
+               printf ( "\n\nmalloc of TTE segment index failed. exiting.\n" );
+               exit (73);
+            }
+            Segment_ptr->Index = New_Index;
+         }
+
+         Segment_ptr->Index [Header_ptr->Num_Index] = Events [i_event] .Time_in_OneVariable;
+         Header_ptr->Num_Index++;
+
+      }  // start of index interval ?
+
+      if ( Segment_ptr->Next_Event == 0 )  Header_ptr->First_Time = Events [i_event] .Time_in_OneVariable;
+      Header_ptr->Last_Time = Events [i_event] .Time_in_OneVariable;
+      Segment_ptr->Next_Event++;
+
+   }  // check & index events
+
+
+   if ( fwrite ( Events, sizeof (Processed_TTE_v2_type), Num_Events, Segment_ptr->File_ptr )  !=  Num_Events ) {
+      printf ( "\n\nError writing TTE segment -- Exiting!\n" );
+      exit (71);
+   }
+
+   Header_ptr->Num_Events = Segment_ptr->Next_Event;
+
+}  // Write_TTE_Segment ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Open_TTE_Segment_Input (
+
+   // Input argument:
+   const char * FileName,
+
+   // Output argument:
+   TTE_Segment_File_type * Segment_ptr
+
+) {
+
+   TTE_Segment_Header_type * Header_ptr = &Segment_ptr->Header;
+
+
+   Segment_ptr->File_ptr = fopen ( FileName, "rb" );
+   if ( Segment_ptr->File_ptr == NULL ) {
+      printf ( "\n\nFailed to open input TTE segment '%s' -- Exiting!\n", FileName );
+      exit (74);
+   }
+
+   if ( fread ( Header_ptr, sizeof (TTE_Segment_Header_type), 1, Segment_ptr->File_ptr ) != 1  ||
+        memcmp ( Header_ptr->Magic, TTE_SEGMENT_MAGIC, sizeof (Header_ptr->Magic) ) != 0  ||
+        Header_ptr->Version != 1  ||  Header_ptr->RecordBytes != sizeof (Processed_TTE_v2_type)  ||
+        Header_ptr->Index_Stride == 0 ) {
+      printf ( "\n\nFile '%s' is not a TTE segment (or is incomplete) -- Exiting!\n", FileName );
+      exit (75);
+   }
+
+   Segment_ptr->Index_Capacity = Header_ptr->Num_Index;
+   Segment_ptr->Index = malloc ( ( Header_ptr->Num_Index + 1 ) * sizeof (uint64_t) );
+   if ( Segment_ptr->Index == NULL ) {
+      printf ( "\n\nmalloc of TTE segment index failed. exiting.\n" );
+      exit (73);
+   }
+
+   if ( fseeko ( Segment_ptr->File_ptr, (off_t) ( sizeof (TTE_Segment_Header_type) +
+                                                  Header_ptr->Num_Events * sizeof (Processed_TTE_v2_type) ), SEEK_SET ) != 0  ||
+        fread ( Segment_ptr->Index, sizeof (uint64_t), Header_ptr->Num_Index, Segment_ptr->File_ptr ) != Header_ptr->Num_Index ) {
+      printf ( "\n\nError reading the index of TTE segment '%s' -- Exiting!\n", FileName );
+      exit (76);
+   }
+
+   Segment_ptr->Next_Event = 0;
+   Segment_ptr->Output = false;
+   fseeko ( Segment_ptr->File_ptr, (off_t) sizeof (TTE_Segment_Header_type), SEEK_SET );
+
+}  // Open_TTE_Segment_Input ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Positions the segment so that the next event read is the first event with time >= Time.
+//  The index gives the interval of Index_Stride events that contains that event, which
+//  is then searched.
+
+void Seek_TTE_Segment (
+
+   // Input/Output argument:
+   TTE_Segment_File_type * Segment_ptr,
+
+   // Input argument:
+   uint64_t Time
+
+) {
+
+   TTE_Segment_Header_type * Header_ptr = &Segment_ptr->Header;
+   Processed_TTE_v2_type  Event;
+   uint32_t  i_low, i_high, i_mid;
+
+
+   //  Binary search for the last index entry with time < Time -- the first event
+   //  with time >= Time can't be in an earlier interval:
+
+   i_low = 0;
+   i_high = Header_ptr->Num_Index;      // the answer is in [i_low, i_high)
+
+   while ( i_high - i_low > 1 ) {
+      i_mid = i_low + ( i_high - i_low ) / 2;
+      if ( Segment_ptr->Index [i_mid] < Time )
+         i_low = i_mid;
+      else
+         i_high = i_mid;
+   }
+
+   Segment_ptr->Next_Event = (uint64_t) i_low * Header_ptr->Index_Stride;
+   if ( Segment_ptr->Next_Event > Header_ptr->Num_Events )  Segment_ptr->Next_Event = Header_ptr->Num_Events;
+
+   fseeko ( Segment_ptr->File_ptr, (off_t) ( sizeof (TTE_Segment_Header_type) +
+                                             Segment_ptr->Next_Event * sizeof (Processed_TTE_v2_type) ), SEEK_SET );
+
+   while ( Segment_ptr->Next_Event < Header_ptr->Num_Events ) {
+
+      if ( fread ( &Event, sizeof (Event), 1, Segment_ptr->File_ptr ) != 1 ) {
+         printf ( "\n\nError reading TTE segment -- Exiting!\n" );
+         exit (77);
+      }
+
+      if ( Event.Time_in_OneVariable >= Time ) {
+         fseeko ( Segment_ptr->File_ptr, - (off_t) sizeof (Event), SEEK_CUR );
+         break;
+      }
+
+      Segment_ptr->Next_Event++;
+
+   }
+
+}  // Seek_TTE_Segment ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Reads up to Max_Events events; returns the number read, 0 at the end of the segment.
+
+size_t Read_TTE_Segment (
+
+   // Input/Output argument:
+   TTE_Segment_File_type * Segment_ptr,
+
+   // Output argument:
+   Processed_TTE_v2_type Events [],
+
+   // Input argument:
+   size_t Max_Events
+
+) {
+
+   size_t  Num_to_Read;
+
+
+   Num_to_Read = Max_Events;
+   if ( Num_to_Read > Segment_ptr->Header.Num_Events - Segment_ptr->Next_Event )
+      Num_to_Read = (size_t) ( Segment_ptr->Header.Num_Events - Segment_ptr->Next_Event );
+
+   if ( Num_to_Read == 0 )  return 0;
+
+   if ( fread ( Events, sizeof (Processed_TTE_v2_type), Num_to_Read, Segment_ptr->File_ptr ) != Num_to_Read ) {
+      printf ( "\n\nError reading TTE segment -- Exiting!\n" );
+      exit (77);
+   }
+
+   Segment_ptr->Next_Event += Num_to_Read;
+
+   return Num_to_Read;
+
+}  // Read_TTE_Segment ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  For an output segment, writes the index, flushes the segment to the disk, then
+//  writes the completed header, with the magic and version, and flushes it.
+
+void Close_TTE_Segment (
+
+   // Input/Output argument:
+   TTE_Segment_File_type * Segment_ptr
+
+) {
+
+   if ( Segment_ptr->Output ) {  // output ?
+
+      if ( fwrite ( Segment_ptr->Index, sizeof (uint64_t), Segment_ptr->Header.Num_Index, Segment_ptr->File_ptr )
+              != Segment_ptr->Header.Num_Index  ||
+           fflush ( Segment_ptr->File_ptr ) != 0  ||  fsync ( fileno ( Segment_ptr->File_ptr ) ) != 0 ) {
+         printf ( "\n\nError writing TTE segment index -- Exiting!\n" );
+         exit (71);
+      }
+
+      memcpy ( Segment_ptr->Header.Magic, TTE_SEGMENT_MAGIC, sizeof (Segment_ptr->Header.Magic) );
+      Segment_ptr->Header.Version = 1;
+
+      if ( fseeko ( Segment_ptr->File_ptr, 0, SEEK_SET ) != 0  ||
+           fwrite ( &Segment_ptr->Header, sizeof (TTE_Segment_Header_type), 1, Segment_ptr->File_ptr ) != 1  ||
+           fflush ( Segment_ptr->File_ptr ) != 0  ||  fsync ( fileno ( Segment_ptr->File_ptr ) ) != 0 ) {
+         printf ( "\n\nError writing TTE segment header -- Exiting!\n" );
+         exit (71);
+      }
+
+   }  // output ?
+
+   if ( fclose ( Segment_ptr->File_ptr ) != 0 ) {
+      printf ( "\n\nError closing TTE segment -- Exiting!\n" );
+      exit (71);
+   }
+
+   free ( Segment_ptr->Index );
+   Segment_ptr->Index = NULL;
+   Segment_ptr->File_ptr = NULL;
+
+}  // Close_TTE_Segment ()
@@ -0,0 +1,313 @@
+//  Checkpoint of the trigger engine (see Trigger_Engine.c), so that the trigger search
+//  continues from one file to the next, e.g., of hourly files processed as they
+//  arrive, as if they were one file: the base times of the bands, the background rings
+//  and cumulative counts, the accumulations underway and their bin numbers, the
+//  background sums, and the time of the last event.   Without it, each file starts cold, its first half minute or so
+//  without a background model ("Only N suitable bins ..."), and the accumulations
+//  underway at the end of the previous file are lost.
+
+//  The checkpoint file is the header, Trigger_Checkpoint_Header_type, then the state,
+//  in the byte order of the machine:
+//     for each algorithm, its parameters, which must be those of the engine resumed,
+//     for each band, its channels, whether started, its base time, its latest
+//        background bin, and its ring: the bin number and the counts of each slot;
+//        then, if it has sliding windows, its latest 4 ms bin, its cumulative counts
+//        and their ring,
+//     for each algorithm, the bin number and the counts of the accumulation underway,
+//        and its range of background bins and their sums.
+//  The results (largest deviations, numbers of accumulations and of triggers) are
+//  those of each run, and are not kept.   The file is written to FileName.tmp and
+//  renamed, so that a checkpoint is never found partly written.
+
+//  Usage:
+//     Init_Trigger_Engine ( Num_Algorithms, Algorithms, &Engine );
+//     Resumed = Read_Trigger_Checkpoint ( "Trigger.ckp", &Engine );
+//     ... the events after Engine.Latest_Time ...
+//     Write_Trigger_Checkpoint ( "Trigger.ckp", &Engine );
+
+
+#include "HSSDB_Progs_Header.h"
+
+
+//  local function prototypes:
+
+static size_t  Checkpoint_Body_Bytes ( const Trigger_Engine_type * Engine_ptr );
+
+static void  Put_Bytes ( unsigned char * Body, size_t * Offset_ptr, const void * Source, size_t Num_Bytes );
+
+static void  Get_Bytes ( const unsigned char * Body, size_t * Offset_ptr, void * Destination, size_t Num_Bytes );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Write_Trigger_Checkpoint (
+
+   // Input arguments:
+   const char * FileName,
+   const Trigger_Engine_type * Engine_ptr
+
+) {
+
+   Trigger_Checkpoint_Header_type  Header;
+   unsigned char *  Body;
+   size_t  Offset = 0;
+
+   const Trigger_Band_type *  Band_ptr;
+   const Trigger_State_type *  State_ptr;
+   uint32_t  Started;
+   uint32_t  i_alg, i_band;
+
+   char *  Temp_FileName;
+   FILE *  Checkpoint_File_ptr;
+
+
+   memset ( &Header, 0, sizeof (Header) );
+   memcpy ( Header.Magic, TRIGGER_CHECKPOINT_MAGIC, sizeof (TRIGGER_CHECKPOINT_MAGIC) );
+   Header.Version = 3;
+   Header.Num_Algorithms = Engine_ptr->Num_Algorithms;
+   Header.Num_Bands = Engine_ptr->Num_Bands;
+   Header.Bckg_Depth = Engine_ptr->Bckg_Depth;
+   Header.Latest_Time = Engine_ptr->Latest_Time;
+   Header.Body_Bytes = Checkpoint_Body_Bytes ( Engine_ptr );
+
+   Body = malloc ( (size_t) Header.Body_Bytes );
+   Temp_FileName = malloc ( strlen ( FileName ) + 5 );
+   if ( Body == NULL  ||  Temp_FileName == NULL ) {
+      printf ( "\n\nmalloc of trigger checkpoint failed. exiting.\n" );
+      exit (161);
+   }
+
+
+   for ( i_alg=0;  i_alg < Engine_ptr->Num_Algorithms;  i_alg++ ) {
+      State_ptr = &Engine_ptr->States [i_alg];
+      Put_Bytes ( Body, &Offset, &State_ptr->Algorithm.Beg_SPEC_Chan, sizeof (uint32_t) );
+      Put_Bytes ( Body, &Offset, &State_ptr->Algorithm.End_SPEC_Chan, sizeof (uint32_t) );
+      Put_Bytes ( Body, &Offset, &State_ptr->Algorithm.Timescale, sizeof (uint64_t) );
+      Put_Bytes ( Body, &Offset, &State_ptr->Algorithm.Offset, sizeof (uint64_t) );
+      Put_Bytes ( Body, &Offset, &State_ptr->Algorithm.Threshold, sizeof (double) );
+      Put_Bytes ( Body, &Offset, &State_ptr->Algorithm.Min_Detectors, sizeof (uint32_t) );
+      Put_Bytes ( Body, &Offset, &State_ptr->Algorithm.Statistic, sizeof (uint32_t) );
+      Put_Bytes ( Body, &Offset, &State_ptr->Algorithm.Step, sizeof (uint64_t) );
+   }
+
+   for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ ) {
+      Band_ptr = &Engine_ptr->Bands [i_band];
+      Started = Band_ptr->Started;
+      Put_Bytes ( Body, &Offset, &Band_ptr->Beg_SPEC_Chan, sizeof (uint32_t) );
+      Put_Bytes ( Body, &Offset, &Band_ptr->End_SPEC_Chan, sizeof (uint32_t) );
+      Put_Bytes ( Body, &Offset, &Started, sizeof (uint32_t) );
+      Put_Bytes ( Body, &Offset, &Band_ptr->BaseTime, sizeof (uint64_t) );
+      Put_Bytes ( Body, &Offset, &Band_ptr->Latest_BinNum, sizeof (uint32_t) );
+      Put_Bytes ( Body, &Offset, Band_ptr->Bckg_BinNum, Engine_ptr->Bckg_Depth * sizeof (uint32_t) );
+      Put_Bytes ( Body, &Offset, Band_ptr->Bckg_Counts, (size_t) Engine_ptr->Bckg_Depth * NUM_NAI_DET * sizeof (uint32_t) );
+      if ( Band_ptr->Fine_Counts == NULL )  continue;
+      Put_Bytes ( Body, &Offset, &Band_ptr->Fine_BinNum, sizeof (uint32_t) );
+      Put_Bytes ( Body, &Offset, Band_ptr->Fine_Totals, sizeof (Band_ptr->Fine_Totals) );
+      Put_Bytes ( Body, &Offset, Band_ptr->Fine_Counts, (size_t) Engine_ptr->Fine_Depth * NUM_NAI_DET * sizeof (uint32_t) );
+   }
+
+   for ( i_alg=0;  i_alg < Engine_ptr->Num_Algorithms;  i_alg++ ) {
+      State_ptr = &Engine_ptr->States [i_alg];
+      Put_Bytes ( Body, &Offset, &State_ptr->BinNum_Underway, sizeof (uint32_t) );
+      Put_Bytes ( Body, &Offset, State_ptr->Data_Accum, sizeof (State_ptr->Data_Accum) );
+      Put_Bytes ( Body, &Offset, &State_ptr->Window_Lo, sizeof (int64_t) );
+      Put_Bytes ( Body, &Offset, &State_ptr->Window_Hi, sizeof (int64_t) );
+      Put_Bytes ( Body, &Offset, State_ptr->Bckg_Sums, sizeof (State_ptr->Bckg_Sums) );
+      Put_Bytes ( Body, &Offset, &State_ptr->Num_Bckg_Bins, sizeof (uint32_t) );
+   }
+
+   Header.Body_CRC = CRC32C ( Body, (size_t) Header.Body_Bytes );
+
+
+   sprintf ( Temp_FileName, "%s.tmp", FileName );
+
+   Checkpoint_File_ptr = fopen ( Temp_FileName, "wb" );
+   if ( Checkpoint_File_ptr == NULL ) {
+      printf ( "\n\nFailed to open output trigger checkpoint '%s' -- Exiting!\n", Temp_FileName );
+      exit (160);
+   }
+
+   if ( fwrite ( &Header, sizeof (Header), 1, Checkpoint_File_ptr ) != 1  ||
+        fwrite ( Body, 1, (size_t) Header.Body_Bytes, Checkpoint_File_ptr ) != Header.Body_Bytes  ||
+        fclose ( Checkpoint_File_ptr ) != 0  ||
+        rename ( Temp_FileName, FileName ) != 0 ) {
+      printf ( "\n\nWrite to trigger checkpoint '%s' failed -- Exiting!\n", FileName );
+      exit (160);
+   }
+
+   free ( Temp_FileName );
+   free ( Body );
+
+}  // Write_Trigger_Checkpoint ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Resumes the engine, initialized with the algorithms of the checkpoint and without
+//  events, from the checkpoint.   Returns false if there is no checkpoint file, i.e.,
+//  for the first file of a sequence; a damaged checkpoint or one of other algorithms
+//  is fatal.
+
+_Bool Read_Trigger_Checkpoint (
+
+   // Input argument:
+   const char * FileName,
+
+   // Input/Output argument:
+   Trigger_Engine_type * Engine_ptr
+
+) {
+
+   Trigger_Checkpoint_Header_type  Header;
+   unsigned char *  Body = NULL;
+   size_t  Offset = 0;
+   FILE *  Checkpoint_File_ptr;
+   _Bool  Valid;
+
+   Trigger_Algorithm_type  Algorithm;
+   Trigger_Band_type *  Band_ptr;
+   Trigger_State_type *  State_ptr;
+   uint32_t  Beg_SPEC_Chan, End_SPEC_Chan;
+   uint32_t  Started;
+   uint32_t  i_alg, i_band;
+
+
+   Checkpoint_File_ptr = fopen ( FileName, "rb" );
+   if ( Checkpoint_File_ptr == NULL )  return false;
+
+   Valid = ( fread ( &Header, sizeof (Header), 1, Checkpoint_File_ptr ) == 1  &&
+             memcmp ( Header.Magic, TRIGGER_CHECKPOINT_MAGIC, sizeof (TRIGGER_CHECKPOINT_MAGIC) ) == 0  &&
+             Header.Version == 3  &&
+             Header.Num_Algorithms == Engine_ptr->Num_Algorithms  &&  Header.Num_Bands == Engine_ptr->Num_Bands  &&
+             Header.Bckg_Depth == Engine_ptr->Bckg_Depth  &&  Header.Body_Bytes == Checkpoint_Body_Bytes ( Engine_ptr ) );
+
+   if ( Valid ) {
+      Body = malloc ( (size_t) Header.Body_Bytes );
+      if ( Body == NULL ) {
+         printf ( "\n\nmalloc of trigger checkpoint failed. exiting.\n" );
+         exit (161);
+      }
+      Valid = ( fread ( Body, 1, (size_t) Header.Body_Bytes, Checkpoint_File_ptr ) == Header.Body_Bytes  &&
+                CRC32C ( Body, (size_t) Header.Body_Bytes ) == Header.Body_CRC );
+   }
+
+   fclose ( Checkpoint_File_ptr );
+
+   if ( ! Valid ) {
+      printf ( "\n\nThe trigger checkpoint '%s' is damaged, or is of other trigger algorithms -- Exiting!\n", FileName );
+      exit (162);
+   }
+
+
+   //  The algorithms must be the same, in the same order:
+
+   for ( i_alg=0;  i_alg < Engine_ptr->Num_Algorithms;  i_alg++ ) {
+      State_ptr = &Engine_ptr->States [i_alg];
+      Get_Bytes ( Body, &Offset, &Algorithm.Beg_SPEC_Chan, sizeof (uint32_t) );
+      Get_Bytes ( Body, &Offset, &Algorithm.End_SPEC_Chan, sizeof (uint32_t) );
+      Get_Bytes ( Body, &Offset, &Algorithm.Timescale, sizeof (uint64_t) );
+      Get_Bytes ( Body, &Offset, &Algorithm.Offset, sizeof (uint64_t) );
+      Get_Bytes ( Body, &Offset, &Algorithm.Threshold, sizeof (double) );
+      Get_Bytes ( Body, &Offset, &Algorithm.Min_Detectors, sizeof (uint32_t) );
+      Get_Bytes ( Body, &Offset, &Algorithm.Statistic, sizeof (uint32_t) );
+      Get_Bytes ( Body, &Offset, &Algorithm.Step, sizeof (uint64_t) );
+      if ( Algorithm.Beg_SPEC_Chan != State_ptr->Algorithm.Beg_SPEC_Chan  ||  Algorithm.End_SPEC_Chan != State_ptr->Algorithm.End_SPEC_Chan  ||
+           Algorithm.Timescale != State_ptr->Algorithm.Timescale  ||  Algorithm.Offset != State_ptr->Algorithm.Offset  ||
+           Algorithm.Threshold != State_ptr->Algorithm.Threshold  ||  Algorithm.Min_Detectors != State_ptr->Algorithm.Min_Detectors  ||
+           Algorithm.Statistic != State_ptr->Algorithm.Statistic  ||  Algorithm.Step != State_ptr->Algorithm.Step ) {
+         printf ( "\n\nThe trigger checkpoint '%s' is of other trigger algorithms (algorithm %u differs) -- Exiting!\n", FileName, i_alg + 1 );
+         exit (162);
+      }
+   }
+
+   Engine_ptr->Num_Bands_Started = 0;
+
+   for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ ) {
+      Band_ptr = &Engine_ptr->Bands [i_band];
+      Get_Bytes ( Body, &Offset, &Beg_SPEC_Chan, sizeof (uint32_t) );
+      Get_Bytes ( Body, &Offset, &End_SPEC_Chan, sizeof (uint32_t) );
+      if ( Beg_SPEC_Chan != Band_ptr->Beg_SPEC_Chan  ||  End_SPEC_Chan != Band_ptr->End_SPEC_Chan ) {
+         printf ( "\n\nThe trigger checkpoint '%s' is of other energy bands -- Exiting!\n", FileName );
+         exit (162);
+      }
+      Get_Bytes ( Body, &Offset, &Started, sizeof (uint32_t) );
+      Band_ptr->Started = ( Started != 0 );
+      if ( Band_ptr->Started )  Engine_ptr->Num_Bands_Started++;
+      Get_Bytes ( Body, &Offset, &Band_ptr->BaseTime, sizeof (uint64_t) );
+      Get_Bytes ( Body, &Offset, &Band_ptr->Latest_BinNum, sizeof (uint32_t) );
+      Get_Bytes ( Body, &Offset, Band_ptr->Bckg_BinNum, Engine_ptr->Bckg_Depth * sizeof (uint32_t) );
+      Get_Bytes ( Body, &Offset, Band_ptr->Bckg_Counts, (size_t) Engine_ptr->Bckg_Depth * NUM_NAI_DET * sizeof (uint32_t) );
+      if ( Band_ptr->Fine_Counts == NULL )  continue;
+      Get_Bytes ( Body, &Offset, &Band_ptr->Fine_BinNum, sizeof (uint32_t) );
+      Get_Bytes ( Body, &Offset, Band_ptr->Fine_Totals, sizeof (Band_ptr->Fine_Totals) );
+      Get_Bytes ( Body, &Offset, Band_ptr->Fine_Counts, (size_t) Engine_ptr->Fine_Depth * NUM_NAI_DET * sizeof (uint32_t) );
+   }
+
+   for ( i_alg=0;  i_alg < Engine_ptr->Num_Algorithms;  i_alg++ ) {
+      State_ptr = &Engine_ptr->States [i_alg];
+      Get_Bytes ( Body, &Offset, &State_ptr->BinNum_Underway, sizeof (uint32_t) );
+      Get_Bytes ( Body, &Offset, State_ptr->Data_Accum, sizeof (State_ptr->Data_Accum) );
+      Get_Bytes ( Body, &Offset, &State_ptr->Window_Lo, sizeof (int64_t) );
+      Get_Bytes ( Body, &Offset, &State_ptr->Window_Hi, sizeof (int64_t) );
+      Get_Bytes ( Body, &Offset, State_ptr->Bckg_Sums, sizeof (State_ptr->Bckg_Sums) );
+      Get_Bytes ( Body, &Offset, &State_ptr->Num_Bckg_Bins, sizeof (uint32_t) );
+   }
+
+   Engine_ptr->Latest_Time = Header.Latest_Time;
+
+   free ( Body );
+
+   return true;
+
+}  // Read_Trigger_Checkpoint ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static size_t  Checkpoint_Body_Bytes ( const Trigger_Engine_type * Engine_ptr ) {
+
+   size_t  Algorithm_Bytes = 4 + 4 + 8 + 8 + 8 + 4 + 4 + 8;
+   size_t  Band_Bytes = 4 + 4 + 4 + 8 + 4 + (size_t) Engine_ptr->Bckg_Depth * ( 1 + NUM_NAI_DET ) * 4;
+   size_t  Fine_Bytes = 4 + NUM_NAI_DET * 4 + (size_t) Engine_ptr->Fine_Depth * NUM_NAI_DET * 4;
+   size_t  State_Bytes = 4 + NUM_NAI_DET * 4 + 8 + 8 + NUM_NAI_DET * 4 + 4;
+   size_t  Body_Bytes;
+   uint32_t  i_band;
+
+
+   Body_Bytes = Engine_ptr->Num_Algorithms * ( Algorithm_Bytes + State_Bytes ) + Engine_ptr->Num_Bands * Band_Bytes;
+
+   for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ )
+      if ( Engine_ptr->Bands [i_band] .Fine_Counts != NULL )  Body_Bytes += Fine_Bytes;
+
+   return Body_Bytes;
+
+}  // Checkpoint_Body_Bytes ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Put_Bytes ( unsigned char * Body, size_t * Offset_ptr, const void * Source, size_t Num_Bytes ) {
+
+   memcpy ( Body + *Offset_ptr, Source, Num_Bytes );
+   *Offset_ptr += Num_Bytes;
+
+}  // Put_Bytes ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Get_Bytes ( const unsigned char * Body, size_t * Offset_ptr, void * Destination, size_t Num_Bytes ) {
+
+   memcpy ( Destination, Body + *Offset_ptr, Num_Bytes );
+   *Offset_ptr += Num_Bytes;
+
+}  // Get_Bytes ()
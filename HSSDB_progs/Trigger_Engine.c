@@ -0,0 +1,1492 @@
+//  The trigger engine of Trigger_from_TTE: evaluates a table of trigger algorithms in
+//  a single pass over the TTE events, as the flight software runs its algorithms
+//  together.   Each algorithm (Trigger_Algorithm_type) is
+//     an energy band, SPEC channels Beg_SPEC_Chan to End_SPEC_Chan,
+//     a timescale, the length of its data accumulations, in 2 microsec ticks,
+//     an offset of its accumulations, e.g., half of the timescale, so that an
+//        algorithm and its offset copy together cover the bursts that straddle the
+//        boundaries of the accumulations,
+//     a threshold in sigma, and
+//     the number of NaI detectors (k of the 12) that must exceed the threshold in the
+//        same accumulation for a trigger.
+
+//  The background is accumulated once per energy band, in 1.024 s bins, and shared by
+//  all of the algorithms of the band, whatever their timescales and offsets.   As in
+//  the original Trigger_from_TTE, when an accumulation of an algorithm is complete it
+//  is compared with the average of the background bins of its band that begin no more
+//  than 35.5 s and end at least 4.096 s before the accumulation (at least 30 such
+//  bins are required).   The detectors that deviate by more than the threshold, in
+//  either direction, are listed, and a trigger is declared when k of them have
+//  positive deviations.   With a single algorithm, the report is exactly that of the
+//  original program.
+
+//  The bands of an event are found with one lookup, in a table of the bands of each
+//  SPEC channel (a bit mask), so that the cost per event does not grow with the number
+//  of bands.
+
+//  The background bins of a band are held in a ring, indexed by bin number, deep
+//  enough for the oldest background of the longest timescale: an accumulation is
+//  evaluated (on the first event after it) before that event is added to the
+//  background, so no bin that it needs has yet been reused.
+
+//  The background bins allowed for an accumulation are a contiguous range of bin
+//  numbers, which only moves forward from one accumulation to the next.   So each
+//  algorithm keeps the sums of the counts over its range: when an accumulation is
+//  complete, the bins that have become old enough (4.096 s) are added and those that
+//  have become too old (35.5 s) are subtracted -- a constant cost per accumulation,
+//  instead of examining every bin of the ring.   The sums are exact (integer), so the
+//  decisions are those of examining the ring.   After a gap in the data, when the old
+//  range may no longer be in the ring, the sums are formed again from the ring.
+
+//  An algorithm's significance is Gaussian, ( counts - expected ) / sqrt (expected), as
+//  in the original program, or, with the statistic "poisson" in the table, exact for a
+//  Poisson background, by a lookup of the significant counts in a precomputed table
+//  (see Trigger_Poisson.c) -- for the short timescales, when few counts are expected.
+
+//  An algorithm with a step (step=Ticks in the table) has sliding windows: an
+//  accumulation of its timescale begins at every step, e.g., every 4 ms for a 64 ms
+//  timescale, instead of one algorithm per offset.   Each band with such algorithms
+//  keeps, in a ring of 4 ms bins, the cumulative counts of the NaI detectors before
+//  each bin, so that the counts of a window, of any length, are the difference of two
+//  entries.   A window is complete when an event of the band is at or after its end,
+//  and is evaluated, like an accumulation, if it has any counts.   With the step equal
+//  to the timescale, the windows are the accumulations of the algorithm without a step.
+
+//  The counts, background sums and significances of the 12 NaI detectors are held as
+//  aligned vectors and, on x86_64, computed with SSE2 two (double) or four (uint32_t)
+//  detectors at a time: the comparisons with the threshold give bit masks of the
+//  detectors, and k of n is the count of the bits of the positive deviations.   The
+//  arithmetic is that of the scalar code, operation for operation (sqrt, not an
+//  approximate reciprocal sqrt), so the decisions and the report are the same.
+
+//  Usage:
+//     Num_Algorithms = Read_Trigger_Algorithms ( "Trigger_Algorithms.txt", &Algorithms );
+//     Init_Trigger_Engine ( Num_Algorithms, Algorithms, &Engine );
+//     ... for each batch of events, in time order ...
+//        Trigger_Engine_Events ( &Engine, Events, Num_Events );
+//     Report_Trigger_Engine ( &Engine, Num_Events_Read );
+//     Close_Trigger_Engine ( &Engine );
+
+
+#define  _POSIX_C_SOURCE  200809L
+
+#include "HSSDB_Progs_Header.h"
+
+#include <pthread.h>
+#include <float.h>
+#include <math.h>
+
+#if defined (__GNUC__)  &&  defined (__SSE2__)
+#define  HAVE_SSE2_TRIGGER
+#include <emmintrin.h>
+#endif
+
+
+#define  MAX_TABLE_LINE   256U
+
+#define  MAX_TRIGGER_THREADS   64U
+
+
+//  local typedefs:
+
+typedef struct  Trigger_Slice_type {
+   Trigger_Engine_type *  Engine_ptr;   // the engine of the caller for the first slice, else Own_Engine
+   Trigger_Engine_type  Own_Engine;
+   const Processed_TTE_v2_type *  Events;
+   size_t  Warm_Up_Begin;        // the events of the warm-up, Warm_Up_Begin to Begin - 1
+   size_t  Begin;                // the events of the slice, Begin to End - 1
+   size_t  End;
+   char *  Output_Buffer;        // its lines, in order
+   size_t  Output_Bytes;
+} Trigger_Slice_type;
+
+
+//  local function prototypes:
+
+static void * Trigger_Slice_Thread ( void * Arg_ptr );
+
+static void  Start_Band ( Trigger_Engine_type * Engine_ptr, uint32_t i_band, uint64_t Time );
+
+static void  Evaluate_Data_Accum ( const Trigger_Engine_type * Engine_ptr, Trigger_State_type * State_ptr );
+
+static void  Slide_Windows ( const Trigger_Engine_type * Engine_ptr, Trigger_State_type * State_ptr, uint32_t Fine_BinNum );
+
+static uint32_t  First_Window_Underway ( const Trigger_State_type * State_ptr, uint32_t Fine_BinNum );
+
+static void  Significance_of_Data_Accum ( const Trigger_State_type * State_ptr, double BackgroundModel [],
+                                          double Significance [], uint32_t * Exceed_Mask_ptr, uint32_t * Positive_Mask_ptr );
+
+static void  Poisson_Significance_of_Data_Accum ( const Trigger_State_type * State_ptr, double BackgroundModel [],
+                                                  double Significance [], uint32_t * Exceed_Mask_ptr, uint32_t * Positive_Mask_ptr );
+
+static uint32_t  Count_Bits ( uint32_t Mask );
+
+static void  Move_Background_Window ( const Trigger_Engine_type * Engine_ptr, Trigger_State_type * State_ptr,
+                                      uint64_t BeginTime_Data_Bin );
+
+static void  Add_Background_Bin ( const Trigger_Engine_type * Engine_ptr, const Trigger_Band_type * Band_ptr,
+                                  Trigger_State_type * State_ptr, int64_t BinNum, int Sign );
+
+static int64_t  Floor_Division ( int64_t Numerator, int64_t Denominator );
+
+static void  Add_to_Background ( const Trigger_Engine_type * Engine_ptr, Trigger_Band_type * Band_ptr,
+                                 uint64_t Time, uint32_t Detector );
+
+static void  Add_to_Fine_Counts ( const Trigger_Engine_type * Engine_ptr, Trigger_Band_type * Band_ptr,
+                                  uint64_t Time, uint32_t Detector );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Reads the table of algorithms: one algorithm per line,
+//     Beg_SPEC_Chan  End_SPEC_Chan  Timescale  Offset  Threshold  Min_Detectors  [Statistic]  [step=Ticks]
+//  with the timescale and offset in 2 microsec ticks, the statistic of the significance
+//  "gauss" (the default) or "poisson", and, for sliding windows, their step in ticks
+//  (the timescale, step and offset then multiples of 4 ms, 2000 ticks); blank lines and
+//  lines beginning with # are ignored.   Returns the number of algorithms.
+
+uint32_t Read_Trigger_Algorithms (
+
+   // Input argument:
+   const char * FileName,
+
+   // Output argument:
+   Trigger_Algorithm_type ** Algorithms_ptr
+
+) {
+
+   FILE *  Table_File_ptr;
+   char  Line [MAX_TABLE_LINE];
+   char  Ignored [2];
+   char  Option [16];
+   const char *  Options;
+   int  Num_Fields, Num_Chars;
+   _Bool  Bad_Option;
+   uint32_t  Line_Number = 0;
+   uint32_t  Num_Algorithms = 0;
+   Trigger_Algorithm_type *  Algorithms;
+   Trigger_Algorithm_type *  Alg_ptr;
+   long long unsigned int  Timescale, Offset, Step;
+
+
+   Table_File_ptr = fopen ( FileName, "r" );
+   if ( Table_File_ptr == NULL ) {
+      printf ( "\n\nFailed to open the table of trigger algorithms '%s' -- Exiting!\n", FileName );
+      exit (150);
+   }
+
+   Algorithms = malloc ( MAX_TRIGGER_ALGORITHMS * sizeof (Trigger_Algorithm_type) );
+   if ( Algorithms == NULL ) {
+      printf ( "\n\nmalloc of trigger algorithms failed. exiting.\n" );
+      exit (151);
+   }
+
+   while ( fgets ( Line, sizeof (Line), Table_File_ptr ) != NULL ) {  // loop over lines
+
+      Line_Number++;
+
+      if ( sscanf ( Line, "%1s", Ignored ) != 1  ||  Ignored [0] == '#' )  continue;   // blank or comment
+
+      if ( Num_Algorithms == MAX_TRIGGER_ALGORITHMS ) {
+         printf ( "\n\nMore than %u trigger algorithms in '%s' -- Exiting!\n", MAX_TRIGGER_ALGORITHMS, FileName );
+         exit (152);
+      }
+
+      Alg_ptr = &Algorithms [Num_Algorithms];
+
+      Num_Fields = sscanf ( Line, "%u %u %llu %llu %lf %u%n", &Alg_ptr->Beg_SPEC_Chan, &Alg_ptr->End_SPEC_Chan,
+                            &Timescale, &Offset, &Alg_ptr->Threshold, &Alg_ptr->Min_Detectors, &Num_Chars );
+
+      //  The options, in any order:
+
+      Alg_ptr->Statistic = TRIGGER_GAUSSIAN;
+      Step = 0;
+      Bad_Option = false;
+
+      if ( Num_Fields == 6 ) {
+         Options = Line + Num_Chars;
+         while ( sscanf ( Options, "%15s%n", Option, &Num_Chars ) == 1 ) {  // loop over options
+            Options += Num_Chars;
+            if ( strcmp ( Option, "gauss" ) == 0 )
+               Alg_ptr->Statistic = TRIGGER_GAUSSIAN;
+            else if ( strcmp ( Option, "poisson" ) == 0 )
+               Alg_ptr->Statistic = TRIGGER_POISSON;
+            else if ( sscanf ( Option, "step=%llu%1s", &Step, Ignored ) != 1  ||  Step == 0 )
+               Bad_Option = true;
+         }  // loop over options
+      }
+
+      if ( Num_Fields < 6  ||  Bad_Option  ||
+           Alg_ptr->Beg_SPEC_Chan > Alg_ptr->End_SPEC_Chan  ||  Alg_ptr->End_SPEC_Chan >= NUM_SPEC_CHAN  ||
+           Timescale == 0  ||  Offset >= ( ( Step > 0 )  ?  Step  :  Timescale )  ||
+           ( Step > 0  &&  ( Step > Timescale  ||  Timescale % TRIGGER_FINE_TICKS != 0  ||
+                             Step % TRIGGER_FINE_TICKS != 0  ||  Offset % TRIGGER_FINE_TICKS != 0 ) )  ||
+           Alg_ptr->Min_Detectors < 1  ||  Alg_ptr->Min_Detectors > NUM_NAI_DET  ||
+           ( Alg_ptr->Statistic == TRIGGER_POISSON  &&  ! ( Alg_ptr->Threshold > 0  &&  Alg_ptr->Threshold <= 30 ) ) ) {
+         printf ( "\n\nBad trigger algorithm at line %u of '%s':\n%s\n", Line_Number, FileName, Line );
+         printf ( "Expected: Beg_SPEC_Chan  End_SPEC_Chan  Timescale  Offset  Threshold  Min_Detectors  [gauss|poisson]  [step=Ticks]\n" );
+         printf ( "with channels 0 to %u, Offset less than Timescale (ticks), Min_Detectors 1 to %u,\n",
+                  NUM_SPEC_CHAN - 1, NUM_NAI_DET );
+         printf ( "for poisson a Threshold above 0 and at most 30 sigma, and for a step at most the Timescale,\n" );
+         printf ( "with Offset less than the step and all three multiples of %llu ticks -- Exiting!\n", TRIGGER_FINE_TICKS );
+         exit (152);
+      }
+
+      Alg_ptr->Timescale = Timescale;
+      Alg_ptr->Offset = Offset;
+      Alg_ptr->Step = Step;
+      Num_Algorithms++;
+
+   }  // loop over lines
+
+   fclose ( Table_File_ptr );
+
+   if ( Num_Algorithms == 0 ) {
+      printf ( "\n\nNo trigger algorithms in '%s' -- Exiting!\n", FileName );
+      exit (152);
+   }
+
+   *Algorithms_ptr = Algorithms;
+
+   return Num_Algorithms;
+
+}  // Read_Trigger_Algorithms ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Init_Trigger_Engine (
+
+   // Input arguments:
+   uint32_t Num_Algorithms,
+   const Trigger_Algorithm_type Algorithms [],
+
+   // Output argument:
+   Trigger_Engine_type * Engine_ptr
+
+) {
+
+   Trigger_State_type *  State_ptr;
+   Trigger_Band_type *  Band_ptr;
+   uint64_t  Max_Timescale = 0;
+   uint32_t  Sliding_Bands = 0;
+   uint32_t  i_alg, i_band, i_slot;
+   uint32_t  i_chan;
+
+
+   memset ( Engine_ptr, 0, sizeof (Trigger_Engine_type) );
+
+   Engine_ptr->Num_Algorithms = Num_Algorithms;
+   Engine_ptr->States = calloc ( Num_Algorithms, sizeof (Trigger_State_type) );
+   if ( Engine_ptr->States == NULL ) {
+      printf ( "\n\nmalloc of trigger algorithms failed. exiting.\n" );
+      exit (151);
+   }
+
+   Engine_ptr->Beg_SPEC_Chan = NUM_SPEC_CHAN - 1;
+   Engine_ptr->End_SPEC_Chan = 0;
+   Engine_ptr->Output = stdout;
+
+   for ( i_alg=0;  i_alg < Num_Algorithms;  i_alg++ ) {  // loop over algorithms
+
+      State_ptr = &Engine_ptr->States [i_alg];
+      State_ptr->Algorithm = Algorithms [i_alg];
+
+      //  The bands are the distinct channel ranges:
+
+      for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ )
+         if ( Engine_ptr->Bands [i_band] .Beg_SPEC_Chan == Algorithms [i_alg] .Beg_SPEC_Chan  &&
+              Engine_ptr->Bands [i_band] .End_SPEC_Chan == Algorithms [i_alg] .End_SPEC_Chan )  break;
+
+      if ( i_band == Engine_ptr->Num_Bands ) {
+         if ( i_band == MAX_TRIGGER_BANDS ) {
+            printf ( "\n\nMore than %u energy bands in the trigger algorithms -- Exiting!\n", MAX_TRIGGER_BANDS );
+            exit (152);
+         }
+         Engine_ptr->Bands [i_band] .Beg_SPEC_Chan = Algorithms [i_alg] .Beg_SPEC_Chan;
+         Engine_ptr->Bands [i_band] .End_SPEC_Chan = Algorithms [i_alg] .End_SPEC_Chan;
+         Engine_ptr->Num_Bands++;
+      }
+
+      State_ptr->Band = i_band;
+      State_ptr->Step = ( Algorithms [i_alg] .Step > 0 )  ?  Algorithms [i_alg] .Step  :  Algorithms [i_alg] .Timescale;
+      State_ptr->Phase = ( State_ptr->Step - Algorithms [i_alg] .Offset ) % State_ptr->Step;
+      //  The sliding windows that include the base time begin up to a timescale before it:
+      if ( Algorithms [i_alg] .Step > 0 )
+         State_ptr->Phase += ( Algorithms [i_alg] .Timescale - 1 ) / State_ptr->Step * State_ptr->Step;
+      State_ptr->Timescale_Factor = (double) Algorithms [i_alg] .Timescale / (double) ONE_SEC_IN_TICKS;
+      State_ptr->BinNum_Underway = 0;
+      State_ptr->Window_Lo = 0;
+      State_ptr->Window_Hi = -1;
+      State_ptr->Largest_Pos_Deviation = -DBL_MAX;
+      State_ptr->Largest_Neg_Deviation =  DBL_MAX;
+      State_ptr->Poisson = ( Algorithms [i_alg] .Statistic == TRIGGER_POISSON ) ? Poisson_Table ( Algorithms [i_alg] .Threshold ) : NULL;
+      if ( Num_Algorithms > 1 )  sprintf ( State_ptr->Prefix, "alg %3u: ", i_alg + 1 );
+
+      if ( Algorithms [i_alg] .Timescale > Max_Timescale )  Max_Timescale = Algorithms [i_alg] .Timescale;
+      if ( Algorithms [i_alg] .Step > 0 ) {
+         Sliding_Bands |= 1U << i_band;
+         if ( Algorithms [i_alg] .Timescale / TRIGGER_FINE_TICKS + 2 > Engine_ptr->Fine_Depth )
+            Engine_ptr->Fine_Depth = (uint32_t) ( Algorithms [i_alg] .Timescale / TRIGGER_FINE_TICKS + 2 );
+      }
+      if ( Algorithms [i_alg] .Beg_SPEC_Chan < Engine_ptr->Beg_SPEC_Chan )  Engine_ptr->Beg_SPEC_Chan = Algorithms [i_alg] .Beg_SPEC_Chan;
+      if ( Algorithms [i_alg] .End_SPEC_Chan > Engine_ptr->End_SPEC_Chan )  Engine_ptr->End_SPEC_Chan = Algorithms [i_alg] .End_SPEC_Chan;
+
+   }  // loop over algorithms
+
+
+   //  The background ring of each band reaches back from the end of the longest
+   //  accumulation to the oldest background bin allowed for the accumulation before it,
+   //  so that the bins leaving the range of an algorithm are still in the ring:
+
+   Engine_ptr->Bckg_Depth = (uint32_t) ( ( MAX_ALLOWED_BCKG_AGE + 2 * Max_Timescale ) / ONE_SEC_IN_TICKS ) + 4;
+
+   //  The events on which an accumulation depends reach back, before its last event, by
+   //  its timescale and the background allowed, and a background bin more, so that the
+   //  first bin of an engine started that far back, which may be partial, is too old:
+
+   Engine_ptr->Max_Timescale = Max_Timescale;
+   Engine_ptr->Warm_Up_Ticks = MAX_ALLOWED_BCKG_AGE + Max_Timescale + ONE_SEC_IN_TICKS;
+
+   //  The ring of cumulative counts of a band with sliding windows (Fine_Depth) reaches
+   //  back from the latest event by the longest of their timescales: the windows not yet
+   //  evaluated end after it.
+
+   for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ ) {
+
+      Band_ptr = &Engine_ptr->Bands [i_band];
+      Band_ptr->Bckg_BinNum = malloc ( Engine_ptr->Bckg_Depth * sizeof (uint32_t) );
+      Band_ptr->Bckg_Counts = calloc ( (size_t) Engine_ptr->Bckg_Depth * NUM_NAI_DET, sizeof (uint32_t) );
+      if ( Band_ptr->Bckg_BinNum == NULL  ||  Band_ptr->Bckg_Counts == NULL ) {
+         printf ( "\n\nmalloc of trigger background failed. exiting.\n" );
+         exit (151);
+      }
+      for ( i_slot=0;  i_slot < Engine_ptr->Bckg_Depth;  i_slot++ )  Band_ptr->Bckg_BinNum [i_slot] = UINT32_MAX;
+      if ( Sliding_Bands & ( 1U << i_band ) ) {
+         Band_ptr->Fine_Counts = calloc ( (size_t) Engine_ptr->Fine_Depth * NUM_NAI_DET, sizeof (uint32_t) );
+         if ( Band_ptr->Fine_Counts == NULL ) {
+            printf ( "\n\nmalloc of trigger cumulative counts failed. exiting.\n" );
+            exit (151);
+         }
+      }
+      if ( Engine_ptr->Num_Bands > 1 )  sprintf ( Band_ptr->Prefix, "band %2u: ", i_band + 1 );
+
+      //  The table of the bands of each channel, so that an event finds its bands with
+      //  one lookup:
+
+      for ( i_chan = Band_ptr->Beg_SPEC_Chan;  i_chan <= Band_ptr->End_SPEC_Chan;  i_chan++ )
+         Engine_ptr->Band_Masks [i_chan] |= 1U << i_band;
+
+   }
+
+}  // Init_Trigger_Engine ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Processes a batch of events, in time order.
+
+void Trigger_Engine_Events (
+
+   // Input/Output argument:
+   Trigger_Engine_type * Engine_ptr,
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events
+
+) {
+
+   const Processed_TTE_v2_type *  Event_ptr;
+   Trigger_State_type *  State_ptr;
+   const Trigger_Band_type *  Band_ptr;
+   uint32_t  In_Bands;
+   uint32_t  DataAccum_BinNum;
+   uint32_t  Fine_BinNum;
+   uint32_t  i_alg, i_band;
+   size_t  i_event;
+
+
+   for ( i_event=0;  i_event < Num_Events;  i_event++ ) {  // loop over events
+
+      Event_ptr = &Events [i_event];
+      Engine_ptr->Latest_Time = Event_ptr->Time_in_OneVariable;
+
+      //  The bands of this event, from the table of the bands of each channel; none for
+      //  the BGO detectors:
+
+      In_Bands = Engine_ptr->Band_Masks [Event_ptr->SpecChannel]  &  ( 0U - (uint32_t) ( Event_ptr->Detector < NUM_NAI_DET ) );
+
+      if ( In_Bands == 0 )  continue;
+
+      //  The first event of a band sets the base time of its bins:
+
+      if ( Engine_ptr->Num_Bands_Started < Engine_ptr->Num_Bands ) {
+         for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ )
+            if ( ( In_Bands & ( 1U << i_band ) )  &&  ! Engine_ptr->Bands [i_band] .Started )
+               Start_Band ( Engine_ptr, i_band, Event_ptr->Time_in_OneVariable );
+      }
+
+      Engine_ptr->Num_Events_in_Bands++;
+
+
+      //  For each algorithm of these bands: if the event begins a new accumulation, the
+      //  one underway is complete -- compare it with the background.   Then accumulate.
+      //  For sliding windows, if the event is in a later 4 ms bin, the windows that end
+      //  by it are complete:
+
+      for ( i_alg=0;  i_alg < Engine_ptr->Num_Algorithms;  i_alg++ ) {  // loop over algorithms
+
+         State_ptr = &Engine_ptr->States [i_alg];
+         if ( ( In_Bands & ( 1U << State_ptr->Band ) ) == 0 )  continue;
+
+         if ( State_ptr->Algorithm.Step > 0 ) {  // sliding windows ?
+            Band_ptr = &Engine_ptr->Bands [State_ptr->Band];
+            Fine_BinNum = (uint32_t) ( ( Event_ptr->Time_in_OneVariable - Band_ptr->BaseTime ) / TRIGGER_FINE_TICKS );
+            if ( Fine_BinNum != Band_ptr->Fine_BinNum )  Slide_Windows ( Engine_ptr, State_ptr, Fine_BinNum );
+            continue;
+         }  // sliding windows ?
+
+         DataAccum_BinNum = (uint32_t) ( ( Event_ptr->Time_in_OneVariable - Engine_ptr->Bands [State_ptr->Band] .BaseTime + State_ptr->Phase )
+                                         / State_ptr->Algorithm.Timescale );
+
+         if ( DataAccum_BinNum != State_ptr->BinNum_Underway ) {  // new data accum bin ?
+            if ( ! Engine_ptr->Warming_Up )  Evaluate_Data_Accum ( Engine_ptr, State_ptr );
+            memset ( State_ptr->Data_Accum, 0, sizeof (State_ptr->Data_Accum) );
+            State_ptr->BinNum_Underway = DataAccum_BinNum;
+         }
+
+         State_ptr->Data_Accum [Event_ptr->Detector] ++;
+
+      }  // loop over algorithms
+
+
+      //  Then the cumulative counts and the background of the bands:
+
+      for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ ) {
+         if ( ( In_Bands & ( 1U << i_band ) ) == 0 )  continue;
+         if ( Engine_ptr->Bands [i_band] .Fine_Counts != NULL )
+            Add_to_Fine_Counts ( Engine_ptr, &Engine_ptr->Bands [i_band], Event_ptr->Time_in_OneVariable, Event_ptr->Detector );
+         Add_to_Background ( Engine_ptr, &Engine_ptr->Bands [i_band], Event_ptr->Time_in_OneVariable, Event_ptr->Detector );
+      }
+
+   }  // loop over events
+
+}  // Trigger_Engine_Events ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Processes all of the events, in time order, divided into time slices processed in
+//  parallel, one per thread, with the same results as Trigger_Engine_Events: the
+//  lines of each slice are output in the order of the slices, and the results of the
+//  slices are combined into the engine, for Report_Trigger_Engine.
+//  The only dependence of an accumulation on the events before it is on the bins of its
+//  band (from the base time of the band, which is found first, for all of the slices),
+//  its own events and the background bins no more than 35.5 s before it.   So each
+//  slice first accumulates, without evaluating, the events of a warm-up reaching back
+//  from the accumulations underway at its beginning by the longest timescale, the age
+//  of the background and a background bin.   Its engine is then in the state of the
+//  serial engine, for everything that its own accumulations depend on.
+//  The first slice is processed by the engine itself, which may have been resumed from
+//  a checkpoint, and the engine is left in the state of the last slice, i.e., in the
+//  state of the serial engine after the last event, as for a checkpoint.   (If a band
+//  resumed from a checkpoint has no events in the first slice, so that the other slices
+//  cannot know the accumulations underway in it, the events are processed serially.)
+
+void Trigger_Engine_Sharded (
+
+   // Input/Output argument:
+   Trigger_Engine_type * Engine_ptr,
+
+   // Input arguments:
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events,
+   uint32_t Num_Threads
+
+) {
+
+   Trigger_Algorithm_type *  Algorithms;
+   Trigger_Slice_type *  Slices;
+   Trigger_Engine_type *  Slice_Engine_ptr;
+   Trigger_State_type *  State_ptr;
+   const Trigger_State_type *  Slice_State_ptr;
+
+   pthread_t  Threads [MAX_TRIGGER_THREADS];
+   size_t  First_in_Band [MAX_TRIGGER_BANDS];
+   uint64_t  BaseTimes [MAX_TRIGGER_BANDS];
+   uint32_t  i_alg, i_band;
+   uint32_t  j_thread;
+
+
+   if ( Num_Threads > MAX_TRIGGER_THREADS )  Num_Threads = MAX_TRIGGER_THREADS;
+   if ( Num_Threads > Num_Events )  Num_Threads = ( Num_Events > 0 )  ?  (uint32_t) Num_Events  :  1;
+
+
+   //  The base time of each band: resumed, or from its first event:
+
+   Trigger_Band_Starts ( Engine_ptr, Events, Num_Events, First_in_Band, BaseTimes );
+
+   for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ )
+      if ( Engine_ptr->Bands [i_band] .Started  &&  First_in_Band [i_band] >= Num_Events / Num_Threads )  Num_Threads = 1;
+
+   if ( Num_Threads == 1 ) {
+      Trigger_Engine_Events ( Engine_ptr, Events, Num_Events );
+      return;
+   }
+
+
+   Algorithms = malloc ( Engine_ptr->Num_Algorithms * sizeof (Trigger_Algorithm_type) );
+   Slices = calloc ( Num_Threads, sizeof (Trigger_Slice_type) );
+   if ( Algorithms == NULL  ||  Slices == NULL ) {
+      printf ( "\n\nmalloc of trigger time slices failed. exiting.\n" );
+      exit (151);
+   }
+
+   for ( i_alg=0;  i_alg < Engine_ptr->Num_Algorithms;  i_alg++ )  Algorithms [i_alg] = Engine_ptr->States [i_alg] .Algorithm;
+
+
+   //  The slices; the first is processed by the engine itself, outputting directly:
+
+   for ( j_thread=0;  j_thread < Num_Threads;  j_thread++ ) {
+
+      Slices [j_thread] .Events = Events;
+      Slices [j_thread] .Begin = Num_Events * j_thread / Num_Threads;
+      Slices [j_thread] .End = Num_Events * ( j_thread + 1 ) / Num_Threads;
+
+      if ( j_thread == 0 ) {
+         Slices [j_thread] .Engine_ptr = Engine_ptr;
+         Slices [j_thread] .Warm_Up_Begin = 0;
+         continue;
+      }
+
+      Slice_Engine_ptr = &Slices [j_thread] .Own_Engine;
+      Slices [j_thread] .Engine_ptr = Slice_Engine_ptr;
+
+      Init_Trigger_Engine ( Engine_ptr->Num_Algorithms, Algorithms, Slice_Engine_ptr );
+
+      Slice_Engine_ptr->Preset_BaseTimes = true;
+      for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ )  Slice_Engine_ptr->Bands [i_band] .BaseTime = BaseTimes [i_band];
+
+      Slices [j_thread] .Warm_Up_Begin = Trigger_Warm_Up_Begin ( Engine_ptr, Events, Slices [j_thread] .Begin, First_in_Band );
+
+      Slice_Engine_ptr->Output = open_memstream ( &Slices [j_thread] .Output_Buffer, &Slices [j_thread] .Output_Bytes );
+      if ( Slice_Engine_ptr->Output == NULL ) {
+         printf ( "\n\nmalloc of the output of a trigger time slice failed. exiting.\n" );
+         exit (151);
+      }
+
+   }
+
+   for ( j_thread=1;  j_thread < Num_Threads;  j_thread++ ) {
+      if ( pthread_create ( &Threads [j_thread], NULL, Trigger_Slice_Thread, &Slices [j_thread] ) != 0 ) {
+         printf ( "\n\nFailed to create thread -- Exiting!\n" );
+         exit (153);
+      }
+   }
+
+   Trigger_Slice_Thread ( &Slices [0] );
+
+   for ( j_thread=1;  j_thread < Num_Threads;  j_thread++ )  pthread_join ( Threads [j_thread], NULL );
+
+
+   //  Output the lines of the other slices in order, and combine their results:
+
+   for ( j_thread=1;  j_thread < Num_Threads;  j_thread++ ) {  // loop over slices
+
+      Slice_Engine_ptr = &Slices [j_thread] .Own_Engine;
+
+      fclose ( Slice_Engine_ptr->Output );
+      fwrite ( Slices [j_thread] .Output_Buffer, 1, Slices [j_thread] .Output_Bytes, Engine_ptr->Output );
+      free ( Slices [j_thread] .Output_Buffer );
+
+      for ( i_alg=0;  i_alg < Engine_ptr->Num_Algorithms;  i_alg++ ) {
+         State_ptr = &Engine_ptr->States [i_alg];
+         Slice_State_ptr = &Slice_Engine_ptr->States [i_alg];
+         if ( Slice_State_ptr->Largest_Pos_Deviation > State_ptr->Largest_Pos_Deviation )
+            State_ptr->Largest_Pos_Deviation = Slice_State_ptr->Largest_Pos_Deviation;
+         if ( Slice_State_ptr->Largest_Neg_Deviation < State_ptr->Largest_Neg_Deviation )
+            State_ptr->Largest_Neg_Deviation = Slice_State_ptr->Largest_Neg_Deviation;
+         State_ptr->DataAccum_with_Bckg += Slice_State_ptr->DataAccum_with_Bckg;
+         State_ptr->DataAccum_without_Bckg += Slice_State_ptr->DataAccum_without_Bckg;
+         State_ptr->Num_Triggers += Slice_State_ptr->Num_Triggers;
+      }
+
+      Engine_ptr->Num_Events_in_Bands += Slice_Engine_ptr->Num_Events_in_Bands;
+
+      if ( j_thread == Num_Threads - 1 )  Copy_Trigger_Engine_State ( Engine_ptr, Slice_Engine_ptr );
+
+      Close_Trigger_Engine ( Slice_Engine_ptr );
+
+   }  // loop over slices
+
+   free ( Slices );
+   free ( Algorithms );
+
+}  // Trigger_Engine_Sharded ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The first event of each band in an array of events (Num_Events if none), and the
+//  base time of each band: that of the engine if it has begun (resumed), else the time
+//  of its first event -- the base times of engines started within the events.
+
+void Trigger_Band_Starts (
+
+   // Input arguments:
+   const Trigger_Engine_type * Engine_ptr,
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events,
+
+   // Output arguments:
+   size_t First_in_Band [],
+   uint64_t BaseTimes []
+
+) {
+
+   uint32_t  In_Bands;
+   uint32_t  Bands_Found = 0;
+   uint32_t  All_Bands;
+   uint32_t  i_band;
+   size_t  i_event;
+
+
+   All_Bands = ( Engine_ptr->Num_Bands < 32 )  ?  ( 1U << Engine_ptr->Num_Bands ) - 1U  :  UINT32_MAX;
+   for ( i_band=0;  i_band < MAX_TRIGGER_BANDS;  i_band++ ) {
+      First_in_Band [i_band] = Num_Events;
+      BaseTimes [i_band] = Engine_ptr->Bands [i_band] .BaseTime;
+   }
+
+   for ( i_event=0;  i_event < Num_Events  &&  Bands_Found != All_Bands;  i_event++ ) {
+      In_Bands = Engine_ptr->Band_Masks [Events [i_event] .SpecChannel]  &  ( 0U - (uint32_t) ( Events [i_event] .Detector < NUM_NAI_DET ) );
+      for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ )
+         if ( ( In_Bands & ~Bands_Found ) & ( 1U << i_band ) ) {
+            First_in_Band [i_band] = i_event;
+            if ( ! Engine_ptr->Bands [i_band] .Started )  BaseTimes [i_band] = Events [i_event] .Time_in_OneVariable;
+         }
+      Bands_Found |= In_Bands;
+   }
+
+}  // Trigger_Band_Starts ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The first event of the warm-up of an engine that is to evaluate the events from
+//  Begin on, having first accumulated the warm-up: the accumulation underway in a band
+//  at Begin includes the last event of the band before Begin, which may be long before
+//  if there is a gap in the data, so the warm-up reaches back Warm_Up_Ticks from the
+//  earliest of these last events.
+
+size_t Trigger_Warm_Up_Begin (
+
+   // Input arguments:
+   const Trigger_Engine_type * Engine_ptr,
+   const Processed_TTE_v2_type Events [],
+   size_t Begin,
+   const size_t First_in_Band []
+
+) {
+
+   uint32_t  Bands_Started = 0;
+   uint32_t  Bands_Seen = 0;
+   uint32_t  In_Bands;
+   uint32_t  i_band;
+   uint64_t  Earliest;
+   size_t  i_event;
+   size_t  Lo, Hi, Mid;
+
+
+   if ( Begin == 0 )  return 0;
+
+   for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ )
+      if ( First_in_Band [i_band] < Begin )  Bands_Started |= 1U << i_band;
+
+   //  Back to the last event of each band that has begun:
+
+   Earliest = Events [Begin] .Time_in_OneVariable;
+
+   for ( i_event = Begin;  Bands_Seen != Bands_Started;  ) {
+      i_event--;
+      In_Bands = Engine_ptr->Band_Masks [Events [i_event] .SpecChannel]  &  ( 0U - (uint32_t) ( Events [i_event] .Detector < NUM_NAI_DET ) );
+      if ( In_Bands & ~Bands_Seen ) {
+         Earliest = Events [i_event] .Time_in_OneVariable;
+         Bands_Seen |= In_Bands;
+      }
+   }
+
+   if ( Earliest <= Engine_ptr->Warm_Up_Ticks )  return 0;
+
+   //  The first event at or after Earliest - Warm_Up_Ticks, by bisection:
+
+   Lo = 0;
+   Hi = Begin;
+   while ( Lo < Hi ) {
+      Mid = Lo + ( Hi - Lo ) / 2;
+      if ( Events [Mid] .Time_in_OneVariable < Earliest - Engine_ptr->Warm_Up_Ticks )
+         Lo = Mid + 1;
+      else
+         Hi = Mid;
+   }
+
+   return Lo;
+
+}  // Trigger_Warm_Up_Begin ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The range of the background bins, Lo to Hi (none if Hi < Lo), allowed for a data
+//  accumulation beginning Begin ticks after the base time of its band (before it, if
+//  negative).   Bin n, from BaseTime + 1.024 s * n to 1.024 s later less one tick, is
+//  allowed if it ends at least MIN_ALLOWED_BCKG_GAP and begins no more than
+//  MAX_ALLOWED_BCKG_AGE before the accumulation.   Also used by Sweep_Trigger.
+
+void Trigger_Background_Bins (
+
+   // Input argument:
+   int64_t Begin,
+
+   // Output arguments:
+   int64_t * Lo_ptr,
+   int64_t * Hi_ptr
+
+) {
+
+   *Lo_ptr = - Floor_Division ( (int64_t) MAX_ALLOWED_BCKG_AGE - Begin, (int64_t) ONE_SEC_IN_TICKS );
+   if ( *Lo_ptr < 0 )  *Lo_ptr = 0;
+   *Hi_ptr = Floor_Division ( Begin - (int64_t) MIN_ALLOWED_BCKG_GAP - (int64_t) ONE_SEC_IN_TICKS + 1, (int64_t) ONE_SEC_IN_TICKS );
+
+}  // Trigger_Background_Bins ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Copies the state of the bands and accumulations of an engine, e.g., of the last time
+//  slice, to another engine with the same algorithms, leaving its results.
+
+void Copy_Trigger_Engine_State (
+
+   // Input/Output argument:
+   Trigger_Engine_type * Engine_ptr,
+
+   // Input argument:
+   const Trigger_Engine_type * From_Engine_ptr
+
+) {
+
+   Trigger_Band_type *  Band_ptr;
+   const Trigger_Band_type *  From_Band_ptr;
+   Trigger_State_type *  State_ptr;
+   const Trigger_State_type *  From_State_ptr;
+   uint32_t  i_band, i_alg;
+
+
+   for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ ) {
+      Band_ptr = &Engine_ptr->Bands [i_band];
+      From_Band_ptr = &From_Engine_ptr->Bands [i_band];
+      Band_ptr->Started = From_Band_ptr->Started;
+      Band_ptr->BaseTime = From_Band_ptr->BaseTime;
+      Band_ptr->Latest_BinNum = From_Band_ptr->Latest_BinNum;
+      memcpy ( Band_ptr->Bckg_BinNum, From_Band_ptr->Bckg_BinNum, Engine_ptr->Bckg_Depth * sizeof (uint32_t) );
+      memcpy ( Band_ptr->Bckg_Counts, From_Band_ptr->Bckg_Counts, (size_t) Engine_ptr->Bckg_Depth * NUM_NAI_DET * sizeof (uint32_t) );
+      if ( Band_ptr->Fine_Counts != NULL ) {
+         memcpy ( Band_ptr->Fine_Counts, From_Band_ptr->Fine_Counts, (size_t) Engine_ptr->Fine_Depth * NUM_NAI_DET * sizeof (uint32_t) );
+         memcpy ( Band_ptr->Fine_Totals, From_Band_ptr->Fine_Totals, sizeof (Band_ptr->Fine_Totals) );
+         Band_ptr->Fine_BinNum = From_Band_ptr->Fine_BinNum;
+      }
+   }
+
+   for ( i_alg=0;  i_alg < Engine_ptr->Num_Algorithms;  i_alg++ ) {
+      State_ptr = &Engine_ptr->States [i_alg];
+      From_State_ptr = &From_Engine_ptr->States [i_alg];
+      State_ptr->BinNum_Underway = From_State_ptr->BinNum_Underway;
+      memcpy ( State_ptr->Data_Accum, From_State_ptr->Data_Accum, sizeof (State_ptr->Data_Accum) );
+      State_ptr->Window_Lo = From_State_ptr->Window_Lo;
+      State_ptr->Window_Hi = From_State_ptr->Window_Hi;
+      memcpy ( State_ptr->Bckg_Sums, From_State_ptr->Bckg_Sums, sizeof (State_ptr->Bckg_Sums) );
+      State_ptr->Num_Bckg_Bins = From_State_ptr->Num_Bckg_Bins;
+   }
+
+   Engine_ptr->Num_Bands_Started = From_Engine_ptr->Num_Bands_Started;
+   Engine_ptr->Latest_Time = From_Engine_ptr->Latest_Time;
+
+}  // Copy_Trigger_Engine_State ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Reports the results of each algorithm, after all of the events.
+
+void Report_Trigger_Engine (
+
+   // Input arguments:
+   const Trigger_Engine_type * Engine_ptr,
+   uint64_t Num_Events_Processed
+
+) {
+
+   const Trigger_State_type *  State_ptr;
+   const Trigger_Algorithm_type *  Alg_ptr;
+   uint32_t  i_alg;
+
+
+   if ( Engine_ptr->Num_Algorithms > 1 ) {
+      printf ( "\n%llu TTE events were processed.\n", (long long unsigned int) Num_Events_Processed );
+      printf ( "%llu of the TTE events were from NaI detectors within the energy bands of the algorithms.\n",
+               (long long unsigned int) Engine_ptr->Num_Events_in_Bands );
+   }
+
+   for ( i_alg=0;  i_alg < Engine_ptr->Num_Algorithms;  i_alg++ ) {  // loop over algorithms
+
+      State_ptr = &Engine_ptr->States [i_alg];
+      Alg_ptr = &State_ptr->Algorithm;
+
+      if ( Engine_ptr->Num_Algorithms > 1  &&  Alg_ptr->Step > 0 )
+         printf ( "\nAlgorithm %u: SPEC channels %u to %u, timescale %llu, offset %llu, step %llu ticks, %.2f sigma%s in %u of %u NaI detectors:\n",
+                  i_alg + 1, Alg_ptr->Beg_SPEC_Chan, Alg_ptr->End_SPEC_Chan, (long long unsigned int) Alg_ptr->Timescale,
+                  (long long unsigned int) Alg_ptr->Offset, (long long unsigned int) Alg_ptr->Step, Alg_ptr->Threshold,
+                  ( Alg_ptr->Statistic == TRIGGER_POISSON ) ? " (Poisson)" : "", Alg_ptr->Min_Detectors, NUM_NAI_DET );
+      else if ( Engine_ptr->Num_Algorithms > 1 )
+         printf ( "\nAlgorithm %u: SPEC channels %u to %u, timescale %llu, offset %llu ticks, %.2f sigma%s in %u of %u NaI detectors:\n",
+                  i_alg + 1, Alg_ptr->Beg_SPEC_Chan, Alg_ptr->End_SPEC_Chan, (long long unsigned int) Alg_ptr->Timescale,
+                  (long long unsigned int) Alg_ptr->Offset, Alg_ptr->Threshold,
+                  ( Alg_ptr->Statistic == TRIGGER_POISSON ) ? " (Poisson)" : "", Alg_ptr->Min_Detectors, NUM_NAI_DET );
+
+      if ( State_ptr->Largest_Pos_Deviation != -DBL_MAX ) {
+         printf ( "\nLargest positive deviation found:  %7.2lf\n", State_ptr->Largest_Pos_Deviation );
+      } else {
+         printf ( "\nNo positive devations were found above %6.2lf sigma.\n", Alg_ptr->Threshold );
+      }
+      if ( State_ptr->Largest_Neg_Deviation !=  DBL_MAX ) {
+         printf ( "Largest negative deviation found: %8.2lf\n", State_ptr->Largest_Neg_Deviation );
+      } else {
+         printf ( "No negative deviations were found exceeding %6.2lf sigma.\n", Alg_ptr->Threshold );
+      }
+
+      if ( Engine_ptr->Num_Algorithms == 1 ) {
+         printf ( "\n%llu TTE events were processed.\n", (long long unsigned int) Num_Events_Processed );
+         printf ( "%llu of the TTE events were from NaI detectors within the trigger energy channels.\n",
+                  (long long unsigned int) Engine_ptr->Num_Events_in_Bands );
+         printf ( "\n" );
+      }
+
+      printf ( "Number of data accumulations with good background model: %u\n", State_ptr->DataAccum_with_Bckg );
+      printf ( "Number of data accumulations without a good background model: %u\n", State_ptr->DataAccum_without_Bckg );
+
+      if ( Engine_ptr->Num_Algorithms > 1 )  printf ( "Number of triggers: %u\n", State_ptr->Num_Triggers );
+
+   }  // loop over algorithms
+
+}  // Report_Trigger_Engine ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+void Close_Trigger_Engine (
+
+   // Input/Output argument:
+   Trigger_Engine_type * Engine_ptr
+
+) {
+
+   uint32_t  i_band;
+
+
+   for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ ) {
+      free ( Engine_ptr->Bands [i_band] .Bckg_BinNum );
+      free ( Engine_ptr->Bands [i_band] .Bckg_Counts );
+      free ( Engine_ptr->Bands [i_band] .Fine_Counts );
+   }
+
+   free ( Engine_ptr->States );
+   Engine_ptr->States = NULL;
+   Engine_ptr->Num_Algorithms = 0;
+   Engine_ptr->Num_Bands = 0;
+
+}  // Close_Trigger_Engine ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void * Trigger_Slice_Thread ( void * Arg_ptr ) {
+
+   Trigger_Slice_type * Slice_ptr = Arg_ptr;
+   Trigger_Engine_type * Engine_ptr = Slice_ptr->Engine_ptr;
+
+
+   if ( Slice_ptr->Warm_Up_Begin < Slice_ptr->Begin ) {
+      Engine_ptr->Warming_Up = true;
+      Trigger_Engine_Events ( Engine_ptr, Slice_ptr->Events + Slice_ptr->Warm_Up_Begin, Slice_ptr->Begin - Slice_ptr->Warm_Up_Begin );
+      Engine_ptr->Warming_Up = false;
+      Engine_ptr->Num_Events_in_Bands = 0;
+   }
+
+   Trigger_Engine_Events ( Engine_ptr, Slice_ptr->Events + Slice_ptr->Begin, Slice_ptr->End - Slice_ptr->Begin );
+
+   return NULL;
+
+}  // Trigger_Slice_Thread ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The first TTE event of a band has its earliest time -- latch this time as the base
+//  time for calculating the bin numbers of the band's algorithms and background.   The
+//  base time of a time slice is that of the whole file, and the earliest time is output
+//  only by the slice of the first event of the band.   The sliding windows of the band
+//  begin with the first that ends after the event, the earlier ones having no counts.
+
+static void  Start_Band ( Trigger_Engine_type * Engine_ptr, uint32_t i_band, uint64_t Time ) {
+
+   Trigger_Band_type *  Band_ptr = &Engine_ptr->Bands [i_band];
+   uint32_t  i_alg;
+
+
+   Band_ptr->Started = true;
+   if ( ! Engine_ptr->Preset_BaseTimes )  Band_ptr->BaseTime = Time;
+   Engine_ptr->Num_Bands_Started++;
+
+   if ( Band_ptr->Fine_Counts != NULL ) {
+      Band_ptr->Fine_BinNum = (uint32_t) ( ( Time - Band_ptr->BaseTime ) / TRIGGER_FINE_TICKS );
+      for ( i_alg=0;  i_alg < Engine_ptr->Num_Algorithms;  i_alg++ )
+         if ( Engine_ptr->States [i_alg] .Band == i_band  &&  Engine_ptr->States [i_alg] .Algorithm.Step > 0 )
+            Engine_ptr->States [i_alg] .BinNum_Underway = First_Window_Underway ( &Engine_ptr->States [i_alg], Band_ptr->Fine_BinNum );
+   }
+
+   if ( Engine_ptr->Warming_Up  ||  Time != Engine_ptr->Bands [i_band] .BaseTime  ||  Engine_ptr->Output == NULL )  return;
+
+   fprintf ( Engine_ptr->Output, "%sEarliest time in the file: %llu\n", Engine_ptr->Bands [i_band] .Prefix, (long long unsigned int) Time );
+
+}  // Start_Band ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Compares a complete data accumulation with the background model of its band.
+
+static void  Evaluate_Data_Accum ( const Trigger_Engine_type * Engine_ptr, Trigger_State_type * State_ptr ) {
+
+   double  BackgroundModel [NUM_NAI_DET]  TRIGGER_ALIGNED;
+   double  Significance [NUM_NAI_DET]  TRIGGER_ALIGNED;
+   uint32_t  Exceed_Mask, Positive_Mask;
+   uint32_t  Num_Good_Bckg_Bins;
+   uint32_t  Num_Pos_Deviations;
+
+   uint64_t  BeginTime_Data_Bin;
+   uint32_t  j_det;
+
+   double  sig_level_in_sigma;
+
+
+   //  The background model (i.e., running average) is formed from the background bins
+   //  of the band that begin no more than 35.5 s and end at least 4.096 s before the
+   //  data accumulation:
+
+   BeginTime_Data_Bin = Engine_ptr->Bands [State_ptr->Band] .BaseTime + State_ptr->Step * State_ptr->BinNum_Underway
+                        - State_ptr->Phase;
+
+   Move_Background_Window ( Engine_ptr, State_ptr, BeginTime_Data_Bin );
+
+   Num_Good_Bckg_Bins = State_ptr->Num_Bckg_Bins;
+
+
+   if ( Num_Good_Bckg_Bins < MIN_REQ_GOOD_BCKG_BINS ) {  // enough good background bins?
+
+      State_ptr->DataAccum_without_Bckg ++;
+      if ( Engine_ptr->Output != NULL )
+         fprintf ( Engine_ptr->Output, "\n%sOnly %u suitable bins for background accum!\n", State_ptr->Prefix, Num_Good_Bckg_Bins );
+      return;
+
+   }  // enough good background bins?
+
+   State_ptr->DataAccum_with_Bckg ++;
+
+
+   //  The significances of all of the detectors, and the masks of the detectors that
+   //  deviate by more than the threshold (in either direction) and of those deviations
+   //  that are positive:
+
+   if ( State_ptr->Poisson == NULL )
+      Significance_of_Data_Accum ( State_ptr, BackgroundModel, Significance, &Exceed_Mask, &Positive_Mask );
+   else
+      Poisson_Significance_of_Data_Accum ( State_ptr, BackgroundModel, Significance, &Exceed_Mask, &Positive_Mask );
+
+   //  A positive deviation in k detectors in the same time bin is a TRIGGER!
+
+   if ( Count_Bits ( Exceed_Mask & Positive_Mask ) >= State_ptr->Algorithm.Min_Detectors )  State_ptr->Num_Triggers++;
+
+   if ( Exceed_Mask == 0  ||  Engine_ptr->Output == NULL )  return;
+
+
+   //  List the significant deviations, in detector order:
+
+   Num_Pos_Deviations = 0;
+
+   for ( j_det=0;  j_det<NUM_NAI_DET;  j_det++ ) {
+
+      if ( ( Exceed_Mask & ( 1U << j_det ) ) == 0 )  continue;   // significant deviation?
+
+      sig_level_in_sigma = Significance [j_det];
+
+      fprintf ( Engine_ptr->Output, "%sdet %2u has %6u counts, vs bckg %7.1f for %8.2f sigma in bin %10u at %20llu\n",
+               State_ptr->Prefix, j_det, State_ptr->Data_Accum [j_det], BackgroundModel [j_det], sig_level_in_sigma,
+               State_ptr->BinNum_Underway, (long long unsigned int) BeginTime_Data_Bin );
+
+      //  Latch the most extreme positive and negative deviations:
+
+      if ( Positive_Mask & ( 1U << j_det ) ) {
+         if ( sig_level_in_sigma > State_ptr->Largest_Pos_Deviation )  State_ptr->Largest_Pos_Deviation = sig_level_in_sigma;
+         Num_Pos_Deviations++;
+         if ( Num_Pos_Deviations >= State_ptr->Algorithm.Min_Detectors ) {
+            if ( State_ptr->Algorithm.Min_Detectors == 2 )
+               fprintf ( Engine_ptr->Output, "%sDuplicate time bin ==> TRIGGER !!!\n", State_ptr->Prefix );
+            else
+               fprintf ( Engine_ptr->Output, "%s%u detectors in time bin ==> TRIGGER !!!\n", State_ptr->Prefix, Num_Pos_Deviations );
+         }
+      } else {
+         if ( sig_level_in_sigma < State_ptr->Largest_Neg_Deviation )  State_ptr->Largest_Neg_Deviation = sig_level_in_sigma;
+      }
+
+   }  // j_det
+
+}  // Evaluate_Data_Accum ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Evaluates the sliding windows of an algorithm that are complete at an event in
+//  4 ms bin Fine_BinNum, later than the bin of the latest event of the band: those
+//  that end by the bin.   The counts of a window are the cumulative counts at its end,
+//  which are those of all of the events so far, less those at its beginning, which is
+//  within the ring.   The windows that begin after the latest event have no counts and
+//  are skipped.
+
+static void  Slide_Windows ( const Trigger_Engine_type * Engine_ptr, Trigger_State_type * State_ptr, uint32_t Fine_BinNum ) {
+
+   const Trigger_Band_type *  Band_ptr = &Engine_ptr->Bands [State_ptr->Band];
+   const uint32_t *  Beg_Counts;
+
+   int64_t  Width = (int64_t) ( State_ptr->Algorithm.Timescale / TRIGGER_FINE_TICKS );
+   int64_t  Step = (int64_t) ( State_ptr->Step / TRIGGER_FINE_TICKS );
+   int64_t  Phase = (int64_t) ( State_ptr->Phase / TRIGGER_FINE_TICKS );
+   int64_t  Beg;
+   uint32_t  Any_Counts;
+   uint32_t  j_det;
+
+#ifdef HAVE_SSE2_TRIGGER
+   __m128i  Counts_4;
+#endif
+
+
+   for ( ;;  State_ptr->BinNum_Underway++ ) {  // loop over windows
+
+      Beg = (int64_t) State_ptr->BinNum_Underway * Step - Phase;
+
+      if ( Beg + Width > (int64_t) Fine_BinNum )  break;   // underway
+
+      if ( Beg > (int64_t) Band_ptr->Fine_BinNum ) {
+         State_ptr->BinNum_Underway = First_Window_Underway ( State_ptr, Fine_BinNum );
+         break;
+      }
+
+      //  The window may begin before the base time, if it is offset:
+
+      if ( Beg <= 0 ) {
+
+         memcpy ( State_ptr->Data_Accum, Band_ptr->Fine_Totals, sizeof (State_ptr->Data_Accum) );
+
+      } else {
+
+         Beg_Counts = &Band_ptr->Fine_Counts [ ( Beg % Engine_ptr->Fine_Depth ) * NUM_NAI_DET ];
+
+#ifdef HAVE_SSE2_TRIGGER
+         for ( j_det=0;  j_det<NUM_NAI_DET;  j_det+=4 ) {
+            Counts_4 = _mm_sub_epi32 ( _mm_load_si128 ( (const __m128i *) &Band_ptr->Fine_Totals [j_det] ),
+                                       _mm_load_si128 ( (const __m128i *) &Beg_Counts [j_det] ) );
+            _mm_store_si128 ( (__m128i *) &State_ptr->Data_Accum [j_det], Counts_4 );
+         }
+#else
+         for ( j_det=0;  j_det<NUM_NAI_DET;  j_det++ )  State_ptr->Data_Accum [j_det] = Band_ptr->Fine_Totals [j_det] - Beg_Counts [j_det];
+#endif
+
+      }
+
+      Any_Counts = 0;
+      for ( j_det=0;  j_det<NUM_NAI_DET;  j_det++ )  Any_Counts |= State_ptr->Data_Accum [j_det];
+
+      if ( Any_Counts != 0  &&  ! Engine_ptr->Warming_Up )  Evaluate_Data_Accum ( Engine_ptr, State_ptr );
+
+   }  // loop over windows
+
+}  // Slide_Windows ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The first sliding window of an algorithm that ends after 4 ms bin Fine_BinNum.
+
+static uint32_t  First_Window_Underway ( const Trigger_State_type * State_ptr, uint32_t Fine_BinNum ) {
+
+   int64_t  Width = (int64_t) ( State_ptr->Algorithm.Timescale / TRIGGER_FINE_TICKS );
+   int64_t  Step = (int64_t) ( State_ptr->Step / TRIGGER_FINE_TICKS );
+   int64_t  Phase = (int64_t) ( State_ptr->Phase / TRIGGER_FINE_TICKS );
+   int64_t  First;
+
+
+   First = Floor_Division ( (int64_t) Fine_BinNum - Width + Phase, Step ) + 1;
+
+   return ( First > 0 )  ?  (uint32_t) First  :  0;
+
+}  // First_Window_Underway ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Calculates, for all of the detectors, the background model (average of the background
+//  bins), the significance of the deviation of the data accumulation from the background
+//  model, in sigma, and the masks of the detectors whose deviations exceed the threshold
+//  in magnitude (bit j_det of Exceed_Mask) and are positive (Positive_Mask).   A detector
+//  with no counts in either has significance NaN, which exceeds no threshold.
+
+static void  Significance_of_Data_Accum ( const Trigger_State_type * State_ptr, double BackgroundModel [],
+                                          double Significance [], uint32_t * Exceed_Mask_ptr, uint32_t * Positive_Mask_ptr ) {
+
+   uint32_t  Exceed_Mask = 0;
+   uint32_t  Positive_Mask = 0;
+   uint32_t  j_det;
+
+#ifdef HAVE_SSE2_TRIGGER
+
+   const __m128i  Sign_Bit_32 = _mm_set1_epi32 ( INT32_MIN );
+   const __m128d  Two_to_31 = _mm_set1_pd ( 2147483648.0 );
+   const __m128d  Sign_Bit_64 = _mm_set1_pd ( -0.0 );
+   const __m128d  Zero = _mm_setzero_pd ();
+   const __m128d  Num_Bins = _mm_set1_pd ( (double) State_ptr->Num_Bckg_Bins );
+   const __m128d  Factor = _mm_set1_pd ( State_ptr->Timescale_Factor );
+   const __m128d  Threshold = _mm_set1_pd ( State_ptr->Algorithm.Threshold );
+
+   __m128i  Data_4, Bckg_4;
+   __m128d  Data, Bckg, Model, Expected, Sig;
+   uint32_t  j_half;
+
+
+   for ( j_det=0;  j_det<NUM_NAI_DET;  j_det+=4 ) {  // four detectors at a time
+
+      //  uint32_t to double: offset by 2^31 into the range of int32_t, which SSE2 converts:
+
+      Data_4 = _mm_xor_si128 ( _mm_load_si128 ( (const __m128i *) &State_ptr->Data_Accum [j_det] ), Sign_Bit_32 );
+      Bckg_4 = _mm_xor_si128 ( _mm_load_si128 ( (const __m128i *) &State_ptr->Bckg_Sums [j_det] ), Sign_Bit_32 );
+
+      for ( j_half=0;  j_half<4;  j_half+=2 ) {  // two detectors at a time
+
+         Data = _mm_add_pd ( _mm_cvtepi32_pd ( Data_4 ), Two_to_31 );
+         Bckg = _mm_add_pd ( _mm_cvtepi32_pd ( Bckg_4 ), Two_to_31 );
+
+         Model = _mm_div_pd ( Bckg, Num_Bins );
+         Expected = _mm_mul_pd ( Factor, Model );
+         Sig = _mm_div_pd ( _mm_sub_pd ( Data, Expected ), _mm_sqrt_pd ( Expected ) );
+
+         _mm_store_pd ( &BackgroundModel [j_det + j_half], Model );
+         _mm_store_pd ( &Significance [j_det + j_half], Sig );
+
+         Exceed_Mask |= (uint32_t) _mm_movemask_pd ( _mm_cmpgt_pd ( _mm_andnot_pd ( Sign_Bit_64, Sig ), Threshold ) ) << ( j_det + j_half );
+         Positive_Mask |= (uint32_t) _mm_movemask_pd ( _mm_cmpgt_pd ( Sig, Zero ) ) << ( j_det + j_half );
+
+         Data_4 = _mm_srli_si128 ( Data_4, 8 );
+         Bckg_4 = _mm_srli_si128 ( Bckg_4, 8 );
+
+      }  // two detectors at a time
+
+   }  // four detectors at a time
+
+#else
+
+   double  excess, sigma;
+
+
+   for ( j_det=0;  j_det<NUM_NAI_DET;  j_det++ ) {
+
+      BackgroundModel [j_det] = (double) State_ptr->Bckg_Sums [j_det] / (double) State_ptr->Num_Bckg_Bins;
+
+      excess = (double) State_ptr->Data_Accum [j_det] - State_ptr->Timescale_Factor * BackgroundModel [j_det];
+      sigma = sqrt ( State_ptr->Timescale_Factor * BackgroundModel [j_det] );
+
+      Significance [j_det] = excess / sigma;
+
+      if ( fabs (Significance [j_det]) > State_ptr->Algorithm.Threshold )  Exceed_Mask |= 1U << j_det;
+      if ( Significance [j_det] > 0 )  Positive_Mask |= 1U << j_det;
+
+   }  // j_det
+
+#endif
+
+   *Exceed_Mask_ptr = Exceed_Mask;
+   *Positive_Mask_ptr = Positive_Mask;
+
+}  // Significance_of_Data_Accum ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  As Significance_of_Data_Accum, for a Poisson background: the decisions are lookups in
+//  the table of the threshold, and the significances are those of the Poisson tail
+//  probabilities, set only for the detectors in Exceed_Mask.
+
+static void  Poisson_Significance_of_Data_Accum ( const Trigger_State_type * State_ptr, double BackgroundModel [],
+                                                  double Significance [], uint32_t * Exceed_Mask_ptr, uint32_t * Positive_Mask_ptr ) {
+
+   uint32_t  Exceed_Mask = 0;
+   uint32_t  Positive_Mask = 0;
+   uint32_t  j_det;
+   int  Deviation;
+
+
+   for ( j_det=0;  j_det<NUM_NAI_DET;  j_det++ ) {
+
+      BackgroundModel [j_det] = (double) State_ptr->Bckg_Sums [j_det] / (double) State_ptr->Num_Bckg_Bins;
+
+      Deviation = Poisson_Deviation ( State_ptr->Poisson, State_ptr->Data_Accum [j_det],
+                                      State_ptr->Timescale_Factor * BackgroundModel [j_det], &Significance [j_det] );
+
+      if ( Deviation != 0 )  Exceed_Mask |= 1U << j_det;
+      if ( Deviation > 0 )  Positive_Mask |= 1U << j_det;
+
+   }  // j_det
+
+   *Exceed_Mask_ptr = Exceed_Mask;
+   *Positive_Mask_ptr = Positive_Mask;
+
+}  // Poisson_Significance_of_Data_Accum ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static uint32_t  Count_Bits ( uint32_t Mask ) {
+
+#if defined (__GNUC__)
+   return (uint32_t) __builtin_popcount ( Mask );
+#else
+   uint32_t  Num_Bits = 0;
+
+   for ( ;  Mask != 0;  Mask &= Mask - 1 )  Num_Bits++;
+   return Num_Bits;
+#endif
+
+}  // Count_Bits ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Counts an event in the 1.024 s background bin of its time.   The slot of the bin is
+//  cleared when the first event of the bin reaches it.
+
+static void  Add_to_Background ( const Trigger_Engine_type * Engine_ptr, Trigger_Band_type * Band_ptr,
+                                 uint64_t Time, uint32_t Detector ) {
+
+   uint32_t  Background_BinNum;
+   uint32_t  i_slot;
+
+
+   Background_BinNum = (uint32_t) ( ( Time - Band_ptr->BaseTime ) / ONE_SEC_IN_TICKS );
+   i_slot = Background_BinNum % Engine_ptr->Bckg_Depth;
+
+   if ( Band_ptr->Bckg_BinNum [i_slot] != Background_BinNum ) {
+      Band_ptr->Bckg_BinNum [i_slot] = Background_BinNum;
+      memset ( &Band_ptr->Bckg_Counts [i_slot * NUM_NAI_DET], 0, NUM_NAI_DET * sizeof (uint32_t) );
+   }
+
+   Band_ptr->Bckg_Counts [i_slot * NUM_NAI_DET + Detector] ++;
+   Band_ptr->Latest_BinNum = Background_BinNum;
+
+}  // Add_to_Background ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Counts an event in the cumulative counts of its band.   When the event is in a later
+//  4 ms bin than the latest, the cumulative counts before each of the bins since, all
+//  those of the events so far, are first entered in the ring (at most the depth of the
+//  ring of them, after a gap in the data).
+
+static void  Add_to_Fine_Counts ( const Trigger_Engine_type * Engine_ptr, Trigger_Band_type * Band_ptr,
+                                  uint64_t Time, uint32_t Detector ) {
+
+   uint32_t  Fine_BinNum;
+   uint32_t  BinNum;
+
+
+   Fine_BinNum = (uint32_t) ( ( Time - Band_ptr->BaseTime ) / TRIGGER_FINE_TICKS );
+
+   if ( Fine_BinNum != Band_ptr->Fine_BinNum ) {
+      BinNum = ( Fine_BinNum - Band_ptr->Fine_BinNum > Engine_ptr->Fine_Depth )  ?  Fine_BinNum - Engine_ptr->Fine_Depth + 1
+                                                                                :  Band_ptr->Fine_BinNum + 1;
+      for ( ;  BinNum <= Fine_BinNum;  BinNum++ )
+         memcpy ( &Band_ptr->Fine_Counts [ ( BinNum % Engine_ptr->Fine_Depth ) * NUM_NAI_DET ], Band_ptr->Fine_Totals,
+                  sizeof (Band_ptr->Fine_Totals) );
+      Band_ptr->Fine_BinNum = Fine_BinNum;
+   }
+
+   Band_ptr->Fine_Totals [Detector] ++;
+
+}  // Add_to_Fine_Counts ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Moves the range of background bins of an algorithm to those allowed for the data
+//  accumulation beginning at BeginTime_Data_Bin (see Trigger_Background_Bins), updating
+//  the sums of their counts.
+
+static void  Move_Background_Window ( const Trigger_Engine_type * Engine_ptr, Trigger_State_type * State_ptr,
+                                      uint64_t BeginTime_Data_Bin ) {
+
+   const Trigger_Band_type *  Band_ptr = &Engine_ptr->Bands [State_ptr->Band];
+
+   int64_t  Begin;
+   int64_t  Lo, Hi;
+   int64_t  BinNum;
+
+
+   //  The accumulation may begin before the base time, if it is offset:
+
+   Begin = (int64_t) ( BeginTime_Data_Bin - Band_ptr->BaseTime );
+
+   Trigger_Background_Bins ( Begin, &Lo, &Hi );
+
+
+   if ( Hi < Lo  ||  State_ptr->Window_Hi < State_ptr->Window_Lo  ||  Lo > State_ptr->Window_Hi  ||
+        (int64_t) Band_ptr->Latest_BinNum >= State_ptr->Window_Lo + (int64_t) Engine_ptr->Bckg_Depth ) {  // form again ?
+
+      //  No overlap with the old range, or the old range is no longer in the ring:
+
+      memset ( State_ptr->Bckg_Sums, 0, sizeof (State_ptr->Bckg_Sums) );
+      State_ptr->Num_Bckg_Bins = 0;
+
+      for ( BinNum = Lo;  BinNum <= Hi;  BinNum++ )  Add_Background_Bin ( Engine_ptr, Band_ptr, State_ptr, BinNum, +1 );
+
+   } else {  // form again ?
+
+      for ( BinNum = State_ptr->Window_Lo;  BinNum < Lo;  BinNum++ )  Add_Background_Bin ( Engine_ptr, Band_ptr, State_ptr, BinNum, -1 );
+
+      for ( BinNum = State_ptr->Window_Hi + 1;  BinNum <= Hi;  BinNum++ )  Add_Background_Bin ( Engine_ptr, Band_ptr, State_ptr, BinNum, +1 );
+
+   }  // form again ?
+
+   State_ptr->Window_Lo = Lo;
+   State_ptr->Window_Hi = ( Hi < Lo )  ?  Lo - 1  :  Hi;
+
+}  // Move_Background_Window ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Adds (Sign +1) or subtracts (-1) the counts of a background bin, if it has data.
+
+static void  Add_Background_Bin ( const Trigger_Engine_type * Engine_ptr, const Trigger_Band_type * Band_ptr,
+                                  Trigger_State_type * State_ptr, int64_t BinNum, int Sign ) {
+
+   const uint32_t *  Counts;
+   uint32_t  i_slot;
+   uint32_t  j_det;
+
+#ifdef HAVE_SSE2_TRIGGER
+   __m128i *  Sums_ptr;
+   __m128i  Counts_4;
+#endif
+
+
+   i_slot = (uint32_t) ( BinNum % Engine_ptr->Bckg_Depth );
+   if ( Band_ptr->Bckg_BinNum [i_slot] != (uint32_t) BinNum )  return;   // no data
+
+   Counts = &Band_ptr->Bckg_Counts [i_slot * NUM_NAI_DET];
+
+#ifdef HAVE_SSE2_TRIGGER
+
+   for ( j_det=0;  j_det<NUM_NAI_DET;  j_det+=4 ) {
+      Sums_ptr = (__m128i *) &State_ptr->Bckg_Sums [j_det];
+      Counts_4 = _mm_load_si128 ( (const __m128i *) &Counts [j_det] );
+      _mm_store_si128 ( Sums_ptr, ( Sign > 0 )  ?  _mm_add_epi32 ( _mm_load_si128 ( Sums_ptr ), Counts_4 )
+                                                :  _mm_sub_epi32 ( _mm_load_si128 ( Sums_ptr ), Counts_4 ) );
+   }
+
+   if ( Sign > 0 )
+      State_ptr->Num_Bckg_Bins++;
+   else
+      State_ptr->Num_Bckg_Bins--;
+
+#else
+
+   if ( Sign > 0 ) {
+      for ( j_det=0;  j_det<NUM_NAI_DET;  j_det++ )  State_ptr->Bckg_Sums [j_det] += Counts [j_det];
+      State_ptr->Num_Bckg_Bins++;
+   } else {
+      for ( j_det=0;  j_det<NUM_NAI_DET;  j_det++ )  State_ptr->Bckg_Sums [j_det] -= Counts [j_det];
+      State_ptr->Num_Bckg_Bins--;
+   }
+
+#endif
+
+}  // Add_Background_Bin ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Rounds toward minus infinity, for a positive denominator.
+
+static int64_t  Floor_Division ( int64_t Numerator, int64_t Denominator ) {
+
+   int64_t  Quotient = Numerator / Denominator;
+
+
+   if ( Numerator % Denominator != 0  &&  Numerator < 0 )  Quotient--;
+
+   return Quotient;
+
+}  // Floor_Division ()
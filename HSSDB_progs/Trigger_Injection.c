@@ -0,0 +1,688 @@
+//  Injection of synthetic bursts into the background of Trigger_from_TTE, for the
+//  efficiency of the trigger algorithms: each burst is a Poisson stream of events,
+//  generated as it is needed and merged, in time order, with the real events, so that
+//  no file of events is written, and thousands of bursts are evaluated in one run.
+
+//  The table of injections has one class of bursts per line:
+//     Counts  Duration  Beg_SPEC_Chan  End_SPEC_Chan  Num_Injections  W_0 ... W_11
+//  Counts is the mean number of events of a burst, summed over the NaI detectors,
+//  Duration its length in 2 microsec ticks, over which its rate is constant, its
+//  events have channels uniformly from Beg_SPEC_Chan to End_SPEC_Chan, and the weights
+//  W_0 to W_11 are the pattern of the burst over the 12 NaI detectors (relative
+//  counts).   A class with Counts 0 measures the chance triggers on the background.
+
+//  Each injection is evaluated by its own engine, with the algorithms of the run,
+//  quietly (no lines output), from the beginning of the burst to the longest timescale
+//  and a second after its end.   The engine of an injection begins with the state of
+//  the engine of the background at the beginning of the burst -- the background bins,
+//  the accumulations underway -- so that its accumulations are those of the serial run
+//  with the burst added.   The burst is found when any algorithm triggers on an
+//  accumulation evaluated in this span.   The beginnings of the bursts are the times of
+//  events chosen at random, so that they fall where there is data, after the warm-up
+//  of the first events.
+
+//  The random numbers of an injection are counter based (SplitMix64): the n-th is a
+//  hash of n and the key of the injection, from the seed and the number of the
+//  injection, so that each injection is the same whatever the number of threads and the
+//  order of processing, and can be made again alone.
+
+//  The injections, in time order, are divided among the threads in blocks, and each
+//  thread makes one pass over the events of its block, in chunks, with an engine of the
+//  background that only accumulates (warmed up as for a time slice, see
+//  Trigger_Engine_Sharded): each chunk is fed to the background, up to the beginning of
+//  each injection, and then to every injection underway in it, while it is in the cache.
+
+//  Usage:
+//     Num_Classes = Read_Injection_Classes ( "Injections.txt", &Classes );
+//     Trigger_Injections ( &Engine, Events, Num_Events, Seed, Num_Threads, Num_Classes, Classes );
+//     Report_Injections ( Num_Classes, Classes, Seed );
+
+
+#include "HSSDB_Progs_Header.h"
+
+#include <pthread.h>
+#include <math.h>
+
+
+#define  MAX_TABLE_LINE   512U
+
+#define  MAX_INJECTION_THREADS   64U
+
+#define  INJECTION_CHUNK   65536U      /* events of the background fed to each injection at a time */
+
+#define  INJECTION_BUFFER_SIZE   65536U     /* of the merged events */
+
+#define  INJECTION_MARGIN   512000LLU      /* 1.024 s in 2 microsec ticks, after the longest timescale */
+
+
+//  local typedefs:
+
+typedef struct  Injection_type {
+   uint32_t  Class;
+   uint64_t  Key;                // of its random numbers
+   uint64_t  Time;               // of the beginning of the burst
+   size_t    Begin;              // the events with the burst, Begin to End - 1
+   size_t    End;
+   double    Offset;             // of the latest event of the burst from Time, in ticks
+   uint64_t  Num_Made;           // events of the burst made, the counter of the random numbers
+   Processed_TTE_v2_type  Next_Event;    // of the burst, Time_in_OneVariable UINT64_MAX after the last
+   Trigger_Engine_type *  Engine_ptr;   // while underway
+   _Bool     Triggered;
+} Injection_type;
+
+typedef struct  Injection_Thread_type {
+   const Trigger_Engine_type *  Engine_ptr;   // of the run: its algorithms
+   const Trigger_Algorithm_type *  Algorithms;
+   const uint64_t *  BaseTimes;
+   const Processed_TTE_v2_type *  Events;
+   size_t    Num_Events;
+   const Injection_Class_type *  Classes;
+   Injection_type **  Injections;   // of the thread, in order of Begin
+   uint32_t  Num_Injections;
+   size_t    Warm_Up_Begin;      // of the background, before the first injection
+   Trigger_Engine_type  Background;
+   Processed_TTE_v2_type *  Buffer;  // of the merged events
+} Injection_Thread_type;
+
+
+//  local function prototypes:
+
+static void * Injection_Thread ( void * Arg_ptr );
+
+static void  Start_Injection ( const Injection_Thread_type * Thread_ptr, Injection_type * Injection_ptr );
+
+static void  Quiet_Engine ( const Injection_Thread_type * Thread_ptr, Trigger_Engine_type * Engine_ptr );
+
+static void  Inject_Events ( const Injection_Thread_type * Thread_ptr, Injection_type * Injection_ptr, size_t From, size_t To );
+
+static void  Next_Burst_Event ( const Injection_Class_type * Class_ptr, Injection_type * Injection_ptr );
+
+static void  Finish_Injection ( Injection_type * Injection_ptr );
+
+static int  Compare_Begin ( const void * A_ptr, const void * B_ptr );
+
+static size_t  First_Event_at ( const Processed_TTE_v2_type Events [], size_t Num_Events, uint64_t Time );
+
+static uint64_t  Mix64 ( uint64_t z );
+
+static double  Random_Uniform ( uint64_t Key, uint64_t Counter );
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Reads the table of injections: one class of bursts per line (see above); blank lines
+//  and lines beginning with # are ignored.   Returns the number of classes.
+
+uint32_t Read_Injection_Classes (
+
+   // Input argument:
+   const char * FileName,
+
+   // Output argument:
+   Injection_Class_type ** Classes_ptr
+
+) {
+
+   FILE *  Table_File_ptr;
+   char  Line [MAX_TABLE_LINE];
+   char  Ignored [2];
+   uint32_t  Line_Number = 0;
+   uint32_t  Num_Classes = 0;
+   Injection_Class_type *  Classes;
+   Injection_Class_type *  Class_ptr;
+   long long unsigned int  Duration;
+   double  W [NUM_NAI_DET];
+   double  Sum_W = 0;
+   uint32_t  j_det;
+   _Bool  Bad_Weight;
+
+
+   Table_File_ptr = fopen ( FileName, "r" );
+   if ( Table_File_ptr == NULL ) {
+      printf ( "\n\nFailed to open the table of injections '%s' -- Exiting!\n", FileName );
+      exit (171);
+   }
+
+   Classes = malloc ( MAX_INJECTION_CLASSES * sizeof (Injection_Class_type) );
+   if ( Classes == NULL ) {
+      printf ( "\n\nmalloc of injections failed. exiting.\n" );
+      exit (172);
+   }
+
+   while ( fgets ( Line, sizeof (Line), Table_File_ptr ) != NULL ) {  // loop over lines
+
+      Line_Number++;
+
+      if ( sscanf ( Line, "%1s", Ignored ) != 1  ||  Ignored [0] == '#' )  continue;   // blank or comment
+
+      if ( Num_Classes == MAX_INJECTION_CLASSES ) {
+         printf ( "\n\nMore than %u classes of injections in '%s' -- Exiting!\n", MAX_INJECTION_CLASSES, FileName );
+         exit (171);
+      }
+
+      Class_ptr = &Classes [Num_Classes];
+
+      Bad_Weight = false;
+      if ( sscanf ( Line, "%lf %llu %u %u %u %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf",
+                    &Class_ptr->Counts, &Duration, &Class_ptr->Beg_SPEC_Chan, &Class_ptr->End_SPEC_Chan, &Class_ptr->Num_Injections,
+                    &W [0], &W [1], &W [2], &W [3], &W [4], &W [5], &W [6], &W [7], &W [8], &W [9], &W [10], &W [11] ) == 17 ) {
+         Sum_W = 0;
+         for ( j_det=0;  j_det<NUM_NAI_DET;  j_det++ ) {
+            if ( ! ( W [j_det] >= 0 ) )  Bad_Weight = true;
+            Sum_W += W [j_det];
+         }
+      } else {
+         Bad_Weight = true;
+      }
+
+      if ( Bad_Weight  ||  ! ( Sum_W > 0 )  ||  ! ( Class_ptr->Counts >= 0 )  ||  Duration == 0  ||
+           Class_ptr->Beg_SPEC_Chan > Class_ptr->End_SPEC_Chan  ||  Class_ptr->End_SPEC_Chan >= NUM_SPEC_CHAN  ||
+           Class_ptr->Num_Injections < 1 ) {
+         printf ( "\n\nBad injection at line %u of '%s':\n%s\n", Line_Number, FileName, Line );
+         printf ( "Expected: Counts  Duration  Beg_SPEC_Chan  End_SPEC_Chan  Num_Injections  W_0 ... W_11\n" );
+         printf ( "with Duration in ticks above 0, channels 0 to %u, and weights of the %u NaI detectors not all 0 -- Exiting!\n",
+                  NUM_SPEC_CHAN - 1, NUM_NAI_DET );
+         exit (171);
+      }
+
+      Class_ptr->Duration = Duration;
+
+      //  The pattern, as the cumulative fraction of the counts:
+
+      Class_ptr->Cum_Weights [0] = W [0] / Sum_W;
+      for ( j_det=1;  j_det<NUM_NAI_DET;  j_det++ )  Class_ptr->Cum_Weights [j_det] = Class_ptr->Cum_Weights [j_det-1] + W [j_det] / Sum_W;
+      Class_ptr->Cum_Weights [NUM_NAI_DET - 1] = 1.0;
+
+      Class_ptr->Num_Triggered = 0;
+      Num_Classes++;
+
+   }  // loop over lines
+
+   fclose ( Table_File_ptr );
+
+   if ( Num_Classes == 0 ) {
+      printf ( "\n\nNo injections in '%s' -- Exiting!\n", FileName );
+      exit (171);
+   }
+
+   *Classes_ptr = Classes;
+
+   return Num_Classes;
+
+}  // Read_Injection_Classes ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Injects the bursts of the classes into the events, in time order, and evaluates
+//  them with the algorithms of the engine (which is not changed), on Num_Threads
+//  threads, counting for each class the bursts that triggered.
+
+void Trigger_Injections (
+
+   // Input arguments:
+   const Trigger_Engine_type * Engine_ptr,
+   const Processed_TTE_v2_type Events [],
+   size_t Num_Events,
+   uint64_t Seed,
+   uint32_t Num_Threads,
+   uint32_t Num_Classes,
+
+   // Input/Output argument:
+   Injection_Class_type Classes []
+
+) {
+
+   Trigger_Algorithm_type *  Algorithms;
+   Injection_type *  Injections;
+   Injection_type **  Ordered;
+   Injection_type *  Injection_ptr;
+   Injection_Thread_type  Threads [MAX_INJECTION_THREADS];
+   pthread_t  Thread_IDs [MAX_INJECTION_THREADS];
+
+   size_t  First_in_Band [MAX_TRIGGER_BANDS];
+   uint64_t  BaseTimes [MAX_TRIGGER_BANDS];
+   uint64_t  Span_After;
+   size_t  Earliest_Begin, Latest_Begin;
+   uint32_t  Num_Injections = 0;
+   uint32_t  i_class, i_inj, k_inj, i_alg;
+   uint32_t  j_thread;
+
+
+   for ( i_class=0;  i_class < Num_Classes;  i_class++ )  Num_Injections += Classes [i_class] .Num_Injections;
+
+   if ( Num_Threads > MAX_INJECTION_THREADS )  Num_Threads = MAX_INJECTION_THREADS;
+   if ( Num_Threads > Num_Injections )  Num_Threads = Num_Injections;
+
+   Algorithms = malloc ( Engine_ptr->Num_Algorithms * sizeof (Trigger_Algorithm_type) );
+   Injections = calloc ( Num_Injections, sizeof (Injection_type) );
+   Ordered = malloc ( Num_Injections * sizeof (Injection_type *) );
+   if ( Algorithms == NULL  ||  Injections == NULL  ||  Ordered == NULL ) {
+      printf ( "\n\nmalloc of injections failed. exiting.\n" );
+      exit (172);
+   }
+
+   for ( i_alg=0;  i_alg < Engine_ptr->Num_Algorithms;  i_alg++ )  Algorithms [i_alg] = Engine_ptr->States [i_alg] .Algorithm;
+
+   Trigger_Band_Starts ( Engine_ptr, Events, Num_Events, First_in_Band, BaseTimes );
+
+
+   //  The injections: each begins at the time of an event chosen at random from those
+   //  after the warm-up of the first events and long enough before the last:
+
+   Earliest_Begin = ( Num_Events > 0 ) ? First_Event_at ( Events, Num_Events, Events [0] .Time_in_OneVariable + Engine_ptr->Warm_Up_Ticks ) : 0;
+
+   i_inj = 0;
+   for ( i_class=0;  i_class < Num_Classes;  i_class++ ) {  // loop over classes
+
+      Span_After = Classes [i_class] .Duration + Engine_ptr->Max_Timescale + INJECTION_MARGIN;
+
+      Latest_Begin = 0;
+      if ( Num_Events > 0  &&  Events [Num_Events - 1] .Time_in_OneVariable > Span_After )
+         Latest_Begin = First_Event_at ( Events, Num_Events, Events [Num_Events - 1] .Time_in_OneVariable - Span_After );
+
+      if ( Latest_Begin <= Earliest_Begin ) {
+         printf ( "\n\nThe events are too short for the injections of class %u: they need %.3f s of events and %.3f s more -- Exiting!\n",
+                  i_class + 1, Engine_ptr->Warm_Up_Ticks * 2.0E-6, Span_After * 2.0E-6 );
+         exit (173);
+      }
+
+      for ( k_inj=0;  k_inj < Classes [i_class] .Num_Injections;  k_inj++ ) {  // loop over injections of the class
+         Injection_ptr = &Injections [i_inj];
+         Injection_ptr->Class = i_class;
+         Injection_ptr->Key = Mix64 ( Seed ^ Mix64 ( i_inj + 1 ) );
+         Injection_ptr->Begin = Earliest_Begin + (size_t) ( Random_Uniform ( Injection_ptr->Key, 0 ) * ( Latest_Begin - Earliest_Begin ) );
+         Injection_ptr->Time = Events [Injection_ptr->Begin] .Time_in_OneVariable;
+         Injection_ptr->Begin = First_Event_at ( Events, Num_Events, Injection_ptr->Time );
+         Injection_ptr->End = First_Event_at ( Events, Num_Events, Injection_ptr->Time + Span_After );
+         Ordered [i_inj] = Injection_ptr;
+         i_inj++;
+      }  // loop over injections of the class
+
+   }  // loop over classes
+
+
+   //  Each thread takes a block of the injections, in time order, with the warm-up of
+   //  its background before the first:
+
+   qsort ( Ordered, Num_Injections, sizeof (Injection_type *), Compare_Begin );
+
+   for ( j_thread=0;  j_thread < Num_Threads;  j_thread++ ) {
+      Threads [j_thread] .Engine_ptr = Engine_ptr;
+      Threads [j_thread] .Algorithms = Algorithms;
+      Threads [j_thread] .BaseTimes = BaseTimes;
+      Threads [j_thread] .Events = Events;
+      Threads [j_thread] .Num_Events = Num_Events;
+      Threads [j_thread] .Classes = Classes;
+      Threads [j_thread] .Injections = Ordered + (size_t) Num_Injections * j_thread / Num_Threads;
+      Threads [j_thread] .Num_Injections = (uint32_t) ( (size_t) Num_Injections * ( j_thread + 1 ) / Num_Threads
+                                                        - (size_t) Num_Injections * j_thread / Num_Threads );
+      Threads [j_thread] .Warm_Up_Begin = Trigger_Warm_Up_Begin ( Engine_ptr, Events, Threads [j_thread] .Injections [0] ->Begin,
+                                                                  First_in_Band );
+      Threads [j_thread] .Buffer = malloc ( INJECTION_BUFFER_SIZE * sizeof (Processed_TTE_v2_type) );
+      if ( Threads [j_thread] .Buffer == NULL ) {
+         printf ( "\n\nmalloc of injections failed. exiting.\n" );
+         exit (172);
+      }
+   }
+
+   for ( j_thread=1;  j_thread < Num_Threads;  j_thread++ ) {
+      if ( pthread_create ( &Thread_IDs [j_thread], NULL, Injection_Thread, &Threads [j_thread] ) != 0 ) {
+         printf ( "\n\nFailed to create thread -- Exiting!\n" );
+         exit (174);
+      }
+   }
+
+   Injection_Thread ( &Threads [0] );
+
+   for ( j_thread=1;  j_thread < Num_Threads;  j_thread++ )  pthread_join ( Thread_IDs [j_thread], NULL );
+
+
+   for ( i_inj=0;  i_inj < Num_Injections;  i_inj++ )
+      if ( Injections [i_inj] .Triggered )  Classes [Injections [i_inj] .Class] .Num_Triggered++;
+
+   for ( j_thread=0;  j_thread < Num_Threads;  j_thread++ )  free ( Threads [j_thread] .Buffer );
+   free ( Ordered );
+   free ( Injections );
+   free ( Algorithms );
+
+}  // Trigger_Injections ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The table of efficiencies: for each class, the fraction of its bursts that
+//  triggered, with its binomial error.
+
+void Report_Injections (
+
+   // Input arguments:
+   uint32_t Num_Classes,
+   const Injection_Class_type Classes [],
+   uint64_t Seed
+
+) {
+
+   uint32_t  Num_Injections = 0;
+   uint32_t  i_class;
+   double  Efficiency;
+
+
+   for ( i_class=0;  i_class < Num_Classes;  i_class++ )  Num_Injections += Classes [i_class] .Num_Injections;
+
+   printf ( "\nEfficiency of the trigger algorithms for %u injected bursts, seed %llu:\n", Num_Injections, (long long unsigned int) Seed );
+   printf ( "class      counts     duration   SPEC chan   injected  triggered   efficiency\n" );
+
+   for ( i_class=0;  i_class < Num_Classes;  i_class++ ) {
+      Efficiency = (double) Classes [i_class] .Num_Triggered / (double) Classes [i_class] .Num_Injections;
+      printf ( "%5u %11.1f %12llu   %3u %3u   %9u  %9u   %6.3f +- %5.3f\n", i_class + 1, Classes [i_class] .Counts,
+               (long long unsigned int) Classes [i_class] .Duration, Classes [i_class] .Beg_SPEC_Chan, Classes [i_class] .End_SPEC_Chan,
+               Classes [i_class] .Num_Injections, Classes [i_class] .Num_Triggered,
+               Efficiency, sqrt ( Efficiency * ( 1.0 - Efficiency ) / Classes [i_class] .Num_Injections ) );
+   }
+
+}  // Report_Injections ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  One pass over the events of the block of the thread, in chunks, feeding each chunk
+//  to the background, up to the beginning of each injection, which takes its state,
+//  and to the injections underway in it.
+
+static void * Injection_Thread ( void * Arg_ptr ) {
+
+   Injection_Thread_type *  Thread_ptr = Arg_ptr;
+   Trigger_Engine_type *  Background_ptr = &Thread_ptr->Background;
+   Injection_type **  Underway;
+   Injection_type *  Injection_ptr;
+   uint32_t  Num_Underway = 0;
+   uint32_t  Next = 0;
+   uint32_t  i_under;
+   size_t  Chunk_Begin = Thread_ptr->Warm_Up_Begin;
+   size_t  Chunk_End;
+   size_t  Fed = Thread_ptr->Warm_Up_Begin;     // the events fed to the background, up to Fed - 1
+   size_t  From, To;
+
+
+   Underway = malloc ( Thread_ptr->Num_Injections * sizeof (Injection_type *) );
+   if ( Underway == NULL ) {
+      printf ( "\n\nmalloc of injections failed. exiting.\n" );
+      exit (172);
+   }
+
+   Quiet_Engine ( Thread_ptr, Background_ptr );
+   Background_ptr->Warming_Up = true;
+
+   while ( Next < Thread_ptr->Num_Injections  ||  Num_Underway > 0 ) {  // loop over chunks
+
+      Chunk_End = Chunk_Begin + INJECTION_CHUNK;
+      if ( Chunk_End > Thread_ptr->Num_Events )  Chunk_End = Thread_ptr->Num_Events;
+
+      //  The background, up to each injection that begins in the chunk, and to the end of
+      //  the chunk while there are injections to begin:
+
+      while ( Next < Thread_ptr->Num_Injections  &&  Thread_ptr->Injections [Next] ->Begin < Chunk_End ) {
+         Injection_ptr = Thread_ptr->Injections [Next++];
+         Trigger_Engine_Events ( Background_ptr, Thread_ptr->Events + Fed, Injection_ptr->Begin - Fed );
+         Fed = Injection_ptr->Begin;
+         Start_Injection ( Thread_ptr, Injection_ptr );
+         Underway [Num_Underway++] = Injection_ptr;
+      }
+
+      if ( Next < Thread_ptr->Num_Injections ) {
+         Trigger_Engine_Events ( Background_ptr, Thread_ptr->Events + Fed, Chunk_End - Fed );
+         Fed = Chunk_End;
+      }
+
+      //  The injections underway:
+
+      for ( i_under=0;  i_under < Num_Underway;  ) {
+
+         Injection_ptr = Underway [i_under];
+
+         From = ( Chunk_Begin > Injection_ptr->Begin ) ? Chunk_Begin : Injection_ptr->Begin;
+         To = ( Chunk_End < Injection_ptr->End ) ? Chunk_End : Injection_ptr->End;
+         if ( From < To )  Inject_Events ( Thread_ptr, Injection_ptr, From, To );
+
+         if ( Injection_ptr->End <= Chunk_End ) {
+            Finish_Injection ( Injection_ptr );
+            Underway [i_under] = Underway [--Num_Underway];
+         } else {
+            i_under++;
+         }
+
+      }
+
+      Chunk_Begin = Chunk_End;
+
+   }  // loop over chunks
+
+   Close_Trigger_Engine ( Background_ptr );
+   free ( Underway );
+
+   return NULL;
+
+}  // Injection_Thread ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The engine of an injection, with the state of the background, and the first event of
+//  its burst.
+
+static void  Start_Injection ( const Injection_Thread_type * Thread_ptr, Injection_type * Injection_ptr ) {
+
+   Injection_ptr->Engine_ptr = malloc ( sizeof (Trigger_Engine_type) );
+   if ( Injection_ptr->Engine_ptr == NULL ) {
+      printf ( "\n\nmalloc of injections failed. exiting.\n" );
+      exit (172);
+   }
+
+   Quiet_Engine ( Thread_ptr, Injection_ptr->Engine_ptr );
+   Copy_Trigger_Engine_State ( Injection_ptr->Engine_ptr, &Thread_ptr->Background );
+
+   Injection_ptr->Offset = 0;
+   Injection_ptr->Num_Made = 0;
+   Next_Burst_Event ( &Thread_ptr->Classes [Injection_ptr->Class], Injection_ptr );
+
+}  // Start_Injection ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  An engine of the algorithms of the run, without output, with the base times of the
+//  whole file.
+
+static void  Quiet_Engine ( const Injection_Thread_type * Thread_ptr, Trigger_Engine_type * Engine_ptr ) {
+
+   uint32_t  i_band;
+
+
+   Init_Trigger_Engine ( Thread_ptr->Engine_ptr->Num_Algorithms, Thread_ptr->Algorithms, Engine_ptr );
+
+   Engine_ptr->Output = NULL;
+   Engine_ptr->Preset_BaseTimes = true;
+   for ( i_band=0;  i_band < Engine_ptr->Num_Bands;  i_band++ )  Engine_ptr->Bands [i_band] .BaseTime = Thread_ptr->BaseTimes [i_band];
+
+}  // Quiet_Engine ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Feeds the events From to To - 1 to the engine of an injection, merged with the
+//  events of its burst.
+
+static void  Inject_Events ( const Injection_Thread_type * Thread_ptr, Injection_type * Injection_ptr, size_t From, size_t To ) {
+
+   const Processed_TTE_v2_type *  Events = Thread_ptr->Events;
+   const Injection_Class_type *  Class_ptr = &Thread_ptr->Classes [Injection_ptr->Class];
+   Processed_TTE_v2_type *  Buffer = Thread_ptr->Buffer;
+   size_t  Num_in_Buffer = 0;
+   size_t  i_event;
+
+
+   for ( i_event = From;  i_event < To;  i_event++ ) {
+
+      while ( Injection_ptr->Next_Event.Time_in_OneVariable < Events [i_event] .Time_in_OneVariable ) {
+         Buffer [Num_in_Buffer++] = Injection_ptr->Next_Event;
+         Next_Burst_Event ( Class_ptr, Injection_ptr );
+         if ( Num_in_Buffer == INJECTION_BUFFER_SIZE ) {
+            Trigger_Engine_Events ( Injection_ptr->Engine_ptr, Buffer, Num_in_Buffer );
+            Num_in_Buffer = 0;
+         }
+      }
+
+      Buffer [Num_in_Buffer++] = Events [i_event];
+      if ( Num_in_Buffer == INJECTION_BUFFER_SIZE ) {
+         Trigger_Engine_Events ( Injection_ptr->Engine_ptr, Buffer, Num_in_Buffer );
+         Num_in_Buffer = 0;
+      }
+
+   }
+
+   if ( Num_in_Buffer > 0 )  Trigger_Engine_Events ( Injection_ptr->Engine_ptr, Buffer, Num_in_Buffer );
+
+}  // Inject_Events ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The next event of a burst: the intervals between its events are exponential, of the
+//  constant rate of the burst, its detector is drawn from the pattern, and its channel
+//  uniformly from those of the class.   Each event uses random numbers 3n+1 to 3n+3.
+
+static void  Next_Burst_Event ( const Injection_Class_type * Class_ptr, Injection_type * Injection_ptr ) {
+
+   uint64_t  Counter = 3 * Injection_ptr->Num_Made;
+   double  U;
+   uint32_t  j_det;
+   uint32_t  Chan;
+
+
+   Injection_ptr->Next_Event.Time_in_OneVariable = UINT64_MAX;
+   if ( Class_ptr->Counts <= 0 )  return;
+
+   U = Random_Uniform ( Injection_ptr->Key, Counter + 1 );
+   Injection_ptr->Offset -= log ( 1.0 - U ) * (double) Class_ptr->Duration / Class_ptr->Counts;
+   if ( Injection_ptr->Offset >= (double) Class_ptr->Duration )  return;
+
+   U = Random_Uniform ( Injection_ptr->Key, Counter + 2 );
+   for ( j_det=0;  j_det < NUM_NAI_DET - 1  &&  U >= Class_ptr->Cum_Weights [j_det];  j_det++ );
+
+   Chan = Class_ptr->Beg_SPEC_Chan + (uint32_t) ( Random_Uniform ( Injection_ptr->Key, Counter + 3 ) *
+                                                  ( Class_ptr->End_SPEC_Chan - Class_ptr->Beg_SPEC_Chan + 1 ) );
+
+   Injection_ptr->Next_Event.Time_in_OneVariable = Injection_ptr->Time + (uint64_t) Injection_ptr->Offset;
+   Injection_ptr->Next_Event.Detector = (uint8_t) j_det;
+   Injection_ptr->Next_Event.SpecChannel = (uint8_t) Chan;
+   Injection_ptr->Next_Event.Flags = 0;
+   Injection_ptr->Next_Event.Reserved = 0;
+   Injection_ptr->Num_Made++;
+
+}  // Next_Burst_Event ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static void  Finish_Injection ( Injection_type * Injection_ptr ) {
+
+   uint32_t  i_alg;
+
+
+   Injection_ptr->Triggered = false;
+   for ( i_alg=0;  i_alg < Injection_ptr->Engine_ptr->Num_Algorithms;  i_alg++ )
+      if ( Injection_ptr->Engine_ptr->States [i_alg] .Num_Triggers > 0 )  Injection_ptr->Triggered = true;
+
+   Close_Trigger_Engine ( Injection_ptr->Engine_ptr );
+   free ( Injection_ptr->Engine_ptr );
+   Injection_ptr->Engine_ptr = NULL;
+
+}  // Finish_Injection ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static int  Compare_Begin ( const void * A_ptr, const void * B_ptr ) {
+
+   const Injection_type *  A = * (Injection_type * const *) A_ptr;
+   const Injection_type *  B = * (Injection_type * const *) B_ptr;
+
+
+   if ( A->Begin != B->Begin )  return ( A->Begin < B->Begin ) ? -1 : 1;
+   return ( A < B ) ? -1 : ( A > B );
+
+}  // Compare_Begin ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The first event at or after Time, by bisection (Num_Events if none).
+
+static size_t  First_Event_at ( const Processed_TTE_v2_type Events [], size_t Num_Events, uint64_t Time ) {
+
+   size_t  Lo = 0;
+   size_t  Hi = Num_Events;
+   size_t  Mid;
+
+
+   while ( Lo < Hi ) {
+      Mid = Lo + ( Hi - Lo ) / 2;
+      if ( Events [Mid] .Time_in_OneVariable < Time )
+         Lo = Mid + 1;
+      else
+         Hi = Mid;
+   }
+
+   return Lo;
+
+}  // First_Event_at ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The finalizer of SplitMix64.
+
+static uint64_t  Mix64 ( uint64_t z ) {
+
+   z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9LLU;
+   z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBLLU;
+   return z ^ ( z >> 31 );
+
+}  // Mix64 ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The random number Counter of the stream Key, uniform in [0, 1), from the top 53 bits.
+
+static double  Random_Uniform ( uint64_t Key, uint64_t Counter ) {
+
+   return (double) ( Mix64 ( Key + Counter * 0x9E3779B97F4A7C15LLU ) >> 11 ) / 9007199254740992.0;
+
+}  // Random_Uniform ()
@@ -0,0 +1,434 @@
+//  Poisson significance for the trigger engine (see Trigger_Engine.c), for the
+//  algorithms of the table with the statistic "poisson".   The Gaussian significance,
+//  ( counts - expected ) / sqrt (expected), is poor when few counts are expected, as in
+//  a detector at 16 to 64 ms: the Poisson distribution is then skewed, its upper tail
+//  much longer than the Gaussian, so that the Gaussian threshold is crossed far more
+//  often than its false alarm rate, and a single count over nothing is "infinite".
+
+//  For a threshold of T sigma, the counts of a detector are a significant excess when
+//  the Poisson probability of at least that many counts, given the expected counts, is
+//  no more than the probability of the Gaussian tail beyond T sigma, and a significant
+//  deficit when the probability of at most that many counts is no more than it.   So,
+//  as a function of the expected counts, there is a least significant excess,
+//  Up_Limit, and a number of significant deficits, counts 0 to Lo_Limit - 1: two step
+//  functions, which are tabulated once for each threshold (Poisson_Table):
+//     the boundaries, the expected counts at each step, found by Newton's method on the
+//        log of the regularized incomplete gamma function, and
+//     the limits at the beginning of each cell of a grid of the expected counts, 0 to
+//        POISSON_MAX_EXPECTED in steps of 1 / POISSON_CELLS_PER_COUNT.
+//  The limits for the expected counts of a detector are those of its cell, advanced
+//  over the boundaries within the cell, if any -- then the decision is an integer
+//  comparison of the counts.   This is exact: the same decision as the Poisson
+//  probability, without computing it.   The significance in sigma, for the report, is
+//  computed only for the detectors that exceed the threshold.
+
+//  Above POISSON_MAX_EXPECTED counts, where the Poisson distribution is close to
+//  Gaussian, the Gaussian significance is used.
+
+//  Usage:
+//     Table_ptr = Poisson_Table ( Threshold );    ... on the main thread
+//     Deviation = Poisson_Deviation ( Table_ptr, Counts, Expected, &Significance );
+
+
+#include "HSSDB_Progs_Header.h"
+
+#include <float.h>
+#include <math.h>
+
+
+#define  POISSON_MAX_EXPECTED      4096U
+
+#define  POISSON_CELLS_PER_COUNT      8U
+
+#define  MAX_NEWTON_ITERATIONS      200U
+
+#define  LOG_TWO_PI   1.8378770664093454836
+
+
+//  local function prototypes:
+
+static double  Find_Boundary ( uint32_t Counts, _Bool Excess, double Log_Tail, double Lo );
+
+static double  Log_Poisson_Tail ( uint32_t Counts, _Bool Excess, double Expected, double * Slope_ptr );
+
+static void  Log_Gamma_Tails ( double a, double x, double * Log_P_ptr, double * Log_Q_ptr );
+
+static double  Log_Normal_Tail ( double Sigma );
+
+static double  Sigma_of_Log_Tail ( double Log_Tail );
+
+static double *  Grow_Boundaries ( double * Boundaries, uint32_t * Capacity_ptr );
+
+
+//  The tables made so far, one per threshold, kept for the run:
+
+static Poisson_Table_type *  Tables [MAX_TRIGGER_ALGORITHMS];
+static uint32_t  Num_Tables = 0;
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Returns the table of a threshold, making it if it is new.   Not thread safe: the
+//  engines call it from Init_Trigger_Engine, on the main thread.
+
+const Poisson_Table_type * Poisson_Table (
+
+   // Input argument:
+   double Threshold
+
+) {
+
+   Poisson_Table_type *  Table_ptr;
+   uint32_t  Up_Capacity = 1024;
+   uint32_t  Lo_Capacity = 1024;
+   uint32_t  i_table, i_cell;
+   uint32_t  n;
+   double  Expected;
+
+
+   for ( i_table=0;  i_table < Num_Tables;  i_table++ )
+      if ( Tables [i_table] ->Threshold == Threshold )  return Tables [i_table];
+
+   if ( Num_Tables == MAX_TRIGGER_ALGORITHMS ) {
+      printf ( "\n\nMore than %u thresholds for Poisson tables -- Exiting!\n", MAX_TRIGGER_ALGORITHMS );
+      exit (170);
+   }
+
+   Table_ptr = malloc ( sizeof (Poisson_Table_type) );
+   if ( Table_ptr == NULL ) {
+      printf ( "\n\nmalloc of Poisson table failed. exiting.\n" );
+      exit (170);
+   }
+
+   Table_ptr->Threshold = Threshold;
+   Table_ptr->Log_Tail = Log_Normal_Tail ( Threshold );
+   Table_ptr->Max_Expected = POISSON_MAX_EXPECTED;
+   Table_ptr->Cells_per_Count = POISSON_CELLS_PER_COUNT;
+   Table_ptr->Num_Cells = POISSON_MAX_EXPECTED * POISSON_CELLS_PER_COUNT;
+   Table_ptr->Up_Boundary = Grow_Boundaries ( NULL, &Up_Capacity );
+   Table_ptr->Lo_Boundary = Grow_Boundaries ( NULL, &Lo_Capacity );
+   Table_ptr->Up_Cell = malloc ( Table_ptr->Num_Cells * sizeof (uint32_t) );
+   Table_ptr->Lo_Cell = malloc ( Table_ptr->Num_Cells * sizeof (uint32_t) );
+   if ( Table_ptr->Up_Cell == NULL  ||  Table_ptr->Lo_Cell == NULL ) {
+      printf ( "\n\nmalloc of Poisson table failed. exiting.\n" );
+      exit (170);
+   }
+
+
+   //  The boundaries, each from the one before, until beyond the grid.   Up_Boundary [n]
+   //  is the largest expected for which n counts are a significant excess (none for 0
+   //  counts), Lo_Boundary [n] the least for which n counts are a significant deficit:
+
+   Table_ptr->Up_Boundary [0] = -1.0;
+   for ( n=1;  Table_ptr->Up_Boundary [n-1] <= POISSON_MAX_EXPECTED;  n++ ) {
+      if ( n == Up_Capacity )  Table_ptr->Up_Boundary = Grow_Boundaries ( Table_ptr->Up_Boundary, &Up_Capacity );
+      Table_ptr->Up_Boundary [n] = Find_Boundary ( n, true, Table_ptr->Log_Tail, fmax ( Table_ptr->Up_Boundary [n-1], 0.0 ) );
+   }
+   Table_ptr->Num_Up = n;
+
+   for ( n=0;  n == 0  ||  Table_ptr->Lo_Boundary [n-1] <= POISSON_MAX_EXPECTED;  n++ ) {
+      if ( n == Lo_Capacity )  Table_ptr->Lo_Boundary = Grow_Boundaries ( Table_ptr->Lo_Boundary, &Lo_Capacity );
+      Table_ptr->Lo_Boundary [n] = Find_Boundary ( n, false, Table_ptr->Log_Tail, n == 0 ? 0.0 : Table_ptr->Lo_Boundary [n-1] );
+   }
+   Table_ptr->Num_Lo = n;
+
+
+   //  The limits at the beginning of each cell:
+
+   for ( i_cell=0;  i_cell < Table_ptr->Num_Cells;  i_cell++ ) {
+
+      Expected = (double) i_cell / POISSON_CELLS_PER_COUNT;
+
+      n = ( i_cell == 0 ) ? 0 : Table_ptr->Up_Cell [i_cell-1];
+      while ( Expected > Table_ptr->Up_Boundary [n] )  n++;
+      Table_ptr->Up_Cell [i_cell] = n;
+
+      n = ( i_cell == 0 ) ? 0 : Table_ptr->Lo_Cell [i_cell-1];
+      while ( Table_ptr->Lo_Boundary [n] <= Expected )  n++;
+      Table_ptr->Lo_Cell [i_cell] = n;
+
+   }
+
+   Tables [Num_Tables] = Table_ptr;
+   Num_Tables++;
+
+   return Table_ptr;
+
+}  // Poisson_Table ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  Returns +1 for a significant excess of the counts over the expected, -1 for a
+//  significant deficit, else 0; and, when significant, the significance in sigma.
+
+int Poisson_Deviation (
+
+   // Input arguments:
+   const Poisson_Table_type * Table_ptr,
+   uint32_t Counts,
+   double Expected,
+
+   // Output argument:
+   double * Significance_ptr
+
+) {
+
+   uint32_t  i_cell;
+   uint32_t  Up_Limit, Lo_Limit;
+   double  Significance;
+
+
+   if ( ! ( Expected < Table_ptr->Max_Expected ) ) {  // in the grid?
+
+      Significance = ( (double) Counts - Expected ) / sqrt ( Expected );
+      if ( ! ( fabs (Significance) > Table_ptr->Threshold ) )  return 0;
+      *Significance_ptr = Significance;
+      return ( Significance > 0 ) ? 1 : -1;
+
+   }  // in the grid?
+
+   i_cell = (uint32_t) ( Expected * Table_ptr->Cells_per_Count );
+
+   Up_Limit = Table_ptr->Up_Cell [i_cell];
+   while ( Expected > Table_ptr->Up_Boundary [Up_Limit] )  Up_Limit++;
+
+   if ( Counts >= Up_Limit ) {
+      *Significance_ptr = Sigma_of_Log_Tail ( Log_Poisson_Tail ( Counts, true, Expected, NULL ) );
+      return 1;
+   }
+
+   Lo_Limit = Table_ptr->Lo_Cell [i_cell];
+   while ( Table_ptr->Lo_Boundary [Lo_Limit] <= Expected )  Lo_Limit++;
+
+   if ( Counts < Lo_Limit ) {
+      *Significance_ptr = - Sigma_of_Log_Tail ( Log_Poisson_Tail ( Counts, false, Expected, NULL ) );
+      return -1;
+   }
+
+   return 0;
+
+}  // Poisson_Deviation ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The expected counts at which the log of the tail probability of Counts (at least
+//  Counts for an excess, at most for a deficit) equals Log_Tail, by Newton's method,
+//  kept within a bracket.   Lo is below the boundary: the boundary of Counts - 1.
+
+static double  Find_Boundary ( uint32_t Counts, _Bool Excess, double Log_Tail, double Lo ) {
+
+   double  Hi = Lo + 1.0;
+   double  Step = 1.0;
+   double  Expected, Next, Difference, Slope;
+   double  Sign = Excess ? 1.0 : -1.0;      // the tail of an excess grows with the expected, of a deficit falls
+   uint32_t  i_iter;
+
+
+   //  Bracket the boundary: Difference * Sign is negative below it, positive above:
+
+   while ( Sign * ( Log_Poisson_Tail ( Counts, Excess, Hi, NULL ) - Log_Tail ) < 0 ) {
+      Lo = Hi;
+      Step *= 2.0;
+      Hi = Lo + Step;
+   }
+
+   Expected = Hi;
+
+   for ( i_iter=0;  i_iter < MAX_NEWTON_ITERATIONS;  i_iter++ ) {
+
+      Difference = Log_Poisson_Tail ( Counts, Excess, Expected, &Slope ) - Log_Tail;
+
+      if ( Sign * Difference < 0 )
+         Lo = Expected;
+      else
+         Hi = Expected;
+
+      Next = Expected - Difference / Slope;
+      if ( ! ( Next > Lo  &&  Next < Hi ) )  Next = 0.5 * ( Lo + Hi );
+
+      if ( fabs ( Next - Expected ) <= 4.0 * DBL_EPSILON * Next  ||  Hi - Lo <= 4.0 * DBL_EPSILON * Hi )  return Next;
+
+      Expected = Next;
+
+   }
+
+   return Expected;
+
+}  // Find_Boundary ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The log of the Poisson probability of at least Counts (Excess) or at most Counts
+//  (deficit), given the expected counts, and, if Slope_ptr is not NULL, its derivative
+//  with respect to the expected counts.   These are regularized incomplete gamma
+//  functions: P(X >= n) = P (n, Expected), P(X <= n) = Q (n + 1, Expected), whose
+//  derivatives are the Poisson probabilities of n - 1 and n.
+
+static double  Log_Poisson_Tail ( uint32_t Counts, _Bool Excess, double Expected, double * Slope_ptr ) {
+
+   double  Log_P, Log_Q, Log_Tail;
+   double  n_prob;
+
+
+   if ( Excess  &&  Counts == 0 ) {
+      if ( Slope_ptr != NULL )  *Slope_ptr = 0.0;
+      return 0.0;
+   }
+
+   n_prob = Excess ? (double) Counts - 1.0 : (double) Counts;
+
+   Log_Gamma_Tails ( n_prob + 1.0, Expected, &Log_P, &Log_Q );
+   Log_Tail = Excess ? Log_P : Log_Q;
+
+   if ( Slope_ptr != NULL )
+      *Slope_ptr = ( Excess ? 1.0 : -1.0 ) * exp ( n_prob * log (Expected) - Expected - lgamma ( n_prob + 1.0 ) - Log_Tail );
+
+   return Log_Tail;
+
+}  // Log_Poisson_Tail ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The logs of the regularized incomplete gamma functions P (a, x) and Q (a, x) =
+//  1 - P (a, x): for x < a + 1 from the series of P, else from the continued fraction
+//  of Q (Numerical Recipes, 6.2), each computed directly where it is small.
+
+static void  Log_Gamma_Tails ( double a, double x, double * Log_P_ptr, double * Log_Q_ptr ) {
+
+   double  Log_Prefactor;
+   double  Sum, Term, ap;
+   double  b, c, d, h, an, del;
+   uint32_t  i;
+
+
+   if ( x <= 0 ) {
+      *Log_P_ptr = -INFINITY;
+      *Log_Q_ptr = 0.0;
+      return;
+   }
+
+   Log_Prefactor = a * log (x) - x - lgamma (a);
+
+   if ( x < a + 1.0 ) {  // series ?
+
+      ap = a;
+      Term = 1.0 / a;
+      Sum = Term;
+      for ( i=0;  i < 1000000;  i++ ) {
+         ap += 1.0;
+         Term *= x / ap;
+         Sum += Term;
+         if ( Term < Sum * DBL_EPSILON )  break;
+      }
+
+      *Log_P_ptr = log (Sum) + Log_Prefactor;
+      *Log_Q_ptr = log1p ( - exp (*Log_P_ptr) );
+
+   } else {  // series ?
+
+      b = x + 1.0 - a;
+      c = 1.0 / DBL_MIN;
+      d = 1.0 / b;
+      h = d;
+      for ( i=1;  i < 1000000;  i++ ) {
+         an = - (double) i * ( (double) i - a );
+         b += 2.0;
+         d = an * d + b;
+         if ( fabs (d) < DBL_MIN )  d = DBL_MIN;
+         c = b + an / c;
+         if ( fabs (c) < DBL_MIN )  c = DBL_MIN;
+         d = 1.0 / d;
+         del = d * c;
+         h *= del;
+         if ( fabs ( del - 1.0 ) < DBL_EPSILON )  break;
+      }
+
+      *Log_Q_ptr = log (h) + Log_Prefactor;
+      *Log_P_ptr = log1p ( - exp (*Log_Q_ptr) );
+
+   }  // series ?
+
+}  // Log_Gamma_Tails ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The log of the probability of the Gaussian tail beyond Sigma, asymptotically where
+//  erfc underflows.
+
+static double  Log_Normal_Tail ( double Sigma ) {
+
+   double  z2;
+
+
+   if ( Sigma < 20.0 )  return log ( 0.5 * erfc ( Sigma / sqrt (2.0) ) );
+
+   z2 = Sigma * Sigma;
+   return - 0.5 * z2 - log (Sigma) - 0.5 * LOG_TWO_PI + log1p ( - 1.0 / z2 + 3.0 / ( z2 * z2 ) - 15.0 / ( z2 * z2 * z2 ) );
+
+}  // Log_Normal_Tail ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+//  The significance in sigma of a tail probability, i.e., of the Gaussian tail of the
+//  same probability, by bisection.   A probability of zero is infinitely significant.
+
+static double  Sigma_of_Log_Tail ( double Log_Tail ) {
+
+   double  Lo = -40.0;
+   double  Hi, Mid;
+   uint32_t  i_iter;
+
+
+   if ( Log_Tail == -INFINITY )  return INFINITY;
+
+   Hi = sqrt ( -2.0 * Log_Tail ) + 2.0;
+
+   for ( i_iter=0;  i_iter < 100;  i_iter++ ) {
+      Mid = 0.5 * ( Lo + Hi );
+      if ( Log_Normal_Tail (Mid) > Log_Tail )
+         Lo = Mid;
+      else
+         Hi = Mid;
+   }
+
+   return 0.5 * ( Lo + Hi );
+
+}  // Sigma_of_Log_Tail ()
+
+
+
+//   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***   ***
+
+
+static double *  Grow_Boundaries ( double * Boundaries, uint32_t * Capacity_ptr ) {
+
+   if ( Boundaries != NULL )  *Capacity_ptr *= 2;
+
+   Boundaries = realloc ( Boundaries, *Capacity_ptr * sizeof (double) );
+   if ( Boundaries == NULL ) {
+      printf ( "\n\nmalloc of Poisson table failed. exiting.\n" );
+      exit (170);
+   }
+
+   return Boundaries;
+
+}  // Grow_Boundaries ()